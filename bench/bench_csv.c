@@ -0,0 +1,190 @@
+#include "csv.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Synthetic capture: one chain of 4 matrices refreshed row by row */
+#define BENCH_DEVICES 4
+#define BENCH_RECORDS 500000
+
+/* Nominal SPI byte period [ns] and row period [ns] */
+#define BENCH_BYTE_PERIOD 1000
+#define BENCH_ROW_PERIOD 125000
+
+/* Capture starts this long before the trigger [ns] */
+#define BENCH_PRETRIGGER 50000000
+
+/* Size of chunks passed to the parser, as read from a pipe */
+#define BENCH_CHUNK 65536
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Generated export text */
+typedef struct
+{
+    char* text;
+    size length;
+    size capacity;
+    u64 lines;
+} Export;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* Append one data line, timestamp relative to the trigger [ns] */
+static bool AppendLine(Export* export, long long timestamp, const char* mosi,
+        int cs)
+{
+    if (export->capacity - export->length < 64) {
+        size capacity = 2 * export->capacity;
+        char* grown = realloc(export->text, capacity);
+        if (grown == NULL) {
+            return false;
+        }
+        export->text = grown;
+        export->capacity = capacity;
+    }
+
+    unsigned long long magnitude = (unsigned long long)
+            (timestamp < 0 ? -timestamp : timestamp);
+    export->length += (size)snprintf(&export->text[export->length],
+            export->capacity - export->length, "%s%llu.%09llu,%s,%d\n",
+            timestamp < 0 ? "-" : "", magnitude / 1000000000u,
+            magnitude % 1000000000u, mosi, cs);
+    ++export->lines;
+    return true;
+}
+
+/* Generate row refresh traffic starting before trigger, MOSI as bytes or words */
+static bool Generate(Export* export, bool words)
+{
+    static const char header[] = "Time [s],MOSI,CS\n";
+    export->capacity = 1u << 20;
+    export->text = malloc(export->capacity);
+    if (export->text == NULL) {
+        return false;
+    }
+    memcpy(export->text, header, sizeof(header) - 1);
+    export->length = sizeof(header) - 1;
+    export->lines = 1;
+
+    long long timestamp = -BENCH_PRETRIGGER;
+    for (size i = 0; i < BENCH_RECORDS; ++i) {
+        unsigned row = (unsigned)(i % MAX7219_DIGITS) + 1;
+        for (size device = 0; device < BENCH_DEVICES; ++device) {
+            char mosi[8];
+            unsigned data = (unsigned)((i * 31 + device * 7) & 0xFF);
+            if (words) {
+                snprintf(mosi, sizeof(mosi), "0x%02X%02X", row, data);
+                if (!AppendLine(export, timestamp, mosi, 0)) {
+                    return false;
+                }
+            } else {
+                snprintf(mosi, sizeof(mosi), "0x%02X", row);
+                if (!AppendLine(export, timestamp, mosi, 0)) {
+                    return false;
+                }
+                timestamp += BENCH_BYTE_PERIOD;
+                snprintf(mosi, sizeof(mosi), "0x%02X", data);
+                if (!AppendLine(export, timestamp, mosi, 0)) {
+                    return false;
+                }
+            }
+            timestamp += BENCH_BYTE_PERIOD;
+        }
+        if (!AppendLine(export, timestamp, "", 1)) {
+            return false;
+        }
+        timestamp += BENCH_ROW_PERIOD;
+    }
+    return true;
+}
+
+/* Count emitted records and frames */
+static TRACE_Status CountRecord(void* context, const TRACE_Record* record)
+{
+    u64* frames = context;
+    frames[0] += 1;
+    frames[1] += record->count;
+    return TRACE_StatusOk;
+}
+
+/* Parse export in pipe-sized chunks, returns false on parse error */
+static bool Parse(const Export* export, const char* name)
+{
+    u64 counts[2] = {0, 0};
+    CSV_Parser parser;
+    CSV_Create(&parser, 0, CountRecord, counts);
+
+    double start = Now();
+    CSV_Status status = CSV_StatusOk;
+    for (size offset = 0; status == CSV_StatusOk && offset < export->length;
+            offset += BENCH_CHUNK) {
+        size chunk = export->length - offset;
+        if (chunk > BENCH_CHUNK) {
+            chunk = BENCH_CHUNK;
+        }
+        status = CSV_Feed(&parser, &export->text[offset], chunk);
+    }
+    if (status == CSV_StatusOk) {
+        status = CSV_Finish(&parser);
+    }
+    double elapsed = Now() - start;
+    CSV_Destroy(&parser);
+
+    printf("%-6s %10zu B  %9llu lines  %6.3f s  %7.1f MB/s  %6.1f Mlines/s\n",
+           name,
+           export->length,
+           (unsigned long long)export->lines,
+           elapsed,
+           (double)export->length / elapsed / 1e6,
+           (double)export->lines / elapsed / 1e6);
+
+    return status == CSV_StatusOk
+            && counts[0] == BENCH_RECORDS
+            && counts[1] == (u64)BENCH_RECORDS * BENCH_DEVICES;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Main ---------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    Export bytes = {0};
+    Export words = {0};
+    if (!Generate(&bytes, false) || !Generate(&words, true)) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%d records, %d devices, capture starts %d ns before trigger\n",
+           BENCH_RECORDS, BENCH_DEVICES, BENCH_PRETRIGGER);
+    bool ok = Parse(&bytes, "bytes") && Parse(&words, "words");
+
+    free(bytes.text);
+    free(words.text);
+
+    if (!ok) {
+        fprintf(stderr, "Export was not parsed completely\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
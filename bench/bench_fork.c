@@ -0,0 +1,146 @@
+#include "chain.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Device farm: 100K devices split into chains */
+#define BENCH_CHAINS 1000
+#define BENCH_DEVICES 100
+
+/* Number of what-if branches and chains driven differently in each one */
+#define BENCH_BRANCHES 200
+#define BENCH_DRIVEN 10
+
+/* Single long chain: forks of it pay a whole-chain copy on the first write */
+#define BENCH_LARGE_DEVICES 100000
+#define BENCH_LARGE_FORKS 100
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* Write single row into every device of the chain */
+static void DriveRow(CHAIN_Instance* chain, u8 row, u8 value)
+{
+    for (size i = 0; i < chain->length; ++i) {
+        CHAIN_Shift(chain, MAX7219_FRAME(MAX7219_RegDigit0 + row, value));
+    }
+    CHAIN_Latch(chain);
+}
+
+/* Measure first and second single-frame write to forks of one long chain */
+static bool RunLargeChain(void)
+{
+    CHAIN_Instance source;
+    if (CHAIN_Create(&source, BENCH_LARGE_DEVICES) != CHAIN_StatusOk) {
+        return false;
+    }
+
+    double forkTime = 0.0;
+    double firstTime = 0.0;
+    double nextTime = 0.0;
+    bool failed = false;
+    for (size i = 0; i < BENCH_LARGE_FORKS; ++i) {
+        CHAIN_Instance fork;
+        double start = Now();
+        CHAIN_Fork(&source, &fork);
+        double forked = Now();
+        CHAIN_Shift(&fork, MAX7219_FRAME(MAX7219_RegDigit0, (u8)i));
+        double first = Now();
+        CHAIN_Shift(&fork, MAX7219_FRAME(MAX7219_RegDigit0 + 1, (u8)i));
+        double next = Now();
+
+        forkTime += forked - start;
+        firstTime += first - forked;
+        nextTime += next - first;
+        failed = failed || fork.failed;
+        CHAIN_Destroy(&fork);
+    }
+
+    printf("%d devices in one chain, %zu B storage\n", BENCH_LARGE_DEVICES,
+           source.storageSize);
+    printf("fork   %8.3f us, first write %8.3f us (whole chain copied), "
+           "next write %8.3f us\n",
+           1e6 * forkTime / BENCH_LARGE_FORKS,
+           1e6 * firstTime / BENCH_LARGE_FORKS,
+           1e6 * nextTime / BENCH_LARGE_FORKS);
+
+    CHAIN_Destroy(&source);
+    return !failed;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Main ---------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    CHAIN_Instance* farm = calloc(BENCH_CHAINS, sizeof(*farm));
+    CHAIN_Instance* branches =
+            calloc((size)BENCH_BRANCHES * BENCH_CHAINS, sizeof(*branches));
+    if (farm == NULL || branches == NULL) {
+        return EXIT_FAILURE;
+    }
+    for (size i = 0; i < BENCH_CHAINS; ++i) {
+        if (CHAIN_Create(&farm[i], BENCH_DEVICES) != CHAIN_StatusOk) {
+            return EXIT_FAILURE;
+        }
+        DriveRow(&farm[i], 0, (u8)i);
+    }
+
+    double start = Now();
+    for (size b = 0; b < BENCH_BRANCHES; ++b) {
+        for (size i = 0; i < BENCH_CHAINS; ++i) {
+            CHAIN_Fork(&farm[i], &branches[b * BENCH_CHAINS + i]);
+        }
+    }
+    double forkTime = Now() - start;
+
+    /* Every branch tries a different firmware variant on a few chains */
+    start = Now();
+    size copied = 0;
+    for (size b = 0; b < BENCH_BRANCHES; ++b) {
+        for (size d = 0; d < BENCH_DRIVEN; ++d) {
+            CHAIN_Instance* chain =
+                    &branches[b * BENCH_CHAINS + (b * 7 + d * 97) % BENCH_CHAINS];
+            copied += chain->shared;
+            DriveRow(chain, 1, (u8)b);
+            CHAIN_Render(chain);
+        }
+    }
+    double driveTime = Now() - start;
+
+    size storage = farm[0].storageSize;
+    printf("%d branches of %d devices\n", BENCH_BRANCHES,
+           BENCH_CHAINS * BENCH_DEVICES);
+    printf("fork   %8.3f ms total, %.3f ms per branch\n",
+           1e3 * forkTime, 1e3 * forkTime / BENCH_BRANCHES);
+    printf("drive  %8.3f ms, %zu chain copies\n", 1e3 * driveTime, copied);
+    printf("memory %8.1f MB copied, %.1f MB for full copies\n",
+           (double)(copied * storage) / 1e6,
+           (double)BENCH_BRANCHES * BENCH_CHAINS * storage / 1e6);
+
+    for (size i = 0; i < (size)BENCH_BRANCHES * BENCH_CHAINS; ++i) {
+        CHAIN_Destroy(&branches[i]);
+    }
+    for (size i = 0; i < BENCH_CHAINS; ++i) {
+        CHAIN_Destroy(&farm[i]);
+    }
+    free(branches);
+    free(farm);
+
+    return RunLargeChain() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,75 @@
+#include "golden.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* One million frames of a 16-device chain, 128 MB per side */
+#define BENCH_FRAMES 1000000
+#define BENCH_DEVICES 16
+
+/* Number of comparisons of the whole sequence */
+#define BENCH_ROUNDS 5
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Main ---------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    size words = (size)BENCH_FRAMES * BENCH_DEVICES;
+    u64* actual = malloc(words * sizeof(u64));
+    u64* expected = malloc(words * sizeof(u64));
+    if (actual == NULL || expected == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    u64 seed = UINT64_C(0x9E3779B97F4A7C15);
+    for (size i = 0; i < words; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        actual[i] = seed;
+    }
+    memcpy(expected, actual, words * sizeof(u64));
+
+    /* A few LEDs differ in the last tenth of the sequence */
+    for (size i = words - words / 10; i < words; i += 4099) {
+        expected[i] ^= UINT64_C(1) << (i % 64);
+    }
+
+    GOLDEN_Result result;
+    double start = Now();
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        GOLDEN_Compare(actual, expected, BENCH_FRAMES, BENCH_DEVICES, &result);
+    }
+    double elapsed = (Now() - start) / BENCH_ROUNDS;
+
+    printf("%d frames x %d devices\n", BENCH_FRAMES, BENCH_DEVICES);
+    printf("compare %7.3f ms (%.0f MB/s), %llu LEDs in %zu frames differ, "
+           "first at frame %zu device %zu\n",
+           1e3 * elapsed, 2.0 * (double)words * sizeof(u64) / elapsed / 1e6,
+           (unsigned long long)result.differingLeds, result.differingFrames,
+           result.firstFrame, result.firstDevice);
+
+    free(actual);
+    free(expected);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+#include "hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Firmware redrawing a 16-device matrix row by row */
+#define BENCH_DEVICES 16
+#define BENCH_REFRESHES 100000
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Main ---------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    CHAIN_Instance chain;
+    if (CHAIN_Create(&chain, BENCH_DEVICES) != CHAIN_StatusOk
+            || HAL_Bind(&chain, 1) != HAL_StatusOk) {
+        return EXIT_FAILURE;
+    }
+
+    static const u8 wake[] = { MAX7219_RegShutdown, 1 };
+    for (size device = 0; device < BENCH_DEVICES; ++device) {
+        spi_select(0, true);
+        spi_write(0, wake, sizeof(wake));
+    }
+    spi_select(0, false);
+
+    /* One transaction per row, scrolling pattern changes every refresh */
+    u8 row[2 * BENCH_DEVICES];
+    double start = Now();
+    for (size refresh = 0; refresh < BENCH_REFRESHES; ++refresh) {
+        for (u8 digit = 0; digit < MAX7219_DIGITS; ++digit) {
+            for (size device = 0; device < BENCH_DEVICES; ++device) {
+                row[2 * device] = MAX7219_RegDigit0 + digit;
+                row[2 * device + 1] = (u8)(refresh + device + digit);
+            }
+            spi_write(0, row, sizeof(row));
+        }
+    }
+    double elapsed = Now() - start;
+
+    u64 frames = (u64)BENCH_REFRESHES * MAX7219_DIGITS * BENCH_DEVICES;
+    printf("%llu frames in %d transactions, %.3f s, %.1f Mframes/s, %.1f ns per spi_write\n",
+           (unsigned long long)frames, BENCH_REFRESHES * MAX7219_DIGITS, elapsed,
+           (double)frames / elapsed / 1e6,
+           1e9 * elapsed / (BENCH_REFRESHES * MAX7219_DIGITS));
+
+    /* The wake-up transaction latched one frame per device as well */
+    bool complete = chain.frames == frames + BENCH_DEVICES;
+    HAL_Unbind();
+    CHAIN_Destroy(&chain);
+    return complete ? EXIT_SUCCESS : EXIT_FAILURE;
+}
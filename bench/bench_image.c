@@ -0,0 +1,121 @@
+#include "chain.h"
+#include "image.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* 8 chains of 8 matrices drawn with 8 px LEDs give a 512x512 image */
+#define BENCH_CHAINS 8
+#define BENCH_DEVICES 8
+#define BENCH_LED_SIZE 8
+
+/* Number of exported frames */
+#define BENCH_FRAMES 200
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* Display new pattern on every device, so each frame is fully redrawn */
+static void Drive(CHAIN_Instance* chain, u8 seed)
+{
+    u16 frames[BENCH_DEVICES];
+    for (size row = 0; row < MAX7219_DIGITS; ++row) {
+        for (size i = 0; i < BENCH_DEVICES; ++i) {
+            frames[i] = MAX7219_FRAME(MAX7219_RegDigit0 + row,
+                    (u8)(seed * 37 + i * 11 + row * 5));
+        }
+        CHAIN_Transfer(chain, frames, BENCH_DEVICES);
+    }
+}
+
+/* Export frames in given format, returns seconds per frame */
+static double Export(IMAGE_Raster* raster, FILE* sink, bool png, double* encodeTime)
+{
+    double start = Now();
+    *encodeTime = 0.0;
+    for (size frame = 0; frame < BENCH_FRAMES; ++frame) {
+        for (size c = 0; c < BENCH_CHAINS; ++c) {
+            Drive(&raster->chains[c], (u8)(frame + c));
+        }
+
+        double encode = Now();
+        IMAGE_Rasterize(raster);
+        IMAGE_Status status = png
+                ? IMAGE_WritePng(raster, sink)
+                : IMAGE_WritePpm(raster, sink);
+        *encodeTime += Now() - encode;
+        if (status != IMAGE_StatusOk) {
+            return -1.0;
+        }
+    }
+    *encodeTime /= BENCH_FRAMES;
+    return (Now() - start) / BENCH_FRAMES;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Main ---------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    CHAIN_Instance chains[BENCH_CHAINS];
+    for (size i = 0; i < BENCH_CHAINS; ++i) {
+        if (CHAIN_Create(&chains[i], BENCH_DEVICES) != CHAIN_StatusOk) {
+            return EXIT_FAILURE;
+        }
+        u16 frames[BENCH_DEVICES];
+        for (size d = 0; d < BENCH_DEVICES; ++d) {
+            frames[d] = MAX7219_FRAME(MAX7219_RegScanLimit, 0x07);
+        }
+        CHAIN_Transfer(&chains[i], frames, BENCH_DEVICES);
+        for (size d = 0; d < BENCH_DEVICES; ++d) {
+            frames[d] = MAX7219_FRAME(MAX7219_RegShutdown, 0x01);
+        }
+        CHAIN_Transfer(&chains[i], frames, BENCH_DEVICES);
+    }
+
+    IMAGE_Raster raster;
+    FILE* sink = fopen("/dev/null", "wb");
+    if (sink == NULL || IMAGE_Create(&raster, chains, BENCH_CHAINS,
+            BENCH_DEVICES, BENCH_LED_SIZE) != IMAGE_StatusOk) {
+        return EXIT_FAILURE;
+    }
+
+    double bytes = (double)raster.width * raster.height * IMAGE_CHANNELS;
+    printf("%ux%u px, %d frames\n", raster.width, raster.height, BENCH_FRAMES);
+
+    bool failed = false;
+    for (int png = 0; png < 2; ++png) {
+        double encode;
+        double total = Export(&raster, sink, png, &encode);
+        failed |= total < 0.0;
+        printf("%s rasterize+write %7.3f ms/frame (%6.0f MB/s), frame total %7.3f ms\n",
+               png ? "png" : "ppm", 1e3 * encode, bytes / encode / 1e6, 1e3 * total);
+    }
+
+    fclose(sink);
+    IMAGE_Destroy(&raster);
+    for (size i = 0; i < BENCH_CHAINS; ++i) {
+        CHAIN_Destroy(&chains[i]);
+    }
+
+    if (failed) {
+        fprintf(stderr, "Image could not be written\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
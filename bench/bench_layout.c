@@ -0,0 +1,83 @@
+#include "layout.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Serpentine board of 64x64 modules (4096 devices, 512x512 px) */
+#define BENCH_COLUMNS 64
+#define BENCH_ROWS 64
+
+/* Number of composed canvases */
+#define BENCH_ROUNDS 200
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Main ---------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    LAYOUT_Descriptor descriptor = {
+        .columns = BENCH_COLUMNS,
+        .rows = BENCH_ROWS,
+        .order = LAYOUT_OrderRowSerpentine,
+        .rotation = LAYOUT_Rotate90,
+        .rotateReversed = true
+    };
+
+    double start = Now();
+    LAYOUT_Map map;
+    if (LAYOUT_Create(&map, &descriptor) != LAYOUT_StatusOk) {
+        return EXIT_FAILURE;
+    }
+    double compile = Now() - start;
+
+    u64* bitboards = malloc(map.devices * sizeof(u64));
+    u64* canvas = malloc(LAYOUT_CanvasWords(&map) * sizeof(u64));
+    if (bitboards == NULL || canvas == NULL) {
+        return EXIT_FAILURE;
+    }
+    u64 seed = UINT64_C(0x9E3779B97F4A7C15);
+    for (size i = 0; i < map.devices; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        bitboards[i] = seed;
+    }
+
+    start = Now();
+    u64 checksum = 0;
+    for (size round = 0; round < BENCH_ROUNDS; ++round) {
+        bitboards[round % map.devices] ^= round;
+        LAYOUT_Gather(&map, bitboards, map.devices, canvas);
+        checksum += canvas[round % LAYOUT_CanvasWords(&map)];
+    }
+    double gather = (Now() - start) / BENCH_ROUNDS;
+
+    printf("%zu devices, %zux%zu px\n", map.devices, map.width, map.height);
+    printf("compile %7.3f ms\n", 1e3 * compile);
+    printf("gather  %7.3f ms (%.1f Mpx/s), checksum %llx\n", 1e3 * gather,
+           (double)(map.width * map.height) / gather / 1e6,
+           (unsigned long long)checksum);
+
+    free(canvas);
+    free(bitboards);
+    LAYOUT_Destroy(&map);
+    return EXIT_SUCCESS;
+}
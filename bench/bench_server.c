@@ -0,0 +1,120 @@
+#include "server.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Ten million frames of a 16-device chain, 4096 frames per message */
+#define BENCH_DEVICES 16
+#define BENCH_BATCH 4096
+#define BENCH_MESSAGES 2442
+
+#define BENCH_PATH "/tmp/bench_server.sock"
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* Server thread entry point */
+static void* ServerThread(void* argument)
+{
+    SERVER_Run(argument);
+    return NULL;
+}
+
+/* Write whole buffer */
+static bool WriteAll(int fd, const void* buffer, size length)
+{
+    const u8* bytes = buffer;
+    while (length > 0) {
+        ssize_t count = write(fd, bytes, length);
+        if (count <= 0) {
+            return false;
+        }
+        bytes += count;
+        length -= (size)count;
+    }
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Main ---------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    SERVER_Instance server;
+    if (SERVER_Create(&server, BENCH_PATH, 1, BENCH_DEVICES, 1) != SERVER_StatusOk) {
+        return EXIT_FAILURE;
+    }
+    pthread_t thread;
+    pthread_create(&thread, NULL, ServerThread, &server);
+
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    strcpy(address.sun_path, BENCH_PATH);
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connect(client, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    static u8 message[sizeof(SERVER_Header) + BENCH_BATCH * sizeof(u16)];
+    SERVER_Header header = {
+        .length = BENCH_BATCH * sizeof(u16),
+        .type = SERVER_MessageFrames,
+        .chain = 0
+    };
+    memcpy(message, &header, sizeof(header));
+    u16* frames = (u16*)(message + sizeof(header));
+    for (size i = 0; i < BENCH_BATCH; ++i) {
+        frames[i] = MAX7219_FRAME(MAX7219_RegDigit0 + (i / BENCH_DEVICES) % 8, i);
+    }
+
+    /* The display reply arrives after all frames have been applied */
+    double start = Now();
+    for (size i = 0; i < BENCH_MESSAGES; ++i) {
+        if (!WriteAll(client, message, sizeof(message))) {
+            return EXIT_FAILURE;
+        }
+    }
+    SERVER_Header request = {.type = SERVER_MessageDisplay};
+    static u8 reply[sizeof(SERVER_Header) + BENCH_DEVICES * sizeof(u64)];
+    WriteAll(client, &request, sizeof(request));
+    for (size received = 0; received < sizeof(reply);) {
+        ssize_t count = read(client, reply + received, sizeof(reply) - received);
+        if (count <= 0) {
+            return EXIT_FAILURE;
+        }
+        received += (size)count;
+    }
+    double elapsed = Now() - start;
+
+    close(client);
+    SERVER_Stop(&server);
+    pthread_join(thread, NULL);
+
+    SERVER_Stats total;
+    SERVER_Total(&server, &total);
+    printf("%llu frames in %llu messages, %.3f s, %.1f Mframes/s\n",
+           (unsigned long long)total.frames, (unsigned long long)total.messages,
+           elapsed, (double)total.frames / elapsed / 1e6);
+
+    SERVER_Destroy(&server);
+    return EXIT_SUCCESS;
+}
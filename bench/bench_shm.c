@@ -0,0 +1,93 @@
+#include "shm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Ten million frames sent as 16-device transactions */
+#define BENCH_DEVICES 16
+#define BENCH_TRANSACTIONS 625000
+
+#define BENCH_NAME "/bench_shm"
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* Firmware process: send scrolling digit writes, then close */
+static int Produce(void)
+{
+    SHM_Ring ring;
+    if (SHM_Open(&ring, BENCH_NAME) != SHM_StatusOk) {
+        return EXIT_FAILURE;
+    }
+
+    u16 frames[BENCH_DEVICES];
+    for (size i = 0; i < BENCH_TRANSACTIONS; ++i) {
+        for (size device = 0; device < BENCH_DEVICES; ++device) {
+            frames[device] = MAX7219_FRAME(MAX7219_RegDigit0 + i % 8, i + device);
+        }
+        if (SHM_Send(&ring, 0, frames, BENCH_DEVICES, SHM_WAIT_FOREVER)
+                != SHM_StatusOk) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    SHM_Close(&ring);
+    return EXIT_SUCCESS;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Main ---------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    CHAIN_Instance chain;
+    SHM_Ring ring;
+    if (CHAIN_Create(&chain, BENCH_DEVICES) != CHAIN_StatusOk
+            || SHM_Create(&ring, BENCH_NAME, SHM_DEFAULT_CAPACITY, 1, BENCH_DEVICES)
+                    != SHM_StatusOk) {
+        return EXIT_FAILURE;
+    }
+
+    double start = Now();
+    pid_t child = fork();
+    if (child == 0) {
+        return Produce();
+    }
+
+    u64 frames = 0;
+    u64 batches = 0;
+    size received;
+    while (SHM_Receive(&ring, &chain, SHM_WAIT_FOREVER, &received) == SHM_StatusOk) {
+        frames += received;
+        ++batches;
+    }
+    double elapsed = Now() - start;
+
+    int result;
+    waitpid(child, &result, 0);
+    printf("%llu frames in %llu batches, %.3f s, %.1f Mframes/s, %.0f frames per wakeup\n",
+           (unsigned long long)frames, (unsigned long long)batches, elapsed,
+           (double)frames / elapsed / 1e6,
+           batches > 0 ? (double)frames / (double)batches : 0.0);
+
+    SHM_Close(&ring);
+    CHAIN_Destroy(&chain);
+    return (frames == (u64)BENCH_TRANSACTIONS * BENCH_DEVICES) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
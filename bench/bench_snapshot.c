@@ -0,0 +1,106 @@
+#include "chain.h"
+#include "snapshot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Device farm: 100K devices split into chains */
+#define BENCH_CHAINS 1000
+#define BENCH_DEVICES 100
+
+/* Number of checkpoints taken and restored */
+#define BENCH_ROUNDS 20
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* Bring every device into normal operation with some pattern displayed */
+static void Drive(CHAIN_Instance* chain, u8 seed)
+{
+    u16 frames[BENCH_DEVICES];
+    for (size row = 0; row < MAX7219_DIGITS; ++row) {
+        for (size i = 0; i < BENCH_DEVICES; ++i) {
+            frames[i] = MAX7219_FRAME(MAX7219_RegDigit0 + row, seed + i * row);
+        }
+        CHAIN_Transfer(chain, frames, BENCH_DEVICES);
+    }
+    for (size i = 0; i < BENCH_DEVICES; ++i) {
+        frames[i] = MAX7219_FRAME(MAX7219_RegShutdown, 0x01);
+    }
+    CHAIN_Transfer(chain, frames, BENCH_DEVICES);
+    CHAIN_Render(chain);
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Main ---------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    CHAIN_Instance* chains = calloc(BENCH_CHAINS, sizeof(*chains));
+    if (chains == NULL) {
+        return EXIT_FAILURE;
+    }
+    for (size i = 0; i < BENCH_CHAINS; ++i) {
+        if (CHAIN_Create(&chains[i], BENCH_DEVICES) != CHAIN_StatusOk) {
+            return EXIT_FAILURE;
+        }
+        Drive(&chains[i], (u8)i);
+    }
+
+    size length = SNAPSHOT_Size(chains, BENCH_CHAINS);
+    void* buffer = malloc(length);
+    if (buffer == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    /* Touch the buffer once so page faults are not measured */
+    memset(buffer, 0, length);
+
+    double saveTime = 0.0;
+    double restoreTime = 0.0;
+    bool failed = false;
+    for (size round = 0; round < BENCH_ROUNDS; ++round) {
+        double start = Now();
+        failed |= SNAPSHOT_Save(chains, BENCH_CHAINS, buffer, length)
+                != SNAPSHOT_StatusOk;
+        saveTime += Now() - start;
+
+        start = Now();
+        failed |= SNAPSHOT_Restore(chains, BENCH_CHAINS, buffer, length)
+                != SNAPSHOT_StatusOk;
+        restoreTime += Now() - start;
+    }
+
+    printf("%d devices in %d chains, snapshot %zu B\n",
+           BENCH_CHAINS * BENCH_DEVICES, BENCH_CHAINS, length);
+    printf("save    %7.3f ms\n", 1e3 * saveTime / BENCH_ROUNDS);
+    printf("restore %7.3f ms\n", 1e3 * restoreTime / BENCH_ROUNDS);
+
+    free(buffer);
+    for (size i = 0; i < BENCH_CHAINS; ++i) {
+        CHAIN_Destroy(&chains[i]);
+    }
+    free(chains);
+
+    if (failed) {
+        fprintf(stderr, "Snapshot could not be saved or restored\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+#include "chain.h"
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Synthetic setup: one chain of 4 matrices refreshed row by row */
+#define BENCH_DEVICES 4
+#define BENCH_RECORDS 2000000
+
+/* Nominal row period [ns] and its jitter */
+#define BENCH_ROW_PERIOD 125000
+#define BENCH_ROW_JITTER 64
+
+/* One in BENCH_CHANGE_RATE display refreshes modifies a row */
+#define BENCH_CHANGE_RATE 20
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Results of writing and replaying single trace */
+typedef struct
+{
+    const char* name;
+    size bytes;
+    double writeTime;
+    double replayTime;
+    u64 framebuffer[BENCH_DEVICES];
+} Result;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* Deterministic pseudo-random generator (xorshift64) */
+static u64 Random(u64* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/* Write refresh-heavy traffic: every row is re-sent although rarely changed */
+static TRACE_Status WriteTraffic(TRACE_Writer* writer)
+{
+    u8 canvas[MAX7219_DIGITS][BENCH_DEVICES] = {{0}};
+    u64 state = 0x9E3779B97F4A7C15u;
+    u64 timestamp = 0;
+
+    for (size i = 0; i < BENCH_RECORDS; ++i) {
+        u8 row = (u8)(i % MAX7219_DIGITS);
+        if (row == 0 && Random(&state) % BENCH_CHANGE_RATE == 0) {
+            u64 bits = Random(&state);
+            memcpy(canvas[bits % MAX7219_DIGITS], &bits, BENCH_DEVICES);
+        }
+
+        u16 frames[BENCH_DEVICES];
+        for (size device = 0; device < BENCH_DEVICES; ++device) {
+            frames[device] = MAX7219_FRAME(MAX7219_RegDigit0 + row,
+                    canvas[row][device]);
+        }
+
+        timestamp += BENCH_ROW_PERIOD + Random(&state) % BENCH_ROW_JITTER;
+        TRACE_Status status = TRACE_WriteRecord(writer, 0, timestamp, frames,
+                BENCH_DEVICES);
+        if (status != TRACE_StatusOk) {
+            return status;
+        }
+    }
+    return TRACE_StatusOk;
+}
+
+/* Write trace with given writer type, then map it and replay into a chain */
+static bool Run(Result* result, bool compressed)
+{
+    char path[] = "/tmp/bench_trace_XXXXXX";
+    int fd = mkstemp(path);
+    FILE* file = (fd >= 0) ? fdopen(fd, "wb") : NULL;
+    if (file == NULL) {
+        return false;
+    }
+
+    double start = Now();
+    TRACE_Writer writer;
+    TRACE_Status status = compressed
+            ? TRACE_WriterInitCompressed(&writer, file)
+            : TRACE_WriterInit(&writer, file);
+    if (status == TRACE_StatusOk) {
+        status = WriteTraffic(&writer);
+    }
+    fclose(file);
+    result->writeTime = Now() - start;
+
+    CHAIN_Instance chain;
+    TRACE_Mapping mapping = {0};
+    if (status == TRACE_StatusOk) {
+        status = TRACE_Map(&mapping, path);
+    }
+    if (status == TRACE_StatusOk) {
+        CHAIN_Create(&chain, BENCH_DEVICES);
+        start = Now();
+        status = TRACE_Replay(&mapping, &chain, 1);
+        CHAIN_Render(&chain);
+        result->replayTime = Now() - start;
+
+        result->bytes = mapping.length;
+        memcpy(result->framebuffer, chain.framebuffer,
+                sizeof(result->framebuffer));
+        CHAIN_Destroy(&chain);
+        TRACE_Unmap(&mapping);
+    }
+    unlink(path);
+
+    return status == TRACE_StatusOk;
+}
+
+/* Print single result */
+static void Report(const Result* result)
+{
+    printf("%-10s %10zu B  write %6.3f s  replay %6.3f s  %7.1f Mrec/s\n",
+           result->name,
+           result->bytes,
+           result->writeTime,
+           result->replayTime,
+           (double)BENCH_RECORDS / result->replayTime / 1e6);
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Main ---------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+int main(void)
+{
+    Result plain = {.name = "plain"};
+    Result compressed = {.name = "compressed"};
+
+    if (!Run(&plain, false) || !Run(&compressed, true)) {
+        fprintf(stderr, "Trace could not be written or replayed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%d records, %d devices, row refresh every %d ns\n",
+           BENCH_RECORDS, BENCH_DEVICES, BENCH_ROW_PERIOD);
+    Report(&plain);
+    Report(&compressed);
+    printf("ratio %.1fx\n", (double)plain.bytes / (double)compressed.bytes);
+
+    if (memcmp(plain.framebuffer, compressed.framebuffer,
+            sizeof(plain.framebuffer)) != 0) {
+        fprintf(stderr, "Replayed outputs differ\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,109 @@
+#include "hal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Bus state kept between HAL calls */
+typedef struct
+{
+    bool selected;    /* LOAD held low by spi_select */
+    bool pendingValid;
+    u8 pending;       /* First byte of a frame split across calls */
+} Bus;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private variables -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+static CHAIN_Instance* boundChains;
+static Bus* buses;
+static size busCount;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Rising edge of LOAD, an incomplete frame never reaches the registers */
+static inline void Latch(Bus* bus, CHAIN_Instance* chain)
+{
+    bus->pendingValid = false;
+    CHAIN_Latch(chain);
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+HAL_Status HAL_Bind(CHAIN_Instance* chains, size count)
+{
+    if (count != 0) {
+        COMMON_NULLPTR_GUARD(chains, HAL_StatusNullPtr);
+    }
+
+    HAL_Unbind();
+    if (count == 0) {
+        return HAL_StatusOk;
+    }
+
+    buses = calloc(count, sizeof(Bus));
+    if (buses == NULL) {
+        return HAL_StatusMemError;
+    }
+    boundChains = chains;
+    busCount = count;
+    return HAL_StatusOk;
+}
+
+void HAL_Unbind(void)
+{
+    free(buses);
+    buses = NULL;
+    boundChains = NULL;
+    busCount = 0;
+}
+
+int spi_write(uint8_t bus, const uint8_t* data, size_t length)
+{
+    if (bus >= busCount || (data == NULL && length != 0)) {
+        return HAL_SPI_ERROR;
+    }
+
+    Bus* state = &buses[bus];
+    CHAIN_Instance* chain = &boundChains[bus];
+    const u8* end = data + length;
+
+    if (state->pendingValid && data < end) {
+        CHAIN_Shift(chain, (u16)(state->pending << 8 | *data++));
+        state->pendingValid = false;
+    }
+    for (; end - data >= 2; data += 2) {
+        CHAIN_Shift(chain, (u16)(data[0] << 8 | data[1]));
+    }
+    if (data < end) {
+        state->pending = *data;
+        state->pendingValid = true;
+    }
+
+    if (!state->selected) {
+        Latch(state, chain);
+    }
+    return HAL_SPI_OK;
+}
+
+int spi_select(uint8_t bus, bool selected)
+{
+    if (bus >= busCount) {
+        return HAL_SPI_ERROR;
+    }
+
+    Bus* state = &buses[bus];
+    if (state->selected && !selected) {
+        Latch(state, &boundChains[bus]);
+    }
+    state->selected = selected;
+    return HAL_SPI_OK;
+}
@@ -0,0 +1,94 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include "common.h"
+#include "chain.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Return values of the firmware-facing calls */
+#define HAL_SPI_OK    0
+#define HAL_SPI_ERROR (-1)
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    HAL_StatusOk = 0,     /**< OK */
+    HAL_StatusNullPtr,    /**< Null pointer was passed to API function */
+    HAL_StatusMemError    /**< Memory allocation error */
+} HAL_Status;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Connect SPI buses seen by the firmware to emulated chains.
+ *
+ * Bus N drives chains[N]. The shim keeps a single global binding, it is meant
+ * for one host-compiled firmware per process and is not thread safe. Binding
+ * again replaces the previous chains and forgets pending bytes.
+ *
+ * @param chains Chains indexed by bus number, owned by the caller
+ * @param count  Number of chains, 0 unbinds
+ *
+ * @return Instance of HAL_Status. The function possible return values are:
+ * - HAL_StatusNullPtr when chains is null and count is not 0
+ * - HAL_StatusMemError when there was a memory allocation error
+ * - HAL_StatusOk after success
+ */
+HAL_Status HAL_Bind(CHAIN_Instance* chains, size count);
+
+/**
+ * @brief Release the binding made with HAL_Bind.
+ */
+void HAL_Unbind(void);
+
+/**
+ * @brief HAL call: send bytes over SPI bus.
+ *
+ * Bytes go out MSB first, so every byte pair is one big-endian MAX7219 frame.
+ * Frames are decoded straight from the caller's buffer on the calling thread.
+ * Unless the firmware holds chip select with spi_select, the call is a whole
+ * transaction: LOAD rises after the last byte and the chain latches. A frame
+ * split across calls is completed by the next call, an incomplete frame left
+ * at the latch is discarded like bits which never reached a full register.
+ *
+ * @param bus    Bus number
+ * @param data   Bytes to be sent
+ * @param length Number of bytes
+ *
+ * @return HAL_SPI_OK, or HAL_SPI_ERROR if the bus is not bound or data is null
+ */
+int spi_write(uint8_t bus, const uint8_t* data, size_t length);
+
+/**
+ * @brief HAL call: drive chip select (LOAD) manually.
+ *
+ * While the bus is selected spi_write only shifts frames in, deselecting it
+ * latches the chain.
+ *
+ * @param bus      Bus number
+ * @param selected True to pull LOAD low, false to release it
+ *
+ * @return HAL_SPI_OK, or HAL_SPI_ERROR if the bus is not bound
+ */
+int spi_select(uint8_t bus, bool selected);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // HAL_H
@@ -1,7 +1,1009 @@
+#include "batch.h"
+#include "chain.h"
+#include "csv.h"
+#include "image.h"
+#include "ingest.h"
+#include "scan.h"
+#include "server.h"
+#include "shm.h"
+#include "stream.h"
+#include "term.h"
+#include "trace.h"
+#include "video.h"
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Command line options */
+typedef struct
+{
+    bool stream;
+    bool csv;
+    bool term;
+    TERM_Mode termMode;
+    size fps;
+    size chains;
+    size devices;
+    const char* exportPattern;
+    const char* scanPath;
+    size ledSize;
+    const char* videoPath;
+    const char* batchPath;
+    size jobs;
+    bool update;
+    const char* shmName;
+    const char* socketPath;
+    bool deterministic;
+} Options;
+
+/* Stdin parser run on the ingest producer thread */
+typedef struct
+{
+    STREAM_Reader* reader;
+    INGEST_Instance* ingest;
+    bool csv;
+    STREAM_Status status;
+} Producer;
+
+/* Destination of multiplex intervals of one chain */
+typedef struct
+{
+    FILE* file;
+    size chain;
+} ScanLog;
+
+/* Chains driven by incoming records */
+typedef struct
+{
+    CHAIN_Instance* chains;
+    size count;
+    u64 records;
+    u64 frames;
+    TERM_Renderer* renderer;
+    double framePeriod;
+    double nextFrame;
+    IMAGE_Raster* raster;
+    const char* exportPattern;
+    u64 exportPeriod;
+    u64 lastSample;
+    u64 exportedImages;
+    IMAGE_Raster* videoRaster;
+    VIDEO_Output* video;
+    double nextVideoFrame;
+    SCAN_Instance* scans;
+    ScanLog* scanLogs;
+} Emulation;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private variables -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Server stopped by SIGINT or SIGTERM */
+static SERVER_Instance* runningServer;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Print command line help */
+static void PrintUsage(const char* program)
+{
+    printf("Usage: %s [options]\n"
+           "  -s, --stream        read binary frame trace from stdin\n"
+           "  -x, --csv           read logic analyzer CSV export from stdin\n"
+           "                      (timestamp, MOSI, CS), frames go to chain 0\n"
+           "  -t, --term MODE     draw chains in terminal, MODE is matrix or digits\n"
+           "  -f, --fps N         terminal frame rate limit and exported frames per\n"
+           "                      second of trace time (default 60)\n"
+           "  -o, --export PATH   save frames whose output changed as images, PATH is\n"
+           "                      a printf pattern with exactly one %%llu-style\n"
+           "                      conversion taking the frame number, e.g.\n"
+           "                      out/%%06llu.png (PNG) or out/%%06llu.ppm (PPM)\n"
+           "  -S, --scan PATH     simulate multiplexing in trace time and write every\n"
+           "                      digit on-interval to PATH as CSV (chain, device,\n"
+           "                      digit, segments, start_ns, end_ns)\n"
+           "  -l, --led-size N    LED diameter of exported images in pixels (default 8)\n"
+           "  -v, --video PATH    write raw RGB24 frames at --fps to PATH (e.g. a FIFO\n"
+           "                      read by an encoder), - is stdout\n"
+           "  -b, --batch FILE    run scenarios listed in FILE in parallel, one per line:\n"
+           "                      TRACE CHAINS DEVICES GOLDEN (GOLDEN is - to skip)\n"
+           "  -j, --jobs N        batch and stream worker threads or server event\n"
+           "                      loops (default: all processors)\n"
+           "  -u, --update        rewrite golden files from batch output\n"
+           "  -m, --shm NAME      create shared-memory ring NAME (e.g. /max7219) and\n"
+           "                      emulate frames sent by co-simulated firmware\n"
+           "  -L, --listen PATH   serve test harnesses on Unix socket PATH, every\n"
+           "                      connection drives its own chains\n"
+           "  -D, --deterministic write every visible change of a stream to stdout\n"
+           "                      (tick chain device bitboard), identical for any\n"
+           "                      --jobs, summary goes to stderr\n"
+           "  -c, --chains N      number of chains (default 1)\n"
+           "  -d, --devices N     devices per chain (default 1)\n"
+           "  -h, --help          show this help\n",
+           program);
+}
+
+/* Parse positive number argument */
+static bool ParseCount(const char* text, size* value)
+{
+    char* end;
+    unsigned long long parsed = strtoull(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || parsed == 0) {
+        return false;
+    }
+    *value = (size)parsed;
+    return true;
+}
+
+/* Check that pattern holds exactly one conversion taking unsigned long long */
+static bool IsFramePattern(const char* pattern)
+{
+    size conversions = 0;
+    for (const char* c = pattern; *c != '\0'; ++c) {
+        if (*c != '%') {
+            continue;
+        }
+        if (*++c == '%') {
+            continue;
+        }
+
+        c += strspn(c, "-+ #0");
+        c += strspn(c, "0123456789");
+        if (*c == '.') {
+            c += 1 + strspn(c + 1, "0123456789");
+        }
+        if (c[0] != 'l' || c[1] != 'l' || c[2] == '\0'
+                || strchr("diouxX", c[2]) == NULL) {
+            return false;
+        }
+        c += 2;
+        ++conversions;
+    }
+    return conversions == 1;
+}
+
+/* Parse command line, returns false on error */
+static bool ParseOptions(int argc, char** argv, Options* options)
+{
+    static const struct option longOptions[] = {
+        {"stream", no_argument, NULL, 's'},
+        {"csv", no_argument, NULL, 'x'},
+        {"term", required_argument, NULL, 't'},
+        {"fps", required_argument, NULL, 'f'},
+        {"chains", required_argument, NULL, 'c'},
+        {"devices", required_argument, NULL, 'd'},
+        {"export", required_argument, NULL, 'o'},
+        {"led-size", required_argument, NULL, 'l'},
+        {"scan", required_argument, NULL, 'S'},
+        {"video", required_argument, NULL, 'v'},
+        {"batch", required_argument, NULL, 'b'},
+        {"jobs", required_argument, NULL, 'j'},
+        {"update", no_argument, NULL, 'u'},
+        {"shm", required_argument, NULL, 'm'},
+        {"listen", required_argument, NULL, 'L'},
+        {"deterministic", no_argument, NULL, 'D'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    *options = (Options){
+        .stream = false,
+        .csv = false,
+        .term = false,
+        .termMode = TERM_ModeMatrix,
+        .fps = 60,
+        .chains = 1,
+        .devices = 1,
+        .exportPattern = NULL,
+        .scanPath = NULL,
+        .ledSize = IMAGE_DEFAULT_LED_SIZE,
+        .videoPath = NULL,
+        .batchPath = NULL,
+        .jobs = BATCH_WORKERS_AUTO,
+        .update = false,
+        .shmName = NULL,
+        .socketPath = NULL,
+        .deterministic = false
+    };
+
+    int option;
+    while ((option = getopt_long(argc, argv, "sxt:f:c:d:o:S:l:v:b:j:um:L:Dh", longOptions, NULL)) != -1) {
+        switch (option) {
+        case 's':
+            options->stream = true;
+            break;
+        case 'x':
+            options->stream = true;
+            options->csv = true;
+            break;
+        case 't':
+            options->term = true;
+            if (strcmp(optarg, "matrix") == 0) {
+                options->termMode = TERM_ModeMatrix;
+            } else if (strcmp(optarg, "digits") == 0) {
+                options->termMode = TERM_ModeDigits;
+            } else {
+                return false;
+            }
+            break;
+        case 'f':
+            if (!ParseCount(optarg, &options->fps)) {
+                return false;
+            }
+            break;
+        case 'c':
+            if (!ParseCount(optarg, &options->chains)) {
+                return false;
+            }
+            break;
+        case 'd':
+            if (!ParseCount(optarg, &options->devices)) {
+                return false;
+            }
+            break;
+        case 'o':
+            /* The pattern is used as printf format of the frame number */
+            if (!IsFramePattern(optarg)) {
+                return false;
+            }
+            options->exportPattern = optarg;
+            break;
+        case 'S':
+            options->scanPath = optarg;
+            break;
+        case 'l':
+            if (!ParseCount(optarg, &options->ledSize)) {
+                return false;
+            }
+            break;
+        case 'v':
+            options->videoPath = optarg;
+            break;
+        case 'b':
+            options->batchPath = optarg;
+            break;
+        case 'j':
+            if (!ParseCount(optarg, &options->jobs)) {
+                return false;
+            }
+            break;
+        case 'u':
+            options->update = true;
+            break;
+        case 'm':
+            options->shmName = optarg;
+            break;
+        case 'L':
+            options->socketPath = optarg;
+            break;
+        case 'D':
+            options->deterministic = true;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    /* Terminal output and video cannot share stdout */
+    if (options->term && options->videoPath != NULL
+            && strcmp(options->videoPath, "-") == 0) {
+        return false;
+    }
+
+    /* Changes are merged after the run, live outputs need the lockstep path */
+    if (options->deterministic && (options->term
+            || options->exportPattern != NULL
+            || options->videoPath != NULL
+            || options->scanPath != NULL)) {
+        return false;
+    }
+    return optind == argc;
+}
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* Save current output as frame of given number if it has changed */
+static bool ExportFrame(Emulation* emulation, u64 sample)
+{
+    if (IMAGE_Rasterize(emulation->raster) == 0 && emulation->exportedImages > 0) {
+        return true;
+    }
+
+    char path[4096];
+    snprintf(path, sizeof(path), emulation->exportPattern, (unsigned long long)sample);
+    if (IMAGE_Save(emulation->raster, path) != IMAGE_StatusOk) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return false;
+    }
+    ++emulation->exportedImages;
+    return true;
+}
+
+/* Publish current output to the video pacing thread if it has changed */
+static bool PublishVideoFrame(Emulation* emulation)
+{
+    if (IMAGE_Rasterize(emulation->videoRaster) == 0 && emulation->video->published > 0) {
+        return true;
+    }
+    return VIDEO_Publish(emulation->video, emulation->videoRaster->pixels) == VIDEO_StatusOk;
+}
+
+/* Write multiplex interval as CSV line */
+static void WriteInterval(void* context, const SCAN_Interval* interval)
+{
+    const ScanLog* log = context;
+    fprintf(log->file, "%zu,%zu,%u,0x%02X,%llu,%llu\n", log->chain, interval->device,
+            (unsigned)interval->digit, (unsigned)interval->segments,
+            (unsigned long long)interval->start, (unsigned long long)interval->end);
+}
+
+/* Feed record into chain selected by its id */
+static TRACE_Status EmulateRecord(void* context, const TRACE_Record* record)
+{
+    Emulation* emulation = context;
+    if (record->chain >= emulation->count) {
+        return TRACE_StatusWrongChain;
+    }
+
+    /* Output at the first frame boundary after the previous record */
+    if (emulation->raster != NULL) {
+        u64 sample = record->timestamp / emulation->exportPeriod;
+        if (sample > emulation->lastSample) {
+            if (!ExportFrame(emulation, emulation->lastSample + 1)) {
+                return TRACE_StatusIoError;
+            }
+            emulation->lastSample = sample;
+        }
+    }
+
+    /* Digits keep being scanned until the latch changes them */
+    if (emulation->scans != NULL) {
+        for (size i = 0; i < emulation->count; ++i) {
+            if (SCAN_Advance(&emulation->scans[i], record->timestamp) != SCAN_StatusOk) {
+                return TRACE_StatusWrongTime;
+            }
+        }
+    }
+
+    TRACE_FeedChain(&emulation->chains[record->chain], record);
+    if (emulation->scans != NULL) {
+        SCAN_Sync(&emulation->scans[record->chain]);
+    }
+    ++emulation->records;
+    emulation->frames += record->count;
+
+    /* Terminal is redrawn at most fps times per second of wall time */
+    if (emulation->renderer != NULL) {
+        double now = Now();
+        if (now >= emulation->nextFrame) {
+            emulation->nextFrame = now + emulation->framePeriod;
+            if (TERM_Draw(emulation->renderer, NULL) != TERM_StatusOk) {
+                return TRACE_StatusIoError;
+            }
+        }
+    }
+
+    /* Video frames are offered at the output rate, pacing never blocks here */
+    if (emulation->video != NULL) {
+        double now = Now();
+        if (now >= emulation->nextVideoFrame) {
+            emulation->nextVideoFrame = now + emulation->framePeriod;
+            if (!PublishVideoFrame(emulation)) {
+                return TRACE_StatusIoError;
+            }
+        }
+    }
+    return TRACE_StatusOk;
+}
+
+/* Pass raw input block to CSV parser */
+static bool ParseCsvBlock(void* context, const u8* data, size length)
+{
+    return CSV_Feed(context, (const char*)data, length) == CSV_StatusOk;
+}
+
+/* Parse CSV export arriving through the reader */
+static STREAM_Status ParseCsv(STREAM_Reader* reader,
+        TRACE_RecordCallback callback, void* context)
+{
+    CSV_Parser parser;
+    CSV_Create(&parser, 0, callback, context);
+
+    STREAM_Status status = STREAM_ForEachBlock(reader, ParseCsvBlock, &parser);
+    if (status == STREAM_StatusOk && CSV_Finish(&parser) != CSV_StatusOk) {
+        status = STREAM_StatusConsumerError;
+    }
+    if (parser.droppedBytes > 0) {
+        fprintf(stderr, "Dropped %llu unpaired bytes\n",
+                (unsigned long long)parser.droppedBytes);
+    }
+    if (status == STREAM_StatusConsumerError
+            && parser.callbackStatus == TRACE_StatusWrongTime) {
+        fprintf(stderr, "CSV line %llu goes back in time\n",
+                (unsigned long long)parser.lines);
+    } else if (status == STREAM_StatusConsumerError) {
+        fprintf(stderr, "CSV error near line %llu\n",
+                (unsigned long long)parser.lines);
+    }
+
+    CSV_Destroy(&parser);
+    return status;
+}
+
+/* Parse stdin into ingest queues */
+static void ProduceRecords(void* context)
+{
+    Producer* producer = context;
+    producer->status = producer->csv
+            ? ParseCsv(producer->reader, INGEST_Record, producer->ingest)
+            : STREAM_Parse(producer->reader, INGEST_Record, producer->ingest);
+}
+
+/* Emulate chains in parallel on the engine while stdin is being parsed */
+static int RunQueued(const Options* options)
+{
+    CHAIN_Instance* chains = calloc(options->chains, sizeof(CHAIN_Instance));
+    if (chains == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (size i = 0; i < options->chains; ++i) {
+        if (CHAIN_Create(&chains[i], options->devices) != CHAIN_StatusOk) {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    INGEST_Instance ingest;
+    if (INGEST_Create(&ingest, chains, options->chains, INGEST_DEFAULT_CAPACITY,
+            options->jobs) != INGEST_StatusOk) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    STREAM_Reader reader;
+    if (STREAM_Create(&reader, STDIN_FILENO) != STREAM_StatusOk) {
+        fprintf(stderr, "Cannot start stdin reader\n");
+        return EXIT_FAILURE;
+    }
+
+    Producer producer = {
+        .reader = &reader,
+        .ingest = &ingest,
+        .csv = options->csv,
+        .status = STREAM_StatusOk
+    };
+    /* Summary goes to stderr when stdout carries changes */
+    FILE* report = options->deterministic ? stderr : stdout;
+    ENGINE_Output* changes = NULL;
+    size changeCount = 0;
+
+    double start = Now();
+    INGEST_Status status = options->deterministic
+            ? INGEST_RunDeterministic(&ingest, ProduceRecords, &producer,
+                    &changes, &changeCount)
+            : INGEST_Run(&ingest, ProduceRecords, &producer);
+    double elapsed = Now() - start;
+
+    if (status == INGEST_StatusThreadError) {
+        fprintf(stderr, "Cannot start parser thread\n");
+        return EXIT_FAILURE;
+    }
+    if (status == INGEST_StatusOk && options->deterministic
+            && (INGEST_WriteChanges(stdout, changes, changeCount) != INGEST_StatusOk
+                    || fflush(stdout) != 0)) {
+        status = INGEST_StatusIoError;
+    }
+    free(changes);
+
+    u64 latched = 0;
+    u64 redundant = 0;
+    for (size i = 0; i < options->chains; ++i) {
+        latched += chains[i].frames;
+        redundant += chains[i].redundantFrames;
+    }
+
+    fprintf(report, "records: %llu, frames: %llu, bytes: %llu, time: %.3f s, %.1f MB/s\n",
+           (unsigned long long)ingest.records,
+           (unsigned long long)ingest.frames,
+           (unsigned long long)reader.bytes,
+           elapsed,
+           elapsed > 0 ? (double)reader.bytes / elapsed / 1e6 : 0.0);
+    fprintf(report, "redundant frames: %llu of %llu (%.1f %%)\n",
+           (unsigned long long)redundant,
+           (unsigned long long)latched,
+           latched > 0 ? 100.0 * (double)redundant / (double)latched : 0.0);
+    fprintf(report, "engine: %zu workers, %llu steals\n", ingest.engine.workers,
+           (unsigned long long)atomic_load(&ingest.engine.steals));
+    if (options->deterministic) {
+        fprintf(report, "changes: %zu\n", changeCount);
+    }
+
+    if (status == INGEST_StatusMemError) {
+        fprintf(stderr, "Out of memory\n");
+    } else if (status == INGEST_StatusIoError) {
+        fprintf(stderr, "Cannot write changes\n");
+    }
+    if (producer.status != STREAM_StatusOk) {
+        fprintf(stderr, "Stream error %d (trace status %d)\n",
+                (int)producer.status, (int)reader.traceStatus);
+    }
+
+    STREAM_Destroy(&reader);
+    INGEST_Destroy(&ingest);
+    for (size i = 0; i < options->chains; ++i) {
+        CHAIN_Destroy(&chains[i]);
+    }
+    free(chains);
+
+    return (status == INGEST_StatusOk && producer.status == STREAM_StatusOk)
+            ? EXIT_SUCCESS
+            : EXIT_FAILURE;
+}
+
+/* Emulate chains driven by trace arriving on stdin */
+static int RunStream(const Options* options)
+{
+    Emulation emulation = {
+        .chains = calloc(options->chains, sizeof(CHAIN_Instance)),
+        .count = options->chains
+    };
+    if (emulation.chains == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (size i = 0; i < options->chains; ++i) {
+        if (CHAIN_Create(&emulation.chains[i], options->devices)
+                != CHAIN_StatusOk) {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    TERM_Renderer renderer;
+    if (options->term) {
+        TERM_Status status = TERM_Create(&renderer, STDOUT_FILENO,
+                options->termMode, emulation.chains, emulation.count,
+                TERM_DEFAULT_PER_ROW);
+        if (status != TERM_StatusOk) {
+            fprintf(stderr, (status == TERM_StatusWrongSize)
+                    ? "Chains do not fit into the terminal\n"
+                    : "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        emulation.renderer = &renderer;
+    }
+    emulation.framePeriod = 1.0 / (double)options->fps;
+
+    FILE* scanFile = NULL;
+    if (options->scanPath != NULL) {
+        scanFile = fopen(options->scanPath, "w");
+        emulation.scans = calloc(emulation.count, sizeof(SCAN_Instance));
+        emulation.scanLogs = calloc(emulation.count, sizeof(ScanLog));
+        if (scanFile == NULL || emulation.scans == NULL || emulation.scanLogs == NULL) {
+            fprintf(stderr, "Cannot open %s\n", options->scanPath);
+            return EXIT_FAILURE;
+        }
+        fprintf(scanFile, "chain,device,digit,segments,start_ns,end_ns\n");
+        for (size i = 0; i < emulation.count; ++i) {
+            emulation.scanLogs[i] = (ScanLog){.file = scanFile, .chain = i};
+            if (SCAN_Create(&emulation.scans[i], &emulation.chains[i],
+                    SCAN_DEFAULT_DIGIT_PERIOD_NS, WriteInterval,
+                    &emulation.scanLogs[i]) != SCAN_StatusOk) {
+                fprintf(stderr, "Out of memory\n");
+                return EXIT_FAILURE;
+            }
+        }
+    }
 
-int main()
+    IMAGE_Raster raster;
+    if (options->exportPattern != NULL) {
+        if (IMAGE_Create(&raster, emulation.chains, emulation.count,
+                IMAGE_DEFAULT_PER_ROW, options->ledSize) != IMAGE_StatusOk) {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+        emulation.raster = &raster;
+        emulation.exportPattern = options->exportPattern;
+        emulation.exportPeriod = 1000000000u / options->fps;
+        if (emulation.exportPeriod == 0) {
+            emulation.exportPeriod = 1;
+        }
+    }
+
+    /* Summary goes to stderr when stdout carries video */
+    FILE* report = stdout;
+    IMAGE_Raster videoRaster;
+    VIDEO_Output video;
+    if (options->videoPath != NULL) {
+        int fd = STDOUT_FILENO;
+        if (strcmp(options->videoPath, "-") == 0) {
+            report = stderr;
+        } else {
+            fd = open(options->videoPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                fprintf(stderr, "Cannot open %s\n", options->videoPath);
+                return EXIT_FAILURE;
+            }
+        }
+
+        /* A reader going away must surface as a write error, not a signal */
+        signal(SIGPIPE, SIG_IGN);
+
+        if (IMAGE_Create(&videoRaster, emulation.chains, emulation.count,
+                IMAGE_DEFAULT_PER_ROW, options->ledSize) != IMAGE_StatusOk
+                || VIDEO_Create(&video, fd, (size)videoRaster.width
+                        * videoRaster.height * IMAGE_CHANNELS, options->fps)
+                        != VIDEO_StatusOk) {
+            fprintf(stderr, "Cannot start video output\n");
+            return EXIT_FAILURE;
+        }
+        emulation.videoRaster = &videoRaster;
+        emulation.video = &video;
+        fprintf(stderr, "video: rgb24 %ux%u @ %zu fps\n",
+                videoRaster.width, videoRaster.height, options->fps);
+    }
+
+    STREAM_Reader reader;
+    if (STREAM_Create(&reader, STDIN_FILENO) != STREAM_StatusOk) {
+        fprintf(stderr, "Cannot start stdin reader\n");
+        return EXIT_FAILURE;
+    }
+
+    double start = Now();
+    STREAM_Status status = options->csv
+            ? ParseCsv(&reader, EmulateRecord, &emulation)
+            : STREAM_Parse(&reader, EmulateRecord, &emulation);
+    double elapsed = Now() - start;
+
+    u64 latched = 0;
+    u64 redundant = 0;
+    for (size i = 0; i < emulation.count; ++i) {
+        CHAIN_Render(&emulation.chains[i]);
+        latched += emulation.chains[i].frames;
+        redundant += emulation.chains[i].redundantFrames;
+    }
+    if (options->term) {
+        TERM_Draw(&renderer, NULL);
+        TERM_Destroy(&renderer);
+    }
+    if (emulation.raster != NULL) {
+        if (!ExportFrame(&emulation, emulation.lastSample + 1)
+                && status == STREAM_StatusOk) {
+            status = STREAM_StatusConsumerError;
+        }
+        IMAGE_Destroy(&raster);
+    }
+    if (emulation.video != NULL) {
+        if ((!PublishVideoFrame(&emulation) || VIDEO_Finish(&video) != VIDEO_StatusOk)
+                && status == STREAM_StatusOk) {
+            fprintf(stderr, "Video output failed\n");
+            status = STREAM_StatusConsumerError;
+        }
+    }
+
+    fprintf(report, "records: %llu, frames: %llu, bytes: %llu, time: %.3f s, %.1f MB/s\n",
+           (unsigned long long)emulation.records,
+           (unsigned long long)emulation.frames,
+           (unsigned long long)reader.bytes,
+           elapsed,
+           elapsed > 0 ? (double)reader.bytes / elapsed / 1e6 : 0.0);
+    fprintf(report, "redundant frames: %llu of %llu (%.1f %%)\n",
+           (unsigned long long)redundant,
+           (unsigned long long)latched,
+           latched > 0 ? 100.0 * (double)redundant / (double)latched : 0.0);
+    if (options->exportPattern != NULL) {
+        fprintf(report, "exported images: %llu\n",
+                (unsigned long long)emulation.exportedImages);
+    }
+    if (emulation.video != NULL) {
+        fprintf(report, "video frames: %llu written, %llu duplicated, "
+                "%llu dropped, %llu ticks skipped\n",
+                (unsigned long long)video.written,
+                (unsigned long long)video.duplicated,
+                (unsigned long long)video.dropped,
+                (unsigned long long)video.skipped);
+        if (video.fd != STDOUT_FILENO) {
+            close(video.fd);
+        }
+        VIDEO_Destroy(&video);
+        IMAGE_Destroy(&videoRaster);
+    }
+
+    if (emulation.scans != NULL) {
+        for (size i = 0; i < emulation.count; ++i) {
+            SCAN_Destroy(&emulation.scans[i]);
+        }
+        free(emulation.scans);
+        free(emulation.scanLogs);
+        if (fclose(scanFile) != 0 && status == STREAM_StatusOk) {
+            fprintf(stderr, "Cannot write %s\n", options->scanPath);
+            status = STREAM_StatusConsumerError;
+        }
+    }
+
+    if (status != STREAM_StatusOk) {
+        fprintf(stderr, "Stream error %d (trace status %d)\n",
+                (int)status, (int)reader.traceStatus);
+    }
+
+    STREAM_Destroy(&reader);
+    for (size i = 0; i < emulation.count; ++i) {
+        CHAIN_Destroy(&emulation.chains[i]);
+    }
+    free(emulation.chains);
+
+    return (status == STREAM_StatusOk) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Serve co-simulated firmware through shared-memory ring until it closes */
+static int RunShm(const Options* options)
 {
+    CHAIN_Instance* chains = calloc(options->chains, sizeof(CHAIN_Instance));
+    if (chains == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (size i = 0; i < options->chains; ++i) {
+        if (CHAIN_Create(&chains[i], options->devices) != CHAIN_StatusOk) {
+            fprintf(stderr, "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    SHM_Ring ring;
+    SHM_Status created = (options->chains > SHM_MAX_CHAINS)
+            ? SHM_StatusWrongSize
+            : SHM_Create(&ring, options->shmName, SHM_DEFAULT_CAPACITY,
+                    (u32)options->chains, (u32)options->devices);
+    if (created == SHM_StatusBusy) {
+        fprintf(stderr, "Shared memory %s is used by another emulator\n",
+                options->shmName);
+        return EXIT_FAILURE;
+    }
+    if (created != SHM_StatusOk) {
+        fprintf(stderr, "Cannot create shared memory %s\n", options->shmName);
+        return EXIT_FAILURE;
+    }
+
+    TERM_Renderer renderer;
+    if (options->term) {
+        TERM_Status status = TERM_Create(&renderer, STDOUT_FILENO,
+                options->termMode, chains, options->chains,
+                TERM_DEFAULT_PER_ROW);
+        if (status != TERM_StatusOk) {
+            fprintf(stderr, (status == TERM_StatusWrongSize)
+                    ? "Chains do not fit into the terminal\n"
+                    : "Out of memory\n");
+            return EXIT_FAILURE;
+        }
+    }
+    fprintf(stderr, "shm: waiting for firmware on %s\n", options->shmName);
+
+    /* State is published after every batch, the firmware reads it any time */
+    double framePeriod = 1.0 / (double)options->fps;
+    double nextFrame = 0.0;
+    double start = Now();
+    u64 frames = 0;
+    SHM_Status status;
+    for (;;) {
+        size received = 0;
+        status = SHM_Receive(&ring, chains, SHM_WAIT_FOREVER, &received);
+        if (status != SHM_StatusOk) {
+            break;
+        }
+        frames += received;
+        SHM_PublishState(&ring, chains);
+
+        if (options->term && Now() >= nextFrame) {
+            TERM_Draw(&renderer, NULL);
+            nextFrame = Now() + framePeriod;
+        }
+    }
+    double elapsed = Now() - start;
+
+    if (options->term) {
+        TERM_Draw(&renderer, NULL);
+        TERM_Destroy(&renderer);
+    }
+    SHM_Close(&ring);
+
+    u64 latched = 0;
+    u64 redundant = 0;
+    for (size i = 0; i < options->chains; ++i) {
+        latched += chains[i].frames;
+        redundant += chains[i].redundantFrames;
+        CHAIN_Destroy(&chains[i]);
+    }
+    free(chains);
+
+    fprintf(stderr, "frames: %llu, time: %.3f s, %.1f Mframes/s\n",
+            (unsigned long long)frames, elapsed,
+            elapsed > 0 ? (double)frames / elapsed / 1e6 : 0.0);
+    fprintf(stderr, "redundant frames: %llu of %llu (%.1f %%)\n",
+            (unsigned long long)redundant,
+            (unsigned long long)latched,
+            latched > 0 ? 100.0 * (double)redundant / (double)latched : 0.0);
+    return (status == SHM_StatusClosed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Signal handler stopping the server */
+static void StopServer(int signal)
+{
+    (void)signal;
+    SERVER_Stop(runningServer);
+}
+
+/* Serve socket clients until interrupted */
+static int RunServer(const Options* options)
+{
+    SERVER_Instance server;
+    SERVER_Status status = SERVER_Create(&server, options->socketPath,
+            options->chains, options->devices, options->jobs);
+    if (status != SERVER_StatusOk) {
+        fprintf(stderr, "Cannot listen on %s (path in use or not writable)\n",
+                options->socketPath);
+        return EXIT_FAILURE;
+    }
+
+    runningServer = &server;
+    struct sigaction action = {.sa_handler = StopServer};
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    fprintf(stderr, "server: listening on %s with %zu event loops\n",
+            options->socketPath, server.workers);
+
+    double start = Now();
+    status = SERVER_Run(&server);
+    double elapsed = Now() - start;
+
+    SERVER_Stats total;
+    SERVER_Total(&server, &total);
+    printf("connections: %llu, messages: %llu, frames: %llu, displays: %llu, "
+           "rejected: %llu\n",
+           (unsigned long long)total.connections,
+           (unsigned long long)total.messages,
+           (unsigned long long)total.frames,
+           (unsigned long long)total.displays,
+           (unsigned long long)total.rejected);
+    printf("time: %.3f s, %.1f Mframes/s\n", elapsed,
+           elapsed > 0 ? (double)total.frames / elapsed / 1e6 : 0.0);
+
+    SERVER_Destroy(&server);
+    return (status == SERVER_StatusOk) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Get printable name of scenario outcome */
+static const char* OutcomeName(BATCH_Outcome outcome)
+{
+    switch (outcome) {
+    case BATCH_OutcomePassed:
+        return "PASS";
+    case BATCH_OutcomeFailed:
+        return "FAIL";
+    case BATCH_OutcomeRan:
+        return "RAN";
+    case BATCH_OutcomeUpdated:
+        return "UPDATED";
+    case BATCH_OutcomeError:
+        return "ERROR";
+    default:
+        return "PENDING";
+    }
+}
+
+/* Run scenario list and print summary */
+static int RunBatch(const Options* options)
+{
+    BATCH_List list;
+    BATCH_Status status = BATCH_Load(&list, options->batchPath);
+    if (status == BATCH_StatusBadLine) {
+        fprintf(stderr, "%s:%zu: expected TRACE CHAINS DEVICES GOLDEN\n",
+                options->batchPath, list.errorLine);
+        return EXIT_FAILURE;
+    }
+    if (status != BATCH_StatusOk) {
+        fprintf(stderr, "Cannot read %s\n", options->batchPath);
+        return EXIT_FAILURE;
+    }
+
+    double start = Now();
+    if (BATCH_Run(&list, options->jobs, options->update) != BATCH_StatusOk) {
+        fprintf(stderr, "Out of memory\n");
+        BATCH_Destroy(&list);
+        return EXIT_FAILURE;
+    }
+    double elapsed = Now() - start;
+
+    size outcomes[BATCH_OutcomeError + 1] = {0};
+    u64 bytes = 0;
+    u64 frames = 0;
+    for (size i = 0; i < list.count; ++i) {
+        const BATCH_Scenario* scenario = &list.scenarios[i];
+        ++outcomes[scenario->outcome];
+        bytes += scenario->bytes;
+        frames += scenario->frames;
+
+        printf("%-7s %s (%.3f s)\n", OutcomeName(scenario->outcome),
+               scenario->trace, scenario->seconds);
+        if (scenario->outcome == BATCH_OutcomeFailed) {
+            const GOLDEN_Result* difference = &scenario->difference;
+            printf("        %llu LEDs differ, first at chain %zu device %zu "
+                   "digit %u bit %u\n",
+                   (unsigned long long)difference->differingLeds,
+                   difference->firstFrame, difference->firstDevice,
+                   (unsigned)difference->firstDigit, (unsigned)difference->firstBit);
+        } else if (scenario->outcome == BATCH_OutcomeError) {
+            printf("        trace status %d, golden file %s\n",
+                   (int)scenario->traceStatus,
+                   scenario->expected != NULL ? scenario->expected : "-");
+        }
+    }
+
+    printf("scenarios: %zu, passed: %zu, failed: %zu, errors: %zu, "
+           "ran: %zu, updated: %zu\n",
+           list.count, outcomes[BATCH_OutcomePassed], outcomes[BATCH_OutcomeFailed],
+           outcomes[BATCH_OutcomeError], outcomes[BATCH_OutcomeRan],
+           outcomes[BATCH_OutcomeUpdated]);
+    printf("frames: %llu, bytes: %llu, time: %.3f s, %.1f MB/s\n",
+           (unsigned long long)frames,
+           (unsigned long long)bytes,
+           elapsed,
+           elapsed > 0 ? (double)bytes / elapsed / 1e6 : 0.0);
+
+    bool passed = outcomes[BATCH_OutcomeFailed] == 0 && outcomes[BATCH_OutcomeError] == 0;
+    BATCH_Destroy(&list);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Main ---------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, &options)) {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (options.batchPath != NULL) {
+        return RunBatch(&options);
+    }
+    if (options.socketPath != NULL) {
+        return RunServer(&options);
+    }
+    if (options.shmName != NULL) {
+        return RunShm(&options);
+    }
+    if (options.stream) {
+        /* Outputs sampling all chains in record order need the lockstep path */
+        bool lockstep = options.term
+                || options.exportPattern != NULL
+                || options.videoPath != NULL
+                || options.scanPath != NULL;
+        return lockstep ? RunStream(&options) : RunQueued(&options);
+    }
+
     printf("Max7219 emulator\n");
-    return 0;
+    PrintUsage(argv[0]);
+    return EXIT_SUCCESS;
 }
@@ -0,0 +1,364 @@
+#include "batch.h"
+#include "engine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Longest accepted scenario line */
+#define LINE_MAX_LENGTH 4096
+
+/* Initial number of scenario slots */
+#define INITIAL_CAPACITY 16
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Scenario scheduling key and engine task context */
+typedef struct
+{
+    u64 bytes;
+    BATCH_Scenario* scenario;
+    bool update;
+} Job;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in seconds */
+static double Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/* Copy path, relative ones are prefixed with the list directory */
+static char* ResolvePath(const char* directory, size directoryLength, const char* path)
+{
+    size prefix = (path[0] == '/') ? 0 : directoryLength;
+    size length = strlen(path);
+    char* resolved = malloc(prefix + length + 1);
+    if (resolved != NULL) {
+        memcpy(resolved, directory, prefix);
+        memcpy(resolved + prefix, path, length + 1);
+    }
+    return resolved;
+}
+
+/* Parse positive count field */
+static bool ParseCount(const char* text, size* value)
+{
+    char* end;
+    unsigned long long parsed = strtoull(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || parsed == 0) {
+        return false;
+    }
+    *value = (size)parsed;
+    return true;
+}
+
+/* Append scenario described by line, returns false on malformed line */
+static BATCH_Status AddScenario(BATCH_List* list, char* line,
+        const char* directory, size directoryLength)
+{
+    char* fields[4];
+    size count = 0;
+    char* save;
+    for (char* field = strtok_r(line, " \t\r\n", &save); field != NULL;
+            field = strtok_r(NULL, " \t\r\n", &save)) {
+        if (count == 0 && field[0] == '#') {
+            return BATCH_StatusOk;
+        }
+        if (count == 4) {
+            return BATCH_StatusBadLine;
+        }
+        fields[count++] = field;
+    }
+    if (count == 0) {
+        return BATCH_StatusOk;
+    }
+
+    BATCH_Scenario scenario = {.outcome = BATCH_OutcomePending};
+    if (count != 4
+            || !ParseCount(fields[1], &scenario.chains)
+            || !ParseCount(fields[2], &scenario.devices)) {
+        return BATCH_StatusBadLine;
+    }
+
+    if (list->count == list->capacity) {
+        size capacity = (list->capacity == 0) ? INITIAL_CAPACITY : 2 * list->capacity;
+        BATCH_Scenario* grown = realloc(list->scenarios, capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return BATCH_StatusMemError;
+        }
+        list->scenarios = grown;
+        list->capacity = capacity;
+    }
+
+    scenario.trace = ResolvePath(directory, directoryLength, fields[0]);
+    if (strcmp(fields[3], "-") != 0) {
+        scenario.expected = ResolvePath(directory, directoryLength, fields[3]);
+    }
+    if (scenario.trace == NULL || (strcmp(fields[3], "-") != 0 && scenario.expected == NULL)) {
+        free(scenario.trace);
+        free(scenario.expected);
+        return BATCH_StatusMemError;
+    }
+
+    list->scenarios[list->count++] = scenario;
+    return BATCH_StatusOk;
+}
+
+/* Read golden bitboards, returns false if the file does not match */
+static bool ReadGolden(const char* path, u64* bitboards, size count)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    u8 raw[8];
+    bool valid = true;
+    for (size i = 0; i < count && valid; ++i) {
+        valid = fread(raw, 1, sizeof(raw), file) == sizeof(raw);
+        bitboards[i] = 0;
+        for (int b = 7; b >= 0; --b) {
+            bitboards[i] = (bitboards[i] << 8) | raw[b];
+        }
+    }
+    valid = valid && fgetc(file) == EOF;
+    fclose(file);
+    return valid;
+}
+
+/* Write golden bitboards */
+static bool WriteGolden(const char* path, const CHAIN_Instance* chains, size count)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    bool valid = true;
+    for (size c = 0; c < count && valid; ++c) {
+        for (size i = 0; i < chains[c].length && valid; ++i) {
+            u8 raw[8];
+            for (size b = 0; b < 8; ++b) {
+                raw[b] = (u8)(chains[c].framebuffer[i] >> (8 * b));
+            }
+            valid = fwrite(raw, 1, sizeof(raw), file) == sizeof(raw);
+        }
+    }
+    return (fclose(file) == 0) && valid;
+}
+
+/* Compare final output of all chains with golden data */
+static BATCH_Outcome Check(BATCH_Scenario* scenario, const CHAIN_Instance* chains)
+{
+    size total = scenario->chains * scenario->devices;
+    u64* actual = malloc(total * sizeof(u64));
+    u64* expected = malloc(total * sizeof(u64));
+    BATCH_Outcome outcome = BATCH_OutcomeError;
+
+    if (actual != NULL && expected != NULL
+            && ReadGolden(scenario->expected, expected, total)) {
+        for (size c = 0; c < scenario->chains; ++c) {
+            memcpy(actual + c * scenario->devices, chains[c].framebuffer,
+                    scenario->devices * sizeof(u64));
+        }
+
+        /* Every chain is a frame, so the location names chain and device */
+        GOLDEN_Compare(actual, expected, scenario->chains, scenario->devices,
+                &scenario->difference);
+        outcome = (scenario->difference.differingFrames == 0)
+                ? BATCH_OutcomePassed
+                : BATCH_OutcomeFailed;
+    }
+
+    free(actual);
+    free(expected);
+    return outcome;
+}
+
+/* Replay single scenario and judge its output */
+static void RunScenario(BATCH_Scenario* scenario, bool update)
+{
+    double start = Now();
+    scenario->outcome = BATCH_OutcomeError;
+
+    CHAIN_Instance* chains = calloc(scenario->chains, sizeof(CHAIN_Instance));
+    size created = 0;
+    while (chains != NULL && created < scenario->chains
+            && CHAIN_Create(&chains[created], scenario->devices) == CHAIN_StatusOk) {
+        ++created;
+    }
+
+    TRACE_Mapping mapping;
+    if (created == scenario->chains) {
+        scenario->traceStatus = TRACE_Map(&mapping, scenario->trace);
+        if (scenario->traceStatus == TRACE_StatusOk) {
+            scenario->bytes = mapping.length;
+            scenario->traceStatus = TRACE_Replay(&mapping, chains, created);
+            TRACE_Unmap(&mapping);
+        }
+    }
+
+    if (created == scenario->chains && scenario->traceStatus == TRACE_StatusOk) {
+        for (size c = 0; c < created; ++c) {
+            CHAIN_Render(&chains[c]);
+            scenario->frames += chains[c].frames;
+        }
+
+        if (scenario->expected == NULL) {
+            scenario->outcome = BATCH_OutcomeRan;
+        } else if (update) {
+            scenario->outcome = WriteGolden(scenario->expected, chains, created)
+                    ? BATCH_OutcomeUpdated
+                    : BATCH_OutcomeError;
+        } else {
+            scenario->outcome = Check(scenario, chains);
+        }
+    }
+
+    for (size c = 0; c < created; ++c) {
+        CHAIN_Destroy(&chains[c]);
+    }
+    free(chains);
+    scenario->seconds = Now() - start;
+}
+
+/* Engine task running single scenario */
+static void RunJob(void* context)
+{
+    Job* job = context;
+    RunScenario(job->scenario, job->update);
+}
+
+/* Order jobs by ascending trace size */
+static int CompareBySize(const void* left, const void* right)
+{
+    u64 a = ((const Job*)left)->bytes;
+    u64 b = ((const Job*)right)->bytes;
+    return (a > b) - (a < b);
+}
+
+/* Get trace file size, 0 if it cannot be determined */
+static u64 FileSize(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return 0;
+    }
+
+    long length = (fseek(file, 0, SEEK_END) == 0) ? ftell(file) : 0;
+    fclose(file);
+    return (length > 0) ? (u64)length : 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+BATCH_Status BATCH_Load(BATCH_List* list, const char* path)
+{
+    COMMON_NULLPTR_GUARD(list, BATCH_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(path, BATCH_StatusNullPtr);
+
+    memset(list, 0, sizeof(*list));
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return BATCH_StatusIoError;
+    }
+
+    const char* slash = strrchr(path, '/');
+    size directoryLength = (slash == NULL) ? 0 : (size)(slash - path + 1);
+
+    char line[LINE_MAX_LENGTH];
+    BATCH_Status status = BATCH_StatusOk;
+    size number = 0;
+    while (status == BATCH_StatusOk && fgets(line, sizeof(line), file) != NULL) {
+        ++number;
+        if (strchr(line, '\n') == NULL && !feof(file)) {
+            status = BATCH_StatusBadLine;
+        } else {
+            status = AddScenario(list, line, path, directoryLength);
+        }
+    }
+    if (status == BATCH_StatusOk && ferror(file)) {
+        status = BATCH_StatusIoError;
+    }
+    fclose(file);
+
+    if (status != BATCH_StatusOk) {
+        size errorLine = (status == BATCH_StatusBadLine) ? number : 0;
+        BATCH_Destroy(list);
+        list->errorLine = errorLine;
+    }
+    return status;
+}
+
+void BATCH_Destroy(BATCH_List* list)
+{
+    if (list == NULL) {
+        return;
+    }
+
+    for (size i = 0; i < list->count; ++i) {
+        free(list->scenarios[i].trace);
+        free(list->scenarios[i].expected);
+    }
+    free(list->scenarios);
+    memset(list, 0, sizeof(*list));
+}
+
+BATCH_Status BATCH_Run(BATCH_List* list, size workers, bool update)
+{
+    COMMON_NULLPTR_GUARD(list, BATCH_StatusNullPtr);
+
+    if (workers == BATCH_WORKERS_AUTO) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = (online > 0) ? (size)online : 1;
+    }
+    if (workers > list->count) {
+        workers = (list->count > 0) ? list->count : 1;
+    }
+
+    Job* order = malloc((list->count + 1) * sizeof(Job));
+    ENGINE_Job* jobs = calloc(list->count + 1, sizeof(ENGINE_Job));
+    if (order == NULL || jobs == NULL) {
+        free(order);
+        free(jobs);
+        return BATCH_StatusMemError;
+    }
+
+    /* Engine deals jobs round-robin and every worker starts with the job
+     * dealt to it last, so ascending order runs the longest scenarios first */
+    for (size i = 0; i < list->count; ++i) {
+        order[i] = (Job){
+            .bytes = FileSize(list->scenarios[i].trace),
+            .scenario = &list->scenarios[i],
+            .update = update
+        };
+    }
+    qsort(order, list->count, sizeof(Job), CompareBySize);
+    for (size i = 0; i < list->count; ++i) {
+        jobs[i] = (ENGINE_Job){.task = RunJob, .context = &order[i]};
+    }
+
+    ENGINE_Instance engine;
+    ENGINE_Create(&engine, workers);
+    ENGINE_Status status = ENGINE_Run(&engine, jobs, list->count);
+
+    free(order);
+    free(jobs);
+    return (status == ENGINE_StatusOk) ? BATCH_StatusOk : BATCH_StatusMemError;
+}
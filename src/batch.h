@@ -0,0 +1,131 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "common.h"
+#include "golden.h"
+#include "trace.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Worker count which selects number of online processors */
+#define BATCH_WORKERS_AUTO 0
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    BATCH_StatusOk = 0,      /**< OK */
+    BATCH_StatusNullPtr,     /**< Null pointer was passed to API function */
+    BATCH_StatusMemError,    /**< Memory allocation error */
+    BATCH_StatusIoError,     /**< Scenario list could not be read */
+    BATCH_StatusBadLine      /**< Malformed scenario line, see errorLine */
+} BATCH_Status;
+
+/**
+ * @brief An enum to represent result of a single scenario
+ */
+typedef enum
+{
+    BATCH_OutcomePending = 0, /**< Not run yet */
+    BATCH_OutcomePassed,      /**< Final output matches golden data */
+    BATCH_OutcomeFailed,      /**< Final output differs from golden data */
+    BATCH_OutcomeRan,         /**< Replayed, no golden data to compare with */
+    BATCH_OutcomeUpdated,     /**< Golden data was rewritten from output */
+    BATCH_OutcomeError        /**< Trace or golden data could not be used */
+} BATCH_Outcome;
+
+/**
+ * @brief Single scenario: trace replayed into chains, compared at the end
+ *
+ * Golden data is the final framebuffer of all chains as raw little-endian
+ * u64 bitboards, chain 0 first.
+ */
+typedef struct
+{
+    char* trace;               /**< Trace file path */
+    size chains;               /**< Number of chains */
+    size devices;              /**< Devices per chain */
+    char* expected;            /**< Golden data path, NULL if not checked */
+    BATCH_Outcome outcome;     /**< Result */
+    TRACE_Status traceStatus;  /**< Replay status */
+    GOLDEN_Result difference;  /**< Comparison details */
+    u64 bytes;                 /**< Trace size */
+    u64 frames;                /**< Frames latched into devices */
+    double seconds;            /**< Wall time of the scenario */
+} BATCH_Scenario;
+
+/**
+ * @brief Scenario list loaded from a text file
+ *
+ * Every non-empty line not starting with '#' holds a trace path, number of
+ * chains, devices per chain and golden data path ('-' for none), separated
+ * by whitespace. Relative paths are resolved against the list directory.
+ */
+typedef struct
+{
+    BATCH_Scenario* scenarios; /**< Loaded scenarios */
+    size count;                /**< Number of scenarios */
+    size capacity;             /**< Allocated number of scenarios */
+    size errorLine;            /**< Line number of the first malformed line */
+} BATCH_List;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Load scenario list.
+ *
+ * @param list List instance to be initialized
+ * @param path Scenario list path
+ *
+ * @return Instance of BATCH_Status. The function possible return values are:
+ * - BATCH_StatusNullPtr when null pointer was passed to function
+ * - BATCH_StatusIoError when the file could not be read
+ * - BATCH_StatusBadLine when a line is malformed, see BATCH_List::errorLine
+ * - BATCH_StatusMemError when there was a memory allocation error
+ * - BATCH_StatusOk after success
+ */
+BATCH_Status BATCH_Load(BATCH_List* list, const char* path);
+
+/**
+ * @brief Release memory owned by the list.
+ *
+ * @param list List loaded with BATCH_Load
+ */
+void BATCH_Destroy(BATCH_List* list);
+
+/**
+ * @brief Run all scenarios in parallel.
+ *
+ * Every scenario is an ENGINE task, so scenarios are balanced across workers
+ * by work stealing, largest traces start first. The calling thread works as
+ * well, so threads which cannot be started only reduce parallelism.
+ *
+ * @param list    Pointer to the list
+ * @param workers Number of threads or BATCH_WORKERS_AUTO
+ * @param update  Write golden data from output instead of comparing
+ *
+ * @return Instance of BATCH_Status. The function possible return values are:
+ * - BATCH_StatusNullPtr when null pointer was passed to function
+ * - BATCH_StatusMemError when there was a memory allocation error
+ * - BATCH_StatusOk after all scenarios finished, whatever their outcomes
+ */
+BATCH_Status BATCH_Run(BATCH_List* list, size workers, bool update);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // BATCH_H
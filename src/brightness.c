@@ -0,0 +1,69 @@
+#include "brightness.h"
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Rounded luminance for intensity N and scan limit S */
+#define LEVEL(N, S)                                                           \
+    ((BRIGHTNESS_FULL_SCALE * (2 * (N) + 1)                                   \
+      + (BRIGHTNESS_DUTY_STEPS * ((S) + 1)) / 2)                              \
+     / (BRIGHTNESS_DUTY_STEPS * ((S) + 1)))
+
+/* Luminance for all scan limits of given intensity */
+#define LEVEL_ROW(N) \
+    {LEVEL(N, 0), LEVEL(N, 1), LEVEL(N, 2), LEVEL(N, 3), \
+     LEVEL(N, 4), LEVEL(N, 5), LEVEL(N, 6), LEVEL(N, 7)}
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private variables -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Luminance look-up table indexed by intensity and scan limit, see
+ * BRIGHTNESS_DutySteps and BRIGHTNESS_ScannedDigits for the model */
+static const u8 levelLut[16][MAX7219_DIGITS] = {
+    LEVEL_ROW(0),  LEVEL_ROW(1),  LEVEL_ROW(2),  LEVEL_ROW(3),
+    LEVEL_ROW(4),  LEVEL_ROW(5),  LEVEL_ROW(6),  LEVEL_ROW(7),
+    LEVEL_ROW(8),  LEVEL_ROW(9),  LEVEL_ROW(10), LEVEL_ROW(11),
+    LEVEL_ROW(12), LEVEL_ROW(13), LEVEL_ROW(14), LEVEL_ROW(15)
+};
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+u8 BRIGHTNESS_Level(const MAX7219_Device* device)
+{
+    return levelLut[BRIGHTNESS_DutySteps(device) / 2]
+            [BRIGHTNESS_ScannedDigits(device) - 1];
+}
+
+void BRIGHTNESS_Compute(
+        const MAX7219_Device* devices,
+        const u64* framebuffer,
+        size count,
+        u8* luminance)
+{
+    for (size i = 0; i < count; ++i) {
+        u8 level = BRIGHTNESS_Level(&devices[i]);
+        u64 bitboard = framebuffer[i];
+
+        /* Branchless expansion: every bit selects either 0 or the level */
+        for (u8 bit = 0; bit < BRIGHTNESS_LEDS_PER_DEVICE; ++bit) {
+            luminance[bit] = (u8)(-(u8)((bitboard >> bit) & 1)) & level;
+        }
+        luminance += BRIGHTNESS_LEDS_PER_DEVICE;
+    }
+}
+
+BRIGHTNESS_Status BRIGHTNESS_ComputeChain(CHAIN_Instance* chain, u8* luminance)
+{
+    COMMON_NULLPTR_GUARD(chain, BRIGHTNESS_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(luminance, BRIGHTNESS_StatusNullPtr);
+
+    CHAIN_Render(chain);
+    BRIGHTNESS_Compute(chain->devices, chain->framebuffer, chain->length,
+            luminance);
+
+    return BRIGHTNESS_StatusOk;
+}
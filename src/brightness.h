@@ -0,0 +1,120 @@
+#ifndef BRIGHTNESS_H
+#define BRIGHTNESS_H
+
+#include "common.h"
+#include "max7219.h"
+#include "chain.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Number of luminance values produced for single device */
+#define BRIGHTNESS_LEDS_PER_DEVICE 64
+
+/* Luminance of LED which would be lit for the whole scan period */
+#define BRIGHTNESS_FULL_SCALE 255
+
+/* Duty cycle denominator of the PWM */
+#define BRIGHTNESS_DUTY_STEPS 32
+
+/* Intensity used during display test */
+#define BRIGHTNESS_DISPLAY_TEST_INTENSITY 0x0F
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    BRIGHTNESS_StatusOk = 0, /**< OK */
+    BRIGHTNESS_StatusNullPtr /**< Null pointer was passed to API function */
+} BRIGHTNESS_Status;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Get PWM on-time of a digit in BRIGHTNESS_DUTY_STEPS units.
+ *
+ * Intensity N keeps the digit on for (2 * N + 1) / 32 of its multiplex slot,
+ * display test always uses the maximum duty cycle.
+ *
+ * @param device Pointer to the device
+ * @return Duty cycle numerator in range 1 - 31
+ */
+static inline u8 BRIGHTNESS_DutySteps(const MAX7219_Device* device)
+{
+    u8 intensity = MAX7219_IsDisplayTest(device)
+            ? BRIGHTNESS_DISPLAY_TEST_INTENSITY
+            : device->intensity & 0x0F;
+    return 2 * intensity + 1;
+}
+
+/**
+ * @brief Get number of digits sharing the scan period.
+ *
+ * @param device Pointer to the device
+ * @return Scan limit plus one, all 8 digits during display test
+ */
+static inline u8 BRIGHTNESS_ScannedDigits(const MAX7219_Device* device)
+{
+    return MAX7219_IsDisplayTest(device)
+            ? MAX7219_DIGITS
+            : (device->scanLimit & 0x07) + 1;
+}
+
+/**
+ * @brief Get perceived luminance of a lit LED.
+ *
+ * The value is BRIGHTNESS_DutySteps / BRIGHTNESS_DUTY_STEPS of full scale
+ * divided by BRIGHTNESS_ScannedDigits, since multiplexing keeps every digit on
+ * for its own slot of the scan period only.
+ *
+ * @param device Pointer to the device
+ * @return Luminance in range 0 - BRIGHTNESS_FULL_SCALE
+ */
+u8 BRIGHTNESS_Level(const MAX7219_Device* device);
+
+/**
+ * @brief Compute luminance of every LED for an array of devices in one pass.
+ *
+ * Output layout is device-major, then digit, then segment bit (D0 first), thus
+ * BRIGHTNESS_LEDS_PER_DEVICE bytes are written per device. Unlit LEDs are 0.
+ *
+ * @param devices     Register files of the devices
+ * @param framebuffer Rendered bitboards of the devices
+ * @param count       Number of devices
+ * @param luminance   Output buffer of count * BRIGHTNESS_LEDS_PER_DEVICE bytes
+ */
+void BRIGHTNESS_Compute(
+        const MAX7219_Device* devices,
+        const u64* framebuffer,
+        size count,
+        u8* luminance);
+
+/**
+ * @brief Render pending changes and compute luminance of the whole chain.
+ *
+ * @param chain     Pointer to the chain
+ * @param luminance Output buffer of length * BRIGHTNESS_LEDS_PER_DEVICE bytes
+ *
+ * @return Instance of BRIGHTNESS_Status. The function possible return values:
+ * - BRIGHTNESS_StatusNullPtr when null pointer was passed to function
+ * - BRIGHTNESS_StatusOk after success
+ */
+BRIGHTNESS_Status BRIGHTNESS_ComputeChain(CHAIN_Instance* chain, u8* luminance);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // BRIGHTNESS_H
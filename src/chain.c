@@ -0,0 +1,295 @@
+#include "chain.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Reference count placed in front of every storage block */
+typedef union
+{
+    atomic_size_t refs;
+    max_align_t alignment;
+} StorageHeader;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Get shift register contents of particular device */
+static inline u16 ShiftRegisterOf(const CHAIN_Instance* chain, size device)
+{
+    size index = chain->shiftHead + device;
+    if (index >= chain->length) {
+        index -= chain->length;
+    }
+    return chain->shift[index];
+}
+
+/* Replicate the first element over the whole array with doubling copies */
+static void Replicate(void* array, size elementSize, size count)
+{
+    u8* bytes = array;
+    size total = elementSize * count;
+    size filled = elementSize;
+
+    while (filled < total) {
+        size chunk = (filled < total - filled) ? filled : total - filled;
+        memcpy(bytes + filled, bytes, chunk);
+        filled += chunk;
+    }
+}
+
+/* Point per-device arrays into storage block, widest elements go first */
+static void CarveStorage(CHAIN_Instance* chain)
+{
+    u8* block = chain->storage;
+    chain->framebuffer = (u64*)block;
+    chain->changedTick = (u64*)(block + chain->length * sizeof(u64));
+    chain->shift = (u16*)(block + 2 * chain->length * sizeof(u64));
+    chain->devices = (MAX7219_Device*)(block
+            + chain->length * (2 * sizeof(u64) + sizeof(u16)));
+}
+
+/* Get reference count of storage block */
+static inline StorageHeader* HeaderOf(void* storage)
+{
+    return (StorageHeader*)storage - 1;
+}
+
+/* Allocate zeroed storage block referenced once */
+static void* AllocStorage(size bytes)
+{
+    StorageHeader* header = calloc(1, sizeof(StorageHeader) + bytes);
+    if (header == NULL) {
+        return NULL;
+    }
+    atomic_init(&header->refs, 1);
+    return header + 1;
+}
+
+/* Drop reference to storage block, the last one frees it */
+static void ReleaseStorage(void* storage)
+{
+    StorageHeader* header = HeaderOf(storage);
+    if (atomic_fetch_sub_explicit(&header->refs, 1, memory_order_acq_rel) == 1) {
+        free(header);
+    }
+}
+
+/* Copy shared storage before it is written, returns false if chain failed */
+static inline bool PrepareWrite(CHAIN_Instance* chain)
+{
+    if (chain->shared && !chain->failed) {
+        CHAIN_Unshare(chain);
+    }
+    return !chain->failed;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+CHAIN_Status CHAIN_Create(CHAIN_Instance* chain, size length)
+{
+    COMMON_NULLPTR_GUARD(chain, CHAIN_StatusNullPtr);
+
+    if (length == 0) {
+        return CHAIN_StatusWrongSize;
+    }
+
+    memset(chain, 0, sizeof(*chain));
+    chain->storage = AllocStorage(CHAIN_StorageSize(length));
+    if (chain->storage == NULL) {
+        return CHAIN_StatusMemError;
+    }
+
+    chain->storageSize = CHAIN_StorageSize(length);
+    chain->length = length;
+    CarveStorage(chain);
+    return CHAIN_StatusOk;
+}
+
+size CHAIN_StorageSize(size length)
+{
+    return length * (2 * sizeof(u64) + sizeof(u16) + sizeof(MAX7219_Device));
+}
+
+void CHAIN_Destroy(CHAIN_Instance* chain)
+{
+    if (chain == NULL) {
+        return;
+    }
+
+    if (chain->storage != NULL) {
+        ReleaseStorage(chain->storage);
+    }
+    memset(chain, 0, sizeof(*chain));
+}
+
+CHAIN_Status CHAIN_Fork(CHAIN_Instance* source, CHAIN_Instance* fork)
+{
+    COMMON_NULLPTR_GUARD(source, CHAIN_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(fork, CHAIN_StatusNullPtr);
+
+    atomic_fetch_add_explicit(&HeaderOf(source->storage)->refs, 1,
+            memory_order_relaxed);
+    source->shared = true;
+
+    *fork = *source;
+    return CHAIN_StatusOk;
+}
+
+CHAIN_Status CHAIN_Unshare(CHAIN_Instance* chain)
+{
+    COMMON_NULLPTR_GUARD(chain, CHAIN_StatusNullPtr);
+
+    if (!chain->shared) {
+        return CHAIN_StatusOk;
+    }
+
+    /* Nobody else can take a new reference while we hold the last one */
+    StorageHeader* header = HeaderOf(chain->storage);
+    if (atomic_load_explicit(&header->refs, memory_order_acquire) > 1) {
+        void* copy = AllocStorage(chain->storageSize);
+        if (copy == NULL) {
+            chain->failed = true;
+            return CHAIN_StatusMemError;
+        }
+        memcpy(copy, chain->storage, chain->storageSize);
+        ReleaseStorage(chain->storage);
+        chain->storage = copy;
+        CarveStorage(chain);
+    }
+
+    chain->shared = false;
+    return CHAIN_StatusOk;
+}
+
+void CHAIN_PowerOn(CHAIN_Instance* chain, u8 digitValue)
+{
+    if (!PrepareWrite(chain)) {
+        return;
+    }
+
+    if (digitValue == 0) {
+        memset(chain->devices, 0, chain->length * sizeof(*chain->devices));
+    } else {
+        MAX7219_PowerOn(&chain->devices[0], digitValue);
+        Replicate(chain->devices, sizeof(*chain->devices), chain->length);
+    }
+
+    /* Every device is blank after power-up, lit ones have just changed */
+    ++chain->tick;
+    for (size i = 0; i < chain->length; ++i) {
+        if (chain->framebuffer[i] != MAX7219_BITBOARD_ALL_OFF) {
+            chain->changedTick[i] = chain->tick;
+        }
+    }
+    memset(chain->framebuffer, 0, chain->length * sizeof(*chain->framebuffer));
+    memset(chain->shift, 0, chain->length * sizeof(*chain->shift));
+    chain->shiftHead = 0;
+    chain->shifted = 0;
+}
+
+void CHAIN_Shift(CHAIN_Instance* chain, u16 frame)
+{
+    if (!PrepareWrite(chain)) {
+        return;
+    }
+
+    /* Moving the head is equivalent to passing every frame one device down */
+    chain->shiftHead = (chain->shiftHead == 0)
+            ? chain->length - 1
+            : chain->shiftHead - 1;
+    chain->shift[chain->shiftHead] = frame;
+    ++chain->shifted;
+}
+
+void CHAIN_Latch(CHAIN_Instance* chain)
+{
+    if (!PrepareWrite(chain)) {
+        return;
+    }
+
+    ++chain->tick;
+    chain->shifted = 0;
+
+    u64 redundant = 0;
+    for (size i = 0; i < chain->length; ++i) {
+        u8 result = MAX7219_Write(&chain->devices[i], ShiftRegisterOf(chain, i));
+        redundant += (result & MAX7219_WRITE_REDUNDANT) != 0;
+    }
+    chain->frames += chain->length;
+    chain->redundantFrames += redundant;
+}
+
+void CHAIN_Transfer(CHAIN_Instance* chain, const u16* frames, size count)
+{
+    for (size i = 0; i < count; ++i) {
+        CHAIN_Shift(chain, frames[i]);
+    }
+    CHAIN_Latch(chain);
+}
+
+void CHAIN_Feed(CHAIN_Instance* chain, const u16* frames, size count)
+{
+    for (size i = 0; i < count; ++i) {
+        CHAIN_Shift(chain, frames[i]);
+        if (chain->shifted >= chain->length) {
+            CHAIN_Latch(chain);
+        }
+    }
+}
+
+size CHAIN_Render(CHAIN_Instance* chain)
+{
+    size changed = 0;
+    for (size i = 0; i < chain->length; ++i) {
+        if (chain->devices[i].dirty == 0) {
+            continue;
+        }
+        if (!PrepareWrite(chain)) {
+            break;
+        }
+
+        MAX7219_Device* device = &chain->devices[i];
+        u64 bitboard = MAX7219_Render(device);
+        if (bitboard != chain->framebuffer[i]) {
+            chain->framebuffer[i] = bitboard;
+            chain->changedTick[i] = chain->tick;
+            ++changed;
+        }
+    }
+    return changed;
+}
+
+CHAIN_Status CHAIN_ChangedSince(
+        CHAIN_Instance* chain,
+        u64 tick,
+        size* indices,
+        size capacity,
+        size* count)
+{
+    COMMON_NULLPTR_GUARD(chain, CHAIN_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(count, CHAIN_StatusNullPtr);
+
+    CHAIN_Render(chain);
+
+    size changed = 0;
+    for (size i = 0; i < chain->length; ++i) {
+        if (chain->changedTick[i] > tick) {
+            if (changed < capacity) {
+                indices[changed] = i;
+            }
+            ++changed;
+        }
+    }
+
+    *count = changed;
+    return CHAIN_StatusOk;
+}
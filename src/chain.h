@@ -0,0 +1,241 @@
+#ifndef CHAIN_H
+#define CHAIN_H
+
+#include "common.h"
+#include "max7219.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    CHAIN_StatusOk = 0,     /**< OK */
+    CHAIN_StatusNullPtr,    /**< Null pointer was passed to API function */
+    CHAIN_StatusMemError,   /**< Memory allocation error */
+    CHAIN_StatusWrongSize   /**< Wrong number of devices or buffer size */
+} CHAIN_Status;
+
+/**
+ * @brief Daisy chain of devices sharing common LOAD(CS) and CLK lines
+ *
+ * Device 0 is connected directly to the microcontroller, thus the first frame
+ * shifted in during a transaction ends up in the last device of the chain.
+ * All per-device arrays are carved out of a single storage block, so the whole
+ * chain state can be copied at once. The block is reference counted and may be
+ * shared by forks (see CHAIN_Fork) until one of them is modified.
+ */
+typedef struct
+{
+    void* storage;           /**< Block holding all the arrays below */
+    size storageSize;        /**< Size of the storage block in bytes */
+    MAX7219_Device* devices; /**< Register files of the devices */
+    u64* framebuffer;        /**< Visible output bitboard per device */
+    u16* shift;              /**< Shift registers, used as a ring buffer */
+    u64* changedTick;        /**< Tick of the last visible change per device */
+    size length;             /**< Number of devices */
+    size shiftHead;          /**< Ring buffer index of device 0 shift register */
+    size shifted;            /**< Frames shifted in since the last latch */
+    u64 tick;                /**< Logical clock, advanced on every latch */
+    u64 frames;              /**< Frames latched into devices */
+    u64 redundantFrames;     /**< Latched frames which left registers unchanged */
+    bool shared;             /**< Storage may be referenced by another fork */
+    bool failed;             /**< Storage could not be unshared, writes dropped
+                                  until the chain is restored from a snapshot */
+} CHAIN_Instance;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create chain of devices.
+ *
+ * Devices are put into the power-on state with digit registers cleared and
+ * the logical clock starts at zero.
+ *
+ * @param chain  Chain instance to be initialized
+ * @param length Number of devices in the chain
+ *
+ * @return Instance of CHAIN_Status. The function possible return values are:
+ * - CHAIN_StatusNullPtr when null pointer was passed to function
+ * - CHAIN_StatusWrongSize when length is zero
+ * - CHAIN_StatusMemError when there was a memory allocation error
+ * - CHAIN_StatusOk after success
+ */
+CHAIN_Status CHAIN_Create(CHAIN_Instance* chain, size length);
+
+/**
+ * @brief Get size of storage block needed by chain of given length.
+ *
+ * @param length Number of devices in the chain
+ * @return Size of the storage block in bytes
+ */
+size CHAIN_StorageSize(size length);
+
+/**
+ * @brief Release memory owned by the chain.
+ *
+ * @param chain Chain instance created with CHAIN_Create
+ */
+void CHAIN_Destroy(CHAIN_Instance* chain);
+
+/**
+ * @brief Create copy-on-write branch of the chain.
+ *
+ * The fork references storage of the source, so creating it costs neither
+ * copying nor allocation. The first modification of either chain copies the
+ * storage block, chains which are never driven again stay shared. Forks may
+ * be driven from different threads. If the copy cannot be allocated, the
+ * modified chain sets CHAIN_Instance::failed and ignores all further writes,
+ * so a state with dropped writes is never driven on. The flag is inherited by
+ * forks and cleared only by SNAPSHOT_Restore.
+ *
+ * Sharing is per chain, not per page: a single shifted frame copies the whole
+ * block, about 32 bytes per device (3.2 MB for 100k devices, see bench_fork).
+ * Large device farms should be split into several chains, so that a branch
+ * only copies the chains it actually drives.
+ *
+ * @param source Chain to be forked, becomes shared as well
+ * @param fork   Chain instance to be initialized, released with CHAIN_Destroy
+ *
+ * @return Instance of CHAIN_Status. The function possible return values are:
+ * - CHAIN_StatusNullPtr when null pointer was passed to function
+ * - CHAIN_StatusOk after success
+ */
+CHAIN_Status CHAIN_Fork(CHAIN_Instance* source, CHAIN_Instance* fork);
+
+/**
+ * @brief Make sure the chain owns its storage exclusively.
+ *
+ * Mutating API functions do it on their own, the function is meant for code
+ * writing chain arrays directly.
+ *
+ * @param chain Pointer to the chain
+ *
+ * @return Instance of CHAIN_Status. The function possible return values are:
+ * - CHAIN_StatusNullPtr when null pointer was passed to function
+ * - CHAIN_StatusMemError when the copy could not be allocated
+ * - CHAIN_StatusOk after success
+ */
+CHAIN_Status CHAIN_Unshare(CHAIN_Instance* chain);
+
+/**
+ * @brief Power-cycle all devices of the chain at once.
+ *
+ * Every device is put into the datasheet power-on state (see MAX7219_Device)
+ * with a bulk memory fill instead of per-register writes. Shift registers are
+ * cleared, the framebuffer is blanked and the logical clock advances by one
+ * tick, so devices which were lit before are reported by CHAIN_ChangedSince.
+ *
+ * @param chain      Pointer to the chain
+ * @param digitValue Value emulating undefined contents of digit registers,
+ * e.g. MAX7219_POWER_ON_DIGIT_DEFAULT
+ */
+void CHAIN_PowerOn(CHAIN_Instance* chain, u8 digitValue);
+
+/**
+ * @brief Shift single 16-bit frame into the chain (LOAD is held low).
+ *
+ * @param chain Pointer to the chain
+ * @param frame Frame to be shifted into device 0
+ */
+void CHAIN_Shift(CHAIN_Instance* chain, u16 frame);
+
+/**
+ * @brief Latch shift registers into devices (rising edge of LOAD).
+ *
+ * Every device decodes the frame present in its shift register and the
+ * logical clock is advanced by one tick. Frames rewriting a register with its
+ * current value are counted in CHAIN_Instance::redundantFrames.
+ *
+ * @param chain Pointer to the chain
+ */
+void CHAIN_Latch(CHAIN_Instance* chain);
+
+/**
+ * @brief Perform complete transaction: shift frames in and latch them.
+ *
+ * @param chain  Pointer to the chain
+ * @param frames Frames in the order they are sent over the bus
+ * @param count  Number of frames
+ */
+void CHAIN_Transfer(CHAIN_Instance* chain, const u16* frames, size count);
+
+/**
+ * @brief Feed stream of frames consisting of full-chain transactions.
+ *
+ * The chain is latched every time one frame per device has been shifted in,
+ * which is how firmware normally drives daisy-chained devices. Transactions
+ * may be split across multiple calls.
+ *
+ * @param chain  Pointer to the chain
+ * @param frames Frames in the order they are sent over the bus
+ * @param count  Number of frames
+ */
+void CHAIN_Feed(CHAIN_Instance* chain, const u16* frames, size count);
+
+/**
+ * @brief Bring rendered state of dirty devices up to date.
+ *
+ * Only devices with pending dirty flags are recomputed into the framebuffer.
+ * Devices whose visible output has changed are stamped with the current tick.
+ *
+ * @param chain Pointer to the chain
+ *
+ * @return Number of devices whose visible output has changed
+ */
+size CHAIN_Render(CHAIN_Instance* chain);
+
+/**
+ * @brief Collect devices whose visible output has changed after given tick.
+ *
+ * The function renders pending changes first, so the result always reflects
+ * the newest register state. Compare against CHAIN_Instance::tick read during
+ * the previous query to get incremental updates.
+ *
+ * @param chain    Pointer to the chain
+ * @param tick     Reference tick
+ * @param indices  Buffer to store device indices (can be NULL if capacity is 0)
+ * @param capacity Size of indices buffer
+ * @param count    The buffer in which total number of changed devices is stored.
+ * Only the first min(count, capacity) indices are written
+ *
+ * @return Instance of CHAIN_Status. The function possible return values are:
+ * - CHAIN_StatusNullPtr when null pointer was passed to function
+ * - CHAIN_StatusOk after success
+ */
+CHAIN_Status CHAIN_ChangedSince(
+        CHAIN_Instance* chain,
+        u64 tick,
+        size* indices,
+        size capacity,
+        size* count);
+
+/**
+ * @brief Get share of latched frames which did not change any register.
+ *
+ * High values point at firmware resending the whole display on every refresh.
+ *
+ * @param chain Pointer to the chain
+ * @return Percentage of redundant frames, 0 if nothing was latched yet
+ */
+static inline double CHAIN_RedundantPercent(const CHAIN_Instance* chain)
+{
+    return (chain->frames == 0)
+            ? 0.0
+            : 100.0 * (double)chain->redundantFrames / (double)chain->frames;
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // CHAIN_H
@@ -0,0 +1,452 @@
+#include "csv.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Decimal exponent of one nanosecond */
+#define NANOSECOND_EXPONENT 9
+
+/* Significant digits which always fit into u64 */
+#define MAX_MANTISSA_DIGITS 19
+
+/* Hex digits of a value treated as a single byte */
+#define BYTE_HEX_DIGITS 2
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private variables -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Powers of ten which fit into u64 */
+static const u64 powersOfTen[] = {
+    UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000),
+    UINT64_C(10000), UINT64_C(100000), UINT64_C(1000000),
+    UINT64_C(10000000), UINT64_C(100000000), UINT64_C(1000000000),
+    UINT64_C(10000000000), UINT64_C(100000000000),
+    UINT64_C(1000000000000), UINT64_C(10000000000000),
+    UINT64_C(100000000000000), UINT64_C(1000000000000000),
+    UINT64_C(10000000000000000), UINT64_C(100000000000000000),
+    UINT64_C(1000000000000000000), UINT64_C(10000000000000000000)
+};
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Check for decimal digit */
+static inline bool IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/* Get value of hex digit or -1 */
+static inline int HexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/* Skip spaces and tabs */
+static inline const char* SkipBlanks(const char* text, const char* end)
+{
+    while (text < end && (*text == ' ' || *text == '\t')) {
+        ++text;
+    }
+    return text;
+}
+
+/* Trim spaces, tabs and carriage returns from the end */
+static inline const char* TrimEnd(const char* text, const char* end)
+{
+    while (end > text && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+        --end;
+    }
+    return end;
+}
+
+/* Find field delimiter or end of line */
+static inline const char* FindDelimiter(const char* text, const char* end)
+{
+    const char* comma = memchr(text, ',', (size)(end - text));
+    return (comma != NULL) ? comma : end;
+}
+
+/* Parse timestamp with optional sign into magnitude [ns] */
+static bool ParseSignedSeconds(const char* text, const char* end,
+        u64* magnitude, bool* negative)
+{
+    text = SkipBlanks(text, end);
+    *negative = (text < end && *text == '-');
+    if (text < end && (*text == '-' || *text == '+')) {
+        ++text;
+    }
+    return CSV_ParseSeconds(text, end, magnitude);
+}
+
+/* Parse hex field, digits is set to 0 for empty field */
+static bool ParseHex(const char* text, const char* end, u16* value, size* digits)
+{
+    text = SkipBlanks(text, end);
+    end = TrimEnd(text, end);
+
+    if (end - text >= 2 && text[0] == '0' && (text[1] | 0x20) == 'x') {
+        text += 2;
+    }
+
+    u32 result = 0;
+    *digits = (size)(end - text);
+    for (; text < end; ++text) {
+        int nibble = HexValue(*text);
+        if (nibble < 0) {
+            return false;
+        }
+        result = (result << 4) | (u32)nibble;
+        if (result > 0xFFFF) {
+            return false;
+        }
+    }
+
+    *value = (u16)result;
+    return true;
+}
+
+/* Make sure there is space for one more frame */
+static bool ReserveFrame(CSV_Parser* parser)
+{
+    if (parser->frameCount < parser->frameCapacity) {
+        return true;
+    }
+
+    size capacity = (parser->frameCapacity == 0) ? 64 : 2 * parser->frameCapacity;
+    u8* grown = realloc(parser->frames, 2 * capacity);
+    if (grown == NULL) {
+        return false;
+    }
+    parser->frames = grown;
+    parser->frameCapacity = capacity;
+    return true;
+}
+
+/* Append frame in trace byte order */
+static bool AppendFrame(CSV_Parser* parser, u16 frame)
+{
+    if (!ReserveFrame(parser)) {
+        return false;
+    }
+
+    u8* slot = &parser->frames[2 * parser->frameCount++];
+    slot[0] = (u8)frame;
+    slot[1] = (u8)(frame >> 8);
+    return true;
+}
+
+/* Handle MOSI value sampled while CS is low */
+static bool ShiftValue(CSV_Parser* parser, u16 value, size digits)
+{
+    if (digits > BYTE_HEX_DIGITS) {
+        if (parser->pendingByte) {
+            parser->pendingByte = false;
+            ++parser->droppedBytes;
+        }
+        return AppendFrame(parser, value);
+    }
+
+    if (!parser->pendingByte) {
+        parser->pendingByte = true;
+        parser->highByte = (u8)value;
+        return true;
+    }
+
+    parser->pendingByte = false;
+    return AppendFrame(parser, (u16)((parser->highByte << 8) | (u8)value));
+}
+
+/* Emit collected frames on rising edge of CS */
+static CSV_Status Latch(CSV_Parser* parser, u64 timestamp)
+{
+    if (parser->pendingByte) {
+        parser->pendingByte = false;
+        ++parser->droppedBytes;
+    }
+
+    TRACE_Record record = {
+        .chain = parser->chain,
+        .timestamp = timestamp,
+        .frames = parser->frames,
+        .count = parser->frameCount
+    };
+    parser->frameCount = 0;
+
+    TRACE_Status status = parser->callback(parser->context, &record);
+    if (status != TRACE_StatusOk) {
+        parser->callbackStatus = status;
+        return CSV_StatusCallbackError;
+    }
+    return CSV_StatusOk;
+}
+
+/* Parse single line without terminating newline */
+static CSV_Status ParseLine(CSV_Parser* parser, const char* line, const char* end)
+{
+    ++parser->lines;
+    line = SkipBlanks(line, end);
+    end = TrimEnd(line, end);
+
+    if (line == end) {
+        return CSV_StatusOk;
+    }
+
+    /* Headers and comments are only expected in front of the data */
+    const char* timeEnd = FindDelimiter(line, end);
+    u64 magnitude;
+    bool negative;
+    bool numeric = ParseSignedSeconds(line, timeEnd, &magnitude, &negative);
+    if (!parser->started) {
+        if (!numeric) {
+            return CSV_StatusOk;
+        }
+        parser->started = true;
+        parser->origin = negative ? magnitude : 0;
+    }
+    if (!numeric || timeEnd == end) {
+        return CSV_StatusSyntaxError;
+    }
+    const char* mosi = timeEnd + 1;
+    const char* mosiEnd = FindDelimiter(mosi, end);
+    if (mosiEnd == end) {
+        return CSV_StatusSyntaxError;
+    }
+    const char* cs = SkipBlanks(mosiEnd + 1, end);
+
+    /* Negative timestamps never precede the first data line */
+    if (negative ? magnitude > parser->origin
+            : magnitude > UINT64_MAX - parser->origin) {
+        return CSV_StatusSyntaxError;
+    }
+    u64 timestamp = negative
+            ? parser->origin - magnitude
+            : parser->origin + magnitude;
+
+    u16 value;
+    size digits;
+    if (!ParseHex(mosi, mosiEnd, &value, &digits)
+            || end - cs != 1
+            || (*cs != '0' && *cs != '1')) {
+        return CSV_StatusSyntaxError;
+    }
+
+    if (*cs == '0') {
+        parser->csLow = true;
+        if (digits > 0 && !ShiftValue(parser, value, digits)) {
+            return CSV_StatusMemError;
+        }
+        return CSV_StatusOk;
+    }
+
+    if (parser->csLow) {
+        parser->csLow = false;
+        return Latch(parser, timestamp);
+    }
+    return CSV_StatusOk;
+}
+
+/* Keep unterminated line for the next chunk */
+static bool KeepPartial(CSV_Parser* parser, const char* data, size length)
+{
+    size required = parser->partialLength + length;
+    if (required > parser->partialCapacity) {
+        size capacity = (parser->partialCapacity == 0) ? 128 : parser->partialCapacity;
+        while (capacity < required) {
+            capacity *= 2;
+        }
+        char* grown = realloc(parser->partial, capacity);
+        if (grown == NULL) {
+            return false;
+        }
+        parser->partial = grown;
+        parser->partialCapacity = capacity;
+    }
+
+    memcpy(&parser->partial[parser->partialLength], data, length);
+    parser->partialLength = required;
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+CSV_Status CSV_Create(
+        CSV_Parser* parser,
+        u64 chain,
+        TRACE_RecordCallback callback,
+        void* context)
+{
+    COMMON_NULLPTR_GUARD(parser, CSV_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(callback, CSV_StatusNullPtr);
+
+    memset(parser, 0, sizeof(*parser));
+    parser->callback = callback;
+    parser->context = context;
+    parser->chain = chain;
+    parser->callbackStatus = TRACE_StatusOk;
+
+    return CSV_StatusOk;
+}
+
+void CSV_Destroy(CSV_Parser* parser)
+{
+    if (parser == NULL) {
+        return;
+    }
+
+    free(parser->frames);
+    free(parser->partial);
+    memset(parser, 0, sizeof(*parser));
+}
+
+CSV_Status CSV_Feed(CSV_Parser* parser, const char* data, size length)
+{
+    COMMON_NULLPTR_GUARD(parser, CSV_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(data, CSV_StatusNullPtr);
+
+    const char* end = data + length;
+    CSV_Status status;
+
+    /* Complete the line split by the previous chunk */
+    if (parser->partialLength > 0) {
+        const char* newline = memchr(data, '\n', length);
+        if (newline == NULL) {
+            return KeepPartial(parser, data, length)
+                    ? CSV_StatusOk
+                    : CSV_StatusMemError;
+        }
+        if (!KeepPartial(parser, data, (size)(newline - data))) {
+            return CSV_StatusMemError;
+        }
+        status = ParseLine(parser, parser->partial,
+                parser->partial + parser->partialLength);
+        parser->partialLength = 0;
+        if (status != CSV_StatusOk) {
+            return status;
+        }
+        data = newline + 1;
+    }
+
+    /* Complete lines are parsed straight from the chunk */
+    for (;;) {
+        const char* newline = memchr(data, '\n', (size)(end - data));
+        if (newline == NULL) {
+            break;
+        }
+        status = ParseLine(parser, data, newline);
+        if (status != CSV_StatusOk) {
+            return status;
+        }
+        data = newline + 1;
+    }
+
+    if (data < end && !KeepPartial(parser, data, (size)(end - data))) {
+        return CSV_StatusMemError;
+    }
+    return CSV_StatusOk;
+}
+
+CSV_Status CSV_Finish(CSV_Parser* parser)
+{
+    COMMON_NULLPTR_GUARD(parser, CSV_StatusNullPtr);
+
+    if (parser->partialLength == 0) {
+        return CSV_StatusOk;
+    }
+
+    CSV_Status status = ParseLine(parser, parser->partial,
+            parser->partial + parser->partialLength);
+    parser->partialLength = 0;
+    return status;
+}
+
+bool CSV_ParseSeconds(const char* text, const char* end, u64* result)
+{
+    text = SkipBlanks(text, end);
+    end = TrimEnd(text, end);
+
+    u64 mantissa = 0;
+    size significant = 0;
+    int exponent = NANOSECOND_EXPONENT;
+    bool anyDigit = false;
+
+    /* Integer part */
+    for (; text < end && IsDigit(*text); ++text) {
+        anyDigit = true;
+        if (significant < MAX_MANTISSA_DIGITS) {
+            mantissa = 10 * mantissa + (u64)(*text - '0');
+            significant += (mantissa != 0);
+        } else {
+            ++exponent;
+        }
+    }
+
+    /* Fraction, digits beyond u64 precision are ignored */
+    if (text < end && *text == '.') {
+        for (++text; text < end && IsDigit(*text); ++text) {
+            anyDigit = true;
+            if (significant < MAX_MANTISSA_DIGITS) {
+                mantissa = 10 * mantissa + (u64)(*text - '0');
+                significant += (mantissa != 0);
+                --exponent;
+            }
+        }
+    }
+
+    if (!anyDigit) {
+        return false;
+    }
+
+    if (text < end && (*text | 0x20) == 'e') {
+        ++text;
+        bool negative = false;
+        if (text < end && (*text == '-' || *text == '+')) {
+            negative = (*text == '-');
+            ++text;
+        }
+        if (text == end) {
+            return false;
+        }
+        int value = 0;
+        for (; text < end && IsDigit(*text); ++text) {
+            if (value < 1000) {
+                value = 10 * value + (*text - '0');
+            }
+        }
+        exponent += negative ? -value : value;
+    }
+
+    if (text != end) {
+        return false;
+    }
+
+    if (mantissa == 0) {
+        *result = 0;
+    } else if (exponent < 0) {
+        *result = (-exponent < MAX_MANTISSA_DIGITS + 1)
+                ? mantissa / powersOfTen[-exponent]
+                : 0;
+    } else {
+        if (exponent > MAX_MANTISSA_DIGITS
+                || mantissa > UINT64_MAX / powersOfTen[exponent]) {
+            return false;
+        }
+        *result = mantissa * powersOfTen[exponent];
+    }
+    return true;
+}
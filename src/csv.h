@@ -0,0 +1,140 @@
+#ifndef CSV_H
+#define CSV_H
+
+#include "common.h"
+#include "trace.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    CSV_StatusOk = 0,       /**< OK */
+    CSV_StatusNullPtr,      /**< Null pointer was passed to API function */
+    CSV_StatusMemError,     /**< Memory allocation error */
+    CSV_StatusSyntaxError,  /**< Malformed data line */
+    CSV_StatusCallbackError /**< Record callback returned an error */
+} CSV_Status;
+
+/**
+ * @brief Incremental parser of logic analyzer SPI exports
+ *
+ * Every data line holds timestamp in seconds, MOSI value in hex and CS level
+ * separated by commas, e.g. "0.000125,0x0C01,0". Values of up to two hex
+ * digits are bytes which are paired MSB first into frames, longer values are
+ * whole 16-bit frames. Frames sent while CS is low form a single record which
+ * is emitted on the rising edge of CS, stamped with the edge timestamp. Lines
+ * in front of the first data line whose timestamp is not a number (headers,
+ * comments) are skipped, afterwards only empty lines are. Timestamps may be
+ * signed, captures triggered mid-stream start before zero, in that case all
+ * timestamps are shifted so the first data line is at zero.
+ */
+typedef struct
+{
+    TRACE_RecordCallback callback; /**< Record consumer */
+    void* context;                 /**< Consumer context */
+    u64 chain;                     /**< Chain id assigned to records */
+    u8* frames;                    /**< Frames of current record, LE pairs */
+    size frameCount;               /**< Frames collected so far */
+    size frameCapacity;            /**< Allocated number of frames */
+    char* partial;                 /**< Line split between two feeds */
+    size partialLength;            /**< Length of the split line */
+    size partialCapacity;          /**< Allocated split line buffer */
+    bool started;                  /**< First data line has been seen */
+    u64 origin;                    /**< Offset added to timestamps [ns] */
+    bool csLow;                    /**< Level of CS on the previous line */
+    bool pendingByte;              /**< High byte of a frame is waiting */
+    u8 highByte;                   /**< Waiting high byte */
+    u64 lines;                     /**< Number of lines processed */
+    u64 droppedBytes;              /**< Unpaired bytes dropped at CS edge */
+    TRACE_Status callbackStatus;   /**< Status returned by failed callback */
+} CSV_Parser;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create parser.
+ *
+ * @param parser   Parser instance to be initialized
+ * @param chain    Chain id assigned to all records
+ * @param callback Record consumer
+ * @param context  User context passed to callback
+ *
+ * @return Instance of CSV_Status. The function possible return values are:
+ * - CSV_StatusNullPtr when null pointer was passed to function
+ * - CSV_StatusOk after success
+ */
+CSV_Status CSV_Create(
+        CSV_Parser* parser,
+        u64 chain,
+        TRACE_RecordCallback callback,
+        void* context);
+
+/**
+ * @brief Release memory owned by the parser.
+ *
+ * @param parser Parser created with CSV_Create
+ */
+void CSV_Destroy(CSV_Parser* parser);
+
+/**
+ * @brief Parse next chunk of the export.
+ *
+ * Chunks can be split at arbitrary positions, complete lines are parsed
+ * directly from the chunk.
+ *
+ * @param parser Pointer to the parser
+ * @param data   Chunk contents
+ * @param length Chunk length
+ *
+ * @return Instance of CSV_Status. The function possible return values are:
+ * - CSV_StatusNullPtr when null pointer was passed to function
+ * - CSV_StatusMemError when there was a memory allocation error
+ * - CSV_StatusSyntaxError when a data line is malformed or goes back before
+ * the first data line
+ * - CSV_StatusCallbackError when the callback failed, see callbackStatus
+ * - CSV_StatusOk after success
+ */
+CSV_Status CSV_Feed(CSV_Parser* parser, const char* data, size length);
+
+/**
+ * @brief Parse the last line if it is not terminated by a newline.
+ *
+ * Frames sent after the last rising edge of CS are not emitted.
+ *
+ * @param parser Pointer to the parser
+ *
+ * @return The same status codes as CSV_Feed
+ */
+CSV_Status CSV_Finish(CSV_Parser* parser);
+
+/**
+ * @brief Parse timestamp in seconds into nanoseconds.
+ *
+ * Non-negative plain decimal and exponent notation are accepted. Integer
+ * arithmetic is used, so no precision is lost for nanosecond resolution
+ * timestamps.
+ *
+ * @param text   Beginning of the number
+ * @param end    End of the field
+ * @param result The buffer in which timestamp [ns] is stored
+ *
+ * @return True if the whole field is a valid number
+ */
+bool CSV_ParseSeconds(const char* text, const char* end, u64* result);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // CSV_H
@@ -0,0 +1,152 @@
+#include "encoder.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Scan limit register value enabling all digits */
+#define SCAN_ALL_DIGITS 0x07
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Set target bits of lit canvas pixels, dark pixels need no work */
+static void Scatter(ENCODER_Instance* encoder, const u64* canvas)
+{
+    const LAYOUT_Map* map = encoder->map;
+    memset(encoder->targets, 0, map->devices * sizeof(u64));
+
+    for (size y = 0; y < map->height; ++y) {
+        const u64* row = canvas + y * map->wordsPerRow;
+        const u32* sources = map->sources + y * map->width;
+
+        for (size w = 0; w < map->wordsPerRow; ++w) {
+            u64 lit = row[w];
+            while (lit != 0) {
+                size x = w * 64 + (size)__builtin_ctzll(lit);
+                lit &= lit - 1;
+                if (x < map->width) {
+                    u32 entry = sources[x];
+                    encoder->targets[entry / 64] |= UINT64_C(1) << (entry % 64);
+                }
+            }
+        }
+    }
+}
+
+/* Collect writes bringing device to target, returns their number */
+static u8 PlanDevice(const MAX7219_Device* device, u64 target, u16* writes)
+{
+    u8 count = 0;
+
+    if (MAX7219_IsDisplayTest(device)) {
+        writes[count++] = MAX7219_FRAME(MAX7219_RegDisplayTest, 0x00);
+    }
+    if (MAX7219_IsShutdown(device)) {
+        writes[count++] = MAX7219_FRAME(MAX7219_RegShutdown, 0x01);
+    }
+    if (device->decodeMode != 0) {
+        writes[count++] = MAX7219_FRAME(MAX7219_RegDecodeMode, 0x00);
+    }
+    if ((device->scanLimit & SCAN_ALL_DIGITS) != SCAN_ALL_DIGITS) {
+        writes[count++] = MAX7219_FRAME(MAX7219_RegScanLimit, SCAN_ALL_DIGITS);
+    }
+
+    for (u8 digit = 0; digit < MAX7219_DIGITS; ++digit) {
+        u8 value = MAX7219_BITBOARD_ROW(target, digit);
+        if (device->digit[digit] != value) {
+            writes[count++] = MAX7219_FRAME(MAX7219_RegDigit0 + digit, value);
+        }
+    }
+    return count;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+ENCODER_Status ENCODER_Create(ENCODER_Instance* encoder, const LAYOUT_Map* map)
+{
+    COMMON_NULLPTR_GUARD(encoder, ENCODER_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(map, ENCODER_StatusNullPtr);
+
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->map = map;
+    encoder->targets = malloc(map->devices * sizeof(u64));
+    encoder->writes = malloc(map->devices * ENCODER_MAX_WRITES * sizeof(u16));
+    encoder->counts = malloc(map->devices);
+
+    if (encoder->targets == NULL || encoder->writes == NULL || encoder->counts == NULL) {
+        ENCODER_Destroy(encoder);
+        return ENCODER_StatusMemError;
+    }
+    return ENCODER_StatusOk;
+}
+
+void ENCODER_Destroy(ENCODER_Instance* encoder)
+{
+    if (encoder == NULL) {
+        return;
+    }
+
+    free(encoder->targets);
+    free(encoder->writes);
+    free(encoder->counts);
+    memset(encoder, 0, sizeof(*encoder));
+}
+
+ENCODER_Status ENCODER_Encode(
+        ENCODER_Instance* encoder,
+        const u64* canvas,
+        const CHAIN_Instance* chain,
+        u16* frames,
+        size capacity,
+        size* count)
+{
+    COMMON_NULLPTR_GUARD(encoder, ENCODER_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(canvas, ENCODER_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(chain, ENCODER_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(count, ENCODER_StatusNullPtr);
+
+    size devices = encoder->map->devices;
+    if (chain->length < devices || chain->shifted != 0) {
+        return ENCODER_StatusWrongSize;
+    }
+
+    Scatter(encoder, canvas);
+
+    size transactions = 0;
+    for (size i = 0; i < devices; ++i) {
+        u8 writes = PlanDevice(&chain->devices[i], encoder->targets[i],
+                encoder->writes + i * ENCODER_MAX_WRITES);
+        encoder->counts[i] = writes;
+        if (writes > transactions) {
+            transactions = writes;
+        }
+    }
+
+    encoder->transactions = transactions;
+    *count = transactions * chain->length;
+    if (*count == 0 || (frames == NULL && capacity == 0)) {
+        return ENCODER_StatusOk;
+    }
+    if (frames == NULL || capacity < *count) {
+        return ENCODER_StatusWrongSize;
+    }
+
+    /* The first frame of a transaction travels to the last device */
+    u16* out = frames;
+    for (size t = 0; t < transactions; ++t) {
+        for (size i = chain->length; i-- > 0;) {
+            bool pending = i < devices && t < encoder->counts[i];
+            *out++ = pending
+                    ? encoder->writes[i * ENCODER_MAX_WRITES + t]
+                    : MAX7219_FRAME(MAX7219_RegNoOp, 0x00);
+        }
+    }
+    return ENCODER_StatusOk;
+}
@@ -0,0 +1,115 @@
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include "common.h"
+#include "chain.h"
+#include "layout.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Most register writes a single device may need: controls and all digits */
+#define ENCODER_MAX_WRITES (4 + MAX7219_DIGITS)
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    ENCODER_StatusOk = 0,   /**< OK */
+    ENCODER_StatusNullPtr,  /**< Null pointer was passed to API function */
+    ENCODER_StatusMemError, /**< Memory allocation error */
+    ENCODER_StatusWrongSize /**< Chain shorter than layout or not latched, or
+                                 buffer too small */
+} ENCODER_Status;
+
+/**
+ * @brief Encoder of a canvas into SPI frames for a chain
+ *
+ * Target bitboards are scattered from the canvas through the layout lookup
+ * table and compared with the register files of the chain. Every device gets
+ * the list of writes it needs: control registers which would hide the image
+ * (display test, shutdown, decode mode, scan limit) first, then changed digit
+ * registers. Transaction N carries the N-th write of every device and no-ops
+ * for devices with fewer writes, so the number of transactions equals the
+ * longest list, which is the minimum for a chain latched as a whole.
+ */
+typedef struct
+{
+    const LAYOUT_Map* map;  /**< Layout of the canvas */
+    u64* targets;           /**< Requested bitboard per device */
+    u16* writes;            /**< ENCODER_MAX_WRITES frames per device */
+    u8* counts;             /**< Number of writes per device */
+    size transactions;      /**< Transactions produced by the last encoding */
+} ENCODER_Instance;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create encoder for canvases of given layout.
+ *
+ * The layout must outlive the encoder.
+ *
+ * @param encoder Encoder instance to be initialized
+ * @param map     Layout of the canvas
+ *
+ * @return Instance of ENCODER_Status. The function possible return values are:
+ * - ENCODER_StatusNullPtr when null pointer was passed to function
+ * - ENCODER_StatusMemError when there was a memory allocation error
+ * - ENCODER_StatusOk after success
+ */
+ENCODER_Status ENCODER_Create(ENCODER_Instance* encoder, const LAYOUT_Map* map);
+
+/**
+ * @brief Release memory owned by the encoder.
+ *
+ * @param encoder Encoder created with ENCODER_Create
+ */
+void ENCODER_Destroy(ENCODER_Instance* encoder);
+
+/**
+ * @brief Produce frames turning current chain state into the canvas.
+ *
+ * Frames are in bus order, every chain->length frames form one transaction
+ * to be latched, e.g. with CHAIN_Feed. Devices of the chain beyond the layout
+ * receive only no-ops. Pass NULL frames with capacity 0 to query the number
+ * of frames. Frames shifted in without a latch would end up in the wrong
+ * devices, so the chain has to be latched (shifted equal to zero).
+ *
+ * @param encoder  Pointer to the encoder
+ * @param canvas   Canvas of LAYOUT_CanvasWords words
+ * @param chain    Chain whose register files are the starting point
+ * @param frames   Buffer to store frames (can be NULL if capacity is 0)
+ * @param capacity Size of frames buffer
+ * @param count    The buffer in which the number of needed frames is stored
+ *
+ * @return Instance of ENCODER_Status. The function possible return values are:
+ * - ENCODER_StatusNullPtr when null pointer was passed to function
+ * - ENCODER_StatusWrongSize when the chain is shorter than the layout or not
+ * latched, or the buffer cannot hold all frames, nothing is written then
+ * - ENCODER_StatusOk after success or a query
+ */
+ENCODER_Status ENCODER_Encode(
+        ENCODER_Instance* encoder,
+        const u64* canvas,
+        const CHAIN_Instance* chain,
+        u16* frames,
+        size capacity,
+        size* count);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // ENCODER_H
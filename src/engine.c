@@ -0,0 +1,493 @@
+#include "engine.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Outcome of processing single slice of a job */
+typedef enum
+{
+    SliceDone,    /* Job is finished */
+    SlicePending, /* Job has more work */
+    SliceIdle     /* Queue job found no frames and waits for its producer */
+} Slice;
+
+/* Per-thread worker state */
+typedef struct
+{
+    ENGINE_Instance* engine;
+    size index;
+    u32 seed;
+} Worker;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Round up to the nearest power of two */
+static size NextPowerOfTwo(size value)
+{
+    size power = 1;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+/* Cheap per-worker pseudo random generator used to pick victims */
+static inline u32 NextRandom(u32* seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+/* Allocate deque buffer able to hold capacity tasks */
+static bool DequeInit(ENGINE_Deque* deque, size capacity)
+{
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    deque->mask = capacity - 1;
+    deque->tasks = calloc(capacity, sizeof(*deque->tasks));
+    return deque->tasks != NULL;
+}
+
+/* Push task to the bottom, only owner is allowed to call it */
+static void DequePush(ENGINE_Deque* deque, size task)
+{
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    atomic_store_explicit(&deque->tasks[bottom & deque->mask], task,
+            memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+}
+
+/* Take task from the bottom, only owner is allowed to call it */
+static bool DequeTake(ENGINE_Deque* deque, size* task)
+{
+    long long bottom =
+            atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return false;
+    }
+
+    *task = atomic_load_explicit(&deque->tasks[bottom & deque->mask],
+            memory_order_relaxed);
+    if (top < bottom) {
+        return true;
+    }
+
+    /* Last task, race against thieves */
+    bool won = atomic_compare_exchange_strong_explicit(&deque->top, &top,
+            top + 1, memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return won;
+}
+
+/* Steal task from the top, any thread is allowed to call it */
+static bool DequeSteal(ENGINE_Deque* deque, size* task)
+{
+    long long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+
+    if (top >= bottom) {
+        return false;
+    }
+
+    *task = atomic_load_explicit(&deque->tasks[top & deque->mask],
+            memory_order_relaxed);
+    return atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+            memory_order_seq_cst, memory_order_relaxed);
+}
+
+/* Try to steal from every other worker, starting at random victim */
+static bool StealAny(Worker* worker, size* task)
+{
+    ENGINE_Instance* engine = worker->engine;
+    size first = NextRandom(&worker->seed) % engine->workers;
+
+    for (size i = 0; i < engine->workers; ++i) {
+        size victim = (first + i) % engine->workers;
+        if (victim != worker->index
+                && DequeSteal(&engine->deques[victim], task)) {
+            atomic_fetch_add_explicit(&engine->steals, 1, memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Append visible change to the log */
+static void LogAppend(ENGINE_Log* log, ENGINE_Output output)
+{
+    if (log->count == log->capacity) {
+        size capacity = (log->capacity == 0) ? 64 : 2 * log->capacity;
+        ENGINE_Output* grown =
+                realloc(log->outputs, capacity * sizeof(*grown));
+        if (grown == NULL) {
+            log->failed = true;
+            return;
+        }
+        log->outputs = grown;
+        log->capacity = capacity;
+    }
+    log->outputs[log->count++] = output;
+}
+
+/* Feed frames latch by latch recording every visible change */
+static void FeedRecorded(ENGINE_Log* log, size task, CHAIN_Instance* chain,
+        const u16* frames, size count)
+{
+    while (count > 0) {
+        size needed = (chain->shifted < chain->length)
+                ? chain->length - chain->shifted
+                : 1;
+        size batch = (count < needed) ? count : needed;
+
+        CHAIN_Feed(chain, frames, batch);
+        frames += batch;
+        count -= batch;
+
+        if (batch == needed && CHAIN_Render(chain) > 0) {
+            for (size i = 0; i < chain->length; ++i) {
+                if (chain->changedTick[i] == chain->tick) {
+                    LogAppend(log, (ENGINE_Output){
+                        .tick = chain->tick,
+                        .job = task,
+                        .device = i,
+                        .bitboard = chain->framebuffer[i]
+                    });
+                }
+            }
+        }
+    }
+}
+
+/* Process frames available in the job queue */
+static Slice ProcessQueued(ENGINE_Instance* engine, size task, ENGINE_Job* job)
+{
+    const u16* frames;
+    size slice = QUEUE_Peek(job->queue, &frames, ENGINE_SLICE_FRAMES);
+    if (slice == 0) {
+        if (QUEUE_IsDrained(job->queue)) {
+            CHAIN_Render(job->chain);
+            return SliceDone;
+        }
+        sched_yield();
+        return SliceIdle;
+    }
+
+    if (engine->logs != NULL) {
+        FeedRecorded(&engine->logs[task], task, job->chain, frames, slice);
+    } else {
+        CHAIN_Feed(job->chain, frames, slice);
+    }
+    QUEUE_Advance(job->queue, slice);
+    job->position += slice;
+    return SlicePending;
+}
+
+/* Process single slice of a job */
+static Slice ProcessSlice(ENGINE_Instance* engine, size task)
+{
+    ENGINE_Job* job = &engine->jobs[task];
+    if (job->task != NULL) {
+        job->task(job->context);
+        return SliceDone;
+    }
+    if (job->queue != NULL) {
+        return ProcessQueued(engine, task, job);
+    }
+
+    size remaining = job->count - job->position;
+    size slice = (remaining < ENGINE_SLICE_FRAMES)
+            ? remaining
+            : ENGINE_SLICE_FRAMES;
+
+    if (engine->logs != NULL) {
+        FeedRecorded(&engine->logs[task], task, job->chain,
+                &job->frames[job->position], slice);
+    } else {
+        CHAIN_Feed(job->chain, &job->frames[job->position], slice);
+    }
+    job->position += slice;
+
+    if (job->position < job->count) {
+        return SlicePending;
+    }
+
+    CHAIN_Render(job->chain);
+    return SliceDone;
+}
+
+/* Merge ordering of recorded changes */
+static inline bool OutputBefore(const ENGINE_Output* a, const ENGINE_Output* b)
+{
+    if (a->tick != b->tick) {
+        return a->tick < b->tick;
+    }
+    if (a->job != b->job) {
+        return a->job < b->job;
+    }
+    return a->device < b->device;
+}
+
+/* Restore heap property of job cursors starting from given node */
+static void SiftDown(const ENGINE_Log* logs, size* cursors, size* heap,
+        size heapSize, size index)
+{
+    for (;;) {
+        size smallest = index;
+        for (size child = 2 * index + 1;
+                child <= 2 * index + 2 && child < heapSize; ++child) {
+            if (OutputBefore(&logs[heap[child]].outputs[cursors[heap[child]]],
+                    &logs[heap[smallest]].outputs[cursors[heap[smallest]]])) {
+                smallest = child;
+            }
+        }
+        if (smallest == index) {
+            return;
+        }
+        size swap = heap[index];
+        heap[index] = heap[smallest];
+        heap[smallest] = swap;
+        index = smallest;
+    }
+}
+
+/* K-way merge of per-job logs, every log is already sorted */
+static ENGINE_Status MergeLogs(const ENGINE_Log* logs, size count,
+        ENGINE_Output** outputs, size* outputCount)
+{
+    size total = 0;
+    for (size i = 0; i < count; ++i) {
+        total += logs[i].count;
+    }
+
+    ENGINE_Output* merged = malloc((total > 0 ? total : 1) * sizeof(*merged));
+    size* cursors = calloc(count > 0 ? count : 1, sizeof(*cursors));
+    size* heap = malloc((count > 0 ? count : 1) * sizeof(*heap));
+    if (merged == NULL || cursors == NULL || heap == NULL) {
+        free(merged);
+        free(cursors);
+        free(heap);
+        return ENGINE_StatusMemError;
+    }
+
+    size heapSize = 0;
+    for (size i = 0; i < count; ++i) {
+        if (logs[i].count > 0) {
+            heap[heapSize++] = i;
+        }
+    }
+    for (size i = heapSize; i-- > 0;) {
+        SiftDown(logs, cursors, heap, heapSize, i);
+    }
+
+    for (size i = 0; i < total; ++i) {
+        size job = heap[0];
+        merged[i] = logs[job].outputs[cursors[job]++];
+        if (cursors[job] == logs[job].count) {
+            heap[0] = heap[--heapSize];
+        }
+        SiftDown(logs, cursors, heap, heapSize, 0);
+    }
+
+    free(cursors);
+    free(heap);
+    *outputs = merged;
+    *outputCount = total;
+    return ENGINE_StatusOk;
+}
+
+/* Worker thread entry point */
+static void* WorkerMain(void* argument)
+{
+    Worker* worker = argument;
+    ENGINE_Instance* engine = worker->engine;
+    ENGINE_Deque* own = &engine->deques[worker->index];
+    bool rotate = false;
+
+    for (;;) {
+        /* An idle queue job goes to the back of the line, otherwise the owner
+         * would keep taking it and starve the chain its producer waits for */
+        size task;
+        bool taken = (rotate && DequeSteal(own, &task)) || DequeTake(own, &task);
+        if (taken || StealAny(worker, &task)) {
+            Slice slice = ProcessSlice(engine, task);
+            rotate = slice == SliceIdle;
+            if (slice == SliceDone) {
+                atomic_fetch_sub_explicit(&engine->pending, 1,
+                        memory_order_acq_rel);
+            } else {
+                DequePush(own, task);
+            }
+            continue;
+        }
+
+        if (atomic_load_explicit(&engine->pending, memory_order_acquire) == 0) {
+            break;
+        }
+        sched_yield();
+    }
+
+    return NULL;
+}
+
+/* Release deques of the current run */
+static void FreeDeques(ENGINE_Instance* engine)
+{
+    for (size i = 0; i < engine->workers; ++i) {
+        free(engine->deques[i].tasks);
+    }
+    free(engine->deques);
+    engine->deques = NULL;
+}
+
+/* Distribute jobs over workers and block until all of them are done */
+static ENGINE_Status RunJobs(ENGINE_Instance* engine, ENGINE_Job* jobs,
+        size count)
+{
+    /* Deques are cache line aligned to keep owners and thieves apart */
+    engine->deques = aligned_alloc(_Alignof(ENGINE_Deque),
+            engine->workers * sizeof(*engine->deques));
+    Worker* workers = calloc(engine->workers, sizeof(*workers));
+    pthread_t* threads = calloc(engine->workers, sizeof(*threads));
+    bool* started = calloc(engine->workers, sizeof(*started));
+    bool allocated = engine->deques != NULL
+            && workers != NULL
+            && threads != NULL
+            && started != NULL;
+
+    size capacity = NextPowerOfTwo(count);
+    if (engine->deques != NULL) {
+        memset(engine->deques, 0, engine->workers * sizeof(*engine->deques));
+    }
+    for (size i = 0; allocated && i < engine->workers; ++i) {
+        allocated = DequeInit(&engine->deques[i], capacity);
+    }
+
+    if (!allocated) {
+        if (engine->deques != NULL) {
+            FreeDeques(engine);
+        }
+        free(workers);
+        free(threads);
+        free(started);
+        return ENGINE_StatusMemError;
+    }
+
+    engine->jobs = jobs;
+    atomic_store(&engine->pending, count);
+    atomic_store(&engine->steals, 0);
+
+    /* Deal jobs round-robin before any worker runs */
+    for (size i = 0; i < count; ++i) {
+        DequePush(&engine->deques[i % engine->workers], i);
+    }
+
+    for (size i = 0; i < engine->workers; ++i) {
+        workers[i] = (Worker){
+            .engine = engine,
+            .index = i,
+            .seed = (u32)(2 * i + 1) * 2654435761u
+        };
+    }
+    for (size i = 1; i < engine->workers; ++i) {
+        started[i] = pthread_create(&threads[i], NULL, WorkerMain,
+                &workers[i]) == 0;
+    }
+
+    WorkerMain(&workers[0]);
+
+    for (size i = 1; i < engine->workers; ++i) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    FreeDeques(engine);
+    engine->jobs = NULL;
+    free(workers);
+    free(threads);
+    free(started);
+
+    return ENGINE_StatusOk;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+ENGINE_Status ENGINE_Create(ENGINE_Instance* engine, size workers)
+{
+    COMMON_NULLPTR_GUARD(engine, ENGINE_StatusNullPtr);
+
+    if (workers == ENGINE_WORKERS_AUTO) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = (online > 0) ? (size)online : 1;
+    }
+
+    memset(engine, 0, sizeof(*engine));
+    engine->workers = workers;
+    atomic_init(&engine->pending, 0);
+    atomic_init(&engine->steals, 0);
+
+    return ENGINE_StatusOk;
+}
+
+ENGINE_Status ENGINE_Run(ENGINE_Instance* engine, ENGINE_Job* jobs, size count)
+{
+    COMMON_NULLPTR_GUARD(engine, ENGINE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(jobs, ENGINE_StatusNullPtr);
+
+    return RunJobs(engine, jobs, count);
+}
+
+ENGINE_Status ENGINE_RunDeterministic(
+        ENGINE_Instance* engine,
+        ENGINE_Job* jobs,
+        size count,
+        ENGINE_Output** outputs,
+        size* outputCount)
+{
+    COMMON_NULLPTR_GUARD(engine, ENGINE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(jobs, ENGINE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(outputs, ENGINE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(outputCount, ENGINE_StatusNullPtr);
+
+    engine->logs = calloc(count > 0 ? count : 1, sizeof(*engine->logs));
+    COMMON_NULLPTR_GUARD(engine->logs, ENGINE_StatusMemError);
+
+    ENGINE_Status status = RunJobs(engine, jobs, count);
+
+    for (size i = 0; status == ENGINE_StatusOk && i < count; ++i) {
+        if (engine->logs[i].failed) {
+            status = ENGINE_StatusMemError;
+        }
+    }
+    if (status == ENGINE_StatusOk) {
+        status = MergeLogs(engine->logs, count, outputs, outputCount);
+    }
+
+    for (size i = 0; i < count; ++i) {
+        free(engine->logs[i].outputs);
+    }
+    free(engine->logs);
+    engine->logs = NULL;
+
+    return status;
+}
@@ -0,0 +1,184 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "common.h"
+#include "chain.h"
+#include "queue.h"
+
+#include <stdatomic.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Number of frames processed before a job becomes stealable again */
+#define ENGINE_SLICE_FRAMES 4096
+
+/* Worker count which selects number of online processors */
+#define ENGINE_WORKERS_AUTO 0
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    ENGINE_StatusOk = 0,  /**< OK */
+    ENGINE_StatusNullPtr, /**< Null pointer was passed to API function */
+    ENGINE_StatusMemError /**< Memory allocation error */
+} ENGINE_Status;
+
+/**
+ * @brief Opaque unit of work run by ENGINE_Run in one piece
+ */
+typedef void (*ENGINE_TaskFn)(void* context);
+
+/**
+ * @brief Work for a single chain: stream of full-chain transactions
+ *
+ * A job with task set runs the task once instead of feeding frames, which
+ * lets coarse work such as whole batch scenarios share the worker pool. A job
+ * with queue set consumes frames pushed by a producer thread instead of the
+ * frames array and finishes once the queue is closed and drained.
+ */
+typedef struct
+{
+    CHAIN_Instance* chain; /**< Chain to be driven */
+    const u16* frames;     /**< Frames as fed to CHAIN_Feed */
+    size count;            /**< Number of frames */
+    size position;         /**< Number of frames already processed */
+    QUEUE_Instance* queue; /**< Queue read instead of frames, or NULL */
+    ENGINE_TaskFn task;    /**< Task run instead of feeding frames, or NULL */
+    void* context;         /**< User context passed to task */
+} ENGINE_Job;
+
+/**
+ * @brief Visible change of a device recorded in deterministic mode
+ */
+typedef struct
+{
+    u64 tick;     /**< Chain tick at which the change happened */
+    size job;     /**< Index of the job driving the chain */
+    size device;  /**< Device index in the chain */
+    u64 bitboard; /**< New visible output of the device */
+} ENGINE_Output;
+
+/**
+ * @brief Growable per-job output log
+ */
+typedef struct
+{
+    ENGINE_Output* outputs; /**< Recorded changes in tick order */
+    size count;             /**< Number of recorded changes */
+    size capacity;          /**< Allocated number of entries */
+    bool failed;            /**< Memory allocation error occurred */
+} ENGINE_Log;
+
+/**
+ * @brief Chase-Lev work-stealing deque of job indices
+ */
+typedef struct
+{
+    _Alignas(64) atomic_llong top;    /**< Steal end, shared by thieves */
+    _Alignas(64) atomic_llong bottom; /**< Owner end */
+    atomic_size_t* tasks;             /**< Circular task buffer */
+    size mask;                        /**< Buffer capacity minus one */
+} ENGINE_Deque;
+
+/**
+ * @brief Worker pool sharding independent chains across cores
+ */
+typedef struct
+{
+    size workers;          /**< Number of worker threads */
+    ENGINE_Deque* deques;  /**< One deque per worker (valid during run) */
+    ENGINE_Job* jobs;      /**< Jobs of the current run */
+    ENGINE_Log* logs;      /**< Per-job logs, deterministic mode only */
+    atomic_size_t pending; /**< Jobs not finished yet */
+    atomic_ullong steals;  /**< Successful steals during the last run */
+} ENGINE_Instance;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create engine.
+ *
+ * @param engine  Engine instance to be initialized
+ * @param workers Number of workers or ENGINE_WORKERS_AUTO
+ *
+ * @return Instance of ENGINE_Status. The function possible return values are:
+ * - ENGINE_StatusNullPtr when null pointer was passed to function
+ * - ENGINE_StatusOk after success
+ */
+ENGINE_Status ENGINE_Create(ENGINE_Instance* engine, size workers);
+
+/**
+ * @brief Process jobs in parallel and block until all of them are done.
+ *
+ * Jobs are initially distributed round-robin. Every worker processes jobs from
+ * the bottom of its own deque in slices of ENGINE_SLICE_FRAMES frames, pushing
+ * an unfinished job back after each slice. Idle workers steal jobs from the
+ * top of other deques, so a single heavy chain only keeps one worker busy.
+ * Every chain is rendered once its job is done. A chain must not appear in
+ * more than one job. Task jobs are never split, a worker owning one runs it
+ * to completion while the others keep stealing. Jobs dealt last to a worker
+ * run first on it. A queue job whose queue is momentarily empty yields the
+ * processor and its worker next takes the oldest job of its deque, so waiting
+ * for one producer never starves the other chains of that worker.
+ *
+ * The calling thread takes part in the work as worker 0. If some worker
+ * threads cannot be started, the remaining ones steal their jobs.
+ *
+ * @param engine Pointer to the engine
+ * @param jobs   Jobs to be processed, position fields are updated
+ * @param count  Number of jobs
+ *
+ * @return Instance of ENGINE_Status. The function possible return values are:
+ * - ENGINE_StatusNullPtr when null pointer was passed to function
+ * - ENGINE_StatusMemError when there was a memory allocation error
+ * - ENGINE_StatusOk after success
+ */
+ENGINE_Status ENGINE_Run(ENGINE_Instance* engine, ENGINE_Job* jobs, size count);
+
+/**
+ * @brief Process jobs in parallel and merge their outputs in a stable order.
+ *
+ * Every chain is rendered after each latch and its visible changes are
+ * recorded in a private log, so no synchronization is needed between workers.
+ * Once all jobs are done the logs are merged by (tick, job, device), which
+ * makes the result bit-identical regardless of number of workers and of the
+ * way jobs were stolen. Task jobs are run but leave nothing in the log.
+ *
+ * @param engine      Pointer to the engine
+ * @param jobs        Jobs to be processed, position fields are updated
+ * @param count       Number of jobs
+ * @param outputs     The buffer in which merged changes are stored. It has to
+ * be released with free()
+ * @param outputCount The buffer in which number of merged changes is stored
+ *
+ * @return Instance of ENGINE_Status. The function possible return values are:
+ * - ENGINE_StatusNullPtr when null pointer was passed to function
+ * - ENGINE_StatusMemError when there was a memory allocation error
+ * - ENGINE_StatusOk after success
+ */
+ENGINE_Status ENGINE_RunDeterministic(
+        ENGINE_Instance* engine,
+        ENGINE_Job* jobs,
+        size count,
+        ENGINE_Output** outputs,
+        size* outputCount);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // ENGINE_H
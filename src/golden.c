@@ -0,0 +1,101 @@
+#include "golden.h"
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Count set bits without relying on a popcount instruction being enabled */
+static inline u64 PopCount(u64 value)
+{
+    value -= (value >> 1) & UINT64_C(0x5555555555555555);
+    value = (value & UINT64_C(0x3333333333333333))
+            + ((value >> 2) & UINT64_C(0x3333333333333333));
+    value = (value + (value >> 4)) & UINT64_C(0x0F0F0F0F0F0F0F0F);
+    return (value * UINT64_C(0x0101010101010101)) >> 56;
+}
+
+/* Count differing bits of two bitboard arrays, the loop vectorizes */
+static u64 CountDifferences(const u64* actual, const u64* expected, size count)
+{
+    u64 differences = 0;
+    for (size i = 0; i < count; ++i) {
+        differences += PopCount(actual[i] ^ expected[i]);
+    }
+    return differences;
+}
+
+/* Record position of the first differing LED of a frame */
+static void LocateFirst(const u64* actual, const u64* expected, size devices,
+        size frame, GOLDEN_Result* result)
+{
+    for (size i = 0; i < devices; ++i) {
+        u64 difference = actual[i] ^ expected[i];
+        if (difference != 0) {
+            u8 bit = (u8)__builtin_ctzll(difference);
+            result->firstFrame = frame;
+            result->firstDevice = i;
+            result->firstDigit = bit / 8;
+            result->firstBit = bit % 8;
+            return;
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+GOLDEN_Status GOLDEN_Compare(
+        const u64* actual,
+        const u64* expected,
+        size frames,
+        size devices,
+        GOLDEN_Result* result)
+{
+    COMMON_NULLPTR_GUARD(actual, GOLDEN_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(expected, GOLDEN_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(result, GOLDEN_StatusNullPtr);
+
+    if (devices == 0) {
+        return GOLDEN_StatusWrongSize;
+    }
+
+    *result = (GOLDEN_Result){
+        .differingLeds = 0,
+        .differingFrames = 0,
+        .firstFrame = GOLDEN_NO_DIFF,
+        .firstDevice = GOLDEN_NO_DIFF,
+        .firstDigit = 0,
+        .firstBit = 0
+    };
+
+    for (size frame = 0; frame < frames; ++frame) {
+        u64 differences = CountDifferences(actual, expected, devices);
+        if (differences != 0) {
+            if (result->differingFrames == 0) {
+                LocateFirst(actual, expected, devices, frame, result);
+            }
+            result->differingLeds += differences;
+            ++result->differingFrames;
+        }
+        actual += devices;
+        expected += devices;
+    }
+    return GOLDEN_StatusOk;
+}
+
+GOLDEN_Status GOLDEN_CompareChain(
+        CHAIN_Instance* chain,
+        const u64* expected,
+        size devices,
+        GOLDEN_Result* result)
+{
+    COMMON_NULLPTR_GUARD(chain, GOLDEN_StatusNullPtr);
+
+    if (devices != chain->length) {
+        return GOLDEN_StatusWrongSize;
+    }
+
+    CHAIN_Render(chain);
+    return GOLDEN_Compare(chain->framebuffer, expected, 1, devices, result);
+}
@@ -0,0 +1,100 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include "common.h"
+#include "chain.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Location fields value when outputs are identical */
+#define GOLDEN_NO_DIFF SIZE_MAX
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    GOLDEN_StatusOk = 0,     /**< OK */
+    GOLDEN_StatusNullPtr,    /**< Null pointer was passed to API function */
+    GOLDEN_StatusWrongSize   /**< Zero devices per frame or length mismatch */
+} GOLDEN_Status;
+
+/**
+ * @brief Outcome of comparing emulated output with golden data
+ */
+typedef struct
+{
+    u64 differingLeds;      /**< LEDs in a different state, all frames */
+    size differingFrames;   /**< Frames with at least one different LED */
+    size firstFrame;        /**< First differing frame or GOLDEN_NO_DIFF */
+    size firstDevice;       /**< Device within that frame or GOLDEN_NO_DIFF */
+    u8 firstDigit;          /**< Digit row of the first differing LED */
+    u8 firstBit;            /**< Segment/column bit of that LED, D7 = 7 */
+} GOLDEN_Result;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Compare a sequence of frames with golden data.
+ *
+ * Each frame consists of one bitboard per device, frames are stored one
+ * after another. Bitboards are XORed and the differences popcounted, the
+ * first difference is located only once, so identical data streams through
+ * at memory speed.
+ *
+ * @param actual   Emulated output
+ * @param expected Golden data of the same shape
+ * @param frames   Number of frames
+ * @param devices  Bitboards per frame
+ * @param result   The buffer in which the outcome is stored
+ *
+ * @return Instance of GOLDEN_Status. The function possible return values are:
+ * - GOLDEN_StatusNullPtr when null pointer was passed to function
+ * - GOLDEN_StatusWrongSize when devices is zero
+ * - GOLDEN_StatusOk after success, also when the data differs
+ */
+GOLDEN_Status GOLDEN_Compare(
+        const u64* actual,
+        const u64* expected,
+        size frames,
+        size devices,
+        GOLDEN_Result* result);
+
+/**
+ * @brief Compare current output of a chain with a golden frame.
+ *
+ * Pending register changes are rendered first.
+ *
+ * @param chain    Pointer to the chain
+ * @param expected One bitboard per device
+ * @param devices  Number of golden bitboards, must match the chain length
+ * @param result   The buffer in which the outcome is stored
+ *
+ * @return Instance of GOLDEN_Status. The function possible return values are:
+ * - GOLDEN_StatusNullPtr when null pointer was passed to function
+ * - GOLDEN_StatusWrongSize when devices differs from the chain length
+ * - GOLDEN_StatusOk after success, also when the output differs
+ */
+GOLDEN_Status GOLDEN_CompareChain(
+        CHAIN_Instance* chain,
+        const u64* expected,
+        size devices,
+        GOLDEN_Result* result);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // GOLDEN_H
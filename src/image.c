@@ -0,0 +1,545 @@
+#include "image.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* LED colours, the background stays black */
+#define LIT_RED     255
+#define LIT_GREEN   40
+#define LIT_BLUE    24
+#define UNLIT_RED   56
+#define UNLIT_GREEN 10
+#define UNLIT_BLUE  8
+
+/* LED radius relative to its cell and subsamples per pixel axis */
+#define LED_RADIUS 0.42
+#define SUBSAMPLES 4
+
+/* PNG building blocks */
+#define PNG_SIGNATURE "\x89PNG\r\n\x1a\n"
+#define PNG_SIGNATURE_SIZE 8
+#define PNG_CHUNK_OVERHEAD 12
+#define PNG_IHDR_SIZE 13
+#define PNG_COLOR_RGB 2
+#define PNG_FILTER_NONE 0
+
+/* zlib stream made of stored deflate blocks */
+#define ZLIB_HEADER_SIZE 2
+#define ZLIB_ADLER_SIZE 4
+#define ZLIB_ADLER_MOD 65521
+#define DEFLATE_STORED_MAX 65535
+#define DEFLATE_STORED_HEADER 5
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Stored deflate stream being assembled together with its checksums */
+typedef struct
+{
+    u8* out;        /* Next free byte of the encoding buffer */
+    size remaining; /* Raw bytes not yet written */
+    size block;     /* Raw bytes left in the current stored block */
+    u32 adlerA;     /* Adler-32 running sums */
+    u32 adlerB;
+} Deflate;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Get pixel row length in bytes */
+static inline size StrideOf(const IMAGE_Raster* raster)
+{
+    return (size)raster->width * IMAGE_CHANNELS;
+}
+
+/* Get sprite of lit or unlit LED */
+static inline const u8* SpriteOf(const IMAGE_Raster* raster, bool lit)
+{
+    size bytes = raster->ledSize * raster->ledSize * IMAGE_CHANNELS;
+    return raster->sprites + (lit ? bytes : 0);
+}
+
+/* Draw anti-aliased round LEDs once, rasterization only copies them */
+static void BuildSprites(IMAGE_Raster* raster)
+{
+    static const u8 colors[2][IMAGE_CHANNELS] = {
+        {UNLIT_RED, UNLIT_GREEN, UNLIT_BLUE},
+        {LIT_RED, LIT_GREEN, LIT_BLUE}
+    };
+
+    double center = (double)raster->ledSize / 2.0;
+    double radius = (double)raster->ledSize * LED_RADIUS;
+    u8* sprite = raster->sprites;
+
+    for (int lit = 0; lit < 2; ++lit) {
+        for (size y = 0; y < raster->ledSize; ++y) {
+            for (size x = 0; x < raster->ledSize; ++x) {
+                u32 inside = 0;
+                for (u32 sy = 0; sy < SUBSAMPLES; ++sy) {
+                    for (u32 sx = 0; sx < SUBSAMPLES; ++sx) {
+                        double dx = (double)x + (sx + 0.5) / SUBSAMPLES - center;
+                        double dy = (double)y + (sy + 0.5) / SUBSAMPLES - center;
+                        inside += (dx * dx + dy * dy <= radius * radius);
+                    }
+                }
+
+                /* Tiny LEDs would vanish, they fill the whole cell instead */
+                if (raster->ledSize < 3) {
+                    inside = SUBSAMPLES * SUBSAMPLES;
+                }
+                for (u32 c = 0; c < IMAGE_CHANNELS; ++c) {
+                    *sprite++ = (u8)(colors[lit][c] * inside
+                            / (SUBSAMPLES * SUBSAMPLES));
+                }
+            }
+        }
+    }
+}
+
+/* Build module grid of every chain and stack the chains */
+static IMAGE_Status Layout(IMAGE_Raster* raster, size perRow)
+{
+    size side = LAYOUT_MODULE_SIZE * raster->ledSize;
+    size width = 0;
+    size top = 0;
+
+    for (size c = 0; c < raster->count; ++c) {
+        IMAGE_Area* area = &raster->areas[c];
+        LAYOUT_Descriptor descriptor = LAYOUT_Wrapped(raster->chains[c].length, perRow);
+        LAYOUT_Status status = LAYOUT_Create(&area->map, &descriptor);
+        if (status != LAYOUT_StatusOk) {
+            return (status == LAYOUT_StatusMemError)
+                    ? IMAGE_StatusMemError
+                    : IMAGE_StatusWrongSize;
+        }
+
+        area->canvas = calloc(LAYOUT_CanvasWords(&area->map), sizeof(u64));
+        if (area->canvas == NULL) {
+            return IMAGE_StatusMemError;
+        }
+        area->top = (u32)top;
+
+        if (area->map.width * raster->ledSize > width) {
+            width = area->map.width * raster->ledSize;
+        }
+
+        /* Chains are separated by one row of LEDs */
+        top += descriptor.rows * side + raster->ledSize;
+    }
+
+    raster->width = (u32)width;
+    raster->height = (u32)(top - raster->ledSize);
+    return IMAGE_StatusOk;
+}
+
+/* Copy sprite lines of LEDs selected by mask into a matrix row, bit 0 leftmost */
+static void BlitRow(IMAGE_Raster* raster, u8* origin, u8 leds, u8 mask)
+{
+    size stride = StrideOf(raster);
+    size line = raster->ledSize * IMAGE_CHANNELS;
+
+    for (u32 x = 0; x < LAYOUT_MODULE_SIZE; ++x) {
+        if ((mask & (1u << x)) == 0) {
+            continue;
+        }
+
+        const u8* sprite = SpriteOf(raster, (leds >> x) & 1);
+        u8* target = origin + x * line;
+        for (size y = 0; y < raster->ledSize; ++y) {
+            memcpy(target + y * stride, sprite + y * line, line);
+        }
+    }
+}
+
+/* Redraw changed pixel rows of a single module, returns true if any changed */
+static bool DrawModule(IMAGE_Raster* raster, const IMAGE_Area* area,
+        size column, size row, bool everything)
+{
+    size stride = StrideOf(raster);
+    size side = LAYOUT_MODULE_SIZE * raster->ledSize;
+    u8* origin = raster->pixels
+            + (size)area->top * stride
+            + column * side * IMAGE_CHANNELS;
+    bool redrawn = false;
+
+    for (size y = row * LAYOUT_MODULE_SIZE; y < (row + 1) * LAYOUT_MODULE_SIZE; ++y) {
+        u8 now = LAYOUT_ModuleRow(&area->map, raster->canvas, column, y);
+        u8 changed = everything
+                ? 0xFF
+                : now ^ LAYOUT_ModuleRow(&area->map, area->canvas, column, y);
+        if (changed != 0) {
+            BlitRow(raster, origin + y * raster->ledSize * stride, now, changed);
+            redrawn = true;
+        }
+    }
+    return redrawn;
+}
+
+/* Gather chain into the canvas and redraw changed modules, returns their count */
+static size DrawChain(IMAGE_Raster* raster, IMAGE_Area* area,
+        const CHAIN_Instance* chain, bool everything)
+{
+    const LAYOUT_Map* map = &area->map;
+    const u64* bitboards = chain->framebuffer;
+    if (chain->length < map->devices) {
+        memcpy(raster->bitboards, chain->framebuffer, chain->length * sizeof(u64));
+        memset(&raster->bitboards[chain->length], 0,
+                (map->devices - chain->length) * sizeof(u64));
+        bitboards = raster->bitboards;
+    }
+    LAYOUT_Gather(map, bitboards, map->devices, raster->canvas);
+
+    size words = LAYOUT_CanvasWords(map);
+    if (!everything && memcmp(raster->canvas, area->canvas, words * sizeof(u64)) == 0) {
+        return 0;
+    }
+
+    size redrawn = 0;
+    for (size row = 0; row < map->descriptor.rows; ++row) {
+        for (size column = 0; column < map->descriptor.columns; ++column) {
+            /* Cells of a partial last row stay background */
+            if (LAYOUT_DeviceAt(map, column, row) < chain->length
+                    && DrawModule(raster, area, column, row, everything)) {
+                ++redrawn;
+            }
+        }
+    }
+
+    memcpy(area->canvas, raster->canvas, words * sizeof(u64));
+    return redrawn;
+}
+
+/* Fill slice-by-8 CRC-32 tables (reflected polynomial 0xEDB88320) */
+static void BuildCrcTable(u32 table[8][256])
+{
+    for (u32 n = 0; n < 256; ++n) {
+        u32 crc = n;
+        for (int k = 0; k < 8; ++k) {
+            crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+        }
+        table[0][n] = crc;
+    }
+
+    /* Table k advances CRC of a byte followed by k zero bytes */
+    for (u32 n = 0; n < 256; ++n) {
+        for (int k = 1; k < 8; ++k) {
+            u32 previous = table[k - 1][n];
+            table[k][n] = table[0][previous & 0xFF] ^ (previous >> 8);
+        }
+    }
+}
+
+/* Compute CRC-32 of a PNG chunk type and data, eight bytes per step */
+static u32 Crc(const u32 table[8][256], const u8* data, size length)
+{
+    u32 crc = 0xFFFFFFFFu;
+    for (; length >= 8; data += 8, length -= 8) {
+        u32 low = crc ^ ((u32)data[0] | (u32)data[1] << 8
+                | (u32)data[2] << 16 | (u32)data[3] << 24);
+        crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF]
+                ^ table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24]
+                ^ table[3][data[4]] ^ table[2][data[5]]
+                ^ table[1][data[6]] ^ table[0][data[7]];
+    }
+    for (; length > 0; ++data, --length) {
+        crc = table[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+/* Store big-endian 32-bit value */
+static inline u8* PutBe32(u8* out, u32 value)
+{
+    out[0] = (u8)(value >> 24);
+    out[1] = (u8)(value >> 16);
+    out[2] = (u8)(value >> 8);
+    out[3] = (u8)value;
+    return out + 4;
+}
+
+/* Append chunk header, data is expected to follow */
+static inline u8* BeginChunk(u8* out, const char* type, u32 length)
+{
+    out = PutBe32(out, length);
+    memcpy(out, type, 4);
+    return out + 4;
+}
+
+/* Append CRC of chunk starting at its type field */
+static inline u8* EndChunk(const IMAGE_Raster* raster, u8* out, const u8* type)
+{
+    return PutBe32(out, Crc(raster->crcTable, type, (size)(out - type)));
+}
+
+/* Get number of bytes of uncompressed PNG pixel data (filter byte per row) */
+static inline size RawSizeOf(const IMAGE_Raster* raster)
+{
+    return (size)raster->height * (1 + StrideOf(raster));
+}
+
+/* Get size of the zlib stream */
+static inline size ZlibSizeOf(const IMAGE_Raster* raster)
+{
+    size raw = RawSizeOf(raster);
+    size blocks = (raw + DEFLATE_STORED_MAX - 1) / DEFLATE_STORED_MAX;
+    return ZLIB_HEADER_SIZE + blocks * DEFLATE_STORED_HEADER + raw + ZLIB_ADLER_SIZE;
+}
+
+/* Get size of the whole PNG file */
+static inline size PngSizeOf(const IMAGE_Raster* raster)
+{
+    return PNG_SIGNATURE_SIZE
+            + PNG_CHUNK_OVERHEAD + PNG_IHDR_SIZE
+            + PNG_CHUNK_OVERHEAD + ZlibSizeOf(raster)
+            + PNG_CHUNK_OVERHEAD;
+}
+
+/* Append raw bytes, opening a new stored block whenever one is full */
+static void DeflateAppend(Deflate* deflate, const u8* data, size length)
+{
+    while (length > 0) {
+        if (deflate->block == 0) {
+            size block = (deflate->remaining < DEFLATE_STORED_MAX)
+                    ? deflate->remaining
+                    : DEFLATE_STORED_MAX;
+            u8* out = deflate->out;
+            out[0] = (block == deflate->remaining);  /* BFINAL, BTYPE = 00 */
+            out[1] = (u8)block;
+            out[2] = (u8)(block >> 8);
+            out[3] = (u8)~block;
+            out[4] = (u8)(~block >> 8);
+            deflate->out += DEFLATE_STORED_HEADER;
+            deflate->block = block;
+        }
+
+        size chunk = (length < deflate->block) ? length : deflate->block;
+        memcpy(deflate->out, data, chunk);
+
+        /* Sums stay below 2^32 for chunks of at most 5552 bytes */
+        for (size done = 0; done < chunk;) {
+            size run = (chunk - done < 5552) ? chunk - done : 5552;
+            for (size i = 0; i < run; ++i) {
+                deflate->adlerA += data[done + i];
+                deflate->adlerB += deflate->adlerA;
+            }
+            deflate->adlerA %= ZLIB_ADLER_MOD;
+            deflate->adlerB %= ZLIB_ADLER_MOD;
+            done += run;
+        }
+
+        deflate->out += chunk;
+        deflate->block -= chunk;
+        deflate->remaining -= chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+/* Encode the raster into the encoding buffer, returns end of the file */
+static u8* EncodePng(IMAGE_Raster* raster)
+{
+    u8* out = raster->encoded;
+    memcpy(out, PNG_SIGNATURE, PNG_SIGNATURE_SIZE);
+    out += PNG_SIGNATURE_SIZE;
+
+    u8* type = out + 4;
+    out = BeginChunk(out, "IHDR", PNG_IHDR_SIZE);
+    out = PutBe32(out, raster->width);
+    out = PutBe32(out, raster->height);
+    *out++ = 8;  /* Bit depth */
+    *out++ = PNG_COLOR_RGB;
+    *out++ = 0;  /* Deflate compression */
+    *out++ = 0;  /* Adaptive filtering */
+    *out++ = 0;  /* No interlace */
+    out = EndChunk(raster, out, type);
+
+    type = out + 4;
+    out = BeginChunk(out, "IDAT", (u32)ZlibSizeOf(raster));
+    *out++ = 0x78;  /* Deflate, 32K window */
+    *out++ = 0x01;  /* No preset dictionary, fastest level */
+
+    Deflate deflate = {
+        .out = out,
+        .remaining = RawSizeOf(raster),
+        .block = 0,
+        .adlerA = 1,
+        .adlerB = 0
+    };
+    size stride = StrideOf(raster);
+    static const u8 filter = PNG_FILTER_NONE;
+    for (u32 y = 0; y < raster->height; ++y) {
+        DeflateAppend(&deflate, &filter, 1);
+        DeflateAppend(&deflate, raster->pixels + y * stride, stride);
+    }
+    out = PutBe32(deflate.out, (deflate.adlerB << 16) | deflate.adlerA);
+    out = EndChunk(raster, out, type);
+
+    type = out + 4;
+    out = BeginChunk(out, "IEND", 0);
+    return EndChunk(raster, out, type);
+}
+
+/* Write whole buffer to the stream */
+static IMAGE_Status WriteAll(FILE* file, const void* data, size length)
+{
+    if (fwrite(data, 1, length, file) != length || fflush(file) != 0) {
+        return IMAGE_StatusIoError;
+    }
+    return IMAGE_StatusOk;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+IMAGE_Status IMAGE_Create(
+        IMAGE_Raster* raster,
+        CHAIN_Instance* chains,
+        size count,
+        size perRow,
+        size ledSize)
+{
+    COMMON_NULLPTR_GUARD(raster, IMAGE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(chains, IMAGE_StatusNullPtr);
+
+    if (count == 0 || perRow == 0 || ledSize == 0) {
+        return IMAGE_StatusWrongSize;
+    }
+
+    memset(raster, 0, sizeof(*raster));
+    raster->chains = chains;
+    raster->count = count;
+    raster->ledSize = ledSize;
+    for (size i = 0; i < count; ++i) {
+        raster->devices += chains[i].length;
+    }
+
+    raster->areas = calloc(count, sizeof(IMAGE_Area));
+    raster->sprites = malloc(2 * ledSize * ledSize * IMAGE_CHANNELS);
+    if (raster->areas == NULL || raster->sprites == NULL) {
+        IMAGE_Destroy(raster);
+        return IMAGE_StatusMemError;
+    }
+
+    IMAGE_Status status = Layout(raster, perRow);
+    if (status != IMAGE_StatusOk) {
+        IMAGE_Destroy(raster);
+        return status;
+    }
+
+    /* Scratch buffers are shared by all chains */
+    size devices = 0;
+    size words = 0;
+    for (size i = 0; i < count; ++i) {
+        if (raster->areas[i].map.devices > devices) {
+            devices = raster->areas[i].map.devices;
+        }
+        if (LAYOUT_CanvasWords(&raster->areas[i].map) > words) {
+            words = LAYOUT_CanvasWords(&raster->areas[i].map);
+        }
+    }
+    raster->bitboards = malloc(devices * sizeof(u64));
+    raster->canvas = malloc(words * sizeof(u64));
+    raster->pixels = calloc((size)raster->height, StrideOf(raster));
+    if (raster->bitboards == NULL || raster->canvas == NULL || raster->pixels == NULL) {
+        IMAGE_Destroy(raster);
+        return IMAGE_StatusMemError;
+    }
+
+    BuildSprites(raster);
+    BuildCrcTable(raster->crcTable);
+    return IMAGE_StatusOk;
+}
+
+void IMAGE_Destroy(IMAGE_Raster* raster)
+{
+    if (raster == NULL) {
+        return;
+    }
+
+    if (raster->areas != NULL) {
+        for (size i = 0; i < raster->count; ++i) {
+            LAYOUT_Destroy(&raster->areas[i].map);
+            free(raster->areas[i].canvas);
+        }
+    }
+    free(raster->areas);
+    free(raster->bitboards);
+    free(raster->canvas);
+    free(raster->sprites);
+    free(raster->pixels);
+    free(raster->encoded);
+    memset(raster, 0, sizeof(*raster));
+}
+
+size IMAGE_Rasterize(IMAGE_Raster* raster)
+{
+    bool everything = !raster->drawn;
+    size redrawn = 0;
+
+    for (size c = 0; c < raster->count; ++c) {
+        CHAIN_Instance* chain = &raster->chains[c];
+        CHAIN_Render(chain);
+        redrawn += DrawChain(raster, &raster->areas[c], chain, everything);
+    }
+
+    raster->drawn = true;
+    return redrawn;
+}
+
+IMAGE_Status IMAGE_WritePpm(const IMAGE_Raster* raster, FILE* file)
+{
+    COMMON_NULLPTR_GUARD(raster, IMAGE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(file, IMAGE_StatusNullPtr);
+
+    if (fprintf(file, "P6\n%u %u\n255\n", raster->width, raster->height) < 0) {
+        return IMAGE_StatusIoError;
+    }
+    return WriteAll(file, raster->pixels, (size)raster->height * StrideOf(raster));
+}
+
+IMAGE_Status IMAGE_WritePng(IMAGE_Raster* raster, FILE* file)
+{
+    COMMON_NULLPTR_GUARD(raster, IMAGE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(file, IMAGE_StatusNullPtr);
+
+    /* The file size depends only on dimensions, the buffer is allocated once */
+    size length = PngSizeOf(raster);
+    if (raster->encoded == NULL) {
+        raster->encoded = malloc(length);
+        if (raster->encoded == NULL) {
+            return IMAGE_StatusMemError;
+        }
+        raster->encodedCapacity = length;
+    }
+
+    u8* end = EncodePng(raster);
+    return WriteAll(file, raster->encoded, (size)(end - raster->encoded));
+}
+
+IMAGE_Status IMAGE_Save(IMAGE_Raster* raster, const char* path)
+{
+    COMMON_NULLPTR_GUARD(raster, IMAGE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(path, IMAGE_StatusNullPtr);
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return IMAGE_StatusIoError;
+    }
+
+    size length = strlen(path);
+    IMAGE_Status status = (length >= 4 && strcmp(path + length - 4, ".png") == 0)
+            ? IMAGE_WritePng(raster, file)
+            : IMAGE_WritePpm(raster, file);
+
+    if (fclose(file) != 0 && status == IMAGE_StatusOk) {
+        status = IMAGE_StatusIoError;
+    }
+    return status;
+}
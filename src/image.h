@@ -0,0 +1,176 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include "common.h"
+#include "chain.h"
+#include "layout.h"
+
+#include <stdio.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Default LED diameter in pixels */
+#define IMAGE_DEFAULT_LED_SIZE 8
+
+/* Devices drawn next to each other before the layout wraps */
+#define IMAGE_DEFAULT_PER_ROW 8
+
+/* Bytes per pixel of the raster (RGB) */
+#define IMAGE_CHANNELS 3
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    IMAGE_StatusOk = 0,     /**< OK */
+    IMAGE_StatusNullPtr,    /**< Null pointer was passed to API function */
+    IMAGE_StatusMemError,   /**< Memory allocation error */
+    IMAGE_StatusWrongSize,  /**< No chains, zero LED size or devices per row */
+    IMAGE_StatusIoError     /**< File could not be opened or written */
+} IMAGE_Status;
+
+/**
+ * @brief Part of the raster showing a single chain
+ */
+typedef struct
+{
+    LAYOUT_Map map; /**< Module grid of the chain, see LAYOUT_Wrapped */
+    u64* canvas;    /**< Canvas currently in the raster */
+    u32 top;        /**< Top pixel row */
+} IMAGE_Area;
+
+/**
+ * @brief RGB raster of a set of chains drawn as 8x8 LED matrices
+ *
+ * Chains are drawn one below another, devices of a chain left to right with
+ * wrapping after perRow devices, digit N is matrix row N and D7 is leftmost.
+ * Every chain is composed by LAYOUT_Gather and every canvas pixel is a copy
+ * of a precomputed LED sprite, so rasterizing a module is a sequence of row
+ * copies. Only modules whose pixels changed since the previous rasterization
+ * are redrawn.
+ */
+typedef struct
+{
+    CHAIN_Instance* chains; /**< Drawn chains */
+    size count;             /**< Number of chains */
+    size devices;           /**< Total number of devices */
+    size ledSize;           /**< LED diameter in pixels */
+    u32 width;              /**< Raster width in pixels */
+    u32 height;             /**< Raster height in pixels */
+    u8* pixels;             /**< Raster, rows of width RGB pixels */
+    u8* sprites;            /**< Unlit and lit LED sprites, ledSize^2 pixels each */
+    IMAGE_Area* areas;      /**< Area of every chain */
+    u64* bitboards;         /**< Chain output padded to a full module grid */
+    u64* canvas;            /**< Canvas of the chain being rasterized */
+    bool drawn;             /**< The raster has been fully drawn */
+    u32 crcTable[8][256];   /**< Slice-by-8 CRC-32 tables used by PNG encoder */
+    u8* encoded;            /**< PNG encoding buffer */
+    size encodedCapacity;   /**< Size of PNG encoding buffer */
+} IMAGE_Raster;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create raster of chains.
+ *
+ * Chains must not change their lengths while the raster exists.
+ *
+ * @param raster  Raster instance to be initialized
+ * @param chains  Chains to be drawn
+ * @param count   Number of chains
+ * @param perRow  Maximal number of devices in a row of the image
+ * @param ledSize LED diameter in pixels
+ *
+ * @return Instance of IMAGE_Status. The function possible return values are:
+ * - IMAGE_StatusNullPtr when null pointer was passed to function
+ * - IMAGE_StatusWrongSize when count, perRow or ledSize is zero
+ * - IMAGE_StatusMemError when there was a memory allocation error
+ * - IMAGE_StatusOk after success
+ */
+IMAGE_Status IMAGE_Create(
+        IMAGE_Raster* raster,
+        CHAIN_Instance* chains,
+        size count,
+        size perRow,
+        size ledSize);
+
+/**
+ * @brief Release memory owned by the raster.
+ *
+ * @param raster Raster created with IMAGE_Create
+ */
+void IMAGE_Destroy(IMAGE_Raster* raster);
+
+/**
+ * @brief Render chains and bring the raster up to date.
+ *
+ * @param raster Pointer to the raster
+ *
+ * @return Number of modules redrawn
+ */
+size IMAGE_Rasterize(IMAGE_Raster* raster);
+
+/**
+ * @brief Write the raster as binary PPM (P6) with a single write.
+ *
+ * @param raster Pointer to the raster
+ * @param file   Output stream opened in binary mode
+ *
+ * @return Instance of IMAGE_Status. The function possible return values are:
+ * - IMAGE_StatusNullPtr when null pointer was passed to function
+ * - IMAGE_StatusIoError when the image could not be written
+ * - IMAGE_StatusOk after success
+ */
+IMAGE_Status IMAGE_WritePpm(const IMAGE_Raster* raster, FILE* file);
+
+/**
+ * @brief Write the raster as PNG with a single write.
+ *
+ * Pixel data is stored in uncompressed deflate blocks, encoding is a copy of
+ * the raster with checksums computed on the way.
+ *
+ * @param raster Pointer to the raster
+ * @param file   Output stream opened in binary mode
+ *
+ * @return Instance of IMAGE_Status. The function possible return values are:
+ * - IMAGE_StatusNullPtr when null pointer was passed to function
+ * - IMAGE_StatusMemError when the encoding buffer could not be allocated
+ * - IMAGE_StatusIoError when the image could not be written
+ * - IMAGE_StatusOk after success
+ */
+IMAGE_Status IMAGE_WritePng(IMAGE_Raster* raster, FILE* file);
+
+/**
+ * @brief Write the raster into a file, format is selected by extension.
+ *
+ * Paths ending with ".png" produce PNG, all the others PPM.
+ *
+ * @param raster Pointer to the raster
+ * @param path   Output file path
+ *
+ * @return Instance of IMAGE_Status. The function possible return values are:
+ * - IMAGE_StatusNullPtr when null pointer was passed to function
+ * - IMAGE_StatusMemError when the PNG encoding buffer could not be allocated
+ * - IMAGE_StatusIoError when the file could not be opened or written
+ * - IMAGE_StatusOk after success
+ */
+IMAGE_Status IMAGE_Save(IMAGE_Raster* raster, const char* path);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // IMAGE_H
@@ -0,0 +1,258 @@
+#include "ingest.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Producer thread arguments */
+typedef struct
+{
+    INGEST_Instance* ingest;
+    INGEST_ProducerFn produce;
+    void* context;
+} Producer;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Read little-endian frame of a record */
+static inline u16 GetU16(const u8* data)
+{
+    return (u16)(data[0] | (data[1] << 8));
+}
+
+/* Push all frames, yielding while the consumer catches up */
+static void PushAll(QUEUE_Instance* queue, const u16* frames, size count)
+{
+    for (;;) {
+        size pushed = QUEUE_Push(queue, frames, count);
+        frames += pushed;
+        count -= pushed;
+        if (count == 0) {
+            return;
+        }
+        sched_yield();
+    }
+}
+
+/* Producer thread entry point, closes every queue after the last record */
+static void* ProducerMain(void* argument)
+{
+    Producer* producer = argument;
+    producer->produce(producer->context);
+
+    for (size i = 0; i < producer->ingest->count; ++i) {
+        QUEUE_Close(&producer->ingest->queues[i]);
+    }
+    return NULL;
+}
+
+/* Feed queues on the calling thread when the engine cannot run */
+static void DrainSerially(INGEST_Instance* ingest)
+{
+    for (;;) {
+        bool open = false;
+        bool progress = false;
+        for (size i = 0; i < ingest->count; ++i) {
+            if (!QUEUE_IsDrained(&ingest->queues[i])) {
+                open = true;
+                progress |= QUEUE_PopToChain(&ingest->queues[i],
+                        &ingest->chains[i], ENGINE_SLICE_FRAMES) > 0;
+            }
+        }
+        if (!open) {
+            break;
+        }
+        if (!progress) {
+            sched_yield();
+        }
+    }
+
+    for (size i = 0; i < ingest->count; ++i) {
+        CHAIN_Render(&ingest->chains[i]);
+    }
+}
+
+/* Run producer thread and engine, changes are collected when outputs is set */
+static INGEST_Status Run(INGEST_Instance* ingest, INGEST_ProducerFn produce,
+        void* context, ENGINE_Output** outputs, size* outputCount)
+{
+    Producer producer = {.ingest = ingest, .produce = produce, .context = context};
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, ProducerMain, &producer) != 0) {
+        return INGEST_StatusThreadError;
+    }
+
+    ENGINE_Status status = (outputs != NULL)
+            ? ENGINE_RunDeterministic(&ingest->engine, ingest->jobs,
+                    ingest->count, outputs, outputCount)
+            : ENGINE_Run(&ingest->engine, ingest->jobs, ingest->count);
+
+    /* The producer blocks on full queues, so they must be consumed anyway */
+    if (status != ENGINE_StatusOk) {
+        DrainSerially(ingest);
+    }
+
+    pthread_join(thread, NULL);
+    return (status == ENGINE_StatusOk || outputs == NULL)
+            ? INGEST_StatusOk
+            : INGEST_StatusMemError;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+INGEST_Status INGEST_Create(
+        INGEST_Instance* ingest,
+        CHAIN_Instance* chains,
+        size count,
+        size capacity,
+        size workers)
+{
+    COMMON_NULLPTR_GUARD(ingest, INGEST_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(chains, INGEST_StatusNullPtr);
+
+    if (count == 0 || capacity == 0) {
+        return INGEST_StatusWrongSize;
+    }
+    size length = chains[0].length;
+    for (size i = 0; i < count; ++i) {
+        if (chains[i].shifted != 0 || chains[i].length != length) {
+            return INGEST_StatusWrongSize;
+        }
+    }
+
+    memset(ingest, 0, sizeof(*ingest));
+    ingest->chains = chains;
+    ingest->count = count;
+    ingest->queues = calloc(count, sizeof(*ingest->queues));
+    ingest->windows = malloc(count * length * sizeof(*ingest->windows));
+    ingest->jobs = calloc(count, sizeof(*ingest->jobs));
+    if (ingest->queues == NULL || ingest->windows == NULL || ingest->jobs == NULL) {
+        INGEST_Destroy(ingest);
+        return INGEST_StatusMemError;
+    }
+
+    for (size i = 0; i < count; ++i) {
+        if (QUEUE_Create(&ingest->queues[i], capacity) != QUEUE_StatusOk) {
+            INGEST_Destroy(ingest);
+            return INGEST_StatusMemError;
+        }
+
+        /* Window starts as the current shift registers, device 0 is newest */
+        u16* window = &ingest->windows[i * length];
+        for (size d = 0; d < length; ++d) {
+            size index = (chains[i].shiftHead + d) % length;
+            window[length - 1 - d] = chains[i].shift[index];
+        }
+
+        ingest->jobs[i] = (ENGINE_Job){
+            .chain = &chains[i],
+            .queue = &ingest->queues[i]
+        };
+    }
+
+    ENGINE_Create(&ingest->engine, workers);
+    if (ingest->engine.workers > count) {
+        ingest->engine.workers = count;
+    }
+
+    return INGEST_StatusOk;
+}
+
+void INGEST_Destroy(INGEST_Instance* ingest)
+{
+    if (ingest == NULL) {
+        return;
+    }
+
+    if (ingest->queues != NULL) {
+        for (size i = 0; i < ingest->count; ++i) {
+            QUEUE_Destroy(&ingest->queues[i]);
+        }
+    }
+    free(ingest->queues);
+    free(ingest->windows);
+    free(ingest->jobs);
+    memset(ingest, 0, sizeof(*ingest));
+}
+
+TRACE_Status INGEST_Record(void* context, const TRACE_Record* record)
+{
+    INGEST_Instance* ingest = context;
+    if (record->chain >= ingest->count) {
+        return TRACE_StatusWrongChain;
+    }
+
+    /* Only the last length frames of the record stay in the chain */
+    size length = ingest->chains[0].length;
+    const u8* frames = record->frames;
+    size count = record->count;
+    if (count > length) {
+        frames += 2 * (count - length);
+        count = length;
+    }
+
+    u16* window = &ingest->windows[record->chain * length];
+    memmove(window, &window[count], (length - count) * sizeof(*window));
+    for (size i = 0; i < count; ++i) {
+        window[length - count + i] = GetU16(&frames[2 * i]);
+    }
+    PushAll(&ingest->queues[record->chain], window, length);
+
+    ++ingest->records;
+    ingest->frames += record->count;
+    return TRACE_StatusOk;
+}
+
+INGEST_Status INGEST_Run(
+        INGEST_Instance* ingest,
+        INGEST_ProducerFn produce,
+        void* context)
+{
+    COMMON_NULLPTR_GUARD(ingest, INGEST_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(produce, INGEST_StatusNullPtr);
+
+    return Run(ingest, produce, context, NULL, NULL);
+}
+
+INGEST_Status INGEST_RunDeterministic(
+        INGEST_Instance* ingest,
+        INGEST_ProducerFn produce,
+        void* context,
+        ENGINE_Output** outputs,
+        size* outputCount)
+{
+    COMMON_NULLPTR_GUARD(ingest, INGEST_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(produce, INGEST_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(outputs, INGEST_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(outputCount, INGEST_StatusNullPtr);
+
+    return Run(ingest, produce, context, outputs, outputCount);
+}
+
+INGEST_Status INGEST_WriteChanges(
+        FILE* file,
+        const ENGINE_Output* outputs,
+        size count)
+{
+    COMMON_NULLPTR_GUARD(file, INGEST_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(outputs, INGEST_StatusNullPtr);
+
+    for (size i = 0; i < count; ++i) {
+        if (fprintf(file, "%llu %zu %zu 0x%016llx\n",
+                (unsigned long long)outputs[i].tick, outputs[i].job,
+                outputs[i].device,
+                (unsigned long long)outputs[i].bitboard) < 0) {
+            return INGEST_StatusIoError;
+        }
+    }
+    return INGEST_StatusOk;
+}
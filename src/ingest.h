@@ -0,0 +1,189 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include "common.h"
+#include "chain.h"
+#include "engine.h"
+#include "queue.h"
+#include "trace.h"
+
+#include <stdio.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Default number of frames buffered per chain */
+#define INGEST_DEFAULT_CAPACITY (1u << 16)
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    INGEST_StatusOk = 0,      /**< OK */
+    INGEST_StatusNullPtr,     /**< Null pointer was passed to API function */
+    INGEST_StatusMemError,    /**< Memory allocation error */
+    INGEST_StatusWrongSize,   /**< Bad chain count, capacity or chain state */
+    INGEST_StatusThreadError, /**< Producer thread could not be started */
+    INGEST_StatusIoError      /**< Changes could not be written */
+} INGEST_Status;
+
+/**
+ * @brief Producer type, passes records to INGEST_Record until input ends
+ */
+typedef void (*INGEST_ProducerFn)(void* context);
+
+/**
+ * @brief Records of a producer thread fanned out to ENGINE workers
+ *
+ * Every chain has its own queue consumed by an ENGINE queue job, so chains
+ * are emulated in parallel while the producer keeps parsing. Queued frames
+ * are full-chain transactions. A record of any other length is turned into
+ * one by sending the last length frames the chain would hold after shifting
+ * the record in, which leaves the chain in exactly the same state as
+ * TRACE_FeedChain. The producer keeps those frames in a per-chain window.
+ */
+typedef struct
+{
+    CHAIN_Instance* chains; /**< Chains fed by the engine */
+    size count;             /**< Number of chains */
+    QUEUE_Instance* queues; /**< Frame queue per chain */
+    u16* windows;           /**< Last transaction per chain, oldest frame first */
+    ENGINE_Job* jobs;       /**< Queue job per chain */
+    ENGINE_Instance engine; /**< Worker pool, at most one worker per chain */
+    u64 records;            /**< Records accepted by INGEST_Record */
+    u64 frames;             /**< Frames of accepted records */
+} INGEST_Instance;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create ingestion path for given chains.
+ *
+ * @param ingest   Ingest instance to be initialized
+ * @param chains   Chains of equal length to be fed, every one latched (shifted
+ * equal to zero)
+ * @param count    Number of chains
+ * @param capacity Frames buffered per chain, see INGEST_DEFAULT_CAPACITY
+ * @param workers  Number of engine workers or ENGINE_WORKERS_AUTO, limited
+ * to the number of chains
+ *
+ * @return Instance of INGEST_Status. The function possible return values are:
+ * - INGEST_StatusNullPtr when null pointer was passed to function
+ * - INGEST_StatusWrongSize when count or capacity is zero, chain lengths
+ * differ or a chain is not latched
+ * - INGEST_StatusMemError when there was a memory allocation error
+ * - INGEST_StatusOk after success
+ */
+INGEST_Status INGEST_Create(
+        INGEST_Instance* ingest,
+        CHAIN_Instance* chains,
+        size count,
+        size capacity,
+        size workers);
+
+/**
+ * @brief Release memory owned by the ingest instance, chains are kept.
+ *
+ * @param ingest Ingest created with INGEST_Create
+ */
+void INGEST_Destroy(INGEST_Instance* ingest);
+
+/**
+ * @brief Queue record for its chain (producer side, TRACE_RecordCallback).
+ *
+ * Blocks while the chain queue is full.
+ *
+ * @param context Pointer to the ingest instance
+ * @param record  Decoded record
+ *
+ * @return Instance of TRACE_Status. The function possible return values are:
+ * - TRACE_StatusWrongChain when the record chain id is out of range
+ * - TRACE_StatusOk after success
+ */
+TRACE_Status INGEST_Record(void* context, const TRACE_Record* record);
+
+/**
+ * @brief Run producer on its own thread and emulate its records on the engine.
+ *
+ * The calling thread works as engine worker 0. Queues are closed once the
+ * producer returns and the function returns after every queued frame was fed
+ * and every chain rendered. If the engine cannot allocate its deques, the
+ * calling thread feeds the queues alone. An instance can be run only once.
+ *
+ * @param ingest  Pointer to the ingest instance
+ * @param produce Producer calling INGEST_Record with ingest as context
+ * @param context User context passed to producer
+ *
+ * @return Instance of INGEST_Status. The function possible return values are:
+ * - INGEST_StatusNullPtr when null pointer was passed to function
+ * - INGEST_StatusThreadError when the producer thread could not be started
+ * - INGEST_StatusOk after success
+ */
+INGEST_Status INGEST_Run(
+        INGEST_Instance* ingest,
+        INGEST_ProducerFn produce,
+        void* context);
+
+/**
+ * @brief Run producer like INGEST_Run and collect visible changes in a stable
+ * order.
+ *
+ * Chains are fed through ENGINE_RunDeterministic, so the merged changes are
+ * bit-identical for any number of workers. Job index of every change is the
+ * chain index.
+ *
+ * @param ingest      Pointer to the ingest instance
+ * @param produce     Producer calling INGEST_Record with ingest as context
+ * @param context     User context passed to producer
+ * @param outputs     The buffer in which merged changes are stored. It has to
+ * be released with free()
+ * @param outputCount The buffer in which number of merged changes is stored
+ *
+ * @return Instance of INGEST_Status. The function possible return values are:
+ * - INGEST_StatusNullPtr when null pointer was passed to function
+ * - INGEST_StatusThreadError when the producer thread could not be started
+ * - INGEST_StatusMemError when there was a memory allocation error, chains
+ * are still fed to the end
+ * - INGEST_StatusOk after success
+ */
+INGEST_Status INGEST_RunDeterministic(
+        INGEST_Instance* ingest,
+        INGEST_ProducerFn produce,
+        void* context,
+        ENGINE_Output** outputs,
+        size* outputCount);
+
+/**
+ * @brief Write changes as text, one "tick chain device bitboard" line each.
+ *
+ * @param file    Destination file
+ * @param outputs Changes from INGEST_RunDeterministic
+ * @param count   Number of changes
+ *
+ * @return Instance of INGEST_Status. The function possible return values are:
+ * - INGEST_StatusNullPtr when null pointer was passed to function
+ * - INGEST_StatusIoError when writing failed
+ * - INGEST_StatusOk after success
+ */
+INGEST_Status INGEST_WriteChanges(
+        FILE* file,
+        const ENGINE_Output* outputs,
+        size count);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // INGEST_H
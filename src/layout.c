@@ -0,0 +1,193 @@
+#include "layout.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Highest pixel coordinate within a module */
+#define MODULE_LAST (LAYOUT_MODULE_SIZE - 1)
+
+/* Bits per canvas word */
+#define WORD_BITS 64
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Find grid cell of device, returns true if the module runs backwards */
+static bool PlaceModule(const LAYOUT_Descriptor* descriptor, size device,
+        size* column, size* row)
+{
+    size columns = descriptor->columns;
+    size rows = descriptor->rows;
+
+    switch (descriptor->order) {
+    case LAYOUT_OrderColumns:
+        *column = device / rows;
+        *row = device % rows;
+        return false;
+    case LAYOUT_OrderRowSerpentine:
+        *row = device / columns;
+        *column = device % columns;
+        if (*row % 2 == 1) {
+            *column = columns - 1 - *column;
+            return true;
+        }
+        return false;
+    case LAYOUT_OrderColumnSerpentine:
+        *column = device / rows;
+        *row = device % rows;
+        if (*column % 2 == 1) {
+            *row = rows - 1 - *row;
+            return true;
+        }
+        return false;
+    case LAYOUT_OrderRows:
+    default:
+        *column = device % columns;
+        *row = device / columns;
+        return false;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+LAYOUT_Status LAYOUT_Create(LAYOUT_Map* map, const LAYOUT_Descriptor* descriptor)
+{
+    COMMON_NULLPTR_GUARD(map, LAYOUT_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(descriptor, LAYOUT_StatusNullPtr);
+
+    if (descriptor->columns == 0 || descriptor->rows == 0) {
+        return LAYOUT_StatusWrongSize;
+    }
+    if (descriptor->order > LAYOUT_OrderColumnSerpentine
+            || descriptor->rotation > LAYOUT_Rotate270) {
+        return LAYOUT_StatusBadDescriptor;
+    }
+
+    /* Entries are u32 device * 64 + bit and the table holds 64 per device */
+    size columns = descriptor->columns;
+    if (columns > SIZE_MAX / descriptor->rows
+            || columns * descriptor->rows > UINT32_MAX / 64
+            || columns * descriptor->rows > SIZE_MAX / 64 / sizeof(u32)) {
+        return LAYOUT_StatusWrongSize;
+    }
+
+    memset(map, 0, sizeof(*map));
+    map->descriptor = *descriptor;
+    map->devices = descriptor->columns * descriptor->rows;
+    map->width = descriptor->columns * LAYOUT_MODULE_SIZE;
+    map->height = descriptor->rows * LAYOUT_MODULE_SIZE;
+    map->wordsPerRow = (map->width + WORD_BITS - 1) / WORD_BITS;
+
+    map->sources = malloc(map->width * map->height * sizeof(u32));
+    if (map->sources == NULL) {
+        return LAYOUT_StatusMemError;
+    }
+
+    /* Every LED is mapped forward once, the table stores the inverse */
+    for (size device = 0; device < map->devices; ++device) {
+        for (u8 digit = 0; digit < MAX7219_DIGITS; ++digit) {
+            for (u8 bit = 0; bit < 8; ++bit) {
+                size x;
+                size y;
+                LAYOUT_Locate(descriptor, device, digit, bit, &x, &y);
+                map->sources[y * map->width + x] = (u32)(device * 64 + digit * 8 + bit);
+            }
+        }
+    }
+    return LAYOUT_StatusOk;
+}
+
+void LAYOUT_Destroy(LAYOUT_Map* map)
+{
+    if (map == NULL) {
+        return;
+    }
+
+    free(map->sources);
+    memset(map, 0, sizeof(*map));
+}
+
+void LAYOUT_Locate(
+        const LAYOUT_Descriptor* descriptor,
+        size device,
+        u8 digit,
+        u8 bit,
+        size* x,
+        size* y)
+{
+    size column;
+    size row;
+    bool reversed = PlaceModule(descriptor, device, &column, &row);
+
+    u32 rotation = (u32)descriptor->rotation;
+    if (reversed && descriptor->rotateReversed) {
+        rotation += LAYOUT_Rotate180;
+    }
+
+    /* Position within unrotated module, then turned clockwise */
+    size sx = MODULE_LAST - bit;
+    size sy = digit;
+    size dx;
+    size dy;
+    switch (rotation % 4) {
+    case LAYOUT_Rotate90:
+        dx = MODULE_LAST - sy;
+        dy = sx;
+        break;
+    case LAYOUT_Rotate180:
+        dx = MODULE_LAST - sx;
+        dy = MODULE_LAST - sy;
+        break;
+    case LAYOUT_Rotate270:
+        dx = sy;
+        dy = MODULE_LAST - sx;
+        break;
+    default:
+        dx = sx;
+        dy = sy;
+        break;
+    }
+
+    *x = column * LAYOUT_MODULE_SIZE + dx;
+    *y = row * LAYOUT_MODULE_SIZE + dy;
+}
+
+LAYOUT_Status LAYOUT_Gather(
+        const LAYOUT_Map* map,
+        const u64* bitboards,
+        size count,
+        u64* canvas)
+{
+    COMMON_NULLPTR_GUARD(map, LAYOUT_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(bitboards, LAYOUT_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(canvas, LAYOUT_StatusNullPtr);
+
+    if (count < map->devices) {
+        return LAYOUT_StatusWrongSize;
+    }
+
+    /* Writes are sequential, reads hit bitboards small enough to stay cached */
+    const u32* source = map->sources;
+    for (size y = 0; y < map->height; ++y) {
+        u64* row = canvas + y * map->wordsPerRow;
+        for (size x = 0; x < map->width; x += WORD_BITS) {
+            size bits = (map->width - x < WORD_BITS) ? map->width - x : WORD_BITS;
+            u64 word = 0;
+            for (size i = 0; i < bits; ++i) {
+                u32 entry = source[i];
+                word |= ((bitboards[entry / 64] >> (entry % 64)) & 1) << i;
+            }
+            row[x / WORD_BITS] = word;
+            source += bits;
+        }
+    }
+    return LAYOUT_StatusOk;
+}
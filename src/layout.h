@@ -0,0 +1,231 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "common.h"
+#include "max7219.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Side of a single module in pixels */
+#define LAYOUT_MODULE_SIZE MAX7219_DIGITS
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    LAYOUT_StatusOk = 0,        /**< OK */
+    LAYOUT_StatusNullPtr,       /**< Null pointer was passed to API function */
+    LAYOUT_StatusMemError,      /**< Memory allocation error */
+    LAYOUT_StatusWrongSize,     /**< Empty grid or too few devices */
+    LAYOUT_StatusBadDescriptor  /**< Unknown order or rotation */
+} LAYOUT_Status;
+
+/**
+ * @brief Order in which chained devices fill the module grid
+ */
+typedef enum
+{
+    LAYOUT_OrderRows = 0,           /**< Left to right, rows top to bottom */
+    LAYOUT_OrderColumns,            /**< Top to bottom, columns left to right */
+    LAYOUT_OrderRowSerpentine,      /**< Like rows, every other row right to left */
+    LAYOUT_OrderColumnSerpentine    /**< Like columns, every other one bottom up */
+} LAYOUT_Order;
+
+/**
+ * @brief Clockwise rotation of a module as mounted on the board
+ */
+typedef enum
+{
+    LAYOUT_Rotate0 = 0,
+    LAYOUT_Rotate90,
+    LAYOUT_Rotate180,
+    LAYOUT_Rotate270
+} LAYOUT_Rotation;
+
+/**
+ * @brief Physical arrangement of chained 8x8 modules
+ *
+ * Device 0 (nearest to the microcontroller) sits in the top-left corner of
+ * the grid. Unrotated modules show digit N as pixel row N with D7 leftmost.
+ */
+typedef struct
+{
+    size columns;             /**< Modules per grid row */
+    size rows;                /**< Module rows */
+    LAYOUT_Order order;       /**< Device order within the grid */
+    LAYOUT_Rotation rotation; /**< Rotation of every module */
+    bool rotateReversed;      /**< Serpentine modules running backwards are
+                                   additionally turned by 180 degrees */
+} LAYOUT_Descriptor;
+
+/**
+ * @brief Layout precompiled into a per-pixel lookup table
+ *
+ * The canvas is a 1 bit per pixel bitmap of rows of wordsPerRow u64 words,
+ * pixel x of a row is bit x % 64 of word x / 64. Every lookup table entry
+ * holds device * 64 + bitboard bit feeding the pixel.
+ */
+typedef struct
+{
+    LAYOUT_Descriptor descriptor; /**< Arrangement the table was built from */
+    size devices;                 /**< Number of modules */
+    size width;                   /**< Canvas width in pixels */
+    size height;                  /**< Canvas height in pixels */
+    size wordsPerRow;             /**< Canvas row stride in u64 words */
+    u32* sources;                 /**< Source bit per canvas pixel, row major */
+} LAYOUT_Map;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Precompile layout into lookup table.
+ *
+ * @param map        Map instance to be initialized
+ * @param descriptor Physical arrangement of modules
+ *
+ * @return Instance of LAYOUT_Status. The function possible return values are:
+ * - LAYOUT_StatusNullPtr when null pointer was passed to function
+ * - LAYOUT_StatusWrongSize when the grid has no modules or is too large for
+ * the lookup table to be addressed
+ * - LAYOUT_StatusBadDescriptor when order or rotation is unknown
+ * - LAYOUT_StatusMemError when there was a memory allocation error
+ * - LAYOUT_StatusOk after success
+ */
+LAYOUT_Status LAYOUT_Create(LAYOUT_Map* map, const LAYOUT_Descriptor* descriptor);
+
+/**
+ * @brief Release memory owned by the map.
+ *
+ * @param map Map created with LAYOUT_Create
+ */
+void LAYOUT_Destroy(LAYOUT_Map* map);
+
+/**
+ * @brief Map a LED of a device to canvas coordinates.
+ *
+ * @param descriptor Physical arrangement of modules
+ * @param device     Device index in the chain
+ * @param digit      Digit register (pixel row of unrotated module)
+ * @param bit        Segment/column bit of the digit, D7 is leftmost
+ * @param x          The buffer in which canvas column is stored
+ * @param y          The buffer in which canvas row is stored
+ */
+void LAYOUT_Locate(
+        const LAYOUT_Descriptor* descriptor,
+        size device,
+        u8 digit,
+        u8 bit,
+        size* x,
+        size* y);
+
+/**
+ * @brief Compose canvas from device bitboards in a single gather pass.
+ *
+ * @param map       Pointer to the map
+ * @param bitboards Visible output per device, e.g. CHAIN_Instance::framebuffer
+ * @param count     Number of bitboards, at least LAYOUT_Map::devices
+ * @param canvas    Canvas of height * wordsPerRow words, fully overwritten
+ *
+ * @return Instance of LAYOUT_Status. The function possible return values are:
+ * - LAYOUT_StatusNullPtr when null pointer was passed to function
+ * - LAYOUT_StatusWrongSize when there are fewer bitboards than modules
+ * - LAYOUT_StatusOk after success
+ */
+LAYOUT_Status LAYOUT_Gather(
+        const LAYOUT_Map* map,
+        const u64* bitboards,
+        size count,
+        u64* canvas);
+
+/**
+ * @brief Describe chain drawn left to right, wrapping after perRow modules.
+ *
+ * @param length Number of devices in the chain, not zero
+ * @param perRow Maximal number of modules in a grid row, not zero
+ * @return Descriptor of unrotated modules in row order. The last grid row is
+ * partial unless length is a multiple of perRow.
+ */
+static inline LAYOUT_Descriptor LAYOUT_Wrapped(size length, size perRow)
+{
+    return (LAYOUT_Descriptor){
+        .columns = (length < perRow) ? length : perRow,
+        .rows = (length + perRow - 1) / perRow,
+        .order = LAYOUT_OrderRows,
+        .rotation = LAYOUT_Rotate0,
+        .rotateReversed = false
+    };
+}
+
+/**
+ * @brief Get canvas size in u64 words.
+ *
+ * @param map Pointer to the map
+ * @return Number of words of the canvas
+ */
+static inline size LAYOUT_CanvasWords(const LAYOUT_Map* map)
+{
+    return map->height * map->wordsPerRow;
+}
+
+/**
+ * @brief Read single canvas pixel.
+ *
+ * @param map    Pointer to the map
+ * @param canvas Canvas composed by LAYOUT_Gather
+ * @param x      Canvas column
+ * @param y      Canvas row
+ * @return True if the pixel is lit
+ */
+static inline bool LAYOUT_Pixel(const LAYOUT_Map* map, const u64* canvas, size x, size y)
+{
+    return (canvas[y * map->wordsPerRow + x / 64] >> (x % 64)) & 1;
+}
+
+/**
+ * @brief Get device shown in a grid cell.
+ *
+ * @param map    Pointer to the map
+ * @param column Grid column
+ * @param row    Grid row
+ * @return Device index, may exceed the chain length in a partial grid row
+ */
+static inline size LAYOUT_DeviceAt(const LAYOUT_Map* map, size column, size row)
+{
+    size corner = row * LAYOUT_MODULE_SIZE * map->width + column * LAYOUT_MODULE_SIZE;
+    return map->sources[corner] / 64;
+}
+
+/**
+ * @brief Read pixel row of a single module.
+ *
+ * @param map    Pointer to the map
+ * @param canvas Canvas composed by LAYOUT_Gather
+ * @param column Grid column of the module
+ * @param y      Canvas row
+ * @return Eight pixels, the leftmost one in bit 0
+ */
+static inline u8 LAYOUT_ModuleRow(const LAYOUT_Map* map, const u64* canvas,
+        size column, size y)
+{
+    size x = column * LAYOUT_MODULE_SIZE;
+    return (u8)(canvas[y * map->wordsPerRow + x / 64] >> (x % 64));
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // LAYOUT_H
@@ -0,0 +1,184 @@
+#include "max7219.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Meaningful bits of scan limit register */
+#define SCAN_LIMIT_MASK 0x07
+
+/* Decimal point segment of the digit register */
+#define DECIMAL_POINT_MASK 0x80
+
+/* Register offset marking addresses without backing storage */
+#define NO_REGISTER 0xFF
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private variables -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Code B font: 0-9, '-', 'E', 'H', 'L', 'P', blank */
+static const u8 codeBFont[16] = {
+    0x7E, 0x30, 0x6D, 0x79, 0x33, 0x5B, 0x5F, 0x70,
+    0x7F, 0x7B, 0x01, 0x4F, 0x37, 0x0E, 0x67, 0x00
+};
+
+/* Offset of register within MAX7219_Device indexed by address */
+static const u8 registerOffset[16] = {
+    NO_REGISTER,
+    offsetof(MAX7219_Device, digit[0]),
+    offsetof(MAX7219_Device, digit[1]),
+    offsetof(MAX7219_Device, digit[2]),
+    offsetof(MAX7219_Device, digit[3]),
+    offsetof(MAX7219_Device, digit[4]),
+    offsetof(MAX7219_Device, digit[5]),
+    offsetof(MAX7219_Device, digit[6]),
+    offsetof(MAX7219_Device, digit[7]),
+    offsetof(MAX7219_Device, decodeMode),
+    offsetof(MAX7219_Device, intensity),
+    offsetof(MAX7219_Device, scanLimit),
+    offsetof(MAX7219_Device, shutdown),
+    NO_REGISTER,
+    NO_REGISTER,
+    offsetof(MAX7219_Device, displayTest)
+};
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Check whether digit registers are currently reflected on the outputs */
+static inline bool DigitsAreVisible(const MAX7219_Device* device)
+{
+    return !MAX7219_IsShutdown(device) && !MAX7219_IsDisplayTest(device);
+}
+
+/* Spread 8 bits into the least significant bit of 8 consecutive bytes */
+static inline u64 SpreadBitsToBytes(u8 bits)
+{
+    u64 spread = ((u64)(bits & 0x7F) * UINT64_C(0x0002040810204081))
+            & UINT64_C(0x0101010101010101);
+    return spread | ((u64)(bits & 0x80) << 49);
+}
+
+/* Pack digit registers into bitboard */
+static inline u64 PackDigits(const u8* digit)
+{
+    u64 packed = 0;
+    for (u8 i = 0; i < MAX7219_DIGITS; ++i) {
+        packed |= (u64)digit[i] << (8 * i);
+    }
+    return packed;
+}
+
+/* Pack Code B translation of selected digits into bitboard */
+static u64 PackDecodedDigits(const u8* digit, u8 decodeMode)
+{
+    u64 packed = 0;
+    for (u8 i = 0; i < MAX7219_DIGITS; ++i) {
+        if (decodeMode & (1u << i)) {
+            packed |= (u64)MAX7219_CodeB(digit[i]) << (8 * i);
+        }
+    }
+    return packed;
+}
+
+/* Check whether particular digit is scanned */
+static inline bool DigitIsScanned(const MAX7219_Device* device, u8 digit)
+{
+    return digit <= (device->scanLimit & SCAN_LIMIT_MASK);
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void MAX7219_PowerOn(MAX7219_Device* device, u8 digitValue)
+{
+    /* All control registers power up as zero, which means shutdown */
+    memset(device, 0, sizeof(*device));
+    memset(device->digit, digitValue, sizeof(device->digit));
+}
+
+u8 MAX7219_Write(MAX7219_Device* device, u16 frame)
+{
+    u8 address = MAX7219_FRAME_ADDRESS(frame);
+    u8 data = MAX7219_FRAME_DATA(frame);
+    u8 dirty = 0;
+
+    /* Refresh loops rewrite unchanged registers most of the time */
+    u8 offset = registerOffset[address];
+    if (offset != NO_REGISTER && ((const u8*)device)[offset] == data) {
+        return MAX7219_WRITE_REDUNDANT;
+    }
+
+    switch (address) {
+    case MAX7219_RegNoOp:
+        break;
+    case MAX7219_RegDecodeMode:
+        device->decodeMode = data;
+        dirty = DigitsAreVisible(device) ? MAX7219_DIRTY_DECODE_MODE : 0;
+        break;
+    case MAX7219_RegIntensity:
+        /* Intensity does not change which LEDs are lit */
+        device->intensity = data;
+        break;
+    case MAX7219_RegScanLimit:
+        device->scanLimit = data;
+        dirty = DigitsAreVisible(device) ? MAX7219_DIRTY_SCAN_LIMIT : 0;
+        break;
+    case MAX7219_RegShutdown:
+        device->shutdown = data;
+        dirty = MAX7219_IsDisplayTest(device) ? 0 : MAX7219_DIRTY_SHUTDOWN;
+        break;
+    case MAX7219_RegDisplayTest:
+        device->displayTest = data;
+        dirty = MAX7219_DIRTY_DISPLAY_TEST;
+        break;
+    default:
+        if (address >= MAX7219_RegDigit0 && address <= MAX7219_RegDigit7) {
+            u8 digit = address - MAX7219_RegDigit0;
+            device->digit[digit] = data;
+
+            /* The write lands even if it is invisible at the moment */
+            if (DigitsAreVisible(device) && DigitIsScanned(device, digit)) {
+                dirty = MAX7219_DIRTY_DIGIT;
+            }
+        }
+        /* Addresses 0xD and 0xE are not implemented by the chip */
+        break;
+    }
+
+    device->dirty |= dirty;
+    return dirty;
+}
+
+u64 MAX7219_Render(MAX7219_Device* device)
+{
+    device->dirty = 0;
+
+    /* Display test overrides all the other registers including shutdown */
+    if (MAX7219_IsDisplayTest(device)) {
+        return MAX7219_BITBOARD_ALL_ON;
+    }
+    if (MAX7219_IsShutdown(device)) {
+        return MAX7219_BITBOARD_ALL_OFF;
+    }
+
+    u64 bitboard = PackDigits(device->digit);
+    if (device->decodeMode != 0) {
+        u64 decodeMask = SpreadBitsToBytes(device->decodeMode) * 0xFF;
+        bitboard = (bitboard & ~decodeMask)
+                | PackDecodedDigits(device->digit, device->decodeMode);
+    }
+
+    return bitboard & MAX7219_ScanLimitMask(device->scanLimit);
+}
+
+u8 MAX7219_CodeB(u8 value)
+{
+    return codeBFont[value & 0x0F] | (value & DECIMAL_POINT_MASK);
+}
@@ -0,0 +1,173 @@
+#ifndef MAX7219_H
+#define MAX7219_H
+
+#include "common.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Number of digit registers (rows of 8x8 matrix) driven by single device */
+#define MAX7219_DIGITS 8
+
+/* Extract register address and data from 16-bit serial frame */
+#define MAX7219_FRAME_ADDRESS(FRAME) ((u8)(((FRAME) >> 8) & 0x0F))
+#define MAX7219_FRAME_DATA(FRAME)    ((u8)((FRAME) & 0xFF))
+
+/* Build 16-bit serial frame from register address and data */
+#define MAX7219_FRAME(ADDRESS, DATA) \
+    ((u16)((((u16)(ADDRESS) & 0x0F) << 8) | ((u16)(DATA) & 0xFF)))
+
+/* Bitboard with all LEDs lit, byte N holds segments/columns of digit N */
+#define MAX7219_BITBOARD_ALL_ON  UINT64_C(0xFFFFFFFFFFFFFFFF)
+#define MAX7219_BITBOARD_ALL_OFF UINT64_C(0)
+
+/* Extract single digit row from bitboard */
+#define MAX7219_BITBOARD_ROW(BITBOARD, DIGIT) \
+    ((u8)(((BITBOARD) >> (8 * (DIGIT))) & 0xFF))
+
+/* Digit registers contents after power-up, datasheet leaves them undefined */
+#define MAX7219_POWER_ON_DIGIT_DEFAULT 0x00
+
+/* Dirty flags - registers which affect rendered output */
+#define MAX7219_DIRTY_DIGIT        (1u << 0)
+#define MAX7219_DIRTY_DECODE_MODE  (1u << 1)
+#define MAX7219_DIRTY_SCAN_LIMIT   (1u << 2)
+#define MAX7219_DIRTY_SHUTDOWN     (1u << 3)
+#define MAX7219_DIRTY_DISPLAY_TEST (1u << 4)
+
+/* Returned by MAX7219_Write for frames which leave registers unchanged */
+#define MAX7219_WRITE_REDUNDANT    (1u << 7)
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent register address map
+ */
+typedef enum
+{
+    MAX7219_RegNoOp = 0x0,        /**< No-op, used to pass data down the chain */
+    MAX7219_RegDigit0 = 0x1,      /**< First digit register */
+    MAX7219_RegDigit7 = 0x8,      /**< Last digit register */
+    MAX7219_RegDecodeMode = 0x9,  /**< Code B decode mode, one bit per digit */
+    MAX7219_RegIntensity = 0xA,   /**< Intensity (PWM duty cycle) */
+    MAX7219_RegScanLimit = 0xB,   /**< Number of scanned digits minus one */
+    MAX7219_RegShutdown = 0xC,    /**< Shutdown (D0 = 0) or normal operation */
+    MAX7219_RegDisplayTest = 0xF  /**< Display test (D0 = 1) */
+} MAX7219_Register;
+
+/**
+ * @brief Single device register file
+ *
+ * After power-up all control registers are cleared: the device is in shutdown,
+ * display test is off, no digit is decoded, intensity is at 1/32 duty cycle
+ * and only digit 0 is scanned. Digit registers hold undefined values.
+ */
+typedef struct
+{
+    u8 digit[MAX7219_DIGITS]; /**< Digit registers as written */
+    u8 decodeMode;            /**< Decode mode register */
+    u8 intensity;             /**< Intensity register */
+    u8 scanLimit;             /**< Scan limit register */
+    u8 shutdown;              /**< Shutdown register */
+    u8 displayTest;           /**< Display test register */
+    u8 dirty;                 /**< Combination of MAX7219_DIRTY_* flags */
+} MAX7219_Device;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Put the device into its power-on state.
+ *
+ * @param device     Pointer to the device
+ * @param digitValue Value emulating undefined contents of digit registers
+ */
+void MAX7219_PowerOn(MAX7219_Device* device, u8 digitValue);
+
+/**
+ * @brief Apply single serial frame to the device registers.
+ *
+ * The function decodes the frame, updates addressed register and marks
+ * rendered state dirty only when the write can affect visible output. Digit
+ * writes outside of scan limit or during shutdown/display test still land in
+ * the register file, but do not cause rendering. Writes of the value already
+ * held by the register are detected before decoding and never mark dirty.
+ *
+ * @param device Pointer to the device
+ * @param frame  16-bit serial frame (D15-D12 are ignored)
+ *
+ * @return Dirty flags raised by this particular write, or
+ * MAX7219_WRITE_REDUNDANT if the register already held the value
+ */
+u8 MAX7219_Write(MAX7219_Device* device, u16 frame);
+
+/**
+ * @brief Recompute visible output from the register file.
+ *
+ * The output is a bitboard where byte N holds segments (or matrix columns)
+ * of digit N. Display test, shutdown and scan limit are applied as whole-word
+ * operations.
+ *
+ * @param device Pointer to the device. Dirty flags are cleared afterwards
+ *
+ * @return Visible output of the device
+ */
+u64 MAX7219_Render(MAX7219_Device* device);
+
+/**
+ * @brief Get bitboard mask of digits enabled by scan limit register.
+ *
+ * @param scanLimit Scan limit register contents
+ * @return Mask with all bits of scanned digits set
+ */
+static inline u64 MAX7219_ScanLimitMask(u8 scanLimit)
+{
+    u8 digits = (scanLimit & 0x07) + 1;
+    return (digits == MAX7219_DIGITS)
+            ? MAX7219_BITBOARD_ALL_ON
+            : (UINT64_C(1) << (8 * digits)) - 1;
+}
+
+/**
+ * @brief Check whether the device is in shutdown mode.
+ *
+ * @param device Pointer to the device
+ * @return True if shutdown register D0 bit is cleared
+ */
+static inline bool MAX7219_IsShutdown(const MAX7219_Device* device)
+{
+    return (device->shutdown & 0x01) == 0;
+}
+
+/**
+ * @brief Check whether the device is in display test mode.
+ *
+ * @param device Pointer to the device
+ * @return True if display test register D0 bit is set
+ */
+static inline bool MAX7219_IsDisplayTest(const MAX7219_Device* device)
+{
+    return (device->displayTest & 0x01) != 0;
+}
+
+/**
+ * @brief Translate 4-bit value into segments using Code B font.
+ *
+ * @param value Digit register contents. D7 (decimal point) is preserved
+ * @return Segments DP, A-G in bits D7-D0
+ */
+u8 MAX7219_CodeB(u8 value);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // MAX7219_H
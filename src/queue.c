@@ -0,0 +1,152 @@
+#include "queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Round up to the nearest power of two */
+static size NextPowerOfTwo(size value)
+{
+    size power = 1;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+
+/* Number of frames ready to be consumed, refreshes cached tail if needed */
+static size Readable(QUEUE_Instance* queue, size head, size max)
+{
+    size available = queue->cachedTail - head;
+    if (available < max) {
+        queue->cachedTail =
+                atomic_load_explicit(&queue->tail, memory_order_acquire);
+        available = queue->cachedTail - head;
+    }
+    return (available < max) ? available : max;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+QUEUE_Status QUEUE_Create(QUEUE_Instance* queue, size capacity)
+{
+    COMMON_NULLPTR_GUARD(queue, QUEUE_StatusNullPtr);
+
+    if (capacity == 0) {
+        return QUEUE_StatusWrongSize;
+    }
+
+    memset(queue, 0, sizeof(*queue));
+    capacity = NextPowerOfTwo(capacity);
+    queue->frames = malloc(capacity * sizeof(*queue->frames));
+    COMMON_NULLPTR_GUARD(queue->frames, QUEUE_StatusMemError);
+
+    queue->mask = capacity - 1;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    atomic_init(&queue->closed, false);
+
+    return QUEUE_StatusOk;
+}
+
+void QUEUE_Destroy(QUEUE_Instance* queue)
+{
+    if (queue == NULL) {
+        return;
+    }
+
+    free(queue->frames);
+    memset(queue, 0, sizeof(*queue));
+}
+
+size QUEUE_Push(QUEUE_Instance* queue, const u16* frames, size count)
+{
+    size tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    size capacity = QUEUE_Capacity(queue);
+
+    size space = capacity - (tail - queue->cachedHead);
+    if (space < count) {
+        queue->cachedHead =
+                atomic_load_explicit(&queue->head, memory_order_acquire);
+        space = capacity - (tail - queue->cachedHead);
+    }
+    if (count > space) {
+        count = space;
+    }
+
+    /* Copy in at most two parts because of wrap-around */
+    size offset = tail & queue->mask;
+    size first = (count < capacity - offset) ? count : capacity - offset;
+    memcpy(&queue->frames[offset], frames, first * sizeof(*frames));
+    memcpy(queue->frames, &frames[first], (count - first) * sizeof(*frames));
+
+    atomic_store_explicit(&queue->tail, tail + count, memory_order_release);
+    return count;
+}
+
+size QUEUE_Pop(QUEUE_Instance* queue, u16* frames, size max)
+{
+    size head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    size count = Readable(queue, head, max);
+    size capacity = QUEUE_Capacity(queue);
+
+    size offset = head & queue->mask;
+    size first = (count < capacity - offset) ? count : capacity - offset;
+    memcpy(frames, &queue->frames[offset], first * sizeof(*frames));
+    memcpy(&frames[first], queue->frames, (count - first) * sizeof(*frames));
+
+    atomic_store_explicit(&queue->head, head + count, memory_order_release);
+    return count;
+}
+
+size QUEUE_PopToChain(QUEUE_Instance* queue, CHAIN_Instance* chain, size max)
+{
+    size head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    size count = Readable(queue, head, max);
+    size capacity = QUEUE_Capacity(queue);
+
+    size offset = head & queue->mask;
+    size first = (count < capacity - offset) ? count : capacity - offset;
+    CHAIN_Feed(chain, &queue->frames[offset], first);
+    CHAIN_Feed(chain, queue->frames, count - first);
+
+    atomic_store_explicit(&queue->head, head + count, memory_order_release);
+    return count;
+}
+
+size QUEUE_Peek(QUEUE_Instance* queue, const u16** frames, size max)
+{
+    size head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    size count = Readable(queue, head, max);
+
+    size offset = head & queue->mask;
+    size contiguous = QUEUE_Capacity(queue) - offset;
+    *frames = &queue->frames[offset];
+    return (count < contiguous) ? count : contiguous;
+}
+
+void QUEUE_Advance(QUEUE_Instance* queue, size count)
+{
+    size head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    atomic_store_explicit(&queue->head, head + count, memory_order_release);
+}
+
+void QUEUE_Close(QUEUE_Instance* queue)
+{
+    atomic_store_explicit(&queue->closed, true, memory_order_release);
+}
+
+bool QUEUE_IsDrained(QUEUE_Instance* queue)
+{
+    /* Closing happens after the last push, so the tail read below is final */
+    if (!atomic_load_explicit(&queue->closed, memory_order_acquire)) {
+        return false;
+    }
+    size head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    return Readable(queue, head, 1) == 0;
+}
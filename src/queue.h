@@ -0,0 +1,172 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include "common.h"
+#include "chain.h"
+
+#include <stdatomic.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Assumed cache line size used for padding of shared indices */
+#define QUEUE_CACHE_LINE 64
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    QUEUE_StatusOk = 0,    /**< OK */
+    QUEUE_StatusNullPtr,   /**< Null pointer was passed to API function */
+    QUEUE_StatusMemError,  /**< Memory allocation error */
+    QUEUE_StatusWrongSize  /**< Capacity is zero */
+} QUEUE_Status;
+
+/**
+ * @brief Wait-free single-producer/single-consumer ring buffer of frames
+ *
+ * Producer and consumer indices live on separate cache lines, each side keeps
+ * a private copy of the opposite index and refreshes it only when the queue
+ * looks full (producer) or empty (consumer). The producer closes the queue
+ * after its last push, so the consumer can tell a drained queue from a slow
+ * producer.
+ */
+typedef struct
+{
+    _Alignas(QUEUE_CACHE_LINE) atomic_size_t head; /**< Next frame to pop */
+    size cachedTail;                               /**< Consumer view of tail */
+    _Alignas(QUEUE_CACHE_LINE) atomic_size_t tail; /**< Next free slot */
+    size cachedHead;                               /**< Producer view of head */
+    atomic_bool closed;                            /**< No more frames follow */
+    _Alignas(QUEUE_CACHE_LINE) u16* frames;        /**< Frame storage */
+    size mask;                                     /**< Capacity minus one */
+} QUEUE_Instance;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create queue.
+ *
+ * @param queue    Queue instance to be initialized
+ * @param capacity Minimal number of frames, rounded up to a power of two
+ *
+ * @return Instance of QUEUE_Status. The function possible return values are:
+ * - QUEUE_StatusNullPtr when null pointer was passed to function
+ * - QUEUE_StatusWrongSize when capacity is zero
+ * - QUEUE_StatusMemError when there was a memory allocation error
+ * - QUEUE_StatusOk after success
+ */
+QUEUE_Status QUEUE_Create(QUEUE_Instance* queue, size capacity);
+
+/**
+ * @brief Release memory owned by the queue.
+ *
+ * @param queue Queue created with QUEUE_Create
+ */
+void QUEUE_Destroy(QUEUE_Instance* queue);
+
+/**
+ * @brief Push as many frames as fit into the queue (producer side).
+ *
+ * @param queue  Pointer to the queue
+ * @param frames Frames to be pushed
+ * @param count  Number of frames
+ *
+ * @return Number of frames actually pushed
+ */
+size QUEUE_Push(QUEUE_Instance* queue, const u16* frames, size count);
+
+/**
+ * @brief Pop up to max frames into caller buffer (consumer side).
+ *
+ * @param queue  Pointer to the queue
+ * @param frames Output buffer
+ * @param max    Size of output buffer
+ *
+ * @return Number of frames popped
+ */
+size QUEUE_Pop(QUEUE_Instance* queue, u16* frames, size max);
+
+/**
+ * @brief Feed queued frames directly to the chain (consumer side).
+ *
+ * Frames are passed to CHAIN_Feed straight from the ring storage in at most
+ * two contiguous batches, without copying.
+ *
+ * @param queue Pointer to the queue
+ * @param chain Chain to be fed
+ * @param max   Maximal number of frames to be consumed
+ *
+ * @return Number of frames consumed
+ */
+size QUEUE_PopToChain(QUEUE_Instance* queue, CHAIN_Instance* chain, size max);
+
+/**
+ * @brief Get contiguous run of queued frames without consuming them (consumer
+ * side).
+ *
+ * The run ends at the wrap-around point of the ring, the rest is returned by
+ * the next call after QUEUE_Advance.
+ *
+ * @param queue  Pointer to the queue
+ * @param frames The buffer in which pointer to the first frame is stored
+ * @param max    Maximal number of frames
+ *
+ * @return Number of frames readable at frames
+ */
+size QUEUE_Peek(QUEUE_Instance* queue, const u16** frames, size max);
+
+/**
+ * @brief Consume frames obtained with QUEUE_Peek (consumer side).
+ *
+ * @param queue Pointer to the queue
+ * @param count Number of frames, at most the value returned by QUEUE_Peek
+ */
+void QUEUE_Advance(QUEUE_Instance* queue, size count);
+
+/**
+ * @brief Mark the end of the stream (producer side).
+ *
+ * Frames pushed before remain readable.
+ *
+ * @param queue Pointer to the queue
+ */
+void QUEUE_Close(QUEUE_Instance* queue);
+
+/**
+ * @brief Check whether the queue is closed and every frame was consumed
+ * (consumer side).
+ *
+ * @param queue Pointer to the queue
+ * @return True when no frame will ever be readable again
+ */
+bool QUEUE_IsDrained(QUEUE_Instance* queue);
+
+/**
+ * @brief Get queue capacity.
+ *
+ * @param queue Pointer to the queue
+ * @return Maximal number of queued frames
+ */
+static inline size QUEUE_Capacity(const QUEUE_Instance* queue)
+{
+    return queue->mask + 1;
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // QUEUE_H
@@ -0,0 +1,198 @@
+#include "scan.h"
+#include "brightness.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Event ordering, ties are broken by device index to stay deterministic */
+static inline bool EventBefore(const SCAN_Event* a, const SCAN_Event* b)
+{
+    return (a->time != b->time) ? a->time < b->time : a->device < b->device;
+}
+
+/* Insert event into the heap */
+static void HeapPush(SCAN_Instance* scan, SCAN_Event event)
+{
+    size index = scan->heapSize++;
+    while (index > 0) {
+        size parent = (index - 1) / 2;
+        if (!EventBefore(&event, &scan->heap[parent])) {
+            break;
+        }
+        scan->heap[index] = scan->heap[parent];
+        index = parent;
+    }
+    scan->heap[index] = event;
+}
+
+/* Remove the earliest event from the heap */
+static SCAN_Event HeapPop(SCAN_Instance* scan)
+{
+    SCAN_Event top = scan->heap[0];
+    SCAN_Event last = scan->heap[--scan->heapSize];
+
+    size index = 0;
+    for (;;) {
+        size child = 2 * index + 1;
+        if (child >= scan->heapSize) {
+            break;
+        }
+        if (child + 1 < scan->heapSize
+                && EventBefore(&scan->heap[child + 1], &scan->heap[child])) {
+            ++child;
+        }
+        if (!EventBefore(&scan->heap[child], &last)) {
+            break;
+        }
+        scan->heap[index] = scan->heap[child];
+        index = child;
+    }
+    if (scan->heapSize > 0) {
+        scan->heap[index] = last;
+    }
+    return top;
+}
+
+/* Schedule device starting from the first digit */
+static void WakeUp(SCAN_Instance* scan, size device)
+{
+    if (scan->scheduled[device]) {
+        return;
+    }
+
+    scan->scheduled[device] = true;
+    scan->nextDigit[device] = 0;
+    HeapPush(scan, (SCAN_Event){.time = scan->now, .device = device});
+}
+
+/* Handle beginning of digit period */
+static void ProcessEvent(SCAN_Instance* scan, SCAN_Event event)
+{
+    const MAX7219_Device* device = &scan->chain->devices[event.device];
+    u64 bitboard = scan->chain->framebuffer[event.device];
+
+    /* Blank device goes to sleep until the next sync wakes it up */
+    if (bitboard == MAX7219_BITBOARD_ALL_OFF) {
+        scan->scheduled[event.device] = false;
+        return;
+    }
+
+    u8 digits = BRIGHTNESS_ScannedDigits(device);
+    u8 digit = scan->nextDigit[event.device];
+    if (digit >= digits) {
+        digit = 0;
+    }
+
+    u8 segments = MAX7219_BITBOARD_ROW(bitboard, digit);
+    if (segments != 0) {
+        SCAN_Interval interval = {
+            .device = event.device,
+            .digit = digit,
+            .segments = segments,
+            .start = event.time,
+            .end = event.time
+                    + scan->digitPeriod * BRIGHTNESS_DutySteps(device)
+                            / BRIGHTNESS_DUTY_STEPS
+        };
+        scan->callback(scan->context, &interval);
+    }
+
+    scan->nextDigit[event.device] = digit + 1;
+    event.time += scan->digitPeriod;
+    HeapPush(scan, event);
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+SCAN_Status SCAN_Create(
+        SCAN_Instance* scan,
+        CHAIN_Instance* chain,
+        u64 digitPeriod,
+        SCAN_IntervalCallback callback,
+        void* context)
+{
+    COMMON_NULLPTR_GUARD(scan, SCAN_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(chain, SCAN_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(callback, SCAN_StatusNullPtr);
+
+    /* Events would never advance and SCAN_Advance would not return */
+    if (digitPeriod == 0) {
+        return SCAN_StatusWrongTime;
+    }
+
+    memset(scan, 0, sizeof(*scan));
+    scan->heap = calloc(chain->length, sizeof(*scan->heap));
+    scan->nextDigit = calloc(chain->length, sizeof(*scan->nextDigit));
+    scan->scheduled = calloc(chain->length, sizeof(*scan->scheduled));
+
+    if (scan->heap == NULL
+            || scan->nextDigit == NULL
+            || scan->scheduled == NULL) {
+        SCAN_Destroy(scan);
+        return SCAN_StatusMemError;
+    }
+
+    scan->chain = chain;
+    scan->callback = callback;
+    scan->context = context;
+    scan->digitPeriod = digitPeriod;
+
+    /* Devices lit before the simulator was attached must be scanned too */
+    CHAIN_Render(chain);
+    for (size i = 0; i < chain->length; ++i) {
+        if (chain->framebuffer[i] != MAX7219_BITBOARD_ALL_OFF) {
+            WakeUp(scan, i);
+        }
+    }
+    scan->syncedTick = chain->tick;
+
+    return SCAN_StatusOk;
+}
+
+void SCAN_Destroy(SCAN_Instance* scan)
+{
+    if (scan == NULL) {
+        return;
+    }
+
+    free(scan->heap);
+    free(scan->nextDigit);
+    free(scan->scheduled);
+    memset(scan, 0, sizeof(*scan));
+}
+
+void SCAN_Sync(SCAN_Instance* scan)
+{
+    CHAIN_Instance* chain = scan->chain;
+
+    CHAIN_Render(chain);
+    for (size i = 0; i < chain->length; ++i) {
+        if (chain->changedTick[i] > scan->syncedTick
+                && chain->framebuffer[i] != MAX7219_BITBOARD_ALL_OFF) {
+            WakeUp(scan, i);
+        }
+    }
+    scan->syncedTick = chain->tick;
+}
+
+SCAN_Status SCAN_Advance(SCAN_Instance* scan, u64 time)
+{
+    COMMON_NULLPTR_GUARD(scan, SCAN_StatusNullPtr);
+
+    if (time < scan->now) {
+        return SCAN_StatusWrongTime;
+    }
+
+    while (scan->heapSize > 0 && scan->heap[0].time < time) {
+        ProcessEvent(scan, HeapPop(scan));
+    }
+    scan->now = time;
+
+    return SCAN_StatusOk;
+}
@@ -0,0 +1,154 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include "common.h"
+#include "chain.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Time each digit is selected, 800 Hz typical scan rate with 8 digits */
+#define SCAN_DEFAULT_DIGIT_PERIOD_NS 156250
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    SCAN_StatusOk = 0,    /**< OK */
+    SCAN_StatusNullPtr,   /**< Null pointer was passed to API function */
+    SCAN_StatusMemError,  /**< Memory allocation error */
+    SCAN_StatusWrongTime  /**< Time lies in the simulated past or period is 0 */
+} SCAN_Status;
+
+/**
+ * @brief Single period of time during which a digit of a device is lit
+ */
+typedef struct
+{
+    size device; /**< Device index in the chain */
+    u8 digit;    /**< Digit index */
+    u8 segments; /**< Lit segments/columns */
+    u64 start;   /**< Simulated time of switching the digit on [ns] */
+    u64 end;     /**< Simulated time of switching the digit off [ns] */
+} SCAN_Interval;
+
+/**
+ * @brief Interval consumer type
+ */
+typedef void (*SCAN_IntervalCallback)(void* context, const SCAN_Interval* interval);
+
+/**
+ * @brief Pending digit switch of a device
+ */
+typedef struct
+{
+    u64 time;    /**< Simulated time of the switch [ns] */
+    size device; /**< Device index in the chain */
+} SCAN_Event;
+
+/**
+ * @brief Time-domain multiplex scanning simulator bound to a chain
+ *
+ * Only devices with at least one lit LED own a pending event, so devices which
+ * are blank or in shutdown do not cost anything while the clock advances.
+ */
+typedef struct
+{
+    CHAIN_Instance* chain;          /**< Simulated chain */
+    SCAN_IntervalCallback callback; /**< Interval consumer */
+    void* context;                  /**< Consumer context */
+    SCAN_Event* heap;               /**< Min-heap of pending events */
+    size heapSize;                  /**< Number of pending events */
+    u8* nextDigit;                  /**< Digit selected on the next event */
+    bool* scheduled;                /**< Whether device owns pending event */
+    u64 digitPeriod;                /**< Time each digit is selected [ns] */
+    u64 now;                        /**< Simulated clock [ns] */
+    u64 syncedTick;                 /**< Chain tick seen by the last sync */
+} SCAN_Instance;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create scanning simulator for a chain.
+ *
+ * @param scan        Simulator instance to be initialized
+ * @param chain       Chain to be simulated. It must outlive the simulator
+ * @param digitPeriod Time each digit is selected [ns], e.g.
+ * SCAN_DEFAULT_DIGIT_PERIOD_NS
+ * @param callback    Function receiving emitted on-intervals
+ * @param context     User context passed to callback
+ *
+ * @return Instance of SCAN_Status. The function possible return values are:
+ * - SCAN_StatusNullPtr when null pointer was passed to function
+ * - SCAN_StatusWrongTime when digit period is zero
+ * - SCAN_StatusMemError when there was a memory allocation error
+ * - SCAN_StatusOk after success
+ */
+SCAN_Status SCAN_Create(
+        SCAN_Instance* scan,
+        CHAIN_Instance* chain,
+        u64 digitPeriod,
+        SCAN_IntervalCallback callback,
+        void* context);
+
+/**
+ * @brief Release memory owned by the simulator.
+ *
+ * @param scan Simulator created with SCAN_Create
+ */
+void SCAN_Destroy(SCAN_Instance* scan);
+
+/**
+ * @brief Wake up devices which became visible since the previous sync.
+ *
+ * Call the function after feeding frames to the chain. Woken devices start
+ * scanning from digit 0 at the current simulated time.
+ *
+ * @param scan Pointer to the simulator
+ */
+void SCAN_Sync(SCAN_Instance* scan);
+
+/**
+ * @brief Advance simulated clock emitting all on-intervals started meanwhile.
+ *
+ * Intensity and scan limit are sampled at the beginning of every digit period,
+ * devices which turned blank are put to sleep on their next event.
+ *
+ * @param scan Pointer to the simulator
+ * @param time Absolute simulated time to advance to [ns]
+ *
+ * @return Instance of SCAN_Status. The function possible return values are:
+ * - SCAN_StatusNullPtr when null pointer was passed to function
+ * - SCAN_StatusWrongTime when time is earlier than the current one
+ * - SCAN_StatusOk after success
+ */
+SCAN_Status SCAN_Advance(SCAN_Instance* scan, u64 time);
+
+/**
+ * @brief Count devices which own pending event.
+ *
+ * @param scan Pointer to the simulator
+ * @return Number of scanned devices
+ */
+static inline size SCAN_CountActive(const SCAN_Instance* scan)
+{
+    return scan->heapSize;
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // SCAN_H
@@ -0,0 +1,523 @@
+#include "server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Events taken from epoll at once */
+#define MAX_EVENTS 64
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Client connection with its own chains */
+typedef struct Connection
+{
+    struct Connection* prev;
+    struct Connection* next;
+    int fd;
+    CHAIN_Instance* chains;
+    u8* input;
+    size inputLength;
+    size inputCapacity;
+    u8* output;
+    size outputLength;
+    size outputSent;
+} Connection;
+
+/* Single event loop */
+typedef struct
+{
+    SERVER_Instance* server;
+    SERVER_Stats* stats;
+    int epollFd;
+    Connection* connections;
+    SERVER_Status status;
+} Loop;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private variables -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Addresses telling the listening socket and stop event apart from connections */
+static char listenMarker;
+static char stopMarker;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Size of display reply payload */
+static size DisplaySize(const SERVER_Instance* server)
+{
+    return server->chains * server->devices * sizeof(u64);
+}
+
+/* Register file descriptor in the loop */
+static bool Watch(Loop* loop, int fd, u32 events, void* data)
+{
+    struct epoll_event event = {.events = events, .data.ptr = data};
+    return epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+/* Switch connection between reading requests and flushing a reply */
+static void Rearm(Loop* loop, Connection* connection, u32 events)
+{
+    struct epoll_event event = {.events = events, .data.ptr = connection};
+    epoll_ctl(loop->epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+}
+
+/* Close connection and release its memory */
+static void Drop(Loop* loop, Connection* connection)
+{
+    if (connection->prev != NULL) {
+        connection->prev->next = connection->next;
+    } else {
+        loop->connections = connection->next;
+    }
+    if (connection->next != NULL) {
+        connection->next->prev = connection->prev;
+    }
+
+    close(connection->fd);
+    if (connection->chains != NULL) {
+        for (size i = 0; i < loop->server->chains; ++i) {
+            CHAIN_Destroy(&connection->chains[i]);
+        }
+    }
+    free(connection->chains);
+    free(connection->input);
+    free(connection->output);
+    free(connection);
+}
+
+/* Set up connection state for accepted socket */
+static bool Admit(Loop* loop, int fd)
+{
+    const SERVER_Instance* server = loop->server;
+    Connection* connection = calloc(1, sizeof(Connection));
+    if (connection == NULL) {
+        close(fd);
+        return false;
+    }
+
+    connection->fd = fd;
+    connection->next = loop->connections;
+    if (loop->connections != NULL) {
+        loop->connections->prev = connection;
+    }
+    loop->connections = connection;
+
+    connection->chains = calloc(server->chains, sizeof(CHAIN_Instance));
+    connection->output = malloc(sizeof(SERVER_Header) + DisplaySize(server));
+    if (connection->chains == NULL || connection->output == NULL) {
+        Drop(loop, connection);
+        return false;
+    }
+    for (size i = 0; i < server->chains; ++i) {
+        if (CHAIN_Create(&connection->chains[i], server->devices) != CHAIN_StatusOk) {
+            Drop(loop, connection);
+            return false;
+        }
+    }
+
+    if (!Watch(loop, fd, EPOLLIN, connection)) {
+        Drop(loop, connection);
+        return false;
+    }
+    ++loop->stats->connections;
+    return true;
+}
+
+/* Accept every pending connection */
+static void AcceptAll(Loop* loop)
+{
+    for (;;) {
+        int fd = accept(loop->server->listenFd, NULL, NULL);
+        if (fd < 0) {
+            /* Another loop may have taken it, or the client gave up already */
+            return;
+        }
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        Admit(loop, fd);
+    }
+}
+
+/* Write pending reply, returns false if the connection is broken */
+static bool Flush(Connection* connection)
+{
+    while (connection->outputSent < connection->outputLength) {
+        ssize_t written = send(connection->fd,
+                connection->output + connection->outputSent,
+                connection->outputLength - connection->outputSent, MSG_NOSIGNAL);
+        if (written < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        connection->outputSent += (size)written;
+    }
+
+    connection->outputLength = 0;
+    connection->outputSent = 0;
+    return true;
+}
+
+/* Render chains into reply */
+static void ReplyDisplay(Loop* loop, Connection* connection, u16 chain)
+{
+    const SERVER_Instance* server = loop->server;
+    SERVER_Header header = {
+        .length = (u32)DisplaySize(server),
+        .type = SERVER_MessageDisplay,
+        .chain = chain
+    };
+    memcpy(connection->output, &header, sizeof(header));
+
+    u8* payload = connection->output + sizeof(header);
+    for (size i = 0; i < server->chains; ++i) {
+        CHAIN_Render(&connection->chains[i]);
+        memcpy(payload + i * server->devices * sizeof(u64),
+                connection->chains[i].framebuffer, server->devices * sizeof(u64));
+    }
+
+    connection->outputLength = sizeof(header) + header.length;
+    connection->outputSent = 0;
+    ++loop->stats->displays;
+}
+
+/* Check request header, malformed ones close the connection */
+static bool IsValid(const SERVER_Instance* server, const SERVER_Header* header)
+{
+    switch (header->type) {
+    case SERVER_MessageFrames:
+        return header->length <= SERVER_MAX_PAYLOAD
+                && header->length % sizeof(u16) == 0
+                && header->chain < server->chains;
+    case SERVER_MessageDisplay:
+    case SERVER_MessageReset:
+        return header->length == 0;
+    default:
+        return false;
+    }
+}
+
+/*
+ * Handle complete requests in the input buffer. Processing pauses while a
+ * reply cannot be written, so a client not reading replies is throttled
+ * instead of growing the output. Returns false if the connection is broken.
+ */
+static bool Process(Loop* loop, Connection* connection)
+{
+    const SERVER_Instance* server = loop->server;
+    size offset = 0;
+    bool alive = true;
+
+    while (connection->inputLength - offset >= sizeof(SERVER_Header)) {
+        SERVER_Header header;
+        memcpy(&header, connection->input + offset, sizeof(header));
+        if (!IsValid(server, &header)) {
+            ++loop->stats->rejected;
+            return false;
+        }
+        if (connection->inputLength - offset < sizeof(header) + header.length) {
+            break;
+        }
+
+        /* Payloads have even length, so frames stay aligned in the buffer */
+        const u8* payload = connection->input + offset + sizeof(header);
+        offset += sizeof(header) + header.length;
+        ++loop->stats->messages;
+
+        if (header.type == SERVER_MessageFrames) {
+            size count = header.length / sizeof(u16);
+            CHAIN_Feed(&connection->chains[header.chain], (const u16*)payload, count);
+            loop->stats->frames += count;
+        } else if (header.type == SERVER_MessageReset) {
+            for (size i = 0; i < server->chains; ++i) {
+                CHAIN_PowerOn(&connection->chains[i], MAX7219_POWER_ON_DIGIT_DEFAULT);
+            }
+        } else {
+            ReplyDisplay(loop, connection, header.chain);
+            alive = Flush(connection);
+            if (!alive || connection->outputLength != 0) {
+                break;
+            }
+        }
+    }
+
+    connection->inputLength -= offset;
+    memmove(connection->input, connection->input + offset, connection->inputLength);
+
+    if (alive && connection->outputLength != 0) {
+        Rearm(loop, connection, EPOLLOUT);
+    }
+    return alive;
+}
+
+/* Read available requests, returns false if the connection is finished */
+static bool Receive(Loop* loop, Connection* connection)
+{
+    /* Room for the largest message and one more read */
+    size needed = connection->inputLength + SERVER_READ_SIZE;
+    if (needed > connection->inputCapacity) {
+        u8* input = realloc(connection->input, needed);
+        if (input == NULL) {
+            return false;
+        }
+        connection->input = input;
+        connection->inputCapacity = needed;
+    }
+
+    ssize_t count = read(connection->fd, connection->input + connection->inputLength,
+            SERVER_READ_SIZE);
+    if (count == 0) {
+        return false;
+    }
+    if (count < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+
+    connection->inputLength += (size)count;
+    return Process(loop, connection);
+}
+
+/* Handle readiness of a connection */
+static void Serve(Loop* loop, Connection* connection, u32 events)
+{
+    bool alive;
+    if (events & EPOLLOUT) {
+        alive = Flush(connection);
+        if (alive && connection->outputLength == 0) {
+            Rearm(loop, connection, EPOLLIN);
+            alive = Process(loop, connection);
+        }
+    } else if (events & EPOLLIN) {
+        alive = Receive(loop, connection);
+    } else {
+        alive = false;
+    }
+
+    if (!alive) {
+        Drop(loop, connection);
+    }
+}
+
+/* Event loop thread entry point */
+static void* LoopMain(void* argument)
+{
+    Loop* loop = argument;
+    SERVER_Instance* server = loop->server;
+
+    loop->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epollFd < 0
+            || !Watch(loop, server->stopFd, EPOLLIN, &stopMarker)
+            || !Watch(loop, server->listenFd, EPOLLIN | EPOLLEXCLUSIVE, &listenMarker)) {
+        loop->status = SERVER_StatusIoError;
+        SERVER_Stop(server);
+    }
+
+    bool stopped = loop->status != SERVER_StatusOk;
+    struct epoll_event events[MAX_EVENTS];
+    while (!stopped) {
+        int count = epoll_wait(loop->epollFd, events, MAX_EVENTS, -1);
+        for (int i = 0; i < count; ++i) {
+            void* data = events[i].data.ptr;
+            if (data == &stopMarker) {
+                stopped = true;
+            } else if (data == &listenMarker) {
+                AcceptAll(loop);
+            } else {
+                Serve(loop, data, events[i].events);
+            }
+        }
+    }
+
+    while (loop->connections != NULL) {
+        Drop(loop, loop->connections);
+    }
+    if (loop->epollFd >= 0) {
+        close(loop->epollFd);
+    }
+    return NULL;
+}
+
+/* Remove socket of a server which is gone, returns false if path is in use */
+static bool ReclaimPath(const struct sockaddr_un* address)
+{
+    struct stat status;
+    if (lstat(address->sun_path, &status) != 0) {
+        return errno == ENOENT;
+    }
+    if (!S_ISSOCK(status.st_mode)) {
+        return false;
+    }
+
+    /* Nobody listens on a stale socket */
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    bool stale = connect(fd, (const struct sockaddr*)address, sizeof(*address)) != 0
+            && errno == ECONNREFUSED;
+    close(fd);
+    return stale && unlink(address->sun_path) == 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+SERVER_Status SERVER_Create(SERVER_Instance* server, const char* path, size chains,
+        size devices, size workers)
+{
+    COMMON_NULLPTR_GUARD(server, SERVER_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(path, SERVER_StatusNullPtr);
+
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    if (chains == 0 || chains > (size)UINT16_MAX + 1 || devices == 0
+            || devices > SERVER_MAX_PAYLOAD / sizeof(u64) / chains
+            || strlen(path) >= sizeof(address.sun_path)) {
+        return SERVER_StatusWrongSize;
+    }
+    strcpy(address.sun_path, path);
+
+    if (workers == SERVER_WORKERS_AUTO) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = (online > 0) ? (size)online : 1;
+    }
+
+    memset(server, 0, sizeof(*server));
+    server->chains = chains;
+    server->devices = devices;
+    server->workers = workers;
+    server->listenFd = -1;
+    server->stopFd = -1;
+    server->path = strdup(path);
+    server->stats = calloc(workers, sizeof(SERVER_Stats));
+    if (server->path == NULL || server->stats == NULL) {
+        SERVER_Destroy(server);
+        return SERVER_StatusMemError;
+    }
+
+    server->listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    server->stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (server->listenFd < 0 || server->stopFd < 0
+            || !ReclaimPath(&address)
+            || bind(server->listenFd, (struct sockaddr*)&address, sizeof(address)) != 0
+            || listen(server->listenFd, SOMAXCONN) != 0) {
+        /* Do not remove a file which may belong to somebody else */
+        free(server->path);
+        server->path = NULL;
+        SERVER_Destroy(server);
+        return SERVER_StatusIoError;
+    }
+    return SERVER_StatusOk;
+}
+
+void SERVER_Destroy(SERVER_Instance* server)
+{
+    if (server == NULL) {
+        return;
+    }
+
+    if (server->listenFd >= 0) {
+        close(server->listenFd);
+    }
+    if (server->stopFd >= 0) {
+        close(server->stopFd);
+    }
+    if (server->path != NULL) {
+        unlink(server->path);
+    }
+    free(server->path);
+    free(server->stats);
+    memset(server, 0, sizeof(*server));
+}
+
+SERVER_Status SERVER_Run(SERVER_Instance* server)
+{
+    COMMON_NULLPTR_GUARD(server, SERVER_StatusNullPtr);
+
+    Loop* loops = calloc(server->workers, sizeof(Loop));
+    pthread_t* threads = malloc(server->workers * sizeof(pthread_t));
+    bool* started = calloc(server->workers, sizeof(bool));
+    if (loops == NULL || threads == NULL || started == NULL) {
+        free(loops);
+        free(threads);
+        free(started);
+        return SERVER_StatusMemError;
+    }
+
+    for (size i = 0; i < server->workers; ++i) {
+        loops[i] = (Loop){
+            .server = server,
+            .stats = &server->stats[i],
+            .epollFd = -1,
+            .status = SERVER_StatusOk
+        };
+    }
+    for (size i = 1; i < server->workers; ++i) {
+        started[i] = pthread_create(&threads[i], NULL, LoopMain, &loops[i]) == 0;
+    }
+    LoopMain(&loops[0]);
+
+    SERVER_Status status = SERVER_StatusOk;
+    for (size i = 0; i < server->workers; ++i) {
+        if (i > 0 && started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+        if (loops[i].status != SERVER_StatusOk) {
+            status = loops[i].status;
+        }
+    }
+
+    /* Consume the stop request, so the server can be run again */
+    u64 value;
+    ssize_t ignored = read(server->stopFd, &value, sizeof(value));
+    (void)ignored;
+
+    free(loops);
+    free(threads);
+    free(started);
+    return status;
+}
+
+void SERVER_Stop(SERVER_Instance* server)
+{
+    if (server == NULL || server->stopFd < 0) {
+        return;
+    }
+
+    u64 value = 1;
+    ssize_t ignored = write(server->stopFd, &value, sizeof(value));
+    (void)ignored;
+}
+
+SERVER_Status SERVER_Total(const SERVER_Instance* server, SERVER_Stats* total)
+{
+    COMMON_NULLPTR_GUARD(server, SERVER_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(total, SERVER_StatusNullPtr);
+
+    memset(total, 0, sizeof(*total));
+    for (size i = 0; i < server->workers; ++i) {
+        total->connections += server->stats[i].connections;
+        total->messages += server->stats[i].messages;
+        total->frames += server->stats[i].frames;
+        total->displays += server->stats[i].displays;
+        total->rejected += server->stats[i].rejected;
+    }
+    return SERVER_StatusOk;
+}
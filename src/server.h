@@ -0,0 +1,174 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "common.h"
+#include "chain.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Start one event loop per online processor */
+#define SERVER_WORKERS_AUTO 0
+
+/* Largest accepted message payload, 512k frames */
+#define SERVER_MAX_PAYLOAD (1u << 20)
+
+/* Bytes read from a connection at once */
+#define SERVER_READ_SIZE (1u << 16)
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    SERVER_StatusOk = 0,     /**< OK */
+    SERVER_StatusNullPtr,    /**< Null pointer was passed to API function */
+    SERVER_StatusMemError,   /**< Memory allocation error */
+    SERVER_StatusWrongSize,  /**< Bad chain count, device count or path */
+    SERVER_StatusIoError     /**< Socket or event loop could not be set up */
+} SERVER_Status;
+
+/**
+ * @brief An enum to represent message types
+ */
+typedef enum
+{
+    SERVER_MessageFrames = 1,  /**< Request: u16 frames fed to the chain */
+    SERVER_MessageDisplay = 2, /**< Request: no payload, reply: bitboards */
+    SERVER_MessageReset = 3    /**< Request: no payload, power-cycle chains */
+} SERVER_MessageType;
+
+/**
+ * @brief Header in front of every message in both directions
+ *
+ * Fields use host byte order, both ends live on the same machine. Frames
+ * payload is a stream of full-chain transactions, the chain is latched every
+ * time one frame per device has been shifted in (see CHAIN_Feed), so one
+ * message may carry thousands of transactions. Display reply carries
+ * chains * devices rendered bitboards, chain 0 first, and echoes the chain
+ * field of the request.
+ */
+typedef struct
+{
+    u32 length; /**< Payload bytes following the header */
+    u16 type;   /**< SERVER_MessageType */
+    u16 chain;  /**< Target chain of frames messages */
+} SERVER_Header;
+
+/**
+ * @brief Counters of a single event loop
+ */
+typedef struct
+{
+    u64 connections; /**< Accepted connections */
+    u64 messages;    /**< Handled requests */
+    u64 frames;      /**< Frames fed to chains */
+    u64 displays;    /**< Display replies sent */
+    u64 rejected;    /**< Connections closed due to malformed messages */
+} SERVER_Stats;
+
+/**
+ * @brief Local socket server
+ *
+ * Every connection gets its own chains of the configured geometry, so any
+ * number of harnesses can drive the server concurrently without affecting
+ * each other. Each event loop has its own epoll instance, connections stay
+ * in the loop which accepted them and need no locking.
+ */
+typedef struct
+{
+    int listenFd;          /**< Listening socket */
+    int stopFd;            /**< Event file signalled by SERVER_Stop */
+    char* path;            /**< Socket path, removed on destroy */
+    size chains;           /**< Chains per connection */
+    size devices;          /**< Devices per chain */
+    size workers;          /**< Number of event loops */
+    SERVER_Stats* stats;   /**< Counters per event loop */
+} SERVER_Instance;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Bind listening Unix-domain stream socket.
+ *
+ * A socket file left at path by a server which is gone (connecting to it is
+ * refused) is replaced. Any other existing file, including the socket of a
+ * running server, is kept and the function fails.
+ *
+ * @param server  Server instance to be initialized
+ * @param path    Socket path
+ * @param chains  Chains per connection, at most UINT16_MAX + 1
+ * @param devices Devices per chain
+ * @param workers Number of event loops or SERVER_WORKERS_AUTO
+ *
+ * @return Instance of SERVER_Status. The function possible return values are:
+ * - SERVER_StatusNullPtr when null pointer was passed to function
+ * - SERVER_StatusWrongSize when counts are invalid, display reply would exceed
+ * SERVER_MAX_PAYLOAD or path is too long
+ * - SERVER_StatusMemError when there was a memory allocation error
+ * - SERVER_StatusIoError when path is in use or the socket could not be bound
+ * - SERVER_StatusOk after success
+ */
+SERVER_Status SERVER_Create(SERVER_Instance* server, const char* path, size chains,
+        size devices, size workers);
+
+/**
+ * @brief Close the socket, remove its file and release memory.
+ *
+ * @param server Server instance created with SERVER_Create, not running
+ */
+void SERVER_Destroy(SERVER_Instance* server);
+
+/**
+ * @brief Serve connections until SERVER_Stop is called.
+ *
+ * Event loop 0 runs on the calling thread. Connections still open when the
+ * server stops are closed.
+ *
+ * @param server Pointer to the server
+ *
+ * @return Instance of SERVER_Status. The function possible return values are:
+ * - SERVER_StatusNullPtr when null pointer was passed to function
+ * - SERVER_StatusMemError when there was a memory allocation error
+ * - SERVER_StatusIoError when an event loop could not be created
+ * - SERVER_StatusOk after the server was stopped
+ */
+SERVER_Status SERVER_Run(SERVER_Instance* server);
+
+/**
+ * @brief Ask running server to stop.
+ *
+ * The function is async-signal-safe and may be called from any thread.
+ *
+ * @param server Pointer to the server
+ */
+void SERVER_Stop(SERVER_Instance* server);
+
+/**
+ * @brief Sum counters of all event loops.
+ *
+ * @param server Pointer to the server
+ * @param total  The buffer in which the sums are stored
+ *
+ * @return Instance of SERVER_Status. The function possible return values are:
+ * - SERVER_StatusNullPtr when null pointer was passed to function
+ * - SERVER_StatusOk after success
+ */
+SERVER_Status SERVER_Total(const SERVER_Instance* server, SERVER_Stats* total);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // SERVER_H
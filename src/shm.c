@@ -0,0 +1,387 @@
+#include "shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Ring entry fields */
+#define ENTRY_LATCH       (1u << 16)
+#define ENTRY_CHAIN_SHIFT 17
+#define ENTRY_FRAME_MASK  0xFFFFu
+
+#define NS_PER_MS 1000000L
+#define MS_PER_SECOND 1000L
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Get size of region holding header, ring and display state */
+static size RegionSize(u32 capacity, u32 chains, u32 devices)
+{
+    return sizeof(SHM_Region)
+            + (size)capacity * sizeof(u32)
+            + (size)chains * devices * sizeof(u64);
+}
+
+/* Point ring arrays into the mapping */
+static void CarveRegion(SHM_Ring* ring)
+{
+    u8* base = (u8*)ring->region;
+    ring->entries = (u32*)(base + sizeof(SHM_Region));
+    ring->state = (u64*)(base + sizeof(SHM_Region)
+            + (size)ring->region->capacity * sizeof(u32));
+}
+
+/* Milliseconds left until deadline, SHM_WAIT_FOREVER stays as is */
+static int Remaining(int timeoutMs, const struct timespec* start)
+{
+    if (timeoutMs < 0) {
+        return SHM_WAIT_FOREVER;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long elapsed = (now.tv_sec - start->tv_sec) * MS_PER_SECOND
+            + (now.tv_nsec - start->tv_nsec) / NS_PER_MS;
+    return (elapsed >= timeoutMs) ? 0 : timeoutMs - (int)elapsed;
+}
+
+/* Sleep while the futex word holds expected value, the word is cross-process */
+static void FutexWait(atomic_uint* word, u32 expected, int timeoutMs)
+{
+    struct timespec timeout;
+    struct timespec* limit = NULL;
+    if (timeoutMs >= 0) {
+        timeout.tv_sec = timeoutMs / MS_PER_SECOND;
+        timeout.tv_nsec = (timeoutMs % MS_PER_SECOND) * NS_PER_MS;
+        limit = &timeout;
+    }
+    syscall(SYS_futex, (u32*)word, FUTEX_WAIT, expected, limit, NULL, 0);
+}
+
+/* Announce progress on a sequence word, wake the other side only if it sleeps */
+static void Notify(atomic_uint* sequence, atomic_uint* waiting)
+{
+    atomic_fetch_add(sequence, 1);
+    if (atomic_load(waiting) != 0) {
+        syscall(SYS_futex, (u32*)sequence, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+/*
+ * Sleep on a sequence word until the observed counter moves or the other side
+ * closes. The waiting flag is raised before the counter is checked again, so
+ * a concurrent Notify either sees the flag or its change is seen here.
+ */
+static bool Wait(atomic_ullong* counter, u64 seen, atomic_uint* sequence,
+        atomic_uint* waiting, atomic_uint* closed, int timeoutMs)
+{
+    u32 expected = atomic_load(sequence);
+    atomic_store(waiting, 1);
+    bool moved = atomic_load(counter) != seen || atomic_load(closed) != 0;
+    if (!moved && timeoutMs != 0) {
+        FutexWait(sequence, expected, timeoutMs);
+    }
+    atomic_store(waiting, 0);
+    return moved;
+}
+
+/* Check object lock, the kernel drops it when the owning emulator dies */
+static bool IsStale(const char* name)
+{
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return errno == ENOENT;
+    }
+    bool stale = flock(fd, LOCK_EX | LOCK_NB) == 0;
+    close(fd);
+    return stale;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+SHM_Status SHM_Create(SHM_Ring* ring, const char* name, u32 capacity, u32 chains,
+        u32 devices)
+{
+    COMMON_NULLPTR_GUARD(ring, SHM_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(name, SHM_StatusNullPtr);
+
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0
+            || chains == 0 || chains > SHM_MAX_CHAINS || devices == 0
+            || strlen(name) >= sizeof(ring->name)) {
+        return SHM_StatusWrongSize;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        if (!IsStale(name)) {
+            return SHM_StatusBusy;
+        }
+        shm_unlink(name);
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        return SHM_StatusIoError;
+    }
+
+    size length = RegionSize(capacity, chains, devices);
+    void* mapping = MAP_FAILED;
+    if (flock(fd, LOCK_EX | LOCK_NB) == 0 && ftruncate(fd, (off_t)length) == 0) {
+        mapping = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (mapping == MAP_FAILED) {
+        shm_unlink(name);
+        close(fd);
+        return SHM_StatusIoError;
+    }
+
+    ring->region = mapping;
+    ring->mappedSize = length;
+    ring->owner = true;
+    ring->lockFd = fd;
+    strcpy(ring->name, name);
+
+    SHM_Region* region = ring->region;
+    region->version = SHM_VERSION;
+    region->capacity = capacity;
+    region->chains = chains;
+    region->devices = devices;
+    atomic_init(&region->head, 0);
+    atomic_init(&region->tail, 0);
+    atomic_init(&region->dataSequence, 0);
+    atomic_init(&region->spaceSequence, 0);
+    atomic_init(&region->consumerWaiting, 0);
+    atomic_init(&region->producerWaiting, 0);
+    atomic_init(&region->producerClosed, 0);
+    atomic_init(&region->consumerClosed, 0);
+    atomic_init(&region->stateSequence, 0);
+    CarveRegion(ring);
+
+    /* Signature goes last, a producer attaching early sees a bad format */
+    atomic_thread_fence(memory_order_release);
+    region->magic = SHM_MAGIC;
+    return SHM_StatusOk;
+}
+
+SHM_Status SHM_Open(SHM_Ring* ring, const char* name)
+{
+    COMMON_NULLPTR_GUARD(ring, SHM_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(name, SHM_StatusNullPtr);
+
+    memset(ring, 0, sizeof(*ring));
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return SHM_StatusIoError;
+    }
+
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (size)info.st_size >= sizeof(SHM_Region)) {
+        mapping = mmap(NULL, (size)info.st_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return SHM_StatusIoError;
+    }
+
+    SHM_Region* region = mapping;
+    atomic_thread_fence(memory_order_acquire);
+    if (region->magic != SHM_MAGIC || region->version != SHM_VERSION
+            || RegionSize(region->capacity, region->chains, region->devices)
+                    != (size)info.st_size) {
+        munmap(mapping, (size)info.st_size);
+        return SHM_StatusBadFormat;
+    }
+
+    ring->region = region;
+    ring->mappedSize = (size)info.st_size;
+    ring->owner = false;
+    ring->lockFd = -1;
+    CarveRegion(ring);
+    return SHM_StatusOk;
+}
+
+void SHM_Close(SHM_Ring* ring)
+{
+    if (ring == NULL || ring->region == NULL) {
+        return;
+    }
+
+    SHM_Region* region = ring->region;
+    if (ring->owner) {
+        atomic_store(&region->consumerClosed, 1);
+        Notify(&region->spaceSequence, &region->producerWaiting);
+        shm_unlink(ring->name);
+        close(ring->lockFd);
+    } else {
+        atomic_store(&region->producerClosed, 1);
+        Notify(&region->dataSequence, &region->consumerWaiting);
+    }
+
+    munmap(ring->region, ring->mappedSize);
+    memset(ring, 0, sizeof(*ring));
+}
+
+SHM_Status SHM_Send(SHM_Ring* ring, u32 chain, const u16* frames, size count,
+        int timeoutMs)
+{
+    COMMON_NULLPTR_GUARD(ring, SHM_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(frames, SHM_StatusNullPtr);
+
+    SHM_Region* region = ring->region;
+    if (chain >= region->chains || count == 0 || count > region->capacity) {
+        return SHM_StatusWrongSize;
+    }
+
+    /* Frames of a transaction are never split, the chain would stay unlatched */
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    u64 head = atomic_load_explicit(&region->head, memory_order_relaxed);
+    for (;;) {
+        if (atomic_load_explicit(&region->consumerClosed, memory_order_acquire)) {
+            return SHM_StatusClosed;
+        }
+
+        u64 tail = atomic_load_explicit(&region->tail, memory_order_acquire);
+        if (region->capacity - (size)(head - tail) >= count) {
+            break;
+        }
+
+        int remaining = Remaining(timeoutMs, &start);
+        if (!Wait(&region->tail, tail, &region->spaceSequence,
+                &region->producerWaiting, &region->consumerClosed, remaining)
+                && remaining == 0) {
+            return SHM_StatusTimeout;
+        }
+    }
+
+    /* The whole transaction becomes visible with a single counter update */
+    u32 mask = region->capacity - 1;
+    u32 tag = chain << ENTRY_CHAIN_SHIFT;
+    for (size i = 0; i < count; ++i) {
+        u32 latch = (i == count - 1) ? ENTRY_LATCH : 0;
+        ring->entries[(head + i) & mask] = tag | latch | frames[i];
+    }
+    atomic_store(&region->head, head + count);
+    Notify(&region->dataSequence, &region->consumerWaiting);
+    return SHM_StatusOk;
+}
+
+SHM_Status SHM_Receive(SHM_Ring* ring, CHAIN_Instance* chains, int timeoutMs,
+        size* received)
+{
+    COMMON_NULLPTR_GUARD(ring, SHM_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(chains, SHM_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(received, SHM_StatusNullPtr);
+
+    SHM_Region* region = ring->region;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    u64 tail = atomic_load_explicit(&region->tail, memory_order_relaxed);
+    u64 head;
+    *received = 0;
+
+    for (;;) {
+        head = atomic_load_explicit(&region->head, memory_order_acquire);
+        if (head != tail) {
+            break;
+        }
+        if (atomic_load_explicit(&region->producerClosed, memory_order_acquire)) {
+            /* Frames published right before closing must not be lost */
+            head = atomic_load_explicit(&region->head, memory_order_acquire);
+            if (head == tail) {
+                return SHM_StatusClosed;
+            }
+            break;
+        }
+
+        int remaining = Remaining(timeoutMs, &start);
+        if (!Wait(&region->head, tail, &region->dataSequence,
+                &region->consumerWaiting, &region->producerClosed, remaining)
+                && remaining == 0) {
+            return SHM_StatusTimeout;
+        }
+    }
+
+    u32 mask = region->capacity - 1;
+    for (u64 position = tail; position != head; ++position) {
+        u32 entry = ring->entries[position & mask];
+        u32 chain = entry >> ENTRY_CHAIN_SHIFT;
+        if (chain >= region->chains) {
+            continue;
+        }
+
+        CHAIN_Shift(&chains[chain], (u16)(entry & ENTRY_FRAME_MASK));
+        if (entry & ENTRY_LATCH) {
+            CHAIN_Latch(&chains[chain]);
+        }
+    }
+
+    *received = (size)(head - tail);
+    atomic_store(&region->tail, head);
+    Notify(&region->spaceSequence, &region->producerWaiting);
+    return SHM_StatusOk;
+}
+
+SHM_Status SHM_PublishState(SHM_Ring* ring, CHAIN_Instance* chains)
+{
+    COMMON_NULLPTR_GUARD(ring, SHM_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(chains, SHM_StatusNullPtr);
+
+    SHM_Region* region = ring->region;
+    for (u32 c = 0; c < region->chains; ++c) {
+        CHAIN_Render(&chains[c]);
+    }
+
+    /* Odd sequence tells readers the state is being rewritten */
+    u32 sequence = atomic_load_explicit(&region->stateSequence, memory_order_relaxed);
+    atomic_store_explicit(&region->stateSequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    for (u32 c = 0; c < region->chains; ++c) {
+        size count = (chains[c].length < region->devices) ? chains[c].length : region->devices;
+        memcpy(ring->state + (size)c * region->devices, chains[c].framebuffer,
+                count * sizeof(u64));
+    }
+
+    atomic_store_explicit(&region->stateSequence, sequence + 2, memory_order_release);
+    return SHM_StatusOk;
+}
+
+SHM_Status SHM_ReadState(const SHM_Ring* ring, u64* bitboards)
+{
+    COMMON_NULLPTR_GUARD(ring, SHM_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(bitboards, SHM_StatusNullPtr);
+
+    SHM_Region* region = ring->region;
+    size length = (size)region->chains * region->devices * sizeof(u64);
+
+    for (;;) {
+        u32 before = atomic_load_explicit(&region->stateSequence, memory_order_acquire);
+        if (before % 2 != 0) {
+            continue;
+        }
+        memcpy(bitboards, ring->state, length);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&region->stateSequence, memory_order_relaxed) == before) {
+            return SHM_StatusOk;
+        }
+    }
+}
@@ -0,0 +1,215 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include "common.h"
+#include "chain.h"
+
+#include <stdatomic.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Region signature "M7SH" and layout version */
+#define SHM_MAGIC   0x4853374Du
+#define SHM_VERSION 1
+
+/* Default ring capacity in frames */
+#define SHM_DEFAULT_CAPACITY (1u << 16)
+
+/* Largest number of chains an entry can address */
+#define SHM_MAX_CHAINS (1u << 15)
+
+/* Timeout value waiting without limit */
+#define SHM_WAIT_FOREVER (-1)
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    SHM_StatusOk = 0,     /**< OK */
+    SHM_StatusNullPtr,    /**< Null pointer was passed to API function */
+    SHM_StatusWrongSize,  /**< Bad capacity, chain count or chain id */
+    SHM_StatusIoError,    /**< Shared memory could not be created or mapped */
+    SHM_StatusBadFormat,  /**< Region has wrong signature or version */
+    SHM_StatusTimeout,    /**< Nothing happened before the timeout */
+    SHM_StatusClosed,     /**< The other side has closed the ring */
+    SHM_StatusBusy        /**< Region is owned by a running emulator */
+} SHM_Status;
+
+/**
+ * @brief Header of the shared region, followed by the ring and display state
+ *
+ * Ring entries are u32: chain id in bits 31-17, latch flag in bit 16 (LOAD
+ * rises after this frame) and the frame in bits 15-0. Counters only grow,
+ * position in the ring is counter & (capacity - 1). Sequence words are the
+ * futex words, a side about to sleep raises its waiting flag first, so the
+ * other side issues a wake syscall only when somebody actually sleeps.
+ */
+typedef struct
+{
+    u32 magic;                          /**< SHM_MAGIC */
+    u32 version;                        /**< SHM_VERSION */
+    u32 capacity;                       /**< Ring entries, power of two */
+    u32 chains;                         /**< Number of chains */
+    u32 devices;                        /**< Devices per chain */
+    _Alignas(64) atomic_ullong head;    /**< Entries written by firmware */
+    atomic_uint dataSequence;           /**< Bumped after head moves */
+    atomic_uint consumerWaiting;        /**< Emulator sleeps on dataSequence */
+    atomic_uint producerClosed;         /**< Firmware will send nothing more */
+    _Alignas(64) atomic_ullong tail;    /**< Entries consumed by emulator */
+    atomic_uint spaceSequence;          /**< Bumped after tail moves */
+    atomic_uint producerWaiting;        /**< Firmware sleeps on spaceSequence */
+    atomic_uint consumerClosed;         /**< Emulator has gone away */
+    _Alignas(64) atomic_uint stateSequence; /**< Seqlock of display state */
+} SHM_Region;
+
+/**
+ * @brief One side's view of the shared ring
+ *
+ * The emulator creates the region and consumes frames, the firmware opens it
+ * and produces frames. Exactly one producer and one consumer are supported.
+ */
+typedef struct
+{
+    SHM_Region* region; /**< Mapped region */
+    size mappedSize;    /**< Size of the mapping */
+    u32* entries;       /**< Ring storage */
+    u64* state;         /**< Display state, chains * devices bitboards */
+    bool owner;         /**< Created the region, unlinks it on close */
+    int lockFd;         /**< Object locked by the owner while it lives, or -1 */
+    char name[64];      /**< Shared memory object name */
+} SHM_Ring;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create shared region as the consumer (emulator side).
+ *
+ * The object is created exclusively and locked (flock) until SHM_Close. An
+ * existing object is replaced only when nobody holds its lock, i.e. its
+ * emulator is gone. The name then refers to a new object, so a firmware
+ * still mapping the old one is not affected.
+ *
+ * @param ring     Ring instance to be initialized
+ * @param name     Shared memory object name, e.g. "/max7219"
+ * @param capacity Ring entries, power of two
+ * @param chains   Number of chains, at most SHM_MAX_CHAINS
+ * @param devices  Devices per chain
+ *
+ * @return Instance of SHM_Status. The function possible return values are:
+ * - SHM_StatusNullPtr when null pointer was passed to function
+ * - SHM_StatusWrongSize when capacity, chains or devices is invalid
+ * - SHM_StatusBusy when the name is used by a running emulator
+ * - SHM_StatusIoError when the region could not be created or mapped
+ * - SHM_StatusOk after success
+ */
+SHM_Status SHM_Create(SHM_Ring* ring, const char* name, u32 capacity, u32 chains,
+        u32 devices);
+
+/**
+ * @brief Attach to existing shared region as the producer (firmware side).
+ *
+ * @param ring Ring instance to be initialized
+ * @param name Shared memory object name
+ *
+ * @return Instance of SHM_Status. The function possible return values are:
+ * - SHM_StatusNullPtr when null pointer was passed to function
+ * - SHM_StatusIoError when the region does not exist or cannot be mapped
+ * - SHM_StatusBadFormat when the region was not created by SHM_Create
+ * - SHM_StatusOk after success
+ */
+SHM_Status SHM_Open(SHM_Ring* ring, const char* name);
+
+/**
+ * @brief Mark own side closed, wake the other one and unmap the region.
+ *
+ * The creator also removes the shared memory object name.
+ *
+ * @param ring Ring created with SHM_Create or SHM_Open
+ */
+void SHM_Close(SHM_Ring* ring);
+
+/**
+ * @brief Send single transaction: frames are shifted into chain, then latched.
+ *
+ * All frames are published at once, the call sleeps while the ring has no
+ * room for the whole transaction. A transaction is never sent partially, so
+ * the chain is left latched after any return value.
+ *
+ * @param ring      Pointer to the ring opened with SHM_Open
+ * @param chain     Chain id
+ * @param frames    Frames in bus order
+ * @param count     Number of frames
+ * @param timeoutMs Longest sleep on a full ring or SHM_WAIT_FOREVER
+ *
+ * @return Instance of SHM_Status. The function possible return values are:
+ * - SHM_StatusNullPtr when null pointer was passed to function
+ * - SHM_StatusWrongSize when chain id is out of range, count is zero or
+ * larger than the ring capacity
+ * - SHM_StatusTimeout when the ring had no room in time, nothing is sent
+ * - SHM_StatusClosed when the emulator has closed the ring
+ * - SHM_StatusOk after success
+ */
+SHM_Status SHM_Send(SHM_Ring* ring, u32 chain, const u16* frames, size count,
+        int timeoutMs);
+
+/**
+ * @brief Apply all available frames to the chains.
+ *
+ * Sleeps until frames arrive if the ring is empty.
+ *
+ * @param ring      Pointer to the ring created with SHM_Create
+ * @param chains    Chains indexed by chain id, as many as the ring was created for
+ * @param timeoutMs Longest sleep on an empty ring or SHM_WAIT_FOREVER
+ * @param received  The buffer in which the number of applied frames is stored
+ *
+ * @return Instance of SHM_Status. The function possible return values are:
+ * - SHM_StatusNullPtr when null pointer was passed to function
+ * - SHM_StatusTimeout when no frame arrived in time
+ * - SHM_StatusClosed when the ring is empty and the firmware has closed it
+ * - SHM_StatusOk after success
+ */
+SHM_Status SHM_Receive(SHM_Ring* ring, CHAIN_Instance* chains, int timeoutMs,
+        size* received);
+
+/**
+ * @brief Render chains and publish their output to the firmware side.
+ *
+ * @param ring   Pointer to the ring created with SHM_Create
+ * @param chains Chains indexed by chain id
+ *
+ * @return Instance of SHM_Status. The function possible return values are:
+ * - SHM_StatusNullPtr when null pointer was passed to function
+ * - SHM_StatusOk after success
+ */
+SHM_Status SHM_PublishState(SHM_Ring* ring, CHAIN_Instance* chains);
+
+/**
+ * @brief Read consistent copy of the published display state.
+ *
+ * @param ring      Pointer to the ring
+ * @param bitboards Buffer of chains * devices bitboards, chain 0 first
+ *
+ * @return Instance of SHM_Status. The function possible return values are:
+ * - SHM_StatusNullPtr when null pointer was passed to function
+ * - SHM_StatusOk after success
+ */
+SHM_Status SHM_ReadState(const SHM_Ring* ring, u64* bitboards);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // SHM_H
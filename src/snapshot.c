@@ -0,0 +1,138 @@
+#include "snapshot.h"
+
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Round size up to keep sections aligned to 8 bytes */
+static inline size AlignSection(size bytes)
+{
+    return (bytes + 7) & ~(size)7;
+}
+
+/* Size of single chain section */
+static inline size SectionSize(size length)
+{
+    return sizeof(SNAPSHOT_ChainHeader)
+            + AlignSection(CHAIN_StorageSize(length));
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+size SNAPSHOT_Size(const CHAIN_Instance* chains, size count)
+{
+    size total = sizeof(SNAPSHOT_Header);
+    for (size i = 0; i < count; ++i) {
+        total += SectionSize(chains[i].length);
+    }
+    return total;
+}
+
+SNAPSHOT_Status SNAPSHOT_Save(
+        const CHAIN_Instance* chains,
+        size count,
+        void* buffer,
+        size capacity)
+{
+    COMMON_NULLPTR_GUARD(chains, SNAPSHOT_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(buffer, SNAPSHOT_StatusNullPtr);
+
+    if (capacity < SNAPSHOT_Size(chains, count)) {
+        return SNAPSHOT_StatusWrongSize;
+    }
+
+    u8* position = buffer;
+    SNAPSHOT_Header* header = (SNAPSHOT_Header*)position;
+    memcpy(header->magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+    header->version = SNAPSHOT_VERSION;
+    header->reserved = 0;
+    header->chains = count;
+    position += sizeof(*header);
+
+    for (size i = 0; i < count; ++i) {
+        const CHAIN_Instance* chain = &chains[i];
+        *(SNAPSHOT_ChainHeader*)position = (SNAPSHOT_ChainHeader){
+            .length = chain->length,
+            .shiftHead = chain->shiftHead,
+            .shifted = (chain->shifted < chain->length)
+                    ? chain->shifted
+                    : chain->length,
+            .tick = chain->tick,
+            .frames = chain->frames,
+            .redundantFrames = chain->redundantFrames
+        };
+        memcpy(position + sizeof(SNAPSHOT_ChainHeader), chain->storage,
+                chain->storageSize);
+        position += SectionSize(chain->length);
+    }
+
+    return SNAPSHOT_StatusOk;
+}
+
+SNAPSHOT_Status SNAPSHOT_Restore(
+        CHAIN_Instance* chains,
+        size count,
+        const void* buffer,
+        size length)
+{
+    COMMON_NULLPTR_GUARD(chains, SNAPSHOT_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(buffer, SNAPSHOT_StatusNullPtr);
+
+    const SNAPSHOT_Header* header = buffer;
+    if (length < sizeof(*header)) {
+        return SNAPSHOT_StatusWrongSize;
+    }
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) != 0
+            || header->version != SNAPSHOT_VERSION
+            || header->chains != count) {
+        return SNAPSHOT_StatusBadFormat;
+    }
+
+    /* Validate all sections before the first chain is modified */
+    const u8* sections = (const u8*)buffer + sizeof(*header);
+    const u8* position = sections;
+    for (size i = 0; i < count; ++i) {
+        size remaining = length - (size)(position - (const u8*)buffer);
+        if (remaining < sizeof(SNAPSHOT_ChainHeader)) {
+            return SNAPSHOT_StatusWrongSize;
+        }
+
+        /* Shift register ring indices are used unchecked once restored */
+        const SNAPSHOT_ChainHeader* saved = (const SNAPSHOT_ChainHeader*)position;
+        if (saved->length != chains[i].length
+                || remaining < SectionSize(chains[i].length)
+                || saved->shiftHead >= saved->length
+                || saved->shifted > saved->length) {
+            return SNAPSHOT_StatusWrongSize;
+        }
+        position += SectionSize(chains[i].length);
+    }
+
+    for (size i = 0; i < count; ++i) {
+        if (CHAIN_Unshare(&chains[i]) != CHAIN_StatusOk) {
+            return SNAPSHOT_StatusMemError;
+        }
+    }
+
+    position = sections;
+    for (size i = 0; i < count; ++i) {
+        CHAIN_Instance* chain = &chains[i];
+        const SNAPSHOT_ChainHeader* saved = (const SNAPSHOT_ChainHeader*)position;
+
+        chain->shiftHead = saved->shiftHead;
+        chain->shifted = saved->shifted;
+        chain->tick = saved->tick;
+        chain->frames = saved->frames;
+        chain->redundantFrames = saved->redundantFrames;
+        chain->failed = false;
+        memcpy(chain->storage, position + sizeof(SNAPSHOT_ChainHeader),
+                chain->storageSize);
+        position += SectionSize(chain->length);
+    }
+
+    return SNAPSHOT_StatusOk;
+}
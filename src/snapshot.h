@@ -0,0 +1,135 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "common.h"
+#include "chain.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Snapshot signature */
+#define SNAPSHOT_MAGIC "M7219SNP"
+#define SNAPSHOT_MAGIC_SIZE 8
+
+/* Current snapshot layout version */
+#define SNAPSHOT_VERSION 1
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    SNAPSHOT_StatusOk = 0,     /**< OK */
+    SNAPSHOT_StatusNullPtr,    /**< Null pointer was passed to API function */
+    SNAPSHOT_StatusWrongSize,  /**< Buffer too small or chain lengths differ */
+    SNAPSHOT_StatusBadFormat,  /**< Wrong signature, version or chain count */
+    SNAPSHOT_StatusMemError    /**< Shared chain storage could not be copied */
+} SNAPSHOT_Status;
+
+/**
+ * @brief Snapshot header, followed by one section per chain
+ *
+ * Every section consists of SNAPSHOT_ChainHeader and the chain storage block
+ * copied verbatim, padded to 8 bytes. Snapshots are memory images: they can
+ * be restored by the same build on the same machine only.
+ */
+typedef struct
+{
+    char magic[SNAPSHOT_MAGIC_SIZE]; /**< SNAPSHOT_MAGIC */
+    u32 version;                     /**< SNAPSHOT_VERSION */
+    u32 reserved;                    /**< Zero */
+    u64 chains;                      /**< Number of chain sections */
+} SNAPSHOT_Header;
+
+/**
+ * @brief Scalar part of a chain stored in front of its storage block
+ */
+typedef struct
+{
+    u64 length;          /**< Number of devices */
+    u64 shiftHead;       /**< CHAIN_Instance::shiftHead */
+    u64 shifted;         /**< CHAIN_Instance::shifted */
+    u64 tick;            /**< CHAIN_Instance::tick */
+    u64 frames;          /**< CHAIN_Instance::frames */
+    u64 redundantFrames; /**< CHAIN_Instance::redundantFrames */
+} SNAPSHOT_ChainHeader;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Get number of bytes needed to snapshot given chains.
+ *
+ * @param chains Array of chains
+ * @param count  Number of chains
+ *
+ * @return Snapshot size in bytes
+ */
+size SNAPSHOT_Size(const CHAIN_Instance* chains, size count);
+
+/**
+ * @brief Serialize registers, framebuffers and clocks of all chains.
+ *
+ * Every chain is copied with a single memcpy of its storage block. More than
+ * length unlatched frames behave like exactly length of them, so shifted is
+ * saved clamped to the chain length.
+ *
+ * @param chains   Array of chains
+ * @param count    Number of chains
+ * @param buffer   Destination buffer, aligned to 8 bytes
+ * @param capacity Size of the buffer, at least SNAPSHOT_Size bytes
+ *
+ * @return Instance of SNAPSHOT_Status. The function possible return values are:
+ * - SNAPSHOT_StatusNullPtr when null pointer was passed to function
+ * - SNAPSHOT_StatusWrongSize when the buffer is too small
+ * - SNAPSHOT_StatusOk after success
+ */
+SNAPSHOT_Status SNAPSHOT_Save(
+        const CHAIN_Instance* chains,
+        size count,
+        void* buffer,
+        size capacity);
+
+/**
+ * @brief Bring chains back to the state stored in the snapshot.
+ *
+ * Chains have to be created with the same lengths as the saved ones. The
+ * whole snapshot is validated first, so chains are left untouched on error.
+ * Forked chains get private storage before it is overwritten and chains
+ * which dropped writes (CHAIN_Instance::failed) become usable again.
+ *
+ * @param chains Array of chains
+ * @param count  Number of chains, equal to the number of saved chains
+ * @param buffer Snapshot created with SNAPSHOT_Save, aligned to 8 bytes
+ * @param length Snapshot length
+ *
+ * @return Instance of SNAPSHOT_Status. The function possible return values are:
+ * - SNAPSHOT_StatusNullPtr when null pointer was passed to function
+ * - SNAPSHOT_StatusBadFormat when the buffer does not hold a snapshot of
+ * count chains
+ * - SNAPSHOT_StatusWrongSize when the snapshot is truncated, lengths of
+ * chains differ or a saved shift register position is out of range
+ * - SNAPSHOT_StatusMemError when storage of a forked chain could not be copied
+ * - SNAPSHOT_StatusOk after success
+ */
+SNAPSHOT_Status SNAPSHOT_Restore(
+        CHAIN_Instance* chains,
+        size count,
+        const void* buffer,
+        size length);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,348 @@
+#include "stream.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Initial number of bytes moved to carry buffer when completing a record */
+#define CARRY_MIN_STEP 32
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Parser state carried across blocks */
+typedef struct
+{
+    STREAM_Reader* reader;
+    TRACE_RecordCallback callback;
+    void* context;
+    bool headerDone;
+    TRACE_Decoder decoder;
+    STREAM_Status status;
+} ParserState;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Read as much as possible into block, only read() may be cancelled */
+static size FillBlock(STREAM_Reader* reader, u8* data, bool* end, bool* error)
+{
+    size length = 0;
+    while (length < STREAM_BLOCK_SIZE) {
+        int state;
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &state);
+        ssize_t count = read(reader->fd, &data[length],
+                STREAM_BLOCK_SIZE - length);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &state);
+
+        if (count > 0) {
+            length += (size)count;
+        } else if (count == 0) {
+            *end = true;
+            break;
+        } else if (errno != EINTR) {
+            *error = true;
+            break;
+        }
+    }
+    return length;
+}
+
+/* Reader thread entry point */
+static void* ReaderMain(void* argument)
+{
+    STREAM_Reader* reader = argument;
+    size index = 0;
+
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+
+    for (;;) {
+        STREAM_Block* block = &reader->blocks[index];
+
+        pthread_mutex_lock(&reader->lock);
+        while (block->full && !reader->stop) {
+            pthread_cond_wait(&reader->changed, &reader->lock);
+        }
+        bool stop = reader->stop;
+        pthread_mutex_unlock(&reader->lock);
+        if (stop) {
+            break;
+        }
+
+        /* Block is owned by the reader now, fill it without holding lock */
+        bool end = false;
+        bool error = false;
+        size length = FillBlock(reader, block->data, &end, &error);
+
+        pthread_mutex_lock(&reader->lock);
+        block->length = length;
+        block->full = length > 0;
+        reader->bytes += length;
+        reader->eof = end || error;
+        reader->ioError = error;
+        pthread_cond_broadcast(&reader->changed);
+        pthread_mutex_unlock(&reader->lock);
+
+        if (end || error) {
+            break;
+        }
+        index = (index + 1) % STREAM_BLOCKS;
+    }
+
+    return NULL;
+}
+
+/* Wait until block is filled, returns false at the end of stream */
+static bool AcquireBlock(STREAM_Reader* reader, STREAM_Block* block)
+{
+    pthread_mutex_lock(&reader->lock);
+    while (!block->full && !reader->eof) {
+        pthread_cond_wait(&reader->changed, &reader->lock);
+    }
+    bool full = block->full;
+    pthread_mutex_unlock(&reader->lock);
+    return full;
+}
+
+/* Hand block back to the reader thread */
+static void ReleaseBlock(STREAM_Reader* reader, STREAM_Block* block)
+{
+    pthread_mutex_lock(&reader->lock);
+    block->full = false;
+    pthread_cond_broadcast(&reader->changed);
+    pthread_mutex_unlock(&reader->lock);
+}
+
+/* Append bytes to carry buffer */
+static bool CarryAppend(STREAM_Reader* reader, const u8* data, size length)
+{
+    size required = reader->carryLength + length;
+    if (required > reader->carryCapacity) {
+        size capacity = (reader->carryCapacity == 0)
+                ? CARRY_MIN_STEP
+                : reader->carryCapacity;
+        while (capacity < required) {
+            capacity *= 2;
+        }
+        u8* grown = realloc(reader->carry, capacity);
+        if (grown == NULL) {
+            return false;
+        }
+        reader->carry = grown;
+        reader->carryCapacity = capacity;
+    }
+
+    memcpy(&reader->carry[reader->carryLength], data, length);
+    reader->carryLength = required;
+    return true;
+}
+
+/* Decode header or single record and pass it to the callback */
+static TRACE_Status Consume(ParserState* parser, const u8* data, size length,
+        size* consumed)
+{
+    if (!parser->headerDone) {
+        TRACE_Header header;
+        TRACE_Status status = TRACE_DecodeHeader(data, length, &header);
+        if (status == TRACE_StatusOk) {
+            parser->headerDone = true;
+            TRACE_DecoderInit(&parser->decoder, header.flags);
+            *consumed = TRACE_HEADER_SIZE;
+        }
+        return status;
+    }
+
+    TRACE_Record record;
+    TRACE_Status status = TRACE_DecoderNext(&parser->decoder, data, length,
+            &record, consumed);
+    if (status != TRACE_StatusOk) {
+        return status;
+    }
+    return parser->callback(parser->context, &record);
+}
+
+/* Parse single block, returns position of unparsed tail or error */
+static STREAM_Status ParseBlock(STREAM_Reader* reader, ParserState* parser,
+        const u8* data, size length)
+{
+    size position = 0;
+    size consumed;
+    TRACE_Status status;
+
+    /* Finish record started in the previous block, growing the piece taken */
+    while (reader->carryLength > 0 && position < length) {
+        size previous = reader->carryLength;
+        size step = (previous < CARRY_MIN_STEP) ? CARRY_MIN_STEP : previous;
+        size take = (step < length - position) ? step : length - position;
+
+        if (!CarryAppend(reader, &data[position], take)) {
+            return STREAM_StatusMemError;
+        }
+
+        status = Consume(parser, reader->carry, reader->carryLength, &consumed);
+        if (status == TRACE_StatusTruncated) {
+            position += take;
+            continue;
+        }
+        if (status != TRACE_StatusOk) {
+            reader->traceStatus = status;
+            return STREAM_StatusTraceError;
+        }
+
+        position += consumed - previous;
+        reader->carryLength = 0;
+    }
+
+    /* Records lying entirely inside the block are decoded in place */
+    while (position < length) {
+        status = Consume(parser, &data[position], length - position, &consumed);
+        if (status == TRACE_StatusTruncated) {
+            if (!CarryAppend(reader, &data[position], length - position)) {
+                return STREAM_StatusMemError;
+            }
+            break;
+        }
+        if (status != TRACE_StatusOk) {
+            reader->traceStatus = status;
+            return STREAM_StatusTraceError;
+        }
+        position += consumed;
+    }
+
+    return STREAM_StatusOk;
+}
+
+/* Block consumer decoding trace records */
+static bool ParseTraceBlock(void* context, const u8* data, size length)
+{
+    ParserState* parser = context;
+    parser->status = ParseBlock(parser->reader, parser, data, length);
+    return parser->status == STREAM_StatusOk;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+STREAM_Status STREAM_Create(STREAM_Reader* reader, int fd)
+{
+    COMMON_NULLPTR_GUARD(reader, STREAM_StatusNullPtr);
+
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = fd;
+    reader->traceStatus = TRACE_StatusOk;
+
+    for (size i = 0; i < STREAM_BLOCKS; ++i) {
+        reader->blocks[i].data = malloc(STREAM_BLOCK_SIZE);
+        if (reader->blocks[i].data == NULL) {
+            for (size j = 0; j < i; ++j) {
+                free(reader->blocks[j].data);
+            }
+            return STREAM_StatusMemError;
+        }
+    }
+
+    pthread_mutex_init(&reader->lock, NULL);
+    pthread_cond_init(&reader->changed, NULL);
+
+    if (pthread_create(&reader->thread, NULL, ReaderMain, reader) != 0) {
+        pthread_mutex_destroy(&reader->lock);
+        pthread_cond_destroy(&reader->changed);
+        for (size i = 0; i < STREAM_BLOCKS; ++i) {
+            free(reader->blocks[i].data);
+        }
+        return STREAM_StatusThreadError;
+    }
+
+    return STREAM_StatusOk;
+}
+
+void STREAM_Destroy(STREAM_Reader* reader)
+{
+    if (reader == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&reader->lock);
+    reader->stop = true;
+    bool eof = reader->eof;
+    pthread_cond_broadcast(&reader->changed);
+    pthread_mutex_unlock(&reader->lock);
+
+    /* Reader may be blocked in read() on a stream which never ends */
+    if (!eof) {
+        pthread_cancel(reader->thread);
+    }
+    pthread_join(reader->thread, NULL);
+
+    pthread_mutex_destroy(&reader->lock);
+    pthread_cond_destroy(&reader->changed);
+    for (size i = 0; i < STREAM_BLOCKS; ++i) {
+        free(reader->blocks[i].data);
+    }
+    free(reader->carry);
+    memset(reader, 0, sizeof(*reader));
+}
+
+STREAM_Status STREAM_ForEachBlock(
+        STREAM_Reader* reader,
+        STREAM_BlockCallback callback,
+        void* context)
+{
+    COMMON_NULLPTR_GUARD(reader, STREAM_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(callback, STREAM_StatusNullPtr);
+
+    for (size index = 0;; index = (index + 1) % STREAM_BLOCKS) {
+        STREAM_Block* block = &reader->blocks[index];
+        if (!AcquireBlock(reader, block)) {
+            break;
+        }
+
+        bool proceed = callback(context, block->data, block->length);
+        ReleaseBlock(reader, block);
+
+        if (!proceed) {
+            return STREAM_StatusConsumerError;
+        }
+    }
+
+    return reader->ioError ? STREAM_StatusIoError : STREAM_StatusOk;
+}
+
+STREAM_Status STREAM_Parse(
+        STREAM_Reader* reader,
+        TRACE_RecordCallback callback,
+        void* context)
+{
+    COMMON_NULLPTR_GUARD(reader, STREAM_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(callback, STREAM_StatusNullPtr);
+
+    ParserState parser = {
+        .reader = reader,
+        .callback = callback,
+        .context = context,
+        .headerDone = false,
+        .status = STREAM_StatusOk
+    };
+
+    STREAM_Status status = STREAM_ForEachBlock(reader, ParseTraceBlock, &parser);
+    if (status == STREAM_StatusConsumerError) {
+        return parser.status;
+    }
+    if (status != STREAM_StatusOk) {
+        return status;
+    }
+
+    if (!parser.headerDone || reader->carryLength > 0) {
+        reader->traceStatus = TRACE_StatusTruncated;
+        return STREAM_StatusTraceError;
+    }
+    return STREAM_StatusOk;
+}
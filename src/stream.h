@@ -0,0 +1,152 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "common.h"
+#include "trace.h"
+
+#include <pthread.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Size of a single input block */
+#define STREAM_BLOCK_SIZE (1u << 20)
+
+/* Number of blocks cycled between reader thread and parser */
+#define STREAM_BLOCKS 2
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    STREAM_StatusOk = 0,       /**< OK */
+    STREAM_StatusNullPtr,      /**< Null pointer was passed to API function */
+    STREAM_StatusMemError,     /**< Memory allocation error */
+    STREAM_StatusIoError,      /**< Reading from the descriptor failed */
+    STREAM_StatusThreadError,  /**< Reader thread could not be started */
+    STREAM_StatusTraceError,   /**< Trace decoding or record callback failed */
+    STREAM_StatusConsumerError /**< Block consumer requested to stop */
+} STREAM_Status;
+
+/**
+ * @brief Raw block consumer type, returns false to stop reading
+ */
+typedef bool (*STREAM_BlockCallback)(void* context, const u8* data, size length);
+
+/**
+ * @brief Input block shared between reader thread and parser
+ */
+typedef struct
+{
+    u8* data;    /**< Block storage of STREAM_BLOCK_SIZE bytes */
+    size length; /**< Number of valid bytes */
+    bool full;   /**< Block is ready to be parsed */
+} STREAM_Block;
+
+/**
+ * @brief Double-buffered reader of a trace arriving through a descriptor
+ *
+ * The reader thread fills one block while the parser works on the other one,
+ * so memory usage does not depend on the stream length.
+ */
+typedef struct
+{
+    int fd;                              /**< Input descriptor */
+    STREAM_Block blocks[STREAM_BLOCKS];  /**< Input blocks */
+    pthread_t thread;                    /**< Reader thread */
+    pthread_mutex_t lock;                /**< Protects block states */
+    pthread_cond_t changed;              /**< Signalled on block state change */
+    bool eof;                            /**< No more blocks will be filled */
+    bool ioError;                        /**< Reading failed */
+    bool stop;                           /**< Parser asks reader to quit */
+    u8* carry;                           /**< Record straddling two blocks */
+    size carryLength;                    /**< Bytes kept in carry buffer */
+    size carryCapacity;                  /**< Allocated carry buffer size */
+    TRACE_Status traceStatus;            /**< Detailed trace error */
+    u64 bytes;                           /**< Bytes read so far */
+} STREAM_Reader;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create reader and start its background thread.
+ *
+ * @param reader Reader instance to be initialized
+ * @param fd     Input descriptor, e.g. STDIN_FILENO
+ *
+ * @return Instance of STREAM_Status. The function possible return values are:
+ * - STREAM_StatusNullPtr when null pointer was passed to function
+ * - STREAM_StatusMemError when there was a memory allocation error
+ * - STREAM_StatusThreadError when the reader thread could not be started
+ * - STREAM_StatusOk after success
+ */
+STREAM_Status STREAM_Create(STREAM_Reader* reader, int fd);
+
+/**
+ * @brief Stop reader thread and release memory owned by the reader.
+ *
+ * @param reader Reader created with STREAM_Create
+ */
+void STREAM_Destroy(STREAM_Reader* reader);
+
+/**
+ * @brief Pass every input block to the consumer in stream order.
+ *
+ * The block is handed back to the reader thread as soon as the callback
+ * returns, thus the data must not be referenced afterwards.
+ *
+ * @param reader   Pointer to the reader
+ * @param callback Block consumer
+ * @param context  User context passed to callback
+ *
+ * @return Instance of STREAM_Status. The function possible return values are:
+ * - STREAM_StatusNullPtr when null pointer was passed to function
+ * - STREAM_StatusIoError when reading failed
+ * - STREAM_StatusConsumerError when the callback returned false
+ * - STREAM_StatusOk after success
+ */
+STREAM_Status STREAM_ForEachBlock(
+        STREAM_Reader* reader,
+        STREAM_BlockCallback callback,
+        void* context);
+
+/**
+ * @brief Parse whole trace stream passing every record to the callback.
+ *
+ * Records are decoded in place from input blocks. Only a record straddling
+ * two blocks is assembled in a small carry buffer.
+ *
+ * @param reader   Pointer to the reader
+ * @param callback Record consumer. Non-OK status stops parsing
+ * @param context  User context passed to callback
+ *
+ * @return Instance of STREAM_Status. The function possible return values are:
+ * - STREAM_StatusNullPtr when null pointer was passed to function
+ * - STREAM_StatusMemError when carry buffer could not be grown
+ * - STREAM_StatusIoError when reading failed
+ * - STREAM_StatusTraceError when decoding or callback failed, see
+ * STREAM_Reader::traceStatus
+ * - STREAM_StatusOk after success
+ */
+STREAM_Status STREAM_Parse(
+        STREAM_Reader* reader,
+        TRACE_RecordCallback callback,
+        void* context);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // STREAM_H
@@ -0,0 +1,417 @@
+#include "term.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Matrix geometry in screen cells, a LED is two columns wide to look square */
+#define MATRIX_LED_WIDTH 2
+#define MATRIX_WIDTH (MAX7219_DIGITS * MATRIX_LED_WIDTH)
+#define MATRIX_HEIGHT MAX7219_DIGITS
+
+/* Seven-segment geometry in screen cells */
+#define DIGIT_WIDTH 4
+#define DIGIT_HEIGHT 3
+#define DIGITS_WIDTH (MAX7219_DIGITS * DIGIT_WIDTH + 2)
+#define DIGITS_HEIGHT (DIGIT_HEIGHT + 1)
+
+/* Worst-case output sizes used to size the frame buffer */
+#define MOVE_MAX_SIZE 14
+#define ATTRIBUTE_MAX_SIZE 5
+#define LED_MAX_SIZE (MOVE_MAX_SIZE + ATTRIBUTE_MAX_SIZE + 6)
+#define DIGIT_MAX_SIZE (ATTRIBUTE_MAX_SIZE + DIGIT_HEIGHT * (MOVE_MAX_SIZE + DIGIT_WIDTH))
+#define FRAME_EXTRA_SIZE 64
+
+/* Escape sequences */
+#define CLEAR_SCREEN "\x1b[2J\x1b[?25l"
+#define RESET_ATTRIBUTES "\x1b[0m"
+#define SHOW_CURSOR "\x1b[?25h"
+#define LIT_ATTRIBUTE "\x1b[91m"
+#define UNLIT_ATTRIBUTE "\x1b[90m"
+
+/* Full block character, drawn twice per LED */
+#define LED_GLYPH "\xe2\x96\x88\xe2\x96\x88"
+
+/* Segment bits of a digit register */
+#define SEGMENT_DP 0x80
+#define SEGMENT_A  0x40
+#define SEGMENT_B  0x20
+#define SEGMENT_C  0x10
+#define SEGMENT_D  0x08
+#define SEGMENT_E  0x04
+#define SEGMENT_F  0x02
+#define SEGMENT_G  0x01
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Frame being assembled together with known terminal state */
+typedef struct
+{
+    char* out;   /* Next free byte of the frame buffer */
+    u16 row;     /* Cursor row, 0 if unknown */
+    u16 column;  /* Cursor column */
+    int lit;     /* Current attribute: 1 lit, 0 unlit, -1 unknown */
+} Frame;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Append string literal or any other bytes */
+static inline void Append(Frame* frame, const char* text, size length)
+{
+    memcpy(frame->out, text, length);
+    frame->out += length;
+}
+
+/* Append decimal number */
+static inline void AppendNumber(Frame* frame, u16 value)
+{
+    char digits[5];
+    size count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (count > 0) {
+        *frame->out++ = digits[--count];
+    }
+}
+
+/* Move cursor unless it is already at the requested position */
+static inline void MoveTo(Frame* frame, u16 row, u16 column)
+{
+    if (frame->row == row && frame->column == column) {
+        return;
+    }
+
+    Append(frame, "\x1b[", 2);
+    AppendNumber(frame, row);
+    *frame->out++ = ';';
+    AppendNumber(frame, column);
+    *frame->out++ = 'H';
+    frame->row = row;
+    frame->column = column;
+}
+
+/* Switch between lit and unlit colour if needed */
+static inline void SetLit(Frame* frame, int lit)
+{
+    if (frame->lit == lit) {
+        return;
+    }
+    if (lit) {
+        Append(frame, LIT_ATTRIBUTE, sizeof(LIT_ATTRIBUTE) - 1);
+    } else {
+        Append(frame, UNLIT_ATTRIBUTE, sizeof(UNLIT_ATTRIBUTE) - 1);
+    }
+    frame->lit = lit;
+}
+
+/* Draw LEDs of a matrix row selected by mask, bit 0 is leftmost */
+static void DrawMatrixRow(Frame* frame, u16 row, u16 column, u8 leds, u8 mask)
+{
+    for (u32 x = 0; x < LAYOUT_MODULE_SIZE; ++x) {
+        if ((mask & (1u << x)) == 0) {
+            continue;
+        }
+
+        MoveTo(frame, row, column + (u16)(x * MATRIX_LED_WIDTH));
+        SetLit(frame, (leds >> x) & 1);
+        Append(frame, LED_GLYPH, sizeof(LED_GLYPH) - 1);
+        frame->column += MATRIX_LED_WIDTH;
+    }
+}
+
+/* Draw single seven-segment digit as three rows of text */
+static void DrawDigit(Frame* frame, u16 row, u16 column, u8 segments)
+{
+    const char lines[DIGIT_HEIGHT][DIGIT_WIDTH] = {
+        {
+            ' ',
+            (segments & SEGMENT_A) ? '_' : ' ',
+            ' ',
+            ' '
+        },
+        {
+            (segments & SEGMENT_F) ? '|' : ' ',
+            (segments & SEGMENT_G) ? '_' : ' ',
+            (segments & SEGMENT_B) ? '|' : ' ',
+            ' '
+        },
+        {
+            (segments & SEGMENT_E) ? '|' : ' ',
+            (segments & SEGMENT_D) ? '_' : ' ',
+            (segments & SEGMENT_C) ? '|' : ' ',
+            (segments & SEGMENT_DP) ? '.' : ' '
+        }
+    };
+
+    SetLit(frame, 1);
+    for (u16 line = 0; line < DIGIT_HEIGHT; ++line) {
+        MoveTo(frame, row + line, column);
+        Append(frame, lines[line], DIGIT_WIDTH);
+        frame->column += DIGIT_WIDTH;
+    }
+}
+
+/* Turn module pixel row (bit 0 leftmost) back into a digit register */
+static inline u8 SegmentsOf(u8 pixels)
+{
+    u8 segments = 0;
+    for (u32 x = 0; x < LAYOUT_MODULE_SIZE; ++x) {
+        segments |= (u8)(((pixels >> x) & 1) << (7 - x));
+    }
+    return segments;
+}
+
+/* Draw changed parts of a single module, full redraw if everything is set */
+static void DrawModule(TERM_Renderer* renderer, Frame* frame,
+        const TERM_Area* area, size column, size row, bool everything)
+{
+    for (size line = 0; line < LAYOUT_MODULE_SIZE; ++line) {
+        size y = row * LAYOUT_MODULE_SIZE + line;
+        u8 now = LAYOUT_ModuleRow(&area->map, renderer->canvas, column, y);
+        u8 changed = everything
+                ? 0xFF
+                : now ^ LAYOUT_ModuleRow(&area->map, area->canvas, column, y);
+        if (changed == 0) {
+            continue;
+        }
+
+        if (renderer->mode == TERM_ModeMatrix) {
+            DrawMatrixRow(frame, (u16)(area->top + y),
+                    (u16)(1 + column * MATRIX_WIDTH), now, changed);
+        } else {
+            u16 position = (u16)((MAX7219_DIGITS - 1 - line) * DIGIT_WIDTH);
+            DrawDigit(frame, (u16)(area->top + row * DIGITS_HEIGHT),
+                    (u16)(1 + column * DIGITS_WIDTH + position), SegmentsOf(now));
+        }
+    }
+}
+
+/* Gather chain into the canvas and draw changed modules */
+static void DrawChain(TERM_Renderer* renderer, Frame* frame, TERM_Area* area,
+        const CHAIN_Instance* chain, bool everything)
+{
+    const LAYOUT_Map* map = &area->map;
+    const u64* bitboards = chain->framebuffer;
+    if (chain->length < map->devices) {
+        memcpy(renderer->bitboards, chain->framebuffer, chain->length * sizeof(u64));
+        memset(&renderer->bitboards[chain->length], 0,
+                (map->devices - chain->length) * sizeof(u64));
+        bitboards = renderer->bitboards;
+    }
+    LAYOUT_Gather(map, bitboards, map->devices, renderer->canvas);
+
+    size words = LAYOUT_CanvasWords(map);
+    if (!everything && memcmp(renderer->canvas, area->canvas, words * sizeof(u64)) == 0) {
+        return;
+    }
+
+    for (size row = 0; row < map->descriptor.rows; ++row) {
+        for (size column = 0; column < map->descriptor.columns; ++column) {
+            /* Cells of a partial last row stay blank */
+            if (LAYOUT_DeviceAt(map, column, row) < chain->length) {
+                DrawModule(renderer, frame, area, column, row, everything);
+            }
+        }
+    }
+
+    memcpy(area->canvas, renderer->canvas, words * sizeof(u64));
+}
+
+/* Write whole buffer, retrying after signals and partial writes */
+static bool WriteAll(int fd, const char* data, size length)
+{
+    while (length > 0) {
+        ssize_t count = write(fd, data, length);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += count;
+        length -= (size)count;
+    }
+    return true;
+}
+
+/* Build module grid of every chain and stack the chains */
+static TERM_Status Layout(TERM_Renderer* renderer, size perRow)
+{
+    size width = (renderer->mode == TERM_ModeMatrix) ? MATRIX_WIDTH : DIGITS_WIDTH;
+    size height = (renderer->mode == TERM_ModeMatrix) ? MATRIX_HEIGHT : DIGITS_HEIGHT;
+    size top = 1;
+
+    for (size c = 0; c < renderer->count; ++c) {
+        TERM_Area* area = &renderer->areas[c];
+        LAYOUT_Descriptor descriptor = LAYOUT_Wrapped(renderer->chains[c].length, perRow);
+        LAYOUT_Status status = LAYOUT_Create(&area->map, &descriptor);
+        if (status != LAYOUT_StatusOk) {
+            return (status == LAYOUT_StatusMemError)
+                    ? TERM_StatusMemError
+                    : TERM_StatusWrongSize;
+        }
+
+        /* Cursor positions are u16, the row below the drawing included */
+        if (1 + descriptor.columns * width > UINT16_MAX
+                || top + descriptor.rows * height > UINT16_MAX) {
+            return TERM_StatusWrongSize;
+        }
+
+        area->canvas = calloc(LAYOUT_CanvasWords(&area->map), sizeof(u64));
+        if (area->canvas == NULL) {
+            return TERM_StatusMemError;
+        }
+        area->top = (u16)top;
+
+        /* Chains are separated by a blank line */
+        top += descriptor.rows * height + 1;
+    }
+
+    /* No separator after the last chain */
+    renderer->height = (u16)(top - 2);
+    return TERM_StatusOk;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+TERM_Status TERM_Create(
+        TERM_Renderer* renderer,
+        int fd,
+        TERM_Mode mode,
+        CHAIN_Instance* chains,
+        size count,
+        size perRow)
+{
+    COMMON_NULLPTR_GUARD(renderer, TERM_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(chains, TERM_StatusNullPtr);
+
+    if (count == 0 || perRow == 0) {
+        return TERM_StatusWrongSize;
+    }
+
+    memset(renderer, 0, sizeof(*renderer));
+    renderer->fd = fd;
+    renderer->mode = mode;
+    renderer->chains = chains;
+    renderer->count = count;
+    for (size i = 0; i < count; ++i) {
+        renderer->devices += chains[i].length;
+    }
+
+    size deviceSize = (mode == TERM_ModeMatrix)
+            ? MAX7219_DIGITS * MAX7219_DIGITS * LED_MAX_SIZE
+            : MAX7219_DIGITS * DIGIT_MAX_SIZE;
+    renderer->capacity = renderer->devices * deviceSize + FRAME_EXTRA_SIZE;
+
+    renderer->areas = calloc(count, sizeof(TERM_Area));
+    renderer->buffer = malloc(renderer->capacity);
+    if (renderer->areas == NULL || renderer->buffer == NULL) {
+        TERM_Destroy(renderer);
+        return TERM_StatusMemError;
+    }
+
+    TERM_Status status = Layout(renderer, perRow);
+    if (status != TERM_StatusOk) {
+        TERM_Destroy(renderer);
+        return status;
+    }
+
+    /* Scratch buffers are shared by all chains */
+    size devices = 0;
+    size words = 0;
+    for (size i = 0; i < count; ++i) {
+        if (renderer->areas[i].map.devices > devices) {
+            devices = renderer->areas[i].map.devices;
+        }
+        if (LAYOUT_CanvasWords(&renderer->areas[i].map) > words) {
+            words = LAYOUT_CanvasWords(&renderer->areas[i].map);
+        }
+    }
+    renderer->bitboards = malloc(devices * sizeof(u64));
+    renderer->canvas = malloc(words * sizeof(u64));
+    if (renderer->bitboards == NULL || renderer->canvas == NULL) {
+        TERM_Destroy(renderer);
+        return TERM_StatusMemError;
+    }
+    return TERM_StatusOk;
+}
+
+void TERM_Destroy(TERM_Renderer* renderer)
+{
+    if (renderer == NULL) {
+        return;
+    }
+
+    if (renderer->drawn && renderer->buffer != NULL) {
+        Frame frame = {.out = renderer->buffer, .row = 0, .lit = -1};
+        Append(&frame, RESET_ATTRIBUTES, sizeof(RESET_ATTRIBUTES) - 1);
+        Append(&frame, SHOW_CURSOR, sizeof(SHOW_CURSOR) - 1);
+        MoveTo(&frame, renderer->height + 1, 1);
+        WriteAll(renderer->fd, renderer->buffer,
+                (size)(frame.out - renderer->buffer));
+    }
+
+    if (renderer->areas != NULL) {
+        for (size i = 0; i < renderer->count; ++i) {
+            LAYOUT_Destroy(&renderer->areas[i].map);
+            free(renderer->areas[i].canvas);
+        }
+    }
+    free(renderer->areas);
+    free(renderer->bitboards);
+    free(renderer->canvas);
+    free(renderer->buffer);
+    memset(renderer, 0, sizeof(*renderer));
+}
+
+TERM_Status TERM_Draw(TERM_Renderer* renderer, size* written)
+{
+    COMMON_NULLPTR_GUARD(renderer, TERM_StatusNullPtr);
+
+    Frame frame = {.out = renderer->buffer, .row = 0, .lit = -1};
+    bool everything = !renderer->drawn;
+    if (everything) {
+        Append(&frame, CLEAR_SCREEN, sizeof(CLEAR_SCREEN) - 1);
+    }
+
+    for (size c = 0; c < renderer->count; ++c) {
+        CHAIN_Instance* chain = &renderer->chains[c];
+        CHAIN_Render(chain);
+        DrawChain(renderer, &frame, &renderer->areas[c], chain, everything);
+    }
+
+    size length = (size)(frame.out - renderer->buffer);
+    if (written != NULL) {
+        *written = 0;
+    }
+    if (length == 0) {
+        return TERM_StatusOk;
+    }
+
+    Append(&frame, RESET_ATTRIBUTES, sizeof(RESET_ATTRIBUTES) - 1);
+    length = (size)(frame.out - renderer->buffer);
+    if (!WriteAll(renderer->fd, renderer->buffer, length)) {
+        return TERM_StatusIoError;
+    }
+
+    renderer->drawn = true;
+    renderer->bytes += length;
+    if (written != NULL) {
+        *written = length;
+    }
+    return TERM_StatusOk;
+}
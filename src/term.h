@@ -0,0 +1,141 @@
+#ifndef TERM_H
+#define TERM_H
+
+#include "common.h"
+#include "chain.h"
+#include "layout.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Devices drawn next to each other before the layout wraps */
+#define TERM_DEFAULT_PER_ROW 8
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    TERM_StatusOk = 0,     /**< OK */
+    TERM_StatusNullPtr,    /**< Null pointer was passed to API function */
+    TERM_StatusMemError,   /**< Memory allocation error */
+    TERM_StatusWrongSize,  /**< No chains, zero devices per row or drawing
+                                exceeds terminal coordinates */
+    TERM_StatusIoError     /**< Writing to the terminal failed */
+} TERM_Status;
+
+/**
+ * @brief How a single device is displayed
+ */
+typedef enum
+{
+    TERM_ModeMatrix = 0, /**< 8x8 LED matrix, digit N is row N, D7 leftmost */
+    TERM_ModeDigits      /**< 8 seven-segment digits, digit 0 rightmost */
+} TERM_Mode;
+
+/**
+ * @brief Part of the screen showing a single chain
+ */
+typedef struct
+{
+    LAYOUT_Map map; /**< Module grid of the chain, see LAYOUT_Wrapped */
+    u64* canvas;    /**< Canvas currently on the screen */
+    u16 top;        /**< Top screen row */
+} TERM_Area;
+
+/**
+ * @brief Terminal renderer of a set of chains
+ *
+ * Chains are drawn one below another, devices of a chain left to right with
+ * wrapping after perRow devices. Every chain is composed by LAYOUT_Gather,
+ * a matrix LED is a canvas pixel and a digit is a module pixel row. The
+ * renderer remembers the canvas on the screen and every frame contains
+ * escape sequences for changed cells only.
+ */
+typedef struct
+{
+    int fd;                        /**< Terminal descriptor */
+    TERM_Mode mode;                /**< Device appearance */
+    CHAIN_Instance* chains;        /**< Drawn chains */
+    size count;                    /**< Number of chains */
+    size devices;                  /**< Total number of devices */
+    TERM_Area* areas;              /**< Area of every chain */
+    u64* bitboards;                /**< Chain output padded to a full module grid */
+    u64* canvas;                   /**< Canvas of the chain being drawn */
+    u16 height;                    /**< Number of screen rows used */
+    bool drawn;                    /**< The first full frame has been drawn */
+    char* buffer;                  /**< Output of a single frame */
+    size capacity;                 /**< Buffer size for a full redraw */
+    u64 bytes;                     /**< Bytes written so far */
+} TERM_Renderer;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create renderer of chains.
+ *
+ * Output buffer is sized for a full redraw, so drawing never allocates.
+ * Chains must not change their lengths while the renderer exists.
+ *
+ * @param renderer Renderer instance to be initialized
+ * @param fd       Terminal descriptor, e.g. STDOUT_FILENO
+ * @param mode     Device appearance
+ * @param chains   Chains to be drawn
+ * @param count    Number of chains
+ * @param perRow   Maximal number of devices in a screen row
+ *
+ * @return Instance of TERM_Status. The function possible return values are:
+ * - TERM_StatusNullPtr when null pointer was passed to function
+ * - TERM_StatusWrongSize when count or perRow is zero or the drawing does
+ *   not fit into 65535 terminal rows and columns
+ * - TERM_StatusMemError when there was a memory allocation error
+ * - TERM_StatusOk after success
+ */
+TERM_Status TERM_Create(
+        TERM_Renderer* renderer,
+        int fd,
+        TERM_Mode mode,
+        CHAIN_Instance* chains,
+        size count,
+        size perRow);
+
+/**
+ * @brief Move cursor below the drawing, restore attributes and free memory.
+ *
+ * @param renderer Renderer created with TERM_Create
+ */
+void TERM_Destroy(TERM_Renderer* renderer);
+
+/**
+ * @brief Draw current output of all chains.
+ *
+ * Chains are rendered first. The first call clears the screen and draws
+ * everything, later calls emit changed cells only. The frame is sent with a
+ * single write() and nothing is written if no cell has changed.
+ *
+ * @param renderer Pointer to the renderer
+ * @param written  The buffer in which frame size in bytes is stored (can be NULL)
+ *
+ * @return Instance of TERM_Status. The function possible return values are:
+ * - TERM_StatusNullPtr when null pointer was passed to function
+ * - TERM_StatusIoError when the frame could not be written
+ * - TERM_StatusOk after success
+ */
+TERM_Status TERM_Draw(TERM_Renderer* renderer, size* written);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TERM_H
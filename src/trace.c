@@ -0,0 +1,507 @@
+#include "trace.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Replay destination */
+typedef struct
+{
+    CHAIN_Instance* chains;
+    size count;
+} ReplayTarget;
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Encode unsigned LEB128 value, returns number of bytes used */
+static size EncodeVarint(u64 value, u8* buffer)
+{
+    size length = 0;
+    while (value >= 0x80) {
+        buffer[length++] = (u8)(value | 0x80);
+        value >>= 7;
+    }
+    buffer[length++] = (u8)value;
+    return length;
+}
+
+/* Decode unsigned LEB128 value, returns number of bytes used or 0 */
+static size DecodeVarint(const u8* data, size length, u64* value)
+{
+    u64 result = 0;
+    for (size i = 0; i < length && i < TRACE_VARINT_MAX_SIZE; ++i) {
+        result |= (u64)(data[i] & 0x7F) << (7 * i);
+        if ((data[i] & 0x80) == 0) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/* Write little-endian u16 */
+static inline void PutU16(u8* buffer, u16 value)
+{
+    buffer[0] = (u8)value;
+    buffer[1] = (u8)(value >> 8);
+}
+
+/* Read little-endian u16 */
+static inline u16 GetU16(const u8* data)
+{
+    return (u16)(data[0] | (data[1] << 8));
+}
+
+/* Map signed difference onto unsigned value with small magnitude */
+static inline u64 ZigzagEncode(i64 value)
+{
+    return ((u64)value << 1) ^ (u64)(value >> 63);
+}
+
+/* Inverse of ZigzagEncode */
+static inline i64 ZigzagDecode(u64 value)
+{
+    return (i64)(value >> 1) ^ -(i64)(value & 1);
+}
+
+/* Convert frames into little-endian byte pairs */
+static inline void PutFrames(u8* buffer, const u16* frames, size count)
+{
+    for (size i = 0; i < count; ++i) {
+        PutU16(&buffer[2 * i], frames[i]);
+    }
+}
+
+/* Write frames as little-endian values */
+static TRACE_Status WriteFrames(FILE* file, const u16* frames, size count)
+{
+    /* Frames are converted in small blocks to keep byte order fixed */
+    u8 block[256];
+    for (size i = 0; i < count;) {
+        size chunk = (count - i < sizeof(block) / 2)
+                ? count - i
+                : sizeof(block) / 2;
+        PutFrames(block, &frames[i], chunk);
+        if (fwrite(block, 2, chunk, file) != chunk) {
+            return TRACE_StatusIoError;
+        }
+        i += chunk;
+    }
+    return TRACE_StatusOk;
+}
+
+/* Write record prefix consisting of three varints */
+static TRACE_Status WritePrefix(FILE* file, u64 chain, u64 time, u64 count)
+{
+    u8 prefix[3 * TRACE_VARINT_MAX_SIZE];
+    size length = EncodeVarint(chain, prefix);
+    length += EncodeVarint(time, &prefix[length]);
+    length += EncodeVarint(count, &prefix[length]);
+
+    if (fwrite(prefix, 1, length, file) != length) {
+        return TRACE_StatusIoError;
+    }
+    return TRACE_StatusOk;
+}
+
+/* Get history slot of the literal record stored given number of records back */
+static inline size HistorySlot(const TRACE_History* history, size distance)
+{
+    return (history->head + TRACE_HISTORY_SIZE - distance) % TRACE_HISTORY_SIZE;
+}
+
+/* Remember literal record, frames are given as little-endian byte pairs */
+static void HistoryPush(TRACE_History* history, u64 chain, const u8* frames,
+        size count)
+{
+    if (count > TRACE_HISTORY_MAX_FRAMES) {
+        return;
+    }
+
+    history->entries[history->head].chain = chain;
+    history->entries[history->head].count = count;
+    memcpy(history->entries[history->head].frames, frames, 2 * count);
+    history->head = (history->head + 1) % TRACE_HISTORY_SIZE;
+    if (history->filled < TRACE_HISTORY_SIZE) {
+        ++history->filled;
+    }
+}
+
+/* Find distance of identical history entry, 0 if there is none */
+static size HistoryFind(const TRACE_History* history, u64 chain,
+        const u8* frames, size count)
+{
+    for (size distance = 1; distance <= history->filled; ++distance) {
+        size slot = HistorySlot(history, distance);
+        if (history->entries[slot].chain == chain
+                && history->entries[slot].count == count
+                && memcmp(history->entries[slot].frames, frames, 2 * count) == 0) {
+            return distance;
+        }
+    }
+    return 0;
+}
+
+/* Write record as a reference to history or as a literal */
+static TRACE_Status WriteCompressed(
+        TRACE_Writer* writer,
+        u64 chain,
+        u64 time,
+        const u16* frames,
+        size count)
+{
+    if (count > TRACE_HISTORY_MAX_FRAMES) {
+        TRACE_Status status = WritePrefix(writer->file, chain, time, count << 1);
+        if (status != TRACE_StatusOk) {
+            return status;
+        }
+        return WriteFrames(writer->file, frames, count);
+    }
+
+    u8 bytes[2 * TRACE_HISTORY_MAX_FRAMES];
+    PutFrames(bytes, frames, count);
+
+    size distance = HistoryFind(&writer->history, chain, bytes, count);
+    if (distance != 0) {
+        return WritePrefix(writer->file, chain, time, ((u64)distance << 1) | 1);
+    }
+
+    TRACE_Status status = WritePrefix(writer->file, chain, time, count << 1);
+    if (status != TRACE_StatusOk) {
+        return status;
+    }
+    if (fwrite(bytes, 2, count, writer->file) != count) {
+        return TRACE_StatusIoError;
+    }
+    HistoryPush(&writer->history, chain, bytes, count);
+    return TRACE_StatusOk;
+}
+
+/* Start writing trace with given header flags */
+static TRACE_Status WriteHeader(TRACE_Writer* writer, FILE* file, u16 flags)
+{
+    u8 header[TRACE_HEADER_SIZE] = {0};
+    memcpy(header, TRACE_MAGIC, TRACE_MAGIC_SIZE);
+    PutU16(&header[TRACE_MAGIC_SIZE], TRACE_VERSION);
+    PutU16(&header[TRACE_MAGIC_SIZE + 2], flags);
+
+    writer->file = file;
+    writer->lastTimestamp = 0;
+    writer->lastDelta = 0;
+    writer->flags = flags;
+    writer->history.head = 0;
+    writer->history.filled = 0;
+
+    if (fwrite(header, sizeof(header), 1, file) != 1) {
+        return TRACE_StatusIoError;
+    }
+    return TRACE_StatusOk;
+}
+
+/* Feed record into chain selected by its id */
+static TRACE_Status ReplayRecord(void* context, const TRACE_Record* record)
+{
+    ReplayTarget* target = context;
+    if (record->chain >= target->count) {
+        return TRACE_StatusWrongChain;
+    }
+
+    TRACE_FeedChain(&target->chains[record->chain], record);
+    return TRACE_StatusOk;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+TRACE_Status TRACE_WriterInit(TRACE_Writer* writer, FILE* file)
+{
+    COMMON_NULLPTR_GUARD(writer, TRACE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(file, TRACE_StatusNullPtr);
+
+    return WriteHeader(writer, file, 0);
+}
+
+TRACE_Status TRACE_WriterInitCompressed(TRACE_Writer* writer, FILE* file)
+{
+    COMMON_NULLPTR_GUARD(writer, TRACE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(file, TRACE_StatusNullPtr);
+
+    return WriteHeader(writer, file, TRACE_FLAG_COMPRESSED);
+}
+
+TRACE_Status TRACE_WriteRecord(
+        TRACE_Writer* writer,
+        u64 chain,
+        u64 timestamp,
+        const u16* frames,
+        size count)
+{
+    COMMON_NULLPTR_GUARD(writer, TRACE_StatusNullPtr);
+    if (count > 0) {
+        COMMON_NULLPTR_GUARD(frames, TRACE_StatusNullPtr);
+    }
+
+    u64 delta = timestamp - writer->lastTimestamp;
+    writer->lastTimestamp = timestamp;
+
+    if (writer->flags & TRACE_FLAG_COMPRESSED) {
+        u64 time = ZigzagEncode((i64)(delta - writer->lastDelta));
+        writer->lastDelta = delta;
+        return WriteCompressed(writer, chain, time, frames, count);
+    }
+
+    TRACE_Status status = WritePrefix(writer->file, chain, delta, count);
+    if (status != TRACE_StatusOk) {
+        return status;
+    }
+    return WriteFrames(writer->file, frames, count);
+}
+
+TRACE_Status TRACE_DecodeHeader(
+        const u8* data,
+        size length,
+        TRACE_Header* header)
+{
+    COMMON_NULLPTR_GUARD(data, TRACE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(header, TRACE_StatusNullPtr);
+
+    if (length < TRACE_HEADER_SIZE) {
+        return TRACE_StatusTruncated;
+    }
+    if (memcmp(data, TRACE_MAGIC, TRACE_MAGIC_SIZE) != 0) {
+        return TRACE_StatusBadHeader;
+    }
+
+    header->version = GetU16(&data[TRACE_MAGIC_SIZE]);
+    header->flags = GetU16(&data[TRACE_MAGIC_SIZE + 2]);
+
+    if (header->version != TRACE_VERSION
+            || (header->flags & ~TRACE_FLAGS_SUPPORTED) != 0) {
+        return TRACE_StatusBadHeader;
+    }
+    return TRACE_StatusOk;
+}
+
+TRACE_Status TRACE_DecodeRecord(
+        const u8* data,
+        size length,
+        u64* timestamp,
+        TRACE_Record* record,
+        size* consumed)
+{
+    u64 chain;
+    u64 delta;
+    u64 count;
+    size used;
+    size offset = 0;
+
+    used = DecodeVarint(data, length, &chain);
+    if (used == 0) {
+        return TRACE_StatusTruncated;
+    }
+    offset += used;
+
+    used = DecodeVarint(&data[offset], length - offset, &delta);
+    if (used == 0) {
+        return TRACE_StatusTruncated;
+    }
+    offset += used;
+
+    used = DecodeVarint(&data[offset], length - offset, &count);
+    if (used == 0 || count > (length - offset - used) / 2) {
+        return TRACE_StatusTruncated;
+    }
+    offset += used;
+
+    record->chain = chain;
+    record->timestamp = *timestamp + delta;
+    record->frames = &data[offset];
+    record->count = (size)count;
+
+    *timestamp = record->timestamp;
+    *consumed = offset + 2 * (size)count;
+    return TRACE_StatusOk;
+}
+
+void TRACE_DecoderInit(TRACE_Decoder* decoder, u16 flags)
+{
+    decoder->flags = flags;
+    decoder->timestamp = 0;
+    decoder->delta = 0;
+    decoder->history.head = 0;
+    decoder->history.filled = 0;
+}
+
+TRACE_Status TRACE_DecoderNext(
+        TRACE_Decoder* decoder,
+        const u8* data,
+        size length,
+        TRACE_Record* record,
+        size* consumed)
+{
+    if ((decoder->flags & TRACE_FLAG_COMPRESSED) == 0) {
+        return TRACE_DecodeRecord(data, length, &decoder->timestamp, record,
+                consumed);
+    }
+
+    u64 chain;
+    u64 time;
+    u64 field;
+    size used;
+    size offset = 0;
+
+    used = DecodeVarint(data, length, &chain);
+    if (used == 0) {
+        return TRACE_StatusTruncated;
+    }
+    offset += used;
+
+    used = DecodeVarint(&data[offset], length - offset, &time);
+    if (used == 0) {
+        return TRACE_StatusTruncated;
+    }
+    offset += used;
+
+    used = DecodeVarint(&data[offset], length - offset, &field);
+    if (used == 0) {
+        return TRACE_StatusTruncated;
+    }
+    offset += used;
+
+    record->chain = chain;
+    if (field & 1) {
+        u64 distance = field >> 1;
+        if (distance == 0 || distance > decoder->history.filled) {
+            return TRACE_StatusBadReference;
+        }
+        size slot = HistorySlot(&decoder->history, (size)distance);
+        record->frames = decoder->history.entries[slot].frames;
+        record->count = decoder->history.entries[slot].count;
+    } else {
+        u64 count = field >> 1;
+        if (count > (length - offset) / 2) {
+            return TRACE_StatusTruncated;
+        }
+        record->frames = &data[offset];
+        record->count = (size)count;
+        offset += 2 * (size)count;
+        HistoryPush(&decoder->history, chain, record->frames, record->count);
+    }
+
+    decoder->delta += (u64)ZigzagDecode(time);
+    decoder->timestamp += decoder->delta;
+    record->timestamp = decoder->timestamp;
+
+    *consumed = offset;
+    return TRACE_StatusOk;
+}
+
+TRACE_Status TRACE_Parse(
+        const u8* data,
+        size length,
+        TRACE_RecordCallback callback,
+        void* context)
+{
+    COMMON_NULLPTR_GUARD(callback, TRACE_StatusNullPtr);
+
+    TRACE_Header header;
+    TRACE_Status status = TRACE_DecodeHeader(data, length, &header);
+    if (status != TRACE_StatusOk) {
+        return status;
+    }
+
+    TRACE_Decoder decoder;
+    TRACE_DecoderInit(&decoder, header.flags);
+
+    size offset = TRACE_HEADER_SIZE;
+    while (offset < length) {
+        TRACE_Record record;
+        size consumed;
+
+        status = TRACE_DecoderNext(&decoder, &data[offset], length - offset,
+                &record, &consumed);
+        if (status == TRACE_StatusOk) {
+            status = callback(context, &record);
+        }
+        if (status != TRACE_StatusOk) {
+            return status;
+        }
+        offset += consumed;
+    }
+
+    return TRACE_StatusOk;
+}
+
+TRACE_Status TRACE_Map(TRACE_Mapping* mapping, const char* path)
+{
+    COMMON_NULLPTR_GUARD(mapping, TRACE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(path, TRACE_StatusNullPtr);
+
+    mapping->data = NULL;
+    mapping->length = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return TRACE_StatusIoError;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return TRACE_StatusIoError;
+    }
+
+    void* data = mmap(NULL, (size)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return TRACE_StatusIoError;
+    }
+
+    /* Replay reads the file front to back exactly once */
+    madvise(data, (size)info.st_size, MADV_SEQUENTIAL);
+
+    mapping->data = data;
+    mapping->length = (size)info.st_size;
+    return TRACE_StatusOk;
+}
+
+void TRACE_Unmap(TRACE_Mapping* mapping)
+{
+    if (mapping == NULL || mapping->data == NULL) {
+        return;
+    }
+
+    munmap((void*)mapping->data, mapping->length);
+    mapping->data = NULL;
+    mapping->length = 0;
+}
+
+void TRACE_FeedChain(CHAIN_Instance* chain, const TRACE_Record* record)
+{
+    const u8* frame = record->frames;
+    for (size i = 0; i < record->count; ++i, frame += 2) {
+        CHAIN_Shift(chain, GetU16(frame));
+    }
+    CHAIN_Latch(chain);
+}
+
+TRACE_Status TRACE_Replay(
+        const TRACE_Mapping* mapping,
+        CHAIN_Instance* chains,
+        size count)
+{
+    COMMON_NULLPTR_GUARD(mapping, TRACE_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(chains, TRACE_StatusNullPtr);
+
+    ReplayTarget target = {.chains = chains, .count = count};
+    return TRACE_Parse(mapping->data, mapping->length, ReplayRecord, &target);
+}
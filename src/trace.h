@@ -0,0 +1,342 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "common.h"
+#include "chain.h"
+
+#include <stdio.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* File signature */
+#define TRACE_MAGIC "M7219TRC"
+#define TRACE_MAGIC_SIZE 8
+
+/* Current format version */
+#define TRACE_VERSION 1
+
+/* Size of the file header in bytes */
+#define TRACE_HEADER_SIZE 16
+
+/* Maximal encoded size of a varint */
+#define TRACE_VARINT_MAX_SIZE 10
+
+/* Header flags */
+#define TRACE_FLAG_COMPRESSED 0x0001 /* Back-references and second order deltas */
+#define TRACE_FLAGS_SUPPORTED TRACE_FLAG_COMPRESSED
+
+/* Number of recent records a compressed record can refer to */
+#define TRACE_HISTORY_SIZE 16
+
+/* Records with more frames are never kept in the history */
+#define TRACE_HISTORY_MAX_FRAMES 64
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    TRACE_StatusOk = 0,       /**< OK */
+    TRACE_StatusNullPtr,      /**< Null pointer was passed to API function */
+    TRACE_StatusIoError,      /**< File could not be opened, mapped or written */
+    TRACE_StatusBadHeader,    /**< Wrong signature or unsupported version */
+    TRACE_StatusTruncated,    /**< Data ends in the middle of a record */
+    TRACE_StatusWrongChain,   /**< Record refers to a chain which does not exist */
+    TRACE_StatusBadReference, /**< Record refers to a missing history entry */
+    TRACE_StatusWrongTime     /**< Record is older than the previous one */
+} TRACE_Status;
+
+/**
+ * @brief Decoded file header
+ *
+ * On disk: 8-byte signature, little-endian u16 version, u16 flags and u32
+ * reserved field.
+ */
+typedef struct
+{
+    u16 version; /**< Format version */
+    u16 flags;   /**< Format flags */
+} TRACE_Header;
+
+/**
+ * @brief Single transaction: frames shifted in while LOAD is low, then latch
+ *
+ * On disk every record consists of varint chain id, varint timestamp delta
+ * to the previous record [ns], varint frame count and the frames as
+ * little-endian u16 values.
+ *
+ * With TRACE_FLAG_COMPRESSED the timestamp field holds zigzag encoded
+ * difference between this and the previous timestamp delta, so periodic
+ * traffic costs a single byte. The count field holds (count << 1) for literal
+ * records followed by frames, or (distance << 1) | 1 for records repeating
+ * the transaction stored distance entries back in TRACE_History.
+ */
+typedef struct
+{
+    u64 chain;        /**< Chain id */
+    u64 timestamp;    /**< Absolute timestamp of the latch [ns] */
+    const u8* frames; /**< Frames as little-endian byte pairs, not copied */
+    size count;       /**< Number of frames */
+} TRACE_Record;
+
+/**
+ * @brief Recently seen transactions, kept in sync by writer and decoder
+ *
+ * Every literal record of at most TRACE_HISTORY_MAX_FRAMES frames is stored
+ * in the ring. References do not modify it, thus a firmware refreshing rows
+ * of the display in a loop refers to the same entries over and over.
+ */
+typedef struct
+{
+    struct
+    {
+        u64 chain;                               /**< Chain id */
+        size count;                              /**< Number of frames */
+        u8 frames[2 * TRACE_HISTORY_MAX_FRAMES]; /**< Little-endian frames */
+    } entries[TRACE_HISTORY_SIZE];
+    size head;   /**< Slot to be filled by the next literal record */
+    size filled; /**< Number of valid entries */
+} TRACE_History;
+
+/**
+ * @brief Record decoding state
+ */
+typedef struct
+{
+    u16 flags;             /**< Header flags of the trace */
+    u64 timestamp;         /**< Timestamp of the previous record */
+    u64 delta;             /**< Timestamp delta of the previous record */
+    TRACE_History history; /**< Back-reference targets, compressed only */
+} TRACE_Decoder;
+
+/**
+ * @brief Record consumer type
+ */
+typedef TRACE_Status (*TRACE_RecordCallback)(void* context,
+        const TRACE_Record* record);
+
+/**
+ * @brief Trace writer
+ */
+typedef struct
+{
+    FILE* file;            /**< Output stream */
+    u64 lastTimestamp;     /**< Timestamp of the previous record */
+    u64 lastDelta;         /**< Timestamp delta of the previous record */
+    u16 flags;             /**< Header flags of the written trace */
+    TRACE_History history; /**< Back-reference targets, compressed only */
+} TRACE_Writer;
+
+/**
+ * @brief Read-only memory mapping of a trace file
+ */
+typedef struct
+{
+    const u8* data; /**< Mapped file contents */
+    size length;    /**< File length */
+} TRACE_Mapping;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Start writing trace into a stream.
+ *
+ * @param writer Writer instance to be initialized
+ * @param file   Output stream opened in binary mode
+ *
+ * @return Instance of TRACE_Status. The function possible return values are:
+ * - TRACE_StatusNullPtr when null pointer was passed to function
+ * - TRACE_StatusIoError when the header could not be written
+ * - TRACE_StatusOk after success
+ */
+TRACE_Status TRACE_WriterInit(TRACE_Writer* writer, FILE* file);
+
+/**
+ * @brief Start writing compressed trace into a stream.
+ *
+ * Transactions identical to one of the TRACE_HISTORY_SIZE recent ones are
+ * written as short references and timestamps are stored as differences of
+ * consecutive deltas. Records are written immediately, nothing is held back.
+ *
+ * @param writer Writer instance to be initialized
+ * @param file   Output stream opened in binary mode
+ *
+ * @return Instance of TRACE_Status. The function possible return values are:
+ * - TRACE_StatusNullPtr when null pointer was passed to function
+ * - TRACE_StatusIoError when the header could not be written
+ * - TRACE_StatusOk after success
+ */
+TRACE_Status TRACE_WriterInitCompressed(TRACE_Writer* writer, FILE* file);
+
+/**
+ * @brief Append single transaction to the trace.
+ *
+ * @param writer    Pointer to the writer
+ * @param chain     Chain id
+ * @param timestamp Absolute timestamp [ns], not lower than the previous one
+ * @param frames    Frames in the order they are sent over the bus
+ * @param count     Number of frames
+ *
+ * @return Instance of TRACE_Status. The function possible return values are:
+ * - TRACE_StatusNullPtr when null pointer was passed to function
+ * - TRACE_StatusIoError when the record could not be written
+ * - TRACE_StatusOk after success
+ */
+TRACE_Status TRACE_WriteRecord(
+        TRACE_Writer* writer,
+        u64 chain,
+        u64 timestamp,
+        const u16* frames,
+        size count);
+
+/**
+ * @brief Decode file header.
+ *
+ * @param data   Beginning of the trace
+ * @param length Number of available bytes
+ * @param header The buffer in which decoded header is stored
+ *
+ * @return Instance of TRACE_Status. The function possible return values are:
+ * - TRACE_StatusNullPtr when null pointer was passed to function
+ * - TRACE_StatusTruncated when less than TRACE_HEADER_SIZE bytes are available
+ * - TRACE_StatusBadHeader when signature, version or flags are not supported
+ * - TRACE_StatusOk after success
+ */
+TRACE_Status TRACE_DecodeHeader(
+        const u8* data,
+        size length,
+        TRACE_Header* header);
+
+/**
+ * @brief Decode single record without copying frames.
+ *
+ * @param data      Beginning of the record
+ * @param length    Number of available bytes
+ * @param timestamp Absolute timestamp of the previous record, updated
+ * @param record    The buffer in which decoded record is stored
+ * @param consumed  The buffer in which size of the record is stored
+ *
+ * @return Instance of TRACE_Status. The function possible return values are:
+ * - TRACE_StatusTruncated when the record is not complete. Nothing is updated
+ * - TRACE_StatusOk after success
+ */
+TRACE_Status TRACE_DecodeRecord(
+        const u8* data,
+        size length,
+        u64* timestamp,
+        TRACE_Record* record,
+        size* consumed);
+
+/**
+ * @brief Prepare decoding of records following the header.
+ *
+ * @param decoder Decoder instance to be initialized
+ * @param flags   Flags of decoded header
+ */
+void TRACE_DecoderInit(TRACE_Decoder* decoder, u16 flags);
+
+/**
+ * @brief Decode single record in the format selected by header flags.
+ *
+ * Frames of literal records point into data, frames of references point into
+ * the decoder history and stay valid until the next call.
+ *
+ * @param decoder  Decoder state
+ * @param data     Beginning of the record
+ * @param length   Number of available bytes
+ * @param record   The buffer in which decoded record is stored
+ * @param consumed The buffer in which size of the record is stored
+ *
+ * @return Instance of TRACE_Status. The function possible return values are:
+ * - TRACE_StatusTruncated when the record is not complete. Nothing is updated
+ * - TRACE_StatusBadReference when the record refers to missing history entry
+ * - TRACE_StatusOk after success
+ */
+TRACE_Status TRACE_DecoderNext(
+        TRACE_Decoder* decoder,
+        const u8* data,
+        size length,
+        TRACE_Record* record,
+        size* consumed);
+
+/**
+ * @brief Parse whole in-memory trace and pass every record to the callback.
+ *
+ * @param data     Trace contents including header
+ * @param length   Trace length
+ * @param callback Record consumer. Non-OK status stops parsing
+ * @param context  User context passed to callback
+ *
+ * @return TRACE_StatusOk after success, decoding error or callback status
+ */
+TRACE_Status TRACE_Parse(
+        const u8* data,
+        size length,
+        TRACE_RecordCallback callback,
+        void* context);
+
+/**
+ * @brief Map trace file into memory.
+ *
+ * @param mapping Mapping instance to be initialized
+ * @param path    Path to the trace file
+ *
+ * @return Instance of TRACE_Status. The function possible return values are:
+ * - TRACE_StatusNullPtr when null pointer was passed to function
+ * - TRACE_StatusIoError when the file could not be opened or mapped
+ * - TRACE_StatusOk after success
+ */
+TRACE_Status TRACE_Map(TRACE_Mapping* mapping, const char* path);
+
+/**
+ * @brief Unmap trace file.
+ *
+ * @param mapping Mapping created with TRACE_Map
+ */
+void TRACE_Unmap(TRACE_Mapping* mapping);
+
+/**
+ * @brief Shift record frames into the chain and latch them.
+ *
+ * Frames are read straight from the record storage.
+ *
+ * @param chain  Pointer to the chain
+ * @param record Decoded record
+ */
+void TRACE_FeedChain(CHAIN_Instance* chain, const TRACE_Record* record);
+
+/**
+ * @brief Replay mapped trace into an array of chains indexed by chain id.
+ *
+ * @param mapping Mapped trace
+ * @param chains  Chains to be driven
+ * @param count   Number of chains
+ *
+ * @return Instance of TRACE_Status. The function possible return values are:
+ * - TRACE_StatusNullPtr when null pointer was passed to function
+ * - TRACE_StatusBadHeader or TRACE_StatusTruncated when trace is malformed
+ * - TRACE_StatusWrongChain when a record refers to chain id >= count
+ * - TRACE_StatusOk after success
+ */
+TRACE_Status TRACE_Replay(
+        const TRACE_Mapping* mapping,
+        CHAIN_Instance* chains,
+        size count);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TRACE_H
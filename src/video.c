@@ -0,0 +1,223 @@
+#include "video.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Ready slot holds buffer index, the flag tells it has not been taken yet */
+#define READY_INDEX_MASK 0x3u
+#define READY_FRESH      0x4u
+
+#define NS_PER_SECOND UINT64_C(1000000000)
+
+/* -------------------------------------------------------------------------- */
+/* ----------------------------- Private functions -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Monotonic time in nanoseconds */
+static u64 Now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * NS_PER_SECOND + (u64)now.tv_nsec;
+}
+
+/* Write whole buffer, retrying after signals and partial writes */
+static bool WriteAll(int fd, const u8* data, size length)
+{
+    while (length > 0) {
+        ssize_t count = write(fd, data, length);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += count;
+        length -= (size)count;
+    }
+    return true;
+}
+
+/* Release frame buffers */
+static void FreeBuffers(VIDEO_Output* video)
+{
+    for (u32 i = 0; i < VIDEO_BUFFERS; ++i) {
+        free(video->buffers[i]);
+        video->buffers[i] = NULL;
+    }
+}
+
+/* Sleep until deadline or stop request, returns true if stop was requested */
+static bool WaitTick(VIDEO_Output* video, u64 deadline)
+{
+    struct timespec until = {
+        .tv_sec = (time_t)(deadline / NS_PER_SECOND),
+        .tv_nsec = (long)(deadline % NS_PER_SECOND)
+    };
+
+    pthread_mutex_lock(&video->lock);
+    while (!video->stop && Now() < deadline) {
+        pthread_cond_timedwait(&video->wake, &video->lock, &until);
+    }
+    bool stop = video->stop;
+    pthread_mutex_unlock(&video->lock);
+    return stop;
+}
+
+/* Take the newest published frame, returns false if there is none */
+static bool TakeFresh(VIDEO_Output* video)
+{
+    if ((atomic_load_explicit(&video->ready, memory_order_relaxed) & READY_FRESH) == 0) {
+        return false;
+    }
+    video->front = atomic_exchange_explicit(&video->ready, video->front,
+            memory_order_acq_rel) & READY_INDEX_MASK;
+    return true;
+}
+
+/* Pacing thread entry point */
+static void* PacingMain(void* argument)
+{
+    VIDEO_Output* video = argument;
+    bool shown = false;
+    u64 deadline = Now();
+
+    for (;;) {
+        bool stop = WaitTick(video, deadline);
+        bool fresh = TakeFresh(video);
+
+        /* The final frame is written once, nothing is repeated after stop */
+        if (fresh || (shown && !stop)) {
+            if (!WriteAll(video->fd, video->buffers[video->front], video->frameSize)) {
+                atomic_store_explicit(&video->failed, true, memory_order_release);
+                break;
+            }
+            video->duplicated += !fresh;
+            ++video->written;
+            shown = true;
+        }
+        if (stop) {
+            break;
+        }
+
+        /* Ticks missed during a blocked write are not caught up */
+        deadline += video->period;
+        u64 now = Now();
+        if (now > deadline) {
+            u64 missed = (now - deadline) / video->period;
+            video->skipped += missed;
+            deadline += missed * video->period;
+        }
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+VIDEO_Status VIDEO_Create(VIDEO_Output* video, int fd, size frameSize, size fps)
+{
+    COMMON_NULLPTR_GUARD(video, VIDEO_StatusNullPtr);
+
+    if (frameSize == 0 || fps == 0) {
+        return VIDEO_StatusWrongSize;
+    }
+
+    memset(video, 0, sizeof(*video));
+    video->fd = fd;
+    video->frameSize = frameSize;
+    video->period = NS_PER_SECOND / fps;
+    if (video->period == 0) {
+        video->period = 1;
+    }
+
+    for (u32 i = 0; i < VIDEO_BUFFERS; ++i) {
+        video->buffers[i] = calloc(1, frameSize);
+        if (video->buffers[i] == NULL) {
+            FreeBuffers(video);
+            return VIDEO_StatusMemError;
+        }
+    }
+    video->back = 0;
+    video->front = 1;
+    atomic_init(&video->ready, 2);
+    atomic_init(&video->failed, false);
+
+    /* Frame deadlines are monotonic, so is the condition variable clock */
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&video->wake, &attributes);
+    pthread_condattr_destroy(&attributes);
+    pthread_mutex_init(&video->lock, NULL);
+
+    if (pthread_create(&video->thread, NULL, PacingMain, video) != 0) {
+        pthread_mutex_destroy(&video->lock);
+        pthread_cond_destroy(&video->wake);
+        FreeBuffers(video);
+        return VIDEO_StatusThreadError;
+    }
+
+    video->running = true;
+    return VIDEO_StatusOk;
+}
+
+VIDEO_Status VIDEO_Publish(VIDEO_Output* video, const u8* frame)
+{
+    COMMON_NULLPTR_GUARD(video, VIDEO_StatusNullPtr);
+    COMMON_NULLPTR_GUARD(frame, VIDEO_StatusNullPtr);
+
+    if (atomic_load_explicit(&video->failed, memory_order_acquire)) {
+        return VIDEO_StatusIoError;
+    }
+
+    memcpy(video->buffers[video->back], frame, video->frameSize);
+    u32 previous = atomic_exchange_explicit(&video->ready,
+            video->back | READY_FRESH, memory_order_acq_rel);
+
+    /* The pacing thread has not taken the previous frame in time */
+    video->dropped += (previous & READY_FRESH) != 0;
+    video->back = previous & READY_INDEX_MASK;
+    ++video->published;
+    return VIDEO_StatusOk;
+}
+
+VIDEO_Status VIDEO_Finish(VIDEO_Output* video)
+{
+    COMMON_NULLPTR_GUARD(video, VIDEO_StatusNullPtr);
+
+    if (video->running) {
+        pthread_mutex_lock(&video->lock);
+        video->stop = true;
+        pthread_cond_broadcast(&video->wake);
+        pthread_mutex_unlock(&video->lock);
+
+        pthread_join(video->thread, NULL);
+        video->running = false;
+    }
+
+    return atomic_load_explicit(&video->failed, memory_order_acquire)
+            ? VIDEO_StatusIoError
+            : VIDEO_StatusOk;
+}
+
+void VIDEO_Destroy(VIDEO_Output* video)
+{
+    if (video == NULL) {
+        return;
+    }
+
+    VIDEO_Finish(video);
+    pthread_mutex_destroy(&video->lock);
+    pthread_cond_destroy(&video->wake);
+    FreeBuffers(video);
+    memset(video, 0, sizeof(*video));
+}
@@ -0,0 +1,131 @@
+#ifndef VIDEO_H
+#define VIDEO_H
+
+#include "common.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Macros -------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Frame buffers cycled between publisher and pacing thread */
+#define VIDEO_BUFFERS 3
+
+/* -------------------------------------------------------------------------- */
+/* -------------------------------- Data types ------------------------------ */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief An enum to represent status codes for module
+ */
+typedef enum
+{
+    VIDEO_StatusOk = 0,       /**< OK */
+    VIDEO_StatusNullPtr,      /**< Null pointer was passed to API function */
+    VIDEO_StatusMemError,     /**< Memory allocation error */
+    VIDEO_StatusWrongSize,    /**< Zero frame size or frame rate */
+    VIDEO_StatusIoError,      /**< Writing to the descriptor failed */
+    VIDEO_StatusThreadError   /**< Pacing thread could not be started */
+} VIDEO_Status;
+
+/**
+ * @brief Fixed frame rate stream of raw frames written by a pacing thread
+ *
+ * Frames are handed over through a triple buffer: publishing swaps the
+ * freshly filled buffer with the ready one and never waits. On every tick the
+ * pacing thread writes the newest published frame, repeating the previous one
+ * if nothing new arrived (duplicated) and skipping ticks it missed while a
+ * write was blocked. A frame replaced before its tick came is dropped.
+ */
+typedef struct
+{
+    int fd;                           /**< Output descriptor */
+    size frameSize;                   /**< Bytes per frame */
+    u64 period;                       /**< Tick period [ns] */
+    u8* buffers[VIDEO_BUFFERS];       /**< Frame buffers */
+    u32 back;                         /**< Buffer filled by publisher */
+    u32 front;                        /**< Buffer written by pacing thread */
+    atomic_uint ready;                /**< Buffer handed over, with fresh flag */
+    atomic_bool failed;               /**< Writing failed, thread has quit */
+    pthread_t thread;                 /**< Pacing thread */
+    pthread_mutex_t lock;             /**< Protects stop flag */
+    pthread_cond_t wake;              /**< Signalled when stop is requested */
+    bool stop;                        /**< Publisher asks pacing thread to quit */
+    bool running;                     /**< Pacing thread has not been joined */
+    u64 published;                    /**< Frames published */
+    u64 dropped;                      /**< Published frames never written */
+    u64 written;                      /**< Frames written, duplicates included */
+    u64 duplicated;                   /**< Ticks which repeated previous frame */
+    u64 skipped;                      /**< Ticks missed while writing was late */
+} VIDEO_Output;
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- API functions ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Create video output and start its pacing thread.
+ *
+ * Nothing is written until the first frame is published.
+ *
+ * @param video     Output instance to be initialized
+ * @param fd        Output descriptor, e.g. STDOUT_FILENO or an opened FIFO
+ * @param frameSize Bytes per frame, e.g. width * height * 3 for RGB
+ * @param fps       Frame rate
+ *
+ * @return Instance of VIDEO_Status. The function possible return values are:
+ * - VIDEO_StatusNullPtr when null pointer was passed to function
+ * - VIDEO_StatusWrongSize when frameSize or fps is zero
+ * - VIDEO_StatusMemError when there was a memory allocation error
+ * - VIDEO_StatusThreadError when the pacing thread could not be started
+ * - VIDEO_StatusOk after success
+ */
+VIDEO_Status VIDEO_Create(VIDEO_Output* video, int fd, size frameSize, size fps);
+
+/**
+ * @brief Hand new frame over to the pacing thread without waiting.
+ *
+ * Must be called from a single thread.
+ *
+ * @param video Pointer to the output
+ * @param frame Frame of VIDEO_Output::frameSize bytes, copied
+ *
+ * @return Instance of VIDEO_Status. The function possible return values are:
+ * - VIDEO_StatusNullPtr when null pointer was passed to function
+ * - VIDEO_StatusIoError when writing has failed, the frame is discarded
+ * - VIDEO_StatusOk after success
+ */
+VIDEO_Status VIDEO_Publish(VIDEO_Output* video, const u8* frame);
+
+/**
+ * @brief Write the last published frame if it is pending and stop the thread.
+ *
+ * Counters stay valid until VIDEO_Destroy.
+ *
+ * @param video Pointer to the output
+ *
+ * @return Instance of VIDEO_Status. The function possible return values are:
+ * - VIDEO_StatusNullPtr when null pointer was passed to function
+ * - VIDEO_StatusIoError when writing has failed
+ * - VIDEO_StatusOk after success
+ */
+VIDEO_Status VIDEO_Finish(VIDEO_Output* video);
+
+/**
+ * @brief Stop pacing thread and release memory owned by the output.
+ *
+ * @param video Output created with VIDEO_Create
+ */
+void VIDEO_Destroy(VIDEO_Output* video);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // VIDEO_H
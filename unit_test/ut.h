@@ -2,6 +2,7 @@
 #define UT_H
 
 #include "unity.h"
+#include "chain.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -13,6 +14,13 @@ extern "C" {
 
 #define TEST_ASSERT_STATUS_EQ(EXP, ACT) TEST_ASSERT_EQUAL_INT32((EXP), (ACT))
 
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- Test helpers ----------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Write the same register in every device of the chain, see ut_common.c */
+void UT_Broadcast(CHAIN_Instance* chain, u8 address, u8 data);
+
 /* -------------------------------------------------------------------------- */
 /* ---------------------------- Test declarations --------------------------- */
 /* ------------ Naming convention: UT_{MODULE}_{FUNCTION}_{CONDITION} ------- */
@@ -20,6 +28,133 @@ extern "C" {
 
 /* Put tests declaration here */
 
+/* UT_VIDEO */
+void UT_VIDEO_Create_WrongArguments(void);
+void UT_VIDEO_Publish_FrameReplacedBeforeTickIsDropped(void);
+void UT_VIDEO_Publish_MissingFramesAreDuplicated(void);
+void UT_VIDEO_Publish_WriteErrorIsReported(void);
+
+/* UT_SERVER */
+void UT_SERVER_Create_WrongArguments(void);
+void UT_SERVER_Create_PathInUseIsKept(void);
+void UT_SERVER_Create_StaleSocketIsReplaced(void);
+void UT_SERVER_Display_BatchedTransactionsAreApplied(void);
+void UT_SERVER_Display_ConnectionsAreIndependent(void);
+void UT_SERVER_Run_MalformedMessageClosesConnection(void);
+
+/* UT_CHAIN */
+void UT_CHAIN_Create_ErrStatusIsReturnedForZeroLength(void);
+void UT_CHAIN_Transfer_FirstFrameEndsUpInLastDevice(void);
+void UT_CHAIN_ChangedSince_OnlyTouchedDevicesAreReported(void);
+void UT_CHAIN_ChangedSince_LeavingShutdownRevealsEarlierWrites(void);
+void UT_CHAIN_Latch_RedundantFramesAreCounted(void);
+void UT_CHAIN_PowerOn_AllDevicesAreResetAndLitOnesReported(void);
+void UT_CHAIN_PowerOn_WritesDuringShutdownShowUpAfterWakeUp(void);
+void UT_CHAIN_Fork_StorageIsSharedUntilWritten(void);
+void UT_CHAIN_Fork_FailedCopyDropsAllLaterWrites(void);
+void UT_CHAIN_Fork_ForkOutlivesItsSource(void);
+
+/* UT_HAL */
+void UT_HAL_Bind_WrongArguments(void);
+void UT_HAL_SpiWrite_CallIsOneTransaction(void);
+void UT_HAL_SpiSelect_HeldLoadSpansCalls(void);
+
+/* UT_BRIGHTNESS */
+void UT_BRIGHTNESS_Level_MaxIntensitySingleDigitIsNearFullScale(void);
+void UT_BRIGHTNESS_Level_ScanLimitDividesLuminance(void);
+void UT_BRIGHTNESS_DutySteps_DisplayTestOverridesRegisters(void);
+void UT_BRIGHTNESS_Compute_UnlitLedsAreZero(void);
+void UT_BRIGHTNESS_ComputeChain_NothingIsDoneWhenNullPointerIsPassed(void);
+
+/* UT_GOLDEN */
+void UT_GOLDEN_Compare_IdenticalData(void);
+void UT_GOLDEN_Compare_CountsDifferencesAndLocatesFirst(void);
+void UT_GOLDEN_Compare_WrongArguments(void);
+void UT_GOLDEN_CompareChain_RendersPendingChanges(void);
+
+/* UT_IMAGE */
+void UT_IMAGE_Create_LayoutWrapsDevicesAndStacksChains(void);
+void UT_IMAGE_Create_WrongArguments(void);
+void UT_IMAGE_Rasterize_OnlyChangedDevicesAreRedrawn(void);
+void UT_IMAGE_Rasterize_PartialGridRowStaysBackground(void);
+void UT_IMAGE_WritePpm_HeaderAndPixels(void);
+void UT_IMAGE_WritePng_StoredBlocksAndChunks(void);
+
+/* UT_STREAM */
+void UT_STREAM_Parse_RecordsStraddlingBlocksAreComplete(void);
+void UT_STREAM_Parse_TruncatedStreamIsReported(void);
+
+/* UT_ENGINE */
+void UT_ENGINE_Run_ParallelResultMatchesSequentialFeed(void);
+void UT_ENGINE_Run_EmptyJobListReturnsImmediately(void);
+void UT_ENGINE_RunDeterministic_OutputIsIndependentOfWorkerCount(void);
+
+/* UT_MAX7219 */
+void UT_MAX7219_Write_DigitWriteMarksDeviceDirty(void);
+void UT_MAX7219_Write_RewriteOfSameValueIsRedundant(void);
+void UT_MAX7219_Write_DigitWriteDuringShutdownLandsWithoutDirty(void);
+void UT_MAX7219_Write_DigitOutsideScanLimitDoesNotMarkDirty(void);
+void UT_MAX7219_Write_IntensityDoesNotMarkDirty(void);
+void UT_MAX7219_Render_DecodeModeUsesCodeBFont(void);
+void UT_MAX7219_Render_DisplayTestOverridesShutdown(void);
+void UT_MAX7219_Render_MixedDecodeModeKeepsRawDigits(void);
+void UT_MAX7219_Render_ScanLimitMasksUpperDigits(void);
+void UT_MAX7219_PowerOn_DeviceStartsInShutdownWithUndefinedDigits(void);
+
+/* UT_TERM */
+void UT_TERM_Draw_OnlyChangedLedsAreRedrawn(void);
+void UT_TERM_Draw_DigitsAreDrawnWithSegments(void);
+void UT_TERM_Create_TooTallDrawingIsRejected(void);
+
+/* UT_CSV */
+void UT_CSV_ParseSeconds_DecimalAndExponentNotationAreAccepted(void);
+void UT_CSV_Feed_BytesArePairedAndEmittedOnCsRisingEdge(void);
+void UT_CSV_Finish_UnterminatedLastLineIsParsed(void);
+void UT_CSV_Feed_MalformedLineIsReported(void);
+void UT_CSV_Feed_SignedTimestampsAreShiftedToFirstLine(void);
+void UT_CSV_Feed_TextAfterFirstDataLineIsReported(void);
+
+/* UT_QUEUE */
+void UT_QUEUE_Create_CapacityIsRoundedUpToPowerOfTwo(void);
+void UT_QUEUE_Push_OnlyFreeSpaceIsFilled(void);
+void UT_QUEUE_Pop_FramesWrapAroundInOrder(void);
+void UT_QUEUE_PopToChain_WrappedFramesAreFedInOrder(void);
+void UT_QUEUE_Peek_RunEndsAtWrapAround(void);
+void UT_QUEUE_IsDrained_OnlyAfterCloseAndLastFrame(void);
+void UT_QUEUE_Pop_ConcurrentProducerFramesArriveInOrder(void);
+
+/* UT_LAYOUT */
+void UT_LAYOUT_Locate_GridOrders(void);
+void UT_LAYOUT_Locate_SerpentineRunsBackwardsOnOddRows(void);
+void UT_LAYOUT_Locate_RotationIsClockwise(void);
+void UT_LAYOUT_Create_WrongDescriptor(void);
+void UT_LAYOUT_Create_OversizedGridIsRejected(void);
+void UT_LAYOUT_Wrapped_LastRowIsPartial(void);
+void UT_LAYOUT_Gather_ComposesCanvasAcrossWords(void);
+
+/* UT_TRACE */
+void UT_TRACE_DecodeRecord_FieldsAreRestored(void);
+void UT_TRACE_DecodeRecord_TruncatedRecordIsDetected(void);
+void UT_TRACE_Parse_WrongSignatureIsRejected(void);
+void UT_TRACE_Replay_MappedTraceDrivesChains(void);
+void UT_TRACE_Replay_UnknownChainIsReported(void);
+void UT_TRACE_WriterInitCompressed_RepeatedRecordsAreRestored(void);
+void UT_TRACE_DecoderNext_MissingReferenceIsDetected(void);
+
+/* UT_SCAN */
+void UT_SCAN_Create_ZeroDigitPeriodIsRejected(void);
+void UT_SCAN_Advance_BlankDevicesAreNotScheduled(void);
+void UT_SCAN_Advance_LitDigitIsEmittedOncePerScanPeriod(void);
+void UT_SCAN_Advance_ShutdownDevicePutsItToSleep(void);
+void UT_SCAN_Advance_ErrStatusIsReturnedForPastTime(void);
+
+/* UT_INGEST */
+void UT_INGEST_Create_InvalidArgumentsAreRejected(void);
+void UT_INGEST_Create_WorkersAreLimitedToChains(void);
+void UT_INGEST_Record_UnknownChainIsRejected(void);
+void UT_INGEST_Run_ResultMatchesLockstepFeed(void);
+void UT_INGEST_RunDeterministic_TextIsIdenticalForAnyWorkerCount(void);
+
 /* UT_HANDLE */
 void UT_HANDLE_Alloc_AfterFirstAllocationZeroHandleIsReturned(void);
 void UT_HANDLE_Alloc_HandlesAreReturnedInAscendingOrder(void);
@@ -35,6 +170,32 @@ void UT_HANDLE_CountFree_ReturnedNumberIsCorrectAfterDealloc(void);
 void UT_HANDLE_CountAll_ByDefaultCorrectNumberIsReturned(void);
 void UT_HANDLE_DeallocAll_HandlesAreFreedAfterOperation(void);
 
+/* UT_SHM */
+void UT_SHM_Create_WrongArguments(void);
+void UT_SHM_Receive_TransactionIsShiftedAndLatched(void);
+void UT_SHM_Create_RunningEmulatorIsNotReplaced(void);
+void UT_SHM_Create_StaleRegionIsReplaced(void);
+void UT_SHM_Send_TransactionIsNeverSplit(void);
+void UT_SHM_Receive_SleepingSidesAreWoken(void);
+void UT_SHM_ReadState_PublishedStateIsVisible(void);
+
+/* UT_BATCH */
+void UT_BATCH_Run_UpdateThenCompare(void);
+void UT_BATCH_Load_MalformedLineIsReported(void);
+
+/* UT_SNAPSHOT */
+void UT_SNAPSHOT_Restore_SavedStateIsBroughtBack(void);
+void UT_SNAPSHOT_Restore_FailedForkAcceptsWritesAgain(void);
+void UT_SNAPSHOT_Restore_DifferentChainLengthLeavesChainsUntouched(void);
+void UT_SNAPSHOT_Restore_ShiftPositionOutOfRangeLeavesChainsUntouched(void);
+void UT_SNAPSHOT_Save_SmallBufferIsRejected(void);
+
+/* UT_ENCODER */
+void UT_ENCODER_Encode_FramesReproduceCanvas(void);
+void UT_ENCODER_Encode_UnchangedDevicesGetNoOps(void);
+void UT_ENCODER_Encode_ChainShorterThanLayout(void);
+void UT_ENCODER_Encode_UnlatchedChainIsRejected(void);
+
 /* End of the tests declaration */
 
 #if defined(__cplusplus)
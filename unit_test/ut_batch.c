@@ -0,0 +1,131 @@
+#include "ut.h"
+#include "unity.h"
+#include "batch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+#define PATH_SIZE 64
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Build path of file inside directory */
+static void JoinPath(char* path, const char* directory, const char* name)
+{
+    snprintf(path, PATH_SIZE, "%s/%s", directory, name);
+}
+
+/* Write text file */
+static void WriteText(const char* path, const char* text)
+{
+    FILE* file = fopen(path, "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fputs(text, file);
+    fclose(file);
+}
+
+/* Write trace turning display test on in both devices of chain 1 */
+static void WriteTrace(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    TEST_ASSERT_NOT_NULL(file);
+
+    TRACE_Writer writer;
+    TRACE_WriterInit(&writer, file);
+    const u16 frames[2] = {
+        MAX7219_FRAME(MAX7219_RegDisplayTest, 0x01),
+        MAX7219_FRAME(MAX7219_RegDisplayTest, 0x01)
+    };
+    TRACE_WriteRecord(&writer, 1, 1000, frames, 2);
+    fclose(file);
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_BATCH_Run_UpdateThenCompare(void)
+{
+    char directory[] = "/tmp/ut_batch_XXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(directory));
+
+    char listPath[PATH_SIZE];
+    char tracePath[PATH_SIZE];
+    char goldenPath[PATH_SIZE];
+    JoinPath(listPath, directory, "scenarios.txt");
+    JoinPath(tracePath, directory, "display.trace");
+    JoinPath(goldenPath, directory, "display.golden");
+    WriteTrace(tracePath);
+    WriteText(listPath,
+            "# trace chains devices golden\n"
+            "display.trace 2 2 display.golden\n"
+            "\n"
+            "missing.trace 1 1 -\n");
+
+    BATCH_List list;
+    TEST_ASSERT_STATUS_EQ(BATCH_StatusOk, BATCH_Load(&list, listPath));
+    TEST_ASSERT_SIZE_EQ(2, list.count);
+    TEST_ASSERT_EQUAL_STRING(tracePath, list.scenarios[0].trace);
+    TEST_ASSERT_NULL(list.scenarios[1].expected);
+
+    /* Golden data is recorded first, the missing trace is an error */
+    TEST_ASSERT_STATUS_EQ(BATCH_StatusOk, BATCH_Run(&list, 2, true));
+    TEST_ASSERT_EQUAL_INT(BATCH_OutcomeUpdated, list.scenarios[0].outcome);
+    TEST_ASSERT_EQUAL_INT(BATCH_OutcomeError, list.scenarios[1].outcome);
+    TEST_ASSERT_EQUAL_UINT64(2, list.scenarios[0].frames);
+    BATCH_Destroy(&list);
+
+    BATCH_Load(&list, listPath);
+    BATCH_Run(&list, BATCH_WORKERS_AUTO, false);
+    TEST_ASSERT_EQUAL_INT(BATCH_OutcomePassed, list.scenarios[0].outcome);
+    BATCH_Destroy(&list);
+
+    /* Expect chain 1 device 0 to be dark except for digit 2 D3 */
+    u64 golden[4] = {0, 0, UINT64_C(1) << 19, MAX7219_BITBOARD_ALL_ON};
+    FILE* file = fopen(goldenPath, "wb");
+    fwrite(golden, sizeof(u64), 4, file);
+    fclose(file);
+
+    BATCH_Load(&list, listPath);
+    BATCH_Run(&list, 1, false);
+    const BATCH_Scenario* scenario = &list.scenarios[0];
+    TEST_ASSERT_EQUAL_INT(BATCH_OutcomeFailed, scenario->outcome);
+    TEST_ASSERT_EQUAL_UINT64(63, scenario->difference.differingLeds);
+    TEST_ASSERT_SIZE_EQ(1, scenario->difference.firstFrame);
+    TEST_ASSERT_SIZE_EQ(0, scenario->difference.firstDevice);
+    TEST_ASSERT_EQUAL_UINT8(0, scenario->difference.firstDigit);
+    BATCH_Destroy(&list);
+
+    remove(listPath);
+    remove(tracePath);
+    remove(goldenPath);
+    rmdir(directory);
+}
+
+void UT_BATCH_Load_MalformedLineIsReported(void)
+{
+    char path[] = "/tmp/ut_batch_XXXXXX";
+    close(mkstemp(path));
+    WriteText(path, "a.trace 1 1 -\nb.trace 0 1 -\n");
+
+    BATCH_List list;
+    TEST_ASSERT_STATUS_EQ(BATCH_StatusBadLine, BATCH_Load(&list, path));
+    TEST_ASSERT_SIZE_EQ(2, list.errorLine);
+    TEST_ASSERT_SIZE_EQ(0, list.count);
+
+    WriteText(path, "a.trace 1 1\n");
+    TEST_ASSERT_STATUS_EQ(BATCH_StatusBadLine, BATCH_Load(&list, path));
+    TEST_ASSERT_STATUS_EQ(BATCH_StatusIoError, BATCH_Load(&list, "/nonexistent/list"));
+
+    remove(path);
+}
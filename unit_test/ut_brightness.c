@@ -0,0 +1,69 @@
+#include "ut.h"
+#include "unity.h"
+#include "brightness.h"
+
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_BRIGHTNESS_Level_MaxIntensitySingleDigitIsNearFullScale(void)
+{
+    MAX7219_Device device;
+    memset(&device, 0, sizeof(device));
+    device.intensity = 0x0F;
+    device.scanLimit = 0x00;
+
+    /* 31/32 duty cycle */
+    TEST_ASSERT_EQUAL_UINT8(247, BRIGHTNESS_Level(&device));
+}
+
+void UT_BRIGHTNESS_Level_ScanLimitDividesLuminance(void)
+{
+    MAX7219_Device device;
+    memset(&device, 0, sizeof(device));
+    device.intensity = 0x0F;
+    device.scanLimit = 0x07;
+
+    /* 31/32 duty cycle, 1/8 multiplex ratio */
+    TEST_ASSERT_EQUAL_UINT8(31, BRIGHTNESS_Level(&device));
+}
+
+void UT_BRIGHTNESS_DutySteps_DisplayTestOverridesRegisters(void)
+{
+    MAX7219_Device device;
+    memset(&device, 0, sizeof(device));
+    device.intensity = 0x03;
+    device.scanLimit = 0x02;
+    TEST_ASSERT_EQUAL_UINT8(7, BRIGHTNESS_DutySteps(&device));
+    TEST_ASSERT_EQUAL_UINT8(3, BRIGHTNESS_ScannedDigits(&device));
+
+    device.displayTest = 0x01;
+    TEST_ASSERT_EQUAL_UINT8(31, BRIGHTNESS_DutySteps(&device));
+    TEST_ASSERT_EQUAL_UINT8(MAX7219_DIGITS, BRIGHTNESS_ScannedDigits(&device));
+}
+
+void UT_BRIGHTNESS_Compute_UnlitLedsAreZero(void)
+{
+    MAX7219_Device devices[2];
+    memset(devices, 0, sizeof(devices));
+    devices[1].intensity = 0x07;
+    const u64 framebuffer[2] = {0, UINT64_C(0x8000000000000001)};
+
+    u8 luminance[2 * BRIGHTNESS_LEDS_PER_DEVICE];
+    BRIGHTNESS_Compute(devices, framebuffer, 2, luminance);
+
+    u8 level = BRIGHTNESS_Level(&devices[1]);
+    TEST_ASSERT_EQUAL_UINT8(0, luminance[0]);
+    TEST_ASSERT_EQUAL_UINT8(level, luminance[BRIGHTNESS_LEDS_PER_DEVICE]);
+    TEST_ASSERT_EQUAL_UINT8(0, luminance[BRIGHTNESS_LEDS_PER_DEVICE + 1]);
+    TEST_ASSERT_EQUAL_UINT8(level, luminance[2 * BRIGHTNESS_LEDS_PER_DEVICE - 1]);
+}
+
+void UT_BRIGHTNESS_ComputeChain_NothingIsDoneWhenNullPointerIsPassed(void)
+{
+    u8 luminance[BRIGHTNESS_LEDS_PER_DEVICE];
+    TEST_ASSERT_STATUS_EQ(BRIGHTNESS_StatusNullPtr,
+            BRIGHTNESS_ComputeChain(NULL, luminance));
+}
@@ -0,0 +1,241 @@
+#include "ut.h"
+#include "unity.h"
+#include "chain.h"
+
+#include <stdint.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_CHAIN_Create_ErrStatusIsReturnedForZeroLength(void)
+{
+    CHAIN_Instance chain;
+    TEST_ASSERT_STATUS_EQ(CHAIN_StatusWrongSize, CHAIN_Create(&chain, 0));
+    TEST_ASSERT_STATUS_EQ(CHAIN_StatusNullPtr, CHAIN_Create(NULL, 1));
+}
+
+void UT_CHAIN_Transfer_FirstFrameEndsUpInLastDevice(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 3);
+
+    const u16 frames[] = {
+        MAX7219_FRAME(MAX7219_RegIntensity, 0x03),
+        MAX7219_FRAME(MAX7219_RegIntensity, 0x02),
+        MAX7219_FRAME(MAX7219_RegIntensity, 0x01)
+    };
+    CHAIN_Transfer(&chain, frames, 3);
+
+    TEST_ASSERT_EQUAL_HEX8(0x01, chain.devices[0].intensity);
+    TEST_ASSERT_EQUAL_HEX8(0x02, chain.devices[1].intensity);
+    TEST_ASSERT_EQUAL_HEX8(0x03, chain.devices[2].intensity);
+    TEST_ASSERT_EQUAL_UINT64(1, chain.tick);
+
+    CHAIN_Destroy(&chain);
+}
+
+void UT_CHAIN_ChangedSince_OnlyTouchedDevicesAreReported(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 4);
+    UT_Broadcast(&chain, MAX7219_RegScanLimit, 0x07);
+    UT_Broadcast(&chain, MAX7219_RegShutdown, 0x01);
+
+    size indices[4];
+    size count;
+    CHAIN_ChangedSince(&chain, 0, indices, 4, &count);
+    u64 observed = chain.tick;
+
+    /* Light up a single row of device 2 only */
+    const u16 frames[] = {
+        MAX7219_FRAME(MAX7219_RegNoOp, 0),
+        MAX7219_FRAME(MAX7219_RegDigit0, 0x81),
+        MAX7219_FRAME(MAX7219_RegNoOp, 0),
+        MAX7219_FRAME(MAX7219_RegNoOp, 0)
+    };
+    CHAIN_Transfer(&chain, frames, 4);
+
+    CHAIN_Status status = CHAIN_ChangedSince(&chain, observed, indices, 4, &count);
+
+    TEST_ASSERT_STATUS_EQ(CHAIN_StatusOk, status);
+    TEST_ASSERT_SIZE_EQ(1, count);
+    TEST_ASSERT_SIZE_EQ(2, indices[0]);
+
+    CHAIN_Destroy(&chain);
+}
+
+void UT_CHAIN_ChangedSince_LeavingShutdownRevealsEarlierWrites(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 2);
+    UT_Broadcast(&chain, MAX7219_RegScanLimit, 0x07);
+    UT_Broadcast(&chain, MAX7219_RegDigit0, 0x0F);
+
+    size count;
+    CHAIN_ChangedSince(&chain, 0, NULL, 0, &count);
+    TEST_ASSERT_SIZE_EQ(0, count);
+
+    UT_Broadcast(&chain, MAX7219_RegShutdown, 0x01);
+    CHAIN_ChangedSince(&chain, 0, NULL, 0, &count);
+
+    TEST_ASSERT_SIZE_EQ(2, count);
+    TEST_ASSERT_EQUAL_HEX64(UINT64_C(0x0F), chain.framebuffer[0]);
+
+    CHAIN_Destroy(&chain);
+}
+
+void UT_CHAIN_Latch_RedundantFramesAreCounted(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 4);
+    UT_Broadcast(&chain, MAX7219_RegShutdown, 0x01);
+
+    /* Refresh the same row twice, then change one device only */
+    UT_Broadcast(&chain, MAX7219_RegDigit0, 0x18);
+    UT_Broadcast(&chain, MAX7219_RegDigit0, 0x18);
+    CHAIN_Shift(&chain, MAX7219_FRAME(MAX7219_RegDigit0, 0x18));
+    CHAIN_Shift(&chain, MAX7219_FRAME(MAX7219_RegDigit0, 0x18));
+    CHAIN_Shift(&chain, MAX7219_FRAME(MAX7219_RegDigit0, 0x18));
+    CHAIN_Shift(&chain, MAX7219_FRAME(MAX7219_RegDigit0, 0x81));
+    CHAIN_Latch(&chain);
+
+    TEST_ASSERT_EQUAL_UINT64(16, chain.frames);
+    TEST_ASSERT_EQUAL_UINT64(7, chain.redundantFrames);
+    TEST_ASSERT_TRUE(CHAIN_RedundantPercent(&chain) == 43.75);
+
+    CHAIN_Destroy(&chain);
+}
+
+void UT_CHAIN_PowerOn_AllDevicesAreResetAndLitOnesReported(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 5);
+    UT_Broadcast(&chain, MAX7219_RegIntensity, 0x0F);
+    UT_Broadcast(&chain, MAX7219_RegDisplayTest, 0x01);
+
+    size count;
+    CHAIN_ChangedSince(&chain, 0, NULL, 0, &count);
+    u64 observed = chain.tick;
+
+    CHAIN_PowerOn(&chain, 0x3C);
+    CHAIN_ChangedSince(&chain, observed, NULL, 0, &count);
+
+    TEST_ASSERT_SIZE_EQ(5, count);
+    for (size i = 0; i < chain.length; ++i) {
+        TEST_ASSERT_TRUE(MAX7219_IsShutdown(&chain.devices[i]));
+        TEST_ASSERT_EQUAL_HEX8(0x00, chain.devices[i].intensity);
+        TEST_ASSERT_EQUAL_HEX8(0x3C, chain.devices[i].digit[0]);
+        TEST_ASSERT_EQUAL_HEX64(MAX7219_BITBOARD_ALL_OFF, chain.framebuffer[i]);
+    }
+
+    CHAIN_Destroy(&chain);
+}
+
+void UT_CHAIN_PowerOn_WritesDuringShutdownShowUpAfterWakeUp(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 1);
+    CHAIN_PowerOn(&chain, MAX7219_POWER_ON_DIGIT_DEFAULT);
+
+    UT_Broadcast(&chain, MAX7219_RegDigit0, 0x42);
+    CHAIN_Render(&chain);
+    TEST_ASSERT_EQUAL_HEX64(MAX7219_BITBOARD_ALL_OFF, chain.framebuffer[0]);
+
+    UT_Broadcast(&chain, MAX7219_RegShutdown, 0x01);
+    CHAIN_Render(&chain);
+    TEST_ASSERT_EQUAL_HEX64(UINT64_C(0x42), chain.framebuffer[0]);
+
+    CHAIN_Destroy(&chain);
+}
+
+void UT_CHAIN_Fork_StorageIsSharedUntilWritten(void)
+{
+    CHAIN_Instance source;
+    CHAIN_Create(&source, 3);
+    UT_Broadcast(&source, MAX7219_RegShutdown, 0x01);
+    UT_Broadcast(&source, MAX7219_RegDigit0, 0x18);
+    CHAIN_Render(&source);
+
+    CHAIN_Instance forks[2];
+    TEST_ASSERT_STATUS_EQ(CHAIN_StatusOk, CHAIN_Fork(&source, &forks[0]));
+    TEST_ASSERT_STATUS_EQ(CHAIN_StatusOk, CHAIN_Fork(&source, &forks[1]));
+    TEST_ASSERT_EQUAL_PTR(source.storage, forks[0].storage);
+    TEST_ASSERT_EQUAL_PTR(source.storage, forks[1].storage);
+
+    /* Reading does not copy */
+    CHAIN_Render(&forks[1]);
+    TEST_ASSERT_EQUAL_PTR(source.storage, forks[1].storage);
+
+    UT_Broadcast(&forks[0], MAX7219_RegDigit0, 0x81);
+    CHAIN_Render(&forks[0]);
+
+    TEST_ASSERT_NOT_EQUAL(source.storage, forks[0].storage);
+    TEST_ASSERT_EQUAL_PTR(source.storage, forks[1].storage);
+    TEST_ASSERT_EQUAL_HEX64(UINT64_C(0x81), forks[0].framebuffer[1]);
+    TEST_ASSERT_EQUAL_HEX64(UINT64_C(0x18), source.framebuffer[1]);
+    TEST_ASSERT_EQUAL_HEX64(UINT64_C(0x18), forks[1].framebuffer[1]);
+
+    CHAIN_Destroy(&forks[0]);
+    CHAIN_Destroy(&forks[1]);
+    CHAIN_Destroy(&source);
+}
+
+void UT_CHAIN_Fork_FailedCopyDropsAllLaterWrites(void)
+{
+    CHAIN_Instance source;
+    CHAIN_Create(&source, 2);
+    UT_Broadcast(&source, MAX7219_RegShutdown, 0x01);
+
+    /* Storage size no allocator can satisfy makes the copy fail */
+    CHAIN_Instance fork;
+    CHAIN_Fork(&source, &fork);
+    size storageSize = fork.storageSize;
+    fork.storageSize = SIZE_MAX / 2;
+    UT_Broadcast(&fork, MAX7219_RegDigit0, 0x18);
+    TEST_ASSERT_TRUE(fork.failed);
+    TEST_ASSERT_EQUAL_PTR(source.storage, fork.storage);
+
+    /* Copy would succeed now, the chain still does not resume */
+    fork.storageSize = storageSize;
+    UT_Broadcast(&fork, MAX7219_RegDigit0 + 1, 0x81);
+    TEST_ASSERT_TRUE(fork.failed);
+    TEST_ASSERT_TRUE(fork.shared);
+    TEST_ASSERT_EQUAL_PTR(source.storage, fork.storage);
+    TEST_ASSERT_EQUAL_HEX8(0x00, fork.devices[0].digit[1]);
+
+    /* Forks of a failed chain inherit the flag */
+    CHAIN_Instance branch;
+    CHAIN_Fork(&fork, &branch);
+    TEST_ASSERT_TRUE(branch.failed);
+
+    CHAIN_Destroy(&branch);
+    CHAIN_Destroy(&fork);
+    CHAIN_Destroy(&source);
+}
+
+void UT_CHAIN_Fork_ForkOutlivesItsSource(void)
+{
+    CHAIN_Instance source;
+    CHAIN_Create(&source, 2);
+    UT_Broadcast(&source, MAX7219_RegShutdown, 0x01);
+
+    CHAIN_Instance fork;
+    CHAIN_Fork(&source, &fork);
+    CHAIN_Destroy(&source);
+
+    /* The last reference is written in place */
+    void* storage = fork.storage;
+    UT_Broadcast(&fork, MAX7219_RegDigit7, 0xFF);
+    TEST_ASSERT_EQUAL_PTR(storage, fork.storage);
+    TEST_ASSERT_FALSE(fork.shared);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, fork.devices[1].digit[7]);
+
+    CHAIN_Destroy(&fork);
+}
@@ -0,0 +1,13 @@
+#include "ut.h"
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------- Test helpers ----------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_Broadcast(CHAIN_Instance* chain, u8 address, u8 data)
+{
+    for (size i = 0; i < chain->length; ++i) {
+        CHAIN_Shift(chain, MAX7219_FRAME(address, data));
+    }
+    CHAIN_Latch(chain);
+}
@@ -0,0 +1,156 @@
+#include "ut.h"
+#include "unity.h"
+#include "csv.h"
+
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define MAX_RECORDED_FRAMES 16
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Copy of the last emitted record */
+typedef struct
+{
+    size records;
+    u64 timestamp;
+    size count;
+    u16 frames[MAX_RECORDED_FRAMES];
+} Recorder;
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Store emitted record */
+static TRACE_Status RecordFrames(void* context, const TRACE_Record* record)
+{
+    Recorder* recorder = context;
+    ++recorder->records;
+    recorder->timestamp = record->timestamp;
+    recorder->count = record->count;
+    for (size i = 0; i < record->count && i < MAX_RECORDED_FRAMES; ++i) {
+        recorder->frames[i] = (u16)(record->frames[2 * i]
+                | (record->frames[2 * i + 1] << 8));
+    }
+    return TRACE_StatusOk;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_CSV_ParseSeconds_DecimalAndExponentNotationAreAccepted(void)
+{
+    const char* plain = "0.000125500";
+    const char* scientific = "1.5e-3";
+    const char* invalid = "1.0x";
+    u64 result;
+
+    TEST_ASSERT_TRUE(CSV_ParseSeconds(plain, plain + strlen(plain), &result));
+    TEST_ASSERT_EQUAL_UINT64(125500, result);
+    TEST_ASSERT_TRUE(CSV_ParseSeconds(scientific,
+            scientific + strlen(scientific), &result));
+    TEST_ASSERT_EQUAL_UINT64(1500000, result);
+    TEST_ASSERT_FALSE(CSV_ParseSeconds(invalid, invalid + strlen(invalid),
+            &result));
+}
+
+void UT_CSV_Feed_BytesArePairedAndEmittedOnCsRisingEdge(void)
+{
+    const char* export =
+            "Time [s],MOSI,CS\r\n"
+            "0.000001,0x0C,0\r\n"
+            "0.000002,0x01,0\r\n"
+            "0.000003,0x0A0F,0\r\n"
+            "0.000004,,1\r\n";
+    Recorder recorder = {0};
+    CSV_Parser parser;
+    CSV_Create(&parser, 0, RecordFrames, &recorder);
+
+    /* Split chunks in the middle of a line */
+    CSV_Status first = CSV_Feed(&parser, export, 30);
+    CSV_Status second = CSV_Feed(&parser, export + 30, strlen(export) - 30);
+
+    TEST_ASSERT_STATUS_EQ(CSV_StatusOk, first);
+    TEST_ASSERT_STATUS_EQ(CSV_StatusOk, second);
+    TEST_ASSERT_EQUAL_size_t(1, recorder.records);
+    TEST_ASSERT_EQUAL_UINT64(4000, recorder.timestamp);
+    TEST_ASSERT_EQUAL_size_t(2, recorder.count);
+    TEST_ASSERT_EQUAL_HEX16(0x0C01, recorder.frames[0]);
+    TEST_ASSERT_EQUAL_HEX16(0x0A0F, recorder.frames[1]);
+
+    CSV_Destroy(&parser);
+}
+
+void UT_CSV_Finish_UnterminatedLastLineIsParsed(void)
+{
+    const char* export = "0.1,0x0C01,0\n0.2,0x0000,1";
+    Recorder recorder = {0};
+    CSV_Parser parser;
+    CSV_Create(&parser, 0, RecordFrames, &recorder);
+
+    CSV_Feed(&parser, export, strlen(export));
+    TEST_ASSERT_EQUAL_size_t(0, recorder.records);
+
+    TEST_ASSERT_STATUS_EQ(CSV_StatusOk, CSV_Finish(&parser));
+    TEST_ASSERT_EQUAL_size_t(1, recorder.records);
+    TEST_ASSERT_EQUAL_UINT64(200000000, recorder.timestamp);
+
+    CSV_Destroy(&parser);
+}
+
+void UT_CSV_Feed_MalformedLineIsReported(void)
+{
+    const char* export = "0.1,0xZZ,0\n";
+    Recorder recorder = {0};
+    CSV_Parser parser;
+    CSV_Create(&parser, 0, RecordFrames, &recorder);
+
+    TEST_ASSERT_STATUS_EQ(CSV_StatusSyntaxError,
+            CSV_Feed(&parser, export, strlen(export)));
+
+    CSV_Destroy(&parser);
+}
+
+void UT_CSV_Feed_SignedTimestampsAreShiftedToFirstLine(void)
+{
+    const char* export =
+            "# pre-trigger capture\n"
+            "-0.000003,0x0C01,0\n"
+            "+0.000001,,1\n";
+    Recorder recorder = {0};
+    CSV_Parser parser;
+    CSV_Create(&parser, 0, RecordFrames, &recorder);
+
+    TEST_ASSERT_STATUS_EQ(CSV_StatusOk,
+            CSV_Feed(&parser, export, strlen(export)));
+    TEST_ASSERT_EQUAL_size_t(1, recorder.records);
+    TEST_ASSERT_EQUAL_UINT64(4000, recorder.timestamp);
+    TEST_ASSERT_EQUAL_HEX16(0x0C01, recorder.frames[0]);
+
+    CSV_Destroy(&parser);
+}
+
+void UT_CSV_Feed_TextAfterFirstDataLineIsReported(void)
+{
+    const char* export =
+            "Time [s],MOSI,CS\n"
+            "0.000001,0x0C01,0\n"
+            "\n"
+            "Time [s],MOSI,CS\n";
+    Recorder recorder = {0};
+    CSV_Parser parser;
+    CSV_Create(&parser, 0, RecordFrames, &recorder);
+
+    TEST_ASSERT_STATUS_EQ(CSV_StatusSyntaxError,
+            CSV_Feed(&parser, export, strlen(export)));
+    TEST_ASSERT_EQUAL_UINT64(4, parser.lines);
+
+    CSV_Destroy(&parser);
+}
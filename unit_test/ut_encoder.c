@@ -0,0 +1,166 @@
+#include "ut.h"
+#include "unity.h"
+#include "encoder.h"
+
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Light canvas pixel */
+static void SetPixel(const LAYOUT_Map* map, u64* canvas, size x, size y)
+{
+    canvas[y * map->wordsPerRow + x / 64] |= UINT64_C(1) << (x % 64);
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_ENCODER_Encode_FramesReproduceCanvas(void)
+{
+    LAYOUT_Descriptor descriptor = {
+        .columns = 2,
+        .rows = 2,
+        .order = LAYOUT_OrderRowSerpentine,
+        .rotation = LAYOUT_Rotate90
+    };
+    LAYOUT_Map map;
+    LAYOUT_Create(&map, &descriptor);
+
+    u64 canvas[16] = {0};
+    for (size i = 0; i < 16; ++i) {
+        SetPixel(&map, canvas, i, i);
+        SetPixel(&map, canvas, 15 - i, i);
+    }
+
+    /* Devices power up in shutdown with blank digits */
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 4);
+    ENCODER_Instance encoder;
+    TEST_ASSERT_STATUS_EQ(ENCODER_StatusOk, ENCODER_Create(&encoder, &map));
+
+    size count;
+    TEST_ASSERT_STATUS_EQ(ENCODER_StatusOk,
+            ENCODER_Encode(&encoder, canvas, &chain, NULL, 0, &count));
+
+    /* Shutdown, scan limit and all eight rows */
+    TEST_ASSERT_SIZE_EQ(10, encoder.transactions);
+    TEST_ASSERT_SIZE_EQ(10 * 4, count);
+
+    u16 frames[64];
+    TEST_ASSERT_STATUS_EQ(ENCODER_StatusOk,
+            ENCODER_Encode(&encoder, canvas, &chain, frames, 64, &count));
+    CHAIN_Feed(&chain, frames, count);
+    CHAIN_Render(&chain);
+
+    u64 result[16];
+    LAYOUT_Gather(&map, chain.framebuffer, chain.length, result);
+    TEST_ASSERT_EQUAL_MEMORY(canvas, result, sizeof(canvas));
+
+    /* Nothing left to do */
+    ENCODER_Encode(&encoder, canvas, &chain, frames, 64, &count);
+    TEST_ASSERT_SIZE_EQ(0, count);
+
+    ENCODER_Destroy(&encoder);
+    CHAIN_Destroy(&chain);
+    LAYOUT_Destroy(&map);
+}
+
+void UT_ENCODER_Encode_UnchangedDevicesGetNoOps(void)
+{
+    LAYOUT_Descriptor descriptor = {.columns = 2, .rows = 1};
+    LAYOUT_Map map;
+    LAYOUT_Create(&map, &descriptor);
+
+    /* The chain is one device longer than the layout */
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 3);
+    UT_Broadcast(&chain, MAX7219_RegScanLimit, 0x07);
+    UT_Broadcast(&chain, MAX7219_RegShutdown, 0x01);
+
+    /* Leftmost LED of row 2 in device 0, rightmost of row 5 in device 1 */
+    u64 canvas[8] = {0};
+    SetPixel(&map, canvas, 0, 2);
+    SetPixel(&map, canvas, 15, 5);
+
+    ENCODER_Instance encoder;
+    ENCODER_Create(&encoder, &map);
+
+    u16 frames[8];
+    size count;
+    TEST_ASSERT_STATUS_EQ(ENCODER_StatusOk,
+            ENCODER_Encode(&encoder, canvas, &chain, frames, 8, &count));
+    TEST_ASSERT_SIZE_EQ(1, encoder.transactions);
+    TEST_ASSERT_SIZE_EQ(3, count);
+    TEST_ASSERT_EQUAL_HEX16(MAX7219_FRAME(MAX7219_RegNoOp, 0x00), frames[0]);
+    TEST_ASSERT_EQUAL_HEX16(MAX7219_FRAME(MAX7219_RegDigit0 + 5, 0x01), frames[1]);
+    TEST_ASSERT_EQUAL_HEX16(MAX7219_FRAME(MAX7219_RegDigit0 + 2, 0x80), frames[2]);
+
+    TEST_ASSERT_STATUS_EQ(ENCODER_StatusWrongSize,
+            ENCODER_Encode(&encoder, canvas, &chain, frames, 2, &count));
+    TEST_ASSERT_SIZE_EQ(3, count);
+
+    ENCODER_Destroy(&encoder);
+    CHAIN_Destroy(&chain);
+    LAYOUT_Destroy(&map);
+}
+
+void UT_ENCODER_Encode_ChainShorterThanLayout(void)
+{
+    LAYOUT_Descriptor descriptor = {.columns = 2, .rows = 1};
+    LAYOUT_Map map;
+    LAYOUT_Create(&map, &descriptor);
+
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 1);
+    ENCODER_Instance encoder;
+    ENCODER_Create(&encoder, &map);
+
+    u64 canvas[8] = {0};
+    size count;
+    TEST_ASSERT_STATUS_EQ(ENCODER_StatusWrongSize,
+            ENCODER_Encode(&encoder, canvas, &chain, NULL, 0, &count));
+    TEST_ASSERT_STATUS_EQ(ENCODER_StatusNullPtr,
+            ENCODER_Encode(&encoder, NULL, &chain, NULL, 0, &count));
+
+    ENCODER_Destroy(&encoder);
+    CHAIN_Destroy(&chain);
+    LAYOUT_Destroy(&map);
+}
+
+void UT_ENCODER_Encode_UnlatchedChainIsRejected(void)
+{
+    LAYOUT_Descriptor descriptor = {.columns = 2, .rows = 1};
+    LAYOUT_Map map;
+    LAYOUT_Create(&map, &descriptor);
+
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 2);
+    ENCODER_Instance encoder;
+    ENCODER_Create(&encoder, &map);
+
+    u64 canvas[8] = {0};
+    u16 frames[32];
+    size count = 0;
+    CHAIN_Shift(&chain, MAX7219_FRAME(MAX7219_RegShutdown, 0x01));
+    TEST_ASSERT_STATUS_EQ(ENCODER_StatusWrongSize,
+            ENCODER_Encode(&encoder, canvas, &chain, frames, 32, &count));
+
+    /* Padding the half-shifted transaction makes the chain usable again */
+    CHAIN_Shift(&chain, MAX7219_FRAME(MAX7219_RegNoOp, 0x00));
+    CHAIN_Latch(&chain);
+    TEST_ASSERT_STATUS_EQ(ENCODER_StatusOk,
+            ENCODER_Encode(&encoder, canvas, &chain, frames, 32, &count));
+
+    ENCODER_Destroy(&encoder);
+    CHAIN_Destroy(&chain);
+    LAYOUT_Destroy(&map);
+}
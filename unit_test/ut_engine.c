@@ -0,0 +1,134 @@
+#include "ut.h"
+#include "unity.h"
+#include "engine.h"
+
+#include <stdlib.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_CHAINS        32
+#define TEST_CHAIN_LENGTH  4
+#define TEST_HEAVY_FRAMES  (10 * ENGINE_SLICE_FRAMES)
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Generate pseudo random stream of full-chain transactions */
+static u16* MakeFrames(size count, u32 seed)
+{
+    u16* frames = malloc(count * sizeof(*frames));
+    for (size i = 0; i < count; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        frames[i] = (u16)(seed >> 16);
+    }
+    return frames;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_ENGINE_Run_ParallelResultMatchesSequentialFeed(void)
+{
+    CHAIN_Instance parallel[TEST_CHAINS];
+    CHAIN_Instance sequential[TEST_CHAINS];
+    ENGINE_Job jobs[TEST_CHAINS];
+    u16* frames[TEST_CHAINS];
+
+    for (size i = 0; i < TEST_CHAINS; ++i) {
+        /* One heavy chain among many light ones */
+        size count = (i == 0) ? TEST_HEAVY_FRAMES : 100 * (i + 1);
+        frames[i] = MakeFrames(count, (u32)i);
+
+        CHAIN_Create(&parallel[i], TEST_CHAIN_LENGTH);
+        CHAIN_Create(&sequential[i], TEST_CHAIN_LENGTH);
+        CHAIN_Feed(&sequential[i], frames[i], count);
+        CHAIN_Render(&sequential[i]);
+
+        jobs[i] = (ENGINE_Job){
+            .chain = &parallel[i],
+            .frames = frames[i],
+            .count = count
+        };
+    }
+
+    ENGINE_Instance engine;
+    ENGINE_Create(&engine, 4);
+    ENGINE_Status status = ENGINE_Run(&engine, jobs, TEST_CHAINS);
+
+    TEST_ASSERT_STATUS_EQ(ENGINE_StatusOk, status);
+    for (size i = 0; i < TEST_CHAINS; ++i) {
+        TEST_ASSERT_EQUAL_size_t(jobs[i].count, jobs[i].position);
+        TEST_ASSERT_EQUAL_UINT64(sequential[i].tick, parallel[i].tick);
+        TEST_ASSERT_EQUAL_HEX64_ARRAY(sequential[i].framebuffer,
+                parallel[i].framebuffer, TEST_CHAIN_LENGTH);
+
+        CHAIN_Destroy(&parallel[i]);
+        CHAIN_Destroy(&sequential[i]);
+        free(frames[i]);
+    }
+}
+
+void UT_ENGINE_Run_EmptyJobListReturnsImmediately(void)
+{
+    ENGINE_Instance engine;
+    ENGINE_Create(&engine, ENGINE_WORKERS_AUTO);
+    ENGINE_Job job;
+
+    TEST_ASSERT_STATUS_EQ(ENGINE_StatusOk, ENGINE_Run(&engine, &job, 0));
+    TEST_ASSERT_STATUS_EQ(ENGINE_StatusNullPtr, ENGINE_Run(&engine, NULL, 0));
+}
+
+void UT_ENGINE_RunDeterministic_OutputIsIndependentOfWorkerCount(void)
+{
+    ENGINE_Output* outputs[2];
+    size outputCount[2];
+    const size workerCounts[2] = {1, 4};
+    u16* frames[TEST_CHAINS];
+
+    for (size i = 0; i < TEST_CHAINS; ++i) {
+        frames[i] = MakeFrames(64 * (i + 1), (u32)(i + 7));
+    }
+
+    for (size run = 0; run < 2; ++run) {
+        CHAIN_Instance chains[TEST_CHAINS];
+        ENGINE_Job jobs[TEST_CHAINS];
+        for (size i = 0; i < TEST_CHAINS; ++i) {
+            CHAIN_Create(&chains[i], TEST_CHAIN_LENGTH);
+            jobs[i] = (ENGINE_Job){
+                .chain = &chains[i],
+                .frames = frames[i],
+                .count = 64 * (i + 1)
+            };
+        }
+
+        ENGINE_Instance engine;
+        ENGINE_Create(&engine, workerCounts[run]);
+        ENGINE_Status status = ENGINE_RunDeterministic(&engine, jobs,
+                TEST_CHAINS, &outputs[run], &outputCount[run]);
+        TEST_ASSERT_STATUS_EQ(ENGINE_StatusOk, status);
+
+        for (size i = 0; i < TEST_CHAINS; ++i) {
+            CHAIN_Destroy(&chains[i]);
+        }
+    }
+
+    TEST_ASSERT_TRUE(outputCount[0] > 0);
+    TEST_ASSERT_EQUAL_size_t(outputCount[0], outputCount[1]);
+    TEST_ASSERT_EQUAL_MEMORY(outputs[0], outputs[1],
+            outputCount[0] * sizeof(ENGINE_Output));
+
+    /* Merged stream is ordered by the logical clock first */
+    for (size i = 1; i < outputCount[0]; ++i) {
+        TEST_ASSERT_TRUE(outputs[0][i - 1].tick <= outputs[0][i].tick);
+    }
+
+    for (size i = 0; i < TEST_CHAINS; ++i) {
+        free(frames[i]);
+    }
+    free(outputs[0]);
+    free(outputs[1]);
+}
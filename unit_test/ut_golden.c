@@ -0,0 +1,82 @@
+#include "ut.h"
+#include "unity.h"
+#include "golden.h"
+
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_GOLDEN_Compare_IdenticalData(void)
+{
+    u64 frames[6] = {1, 2, 3, 4, 5, 6};
+    GOLDEN_Result result;
+
+    TEST_ASSERT_STATUS_EQ(GOLDEN_StatusOk, GOLDEN_Compare(frames, frames, 3, 2, &result));
+    TEST_ASSERT_EQUAL_UINT64(0, result.differingLeds);
+    TEST_ASSERT_SIZE_EQ(0, result.differingFrames);
+    TEST_ASSERT_SIZE_EQ(GOLDEN_NO_DIFF, result.firstFrame);
+    TEST_ASSERT_SIZE_EQ(GOLDEN_NO_DIFF, result.firstDevice);
+}
+
+void UT_GOLDEN_Compare_CountsDifferencesAndLocatesFirst(void)
+{
+    u64 actual[6] = {0};
+    u64 expected[6] = {0};
+
+    /* Frame 1 device 1 digit 3 D5, frame 2 all of device 0 */
+    expected[3] = UINT64_C(1) << (3 * 8 + 5);
+    actual[3] = UINT64_C(1) << 63;
+    actual[4] = MAX7219_BITBOARD_ALL_ON;
+
+    GOLDEN_Result result;
+    TEST_ASSERT_STATUS_EQ(GOLDEN_StatusOk, GOLDEN_Compare(actual, expected, 3, 2, &result));
+    TEST_ASSERT_EQUAL_UINT64(2 + 64, result.differingLeds);
+    TEST_ASSERT_SIZE_EQ(2, result.differingFrames);
+    TEST_ASSERT_SIZE_EQ(1, result.firstFrame);
+    TEST_ASSERT_SIZE_EQ(1, result.firstDevice);
+    TEST_ASSERT_EQUAL_UINT8(3, result.firstDigit);
+    TEST_ASSERT_EQUAL_UINT8(5, result.firstBit);
+}
+
+void UT_GOLDEN_Compare_WrongArguments(void)
+{
+    u64 frame = 0;
+    GOLDEN_Result result;
+
+    TEST_ASSERT_STATUS_EQ(GOLDEN_StatusNullPtr, GOLDEN_Compare(NULL, &frame, 1, 1, &result));
+    TEST_ASSERT_STATUS_EQ(GOLDEN_StatusNullPtr, GOLDEN_Compare(&frame, &frame, 1, 1, NULL));
+    TEST_ASSERT_STATUS_EQ(GOLDEN_StatusWrongSize, GOLDEN_Compare(&frame, &frame, 1, 0, &result));
+}
+
+void UT_GOLDEN_CompareChain_RendersPendingChanges(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 2);
+    CHAIN_Transfer(&chain, (const u16[]){
+            MAX7219_FRAME(MAX7219_RegDisplayTest, 0x01),
+            MAX7219_FRAME(MAX7219_RegNoOp, 0x00)}, 2);
+
+    u64 golden[2] = {0, MAX7219_BITBOARD_ALL_ON};
+    GOLDEN_Result result;
+    TEST_ASSERT_STATUS_EQ(GOLDEN_StatusOk,
+            GOLDEN_CompareChain(&chain, golden, 2, &result));
+    TEST_ASSERT_SIZE_EQ(0, result.differingFrames);
+
+    golden[0] = 0x10;
+    GOLDEN_CompareChain(&chain, golden, 2, &result);
+    TEST_ASSERT_EQUAL_UINT64(1, result.differingLeds);
+    TEST_ASSERT_SIZE_EQ(0, result.firstDevice);
+    TEST_ASSERT_EQUAL_UINT8(4, result.firstBit);
+
+    TEST_ASSERT_STATUS_EQ(GOLDEN_StatusWrongSize,
+            GOLDEN_CompareChain(&chain, golden, 1, &result));
+    CHAIN_Destroy(&chain);
+}
@@ -0,0 +1,76 @@
+#include "ut.h"
+#include "unity.h"
+#include "hal.h"
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define DEVICES 2
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_HAL_Bind_WrongArguments(void)
+{
+    static const u8 bytes[2] = { 0 };
+    TEST_ASSERT_STATUS_EQ(HAL_StatusNullPtr, HAL_Bind(NULL, 1));
+    TEST_ASSERT_STATUS_EQ(HAL_StatusOk, HAL_Bind(NULL, 0));
+    TEST_ASSERT_EQUAL_INT(HAL_SPI_ERROR, spi_write(0, bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL_INT(HAL_SPI_ERROR, spi_select(0, true));
+}
+
+void UT_HAL_SpiWrite_CallIsOneTransaction(void)
+{
+    CHAIN_Instance chains[2];
+    CHAIN_Create(&chains[0], DEVICES);
+    CHAIN_Create(&chains[1], DEVICES);
+    TEST_ASSERT_STATUS_EQ(HAL_StatusOk, HAL_Bind(chains, 2));
+
+    /* Big-endian frames, the first one ends up in the last device */
+    static const u8 bytes[] = { 0x03, 0xAA, 0x06, 0x55 };
+    TEST_ASSERT_EQUAL_INT(HAL_SPI_OK, spi_write(1, bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL_INT(HAL_SPI_ERROR, spi_write(2, bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL_INT(HAL_SPI_ERROR, spi_write(1, NULL, 2));
+
+    TEST_ASSERT_EQUAL_HEX8(0xAA, chains[1].devices[1].digit[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x55, chains[1].devices[0].digit[5]);
+    TEST_ASSERT_EQUAL_UINT64(DEVICES, chains[1].frames);
+    TEST_ASSERT_EQUAL_UINT64(0, chains[0].frames);
+
+    HAL_Unbind();
+    CHAIN_Destroy(&chains[0]);
+    CHAIN_Destroy(&chains[1]);
+}
+
+void UT_HAL_SpiSelect_HeldLoadSpansCalls(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, DEVICES);
+    TEST_ASSERT_STATUS_EQ(HAL_StatusOk, HAL_Bind(&chain, 1));
+
+    /* Byte-by-byte writes, a frame is split across calls */
+    static const u8 bytes[] = { 0x01, 0x0F, 0x08, 0xF0 };
+    TEST_ASSERT_EQUAL_INT(HAL_SPI_OK, spi_select(0, true));
+    for (size i = 0; i < sizeof(bytes); ++i) {
+        TEST_ASSERT_EQUAL_INT(HAL_SPI_OK, spi_write(0, &bytes[i], 1));
+    }
+    TEST_ASSERT_EQUAL_UINT64(0, chain.frames);
+
+    TEST_ASSERT_EQUAL_INT(HAL_SPI_OK, spi_select(0, false));
+    TEST_ASSERT_EQUAL_UINT64(DEVICES, chain.frames);
+    TEST_ASSERT_EQUAL_HEX8(0x0F, chain.devices[1].digit[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xF0, chain.devices[0].digit[7]);
+
+    /* Trailing half frame is dropped at the latch */
+    static const u8 odd[] = { 0x02, 0x11, 0x02 };
+    TEST_ASSERT_EQUAL_INT(HAL_SPI_OK, spi_write(0, odd, sizeof(odd)));
+    static const u8 next[] = { 0x03, 0x22 };
+    TEST_ASSERT_EQUAL_INT(HAL_SPI_OK, spi_write(0, next, sizeof(next)));
+    TEST_ASSERT_EQUAL_HEX8(0x22, chain.devices[0].digit[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x11, chain.devices[1].digit[1]);
+
+    HAL_Unbind();
+    CHAIN_Destroy(&chain);
+}
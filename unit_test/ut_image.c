@@ -0,0 +1,228 @@
+#include "ut.h"
+#include "unity.h"
+#include "image.h"
+
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Get top-left pixel of device in given chain */
+static void DeviceOrigin(const IMAGE_Raster* raster, size chain, size device,
+        size* x, size* y)
+{
+    const IMAGE_Area* area = &raster->areas[chain];
+    LAYOUT_Locate(&area->map.descriptor, device, 0, 7, x, y);
+    *x *= raster->ledSize;
+    *y = area->top + *y * raster->ledSize;
+}
+
+/* Get pixel at the centre of LED in device of the first chain, row and column (0 = D7) */
+static const u8* LedCenter(const IMAGE_Raster* raster, size device, size row,
+        size column)
+{
+    size x;
+    size y;
+    DeviceOrigin(raster, 0, device, &x, &y);
+    x += column * raster->ledSize + raster->ledSize / 2;
+    y += row * raster->ledSize + raster->ledSize / 2;
+    return raster->pixels + (y * raster->width + x) * IMAGE_CHANNELS;
+}
+
+/* Write image into temporary file and read it back */
+static size WriteAndRead(IMAGE_Raster* raster, bool png, u8* buffer, size capacity)
+{
+    FILE* file = tmpfile();
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_STATUS_EQ(IMAGE_StatusOk, png
+            ? IMAGE_WritePng(raster, file)
+            : IMAGE_WritePpm(raster, file));
+
+    rewind(file);
+    size length = fread(buffer, 1, capacity, file);
+    fclose(file);
+    return length;
+}
+
+/* Read big-endian 32-bit value */
+static u32 GetBe32(const u8* data)
+{
+    return ((u32)data[0] << 24) | ((u32)data[1] << 16)
+            | ((u32)data[2] << 8) | (u32)data[3];
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_IMAGE_Create_LayoutWrapsDevicesAndStacksChains(void)
+{
+    CHAIN_Instance chains[2];
+    CHAIN_Create(&chains[0], 3);
+    CHAIN_Create(&chains[1], 10);
+
+    IMAGE_Raster raster;
+    TEST_ASSERT_STATUS_EQ(IMAGE_StatusOk, IMAGE_Create(&raster, chains, 2, 8, 4));
+
+    /* 8 matrices of 32 px, chain rows of 32 px separated by one LED */
+    TEST_ASSERT_EQUAL_UINT32(256, raster.width);
+    TEST_ASSERT_EQUAL_UINT32(32 + 4 + 64, raster.height);
+    size x;
+    size y;
+    DeviceOrigin(&raster, 0, 2, &x, &y);
+    TEST_ASSERT_SIZE_EQ(64, x);
+    DeviceOrigin(&raster, 1, 0, &x, &y);
+    TEST_ASSERT_SIZE_EQ(36, y);
+    DeviceOrigin(&raster, 1, 8, &x, &y);
+    TEST_ASSERT_SIZE_EQ(0, x);
+    TEST_ASSERT_SIZE_EQ(68, y);
+
+    IMAGE_Destroy(&raster);
+    CHAIN_Destroy(&chains[0]);
+    CHAIN_Destroy(&chains[1]);
+}
+
+void UT_IMAGE_Create_WrongArguments(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 1);
+    IMAGE_Raster raster;
+
+    TEST_ASSERT_STATUS_EQ(IMAGE_StatusNullPtr, IMAGE_Create(NULL, &chain, 1, 8, 4));
+    TEST_ASSERT_STATUS_EQ(IMAGE_StatusNullPtr, IMAGE_Create(&raster, NULL, 1, 8, 4));
+    TEST_ASSERT_STATUS_EQ(IMAGE_StatusWrongSize, IMAGE_Create(&raster, &chain, 0, 8, 4));
+    TEST_ASSERT_STATUS_EQ(IMAGE_StatusWrongSize, IMAGE_Create(&raster, &chain, 1, 0, 4));
+    TEST_ASSERT_STATUS_EQ(IMAGE_StatusWrongSize, IMAGE_Create(&raster, &chain, 1, 8, 0));
+
+    CHAIN_Destroy(&chain);
+}
+
+void UT_IMAGE_Rasterize_OnlyChangedDevicesAreRedrawn(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 2);
+    UT_Broadcast(&chain, MAX7219_RegScanLimit, 0x07);
+    UT_Broadcast(&chain, MAX7219_RegShutdown, 0x01);
+
+    IMAGE_Raster raster;
+    IMAGE_Create(&raster, &chain, 1, IMAGE_DEFAULT_PER_ROW, IMAGE_DEFAULT_LED_SIZE);
+    TEST_ASSERT_SIZE_EQ(2, IMAGE_Rasterize(&raster));
+    TEST_ASSERT_SIZE_EQ(0, IMAGE_Rasterize(&raster));
+
+    u8 unlit[IMAGE_CHANNELS];
+    memcpy(unlit, LedCenter(&raster, 1, 3, 0), IMAGE_CHANNELS);
+
+    /* D7 of row 3 in device 1 */
+    CHAIN_Shift(&chain, MAX7219_FRAME(MAX7219_RegDigit0 + 3, 0x80));
+    CHAIN_Shift(&chain, MAX7219_FRAME(MAX7219_RegNoOp, 0x00));
+    CHAIN_Latch(&chain);
+    TEST_ASSERT_SIZE_EQ(1, IMAGE_Rasterize(&raster));
+
+    const u8* lit = LedCenter(&raster, 1, 3, 0);
+    TEST_ASSERT_TRUE(lit[0] > unlit[0]);
+    TEST_ASSERT_EQUAL_MEMORY(unlit, LedCenter(&raster, 1, 3, 1), IMAGE_CHANNELS);
+    TEST_ASSERT_EQUAL_MEMORY(unlit, LedCenter(&raster, 0, 3, 0), IMAGE_CHANNELS);
+
+    /* Corners of the cell are background */
+    size x;
+    size y;
+    DeviceOrigin(&raster, 0, 1, &x, &y);
+    const u8* corner = raster.pixels + (y * raster.width + x) * IMAGE_CHANNELS;
+    TEST_ASSERT_EQUAL_UINT8(0, corner[0]);
+
+    IMAGE_Destroy(&raster);
+    CHAIN_Destroy(&chain);
+}
+
+void UT_IMAGE_Rasterize_PartialGridRowStaysBackground(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 3);
+    UT_Broadcast(&chain, MAX7219_RegDisplayTest, 0x01);
+
+    /* Devices 0 and 1 above device 2, the cell right of device 2 is empty */
+    IMAGE_Raster raster;
+    IMAGE_Create(&raster, &chain, 1, 2, 4);
+    TEST_ASSERT_SIZE_EQ(3, IMAGE_Rasterize(&raster));
+    TEST_ASSERT_EQUAL_UINT32(64, raster.width);
+    TEST_ASSERT_EQUAL_UINT32(64, raster.height);
+
+    const u8* lit = LedCenter(&raster, 2, 7, 7);
+    const u8* empty = raster.pixels + ((48 + 2) * 64 + 32 + 2) * IMAGE_CHANNELS;
+    TEST_ASSERT_TRUE(lit[0] > 0);
+    TEST_ASSERT_EQUAL_UINT8(0, empty[0]);
+
+    IMAGE_Destroy(&raster);
+    CHAIN_Destroy(&chain);
+}
+
+void UT_IMAGE_WritePpm_HeaderAndPixels(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 1);
+    UT_Broadcast(&chain, MAX7219_RegDisplayTest, 0x01);
+
+    IMAGE_Raster raster;
+    IMAGE_Create(&raster, &chain, 1, IMAGE_DEFAULT_PER_ROW, 2);
+    IMAGE_Rasterize(&raster);
+
+    static u8 output[1024];
+    size length = WriteAndRead(&raster, false, output, sizeof(output));
+
+    const char header[] = "P6\n16 16\n255\n";
+    TEST_ASSERT_SIZE_EQ(sizeof(header) - 1 + 16 * 16 * 3, length);
+    TEST_ASSERT_EQUAL_MEMORY(header, output, sizeof(header) - 1);
+    TEST_ASSERT_EQUAL_MEMORY(raster.pixels, output + sizeof(header) - 1, 16 * 16 * 3);
+
+    IMAGE_Destroy(&raster);
+    CHAIN_Destroy(&chain);
+}
+
+void UT_IMAGE_WritePng_StoredBlocksAndChunks(void)
+{
+    /* 640x64 px rows take 1921 B, the data needs two stored blocks */
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 10);
+    UT_Broadcast(&chain, MAX7219_RegDisplayTest, 0x01);
+
+    IMAGE_Raster raster;
+    IMAGE_Create(&raster, &chain, 1, 10, 8);
+    IMAGE_Rasterize(&raster);
+
+    static u8 output[160000];
+    size length = WriteAndRead(&raster, true, output, sizeof(output));
+
+    size raw = 64 * (1 + 640 * 3);
+    size zlib = 2 + 2 * 5 + raw + 4;
+    TEST_ASSERT_SIZE_EQ(8 + 25 + 12 + zlib + 12, length);
+    TEST_ASSERT_EQUAL_MEMORY("\x89PNG\r\n\x1a\n", output, 8);
+
+    /* IHDR */
+    TEST_ASSERT_EQUAL_UINT32(13, GetBe32(output + 8));
+    TEST_ASSERT_EQUAL_MEMORY("IHDR", output + 12, 4);
+    TEST_ASSERT_EQUAL_UINT32(640, GetBe32(output + 16));
+    TEST_ASSERT_EQUAL_UINT32(64, GetBe32(output + 20));
+
+    /* IDAT with the first block full and final flag on the second one */
+    const u8* idat = output + 33;
+    TEST_ASSERT_EQUAL_UINT32(zlib, GetBe32(idat));
+    TEST_ASSERT_EQUAL_MEMORY("IDAT", idat + 4, 4);
+    TEST_ASSERT_EQUAL_MEMORY("\x78\x01\x00\xFF\xFF\x00\x00", idat + 8, 7);
+    const u8* second = idat + 8 + 2 + 5 + 65535;
+    TEST_ASSERT_EQUAL_UINT8(1, second[0]);
+    TEST_ASSERT_EQUAL_UINT8((raw - 65535) & 0xFF, second[1]);
+
+    /* IEND has a well-known CRC */
+    TEST_ASSERT_EQUAL_MEMORY("\x00\x00\x00\x00IEND\xAE\x42\x60\x82",
+            output + length - 12, 12);
+
+    IMAGE_Destroy(&raster);
+    CHAIN_Destroy(&chain);
+}
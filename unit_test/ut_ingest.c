@@ -0,0 +1,225 @@
+#include "ut.h"
+#include "unity.h"
+#include "ingest.h"
+
+#include <stdlib.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+#define TEST_CHAINS        6
+#define TEST_CHAIN_LENGTH  4
+#define TEST_RECORDS       3000
+#define TEST_MAX_FRAMES    (2 * TEST_CHAIN_LENGTH)
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Pre-generated records of every length from zero to twice the chain */
+typedef struct
+{
+    TRACE_Record records[TEST_RECORDS];
+    u8 frames[TEST_RECORDS][2 * TEST_MAX_FRAMES];
+    INGEST_Instance* ingest;
+} Trace;
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Fill trace with pseudo random records */
+static void MakeTrace(Trace* trace)
+{
+    u32 seed = 7;
+    for (size r = 0; r < TEST_RECORDS; ++r) {
+        for (size i = 0; i < sizeof(trace->frames[r]); ++i) {
+            seed = seed * 1103515245u + 12345u;
+            trace->frames[r][i] = (u8)(seed >> 16);
+        }
+        trace->records[r] = (TRACE_Record){
+            .chain = r % TEST_CHAINS,
+            .timestamp = r,
+            .frames = trace->frames[r],
+            .count = (r / TEST_CHAINS) % (TEST_MAX_FRAMES + 1)
+        };
+    }
+}
+
+/* Producer passing the whole trace to ingest */
+static void ProduceTrace(void* context)
+{
+    Trace* trace = context;
+    for (size r = 0; r < TEST_RECORDS; ++r) {
+        INGEST_Record(trace->ingest, &trace->records[r]);
+    }
+}
+
+/* Run trace deterministically and return written changes, NULL on error */
+static char* RunToText(Trace* trace, size workers, long* length)
+{
+    CHAIN_Instance chains[TEST_CHAINS];
+    for (size i = 0; i < TEST_CHAINS; ++i) {
+        CHAIN_Create(&chains[i], TEST_CHAIN_LENGTH);
+    }
+    INGEST_Instance ingest;
+    INGEST_Create(&ingest, chains, TEST_CHAINS, 16, workers);
+    trace->ingest = &ingest;
+
+    ENGINE_Output* changes = NULL;
+    size count = 0;
+    FILE* file = tmpfile();
+    char* text = NULL;
+    if (file != NULL
+            && INGEST_RunDeterministic(&ingest, ProduceTrace, trace,
+                    &changes, &count) == INGEST_StatusOk
+            && INGEST_WriteChanges(file, changes, count) == INGEST_StatusOk) {
+        *length = ftell(file);
+        text = malloc((size)*length + 1);
+        rewind(file);
+        if (text != NULL && fread(text, 1, (size)*length, file) != (size)*length) {
+            free(text);
+            text = NULL;
+        }
+    }
+
+    if (file != NULL) {
+        fclose(file);
+    }
+    free(changes);
+    INGEST_Destroy(&ingest);
+    for (size i = 0; i < TEST_CHAINS; ++i) {
+        CHAIN_Destroy(&chains[i]);
+    }
+    return text;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_INGEST_Create_InvalidArgumentsAreRejected(void)
+{
+    CHAIN_Instance chains[2];
+    CHAIN_Create(&chains[0], TEST_CHAIN_LENGTH);
+    CHAIN_Create(&chains[1], TEST_CHAIN_LENGTH + 1);
+    INGEST_Instance ingest;
+
+    TEST_ASSERT_STATUS_EQ(INGEST_StatusNullPtr,
+            INGEST_Create(NULL, chains, 1, 16, 1));
+    TEST_ASSERT_STATUS_EQ(INGEST_StatusWrongSize,
+            INGEST_Create(&ingest, chains, 0, 16, 1));
+    TEST_ASSERT_STATUS_EQ(INGEST_StatusWrongSize,
+            INGEST_Create(&ingest, chains, 1, 0, 1));
+    TEST_ASSERT_STATUS_EQ(INGEST_StatusWrongSize,
+            INGEST_Create(&ingest, chains, 2, 16, 1));
+
+    CHAIN_Shift(&chains[0], 0);
+    TEST_ASSERT_STATUS_EQ(INGEST_StatusWrongSize,
+            INGEST_Create(&ingest, chains, 1, 16, 1));
+
+    CHAIN_Destroy(&chains[0]);
+    CHAIN_Destroy(&chains[1]);
+}
+
+void UT_INGEST_Create_WorkersAreLimitedToChains(void)
+{
+    CHAIN_Instance chains[TEST_CHAINS];
+    for (size i = 0; i < TEST_CHAINS; ++i) {
+        CHAIN_Create(&chains[i], TEST_CHAIN_LENGTH);
+    }
+    INGEST_Instance ingest;
+
+    TEST_ASSERT_STATUS_EQ(INGEST_StatusOk,
+            INGEST_Create(&ingest, chains, TEST_CHAINS, 16, 64));
+    TEST_ASSERT_SIZE_EQ(TEST_CHAINS, ingest.engine.workers);
+
+    INGEST_Destroy(&ingest);
+    for (size i = 0; i < TEST_CHAINS; ++i) {
+        CHAIN_Destroy(&chains[i]);
+    }
+}
+
+void UT_INGEST_Record_UnknownChainIsRejected(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, TEST_CHAIN_LENGTH);
+    INGEST_Instance ingest;
+    INGEST_Create(&ingest, &chain, 1, 16, 1);
+
+    const u8 frames[2] = {0};
+    TRACE_Record record = {.chain = 1, .frames = frames, .count = 1};
+    TEST_ASSERT_STATUS_EQ(TRACE_StatusWrongChain, INGEST_Record(&ingest, &record));
+    TEST_ASSERT_EQUAL_UINT64(0, ingest.records);
+
+    INGEST_Destroy(&ingest);
+    CHAIN_Destroy(&chain);
+}
+
+void UT_INGEST_Run_ResultMatchesLockstepFeed(void)
+{
+    static Trace trace;
+    MakeTrace(&trace);
+
+    CHAIN_Instance queued[TEST_CHAINS];
+    CHAIN_Instance lockstep[TEST_CHAINS];
+    for (size i = 0; i < TEST_CHAINS; ++i) {
+        CHAIN_Create(&queued[i], TEST_CHAIN_LENGTH);
+        CHAIN_Create(&lockstep[i], TEST_CHAIN_LENGTH);
+    }
+    for (size r = 0; r < TEST_RECORDS; ++r) {
+        TRACE_FeedChain(&lockstep[trace.records[r].chain], &trace.records[r]);
+    }
+
+    /* Small queues keep the producer blocking on the workers */
+    INGEST_Instance ingest;
+    TEST_ASSERT_STATUS_EQ(INGEST_StatusOk,
+            INGEST_Create(&ingest, queued, TEST_CHAINS, 16, 2));
+    trace.ingest = &ingest;
+    TEST_ASSERT_STATUS_EQ(INGEST_StatusOk,
+            INGEST_Run(&ingest, ProduceTrace, &trace));
+    TEST_ASSERT_EQUAL_UINT64(TEST_RECORDS, ingest.records);
+
+    for (size i = 0; i < TEST_CHAINS; ++i) {
+        CHAIN_Render(&lockstep[i]);
+        TEST_ASSERT_EQUAL_UINT64(lockstep[i].tick, queued[i].tick);
+        TEST_ASSERT_EQUAL_UINT64(lockstep[i].frames, queued[i].frames);
+        TEST_ASSERT_EQUAL_UINT64(lockstep[i].redundantFrames,
+                queued[i].redundantFrames);
+        TEST_ASSERT_EQUAL_HEX64_ARRAY(lockstep[i].framebuffer,
+                queued[i].framebuffer, TEST_CHAIN_LENGTH);
+        for (size d = 0; d < TEST_CHAIN_LENGTH; ++d) {
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(lockstep[i].devices[d].digit,
+                    queued[i].devices[d].digit, MAX7219_DIGITS);
+        }
+    }
+
+    INGEST_Destroy(&ingest);
+    for (size i = 0; i < TEST_CHAINS; ++i) {
+        CHAIN_Destroy(&queued[i]);
+        CHAIN_Destroy(&lockstep[i]);
+    }
+}
+
+void UT_INGEST_RunDeterministic_TextIsIdenticalForAnyWorkerCount(void)
+{
+    static Trace trace;
+    MakeTrace(&trace);
+
+    long singleLength = 0;
+    long parallelLength = 0;
+    char* single = RunToText(&trace, 1, &singleLength);
+    char* parallel = RunToText(&trace, 4, &parallelLength);
+
+    TEST_ASSERT_NOT_NULL(single);
+    TEST_ASSERT_NOT_NULL(parallel);
+    TEST_ASSERT_TRUE(singleLength > 0);
+    TEST_ASSERT_EQUAL_INT64(singleLength, parallelLength);
+    TEST_ASSERT_EQUAL_MEMORY(single, parallel, (size)singleLength);
+
+    free(single);
+    free(parallel);
+}
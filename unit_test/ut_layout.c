@@ -0,0 +1,165 @@
+#include "ut.h"
+#include "unity.h"
+#include "layout.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Check canvas position of a single LED */
+static void AssertLocation(const LAYOUT_Descriptor* descriptor, size device,
+        u8 digit, u8 bit, size expectedX, size expectedY)
+{
+    size x;
+    size y;
+    LAYOUT_Locate(descriptor, device, digit, bit, &x, &y);
+    TEST_ASSERT_SIZE_EQ(expectedX, x);
+    TEST_ASSERT_SIZE_EQ(expectedY, y);
+}
+
+/* Count lit canvas pixels */
+static size CountLit(const LAYOUT_Map* map, const u64* canvas)
+{
+    size lit = 0;
+    for (size i = 0; i < LAYOUT_CanvasWords(map); ++i) {
+        lit += (size)__builtin_popcountll(canvas[i]);
+    }
+    return lit;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_LAYOUT_Locate_GridOrders(void)
+{
+    LAYOUT_Descriptor rows = {.columns = 3, .rows = 2, .order = LAYOUT_OrderRows};
+    AssertLocation(&rows, 0, 0, 7, 0, 0);
+    AssertLocation(&rows, 0, 7, 0, 7, 7);
+    AssertLocation(&rows, 4, 0, 7, 8, 8);
+
+    LAYOUT_Descriptor columns = {.columns = 3, .rows = 2, .order = LAYOUT_OrderColumns};
+    AssertLocation(&columns, 1, 0, 7, 0, 8);
+    AssertLocation(&columns, 4, 0, 7, 16, 0);
+}
+
+void UT_LAYOUT_Locate_SerpentineRunsBackwardsOnOddRows(void)
+{
+    LAYOUT_Descriptor serpentine = {
+        .columns = 3,
+        .rows = 2,
+        .order = LAYOUT_OrderRowSerpentine
+    };
+    AssertLocation(&serpentine, 3, 0, 7, 16, 8);
+    AssertLocation(&serpentine, 5, 0, 7, 0, 8);
+
+    /* Backwards modules mounted upside down */
+    serpentine.rotateReversed = true;
+    AssertLocation(&serpentine, 2, 0, 7, 16, 0);
+    AssertLocation(&serpentine, 3, 0, 7, 23, 15);
+
+    LAYOUT_Descriptor columns = {
+        .columns = 2,
+        .rows = 3,
+        .order = LAYOUT_OrderColumnSerpentine
+    };
+    AssertLocation(&columns, 3, 0, 7, 8, 16);
+}
+
+void UT_LAYOUT_Locate_RotationIsClockwise(void)
+{
+    LAYOUT_Descriptor descriptor = {.columns = 1, .rows = 1};
+
+    /* Top-left LED moves to the top-right corner and so on */
+    descriptor.rotation = LAYOUT_Rotate90;
+    AssertLocation(&descriptor, 0, 0, 7, 7, 0);
+    AssertLocation(&descriptor, 0, 0, 0, 7, 7);
+    descriptor.rotation = LAYOUT_Rotate180;
+    AssertLocation(&descriptor, 0, 0, 7, 7, 7);
+    descriptor.rotation = LAYOUT_Rotate270;
+    AssertLocation(&descriptor, 0, 0, 7, 0, 7);
+    AssertLocation(&descriptor, 0, 0, 0, 0, 0);
+}
+
+void UT_LAYOUT_Create_WrongDescriptor(void)
+{
+    LAYOUT_Map map;
+    LAYOUT_Descriptor empty = {.columns = 0, .rows = 1};
+    LAYOUT_Descriptor rotation = {.columns = 1, .rows = 1, .rotation = 4};
+
+    TEST_ASSERT_STATUS_EQ(LAYOUT_StatusNullPtr, LAYOUT_Create(NULL, &empty));
+    TEST_ASSERT_STATUS_EQ(LAYOUT_StatusNullPtr, LAYOUT_Create(&map, NULL));
+    TEST_ASSERT_STATUS_EQ(LAYOUT_StatusWrongSize, LAYOUT_Create(&map, &empty));
+    TEST_ASSERT_STATUS_EQ(LAYOUT_StatusBadDescriptor, LAYOUT_Create(&map, &rotation));
+}
+
+void UT_LAYOUT_Create_OversizedGridIsRejected(void)
+{
+    LAYOUT_Map map;
+    LAYOUT_Descriptor wrapping = {.columns = SIZE_MAX / 2, .rows = 4};
+    LAYOUT_Descriptor unaddressable = {.columns = UINT32_MAX / 64 + 1, .rows = 1};
+
+    TEST_ASSERT_STATUS_EQ(LAYOUT_StatusWrongSize, LAYOUT_Create(&map, &wrapping));
+    TEST_ASSERT_STATUS_EQ(LAYOUT_StatusWrongSize, LAYOUT_Create(&map, &unaddressable));
+}
+
+void UT_LAYOUT_Wrapped_LastRowIsPartial(void)
+{
+    LAYOUT_Descriptor descriptor = LAYOUT_Wrapped(10, 8);
+    TEST_ASSERT_SIZE_EQ(8, descriptor.columns);
+    TEST_ASSERT_SIZE_EQ(2, descriptor.rows);
+
+    LAYOUT_Map map;
+    TEST_ASSERT_STATUS_EQ(LAYOUT_StatusOk, LAYOUT_Create(&map, &descriptor));
+    TEST_ASSERT_SIZE_EQ(3, LAYOUT_DeviceAt(&map, 3, 0));
+    TEST_ASSERT_SIZE_EQ(9, LAYOUT_DeviceAt(&map, 1, 1));
+    TEST_ASSERT_SIZE_EQ(15, LAYOUT_DeviceAt(&map, 7, 1));
+
+    /* D7 of digit 2 is the leftmost pixel of module row 2 */
+    u64 bitboards[16] = {0};
+    bitboards[9] = UINT64_C(0x80) << (2 * 8);
+    u64 canvas[16];
+    LAYOUT_Gather(&map, bitboards, 16, canvas);
+    TEST_ASSERT_EQUAL_HEX8(0x01, LAYOUT_ModuleRow(&map, canvas, 1, 8 + 2));
+    TEST_ASSERT_EQUAL_HEX8(0x00, LAYOUT_ModuleRow(&map, canvas, 0, 8 + 2));
+
+    LAYOUT_Destroy(&map);
+}
+
+void UT_LAYOUT_Gather_ComposesCanvasAcrossWords(void)
+{
+    /* 72 px wide canvas needs two words per row */
+    LAYOUT_Descriptor descriptor = {.columns = 9, .rows = 2, .order = LAYOUT_OrderRows};
+    LAYOUT_Map map;
+    TEST_ASSERT_STATUS_EQ(LAYOUT_StatusOk, LAYOUT_Create(&map, &descriptor));
+    TEST_ASSERT_SIZE_EQ(72, map.width);
+    TEST_ASSERT_SIZE_EQ(16, map.height);
+    TEST_ASSERT_SIZE_EQ(2, map.wordsPerRow);
+
+    u64 bitboards[18] = {0};
+    bitboards[8] = UINT64_C(1) << (3 * 8);        /* D0 of digit 3 */
+    bitboards[9] = UINT64_C(0x80) << (5 * 8);     /* D7 of digit 5 */
+    bitboards[17] = MAX7219_BITBOARD_ALL_ON;
+
+    u64 canvas[32];
+    memset(canvas, 0xA5, sizeof(canvas));
+    TEST_ASSERT_STATUS_EQ(LAYOUT_StatusOk, LAYOUT_Gather(&map, bitboards, 18, canvas));
+
+    TEST_ASSERT_TRUE(LAYOUT_Pixel(&map, canvas, 71, 3));
+    TEST_ASSERT_EQUAL_HEX64(UINT64_C(1) << 7, canvas[3 * 2 + 1]);
+    TEST_ASSERT_TRUE(LAYOUT_Pixel(&map, canvas, 0, 13));
+    TEST_ASSERT_TRUE(LAYOUT_Pixel(&map, canvas, 64, 8));
+    TEST_ASSERT_SIZE_EQ(2 + 64, CountLit(&map, canvas));
+
+    TEST_ASSERT_STATUS_EQ(LAYOUT_StatusWrongSize, LAYOUT_Gather(&map, bitboards, 17, canvas));
+    LAYOUT_Destroy(&map);
+}
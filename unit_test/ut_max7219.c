@@ -0,0 +1,148 @@
+#include "ut.h"
+#include "unity.h"
+#include "max7219.h"
+
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Create device in normal operation with all digits scanned */
+static MAX7219_Device MakeRunningDevice(void)
+{
+    MAX7219_Device device;
+    memset(&device, 0, sizeof(device));
+
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegScanLimit, 0x07));
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegShutdown, 0x01));
+    MAX7219_Render(&device);
+    return device;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_MAX7219_Write_DigitWriteMarksDeviceDirty(void)
+{
+    MAX7219_Device device = MakeRunningDevice();
+
+    u8 dirty = MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDigit0 + 3, 0x55));
+
+    TEST_ASSERT_EQUAL_HEX8(MAX7219_DIRTY_DIGIT, dirty);
+    TEST_ASSERT_EQUAL_HEX8(0x55, device.digit[3]);
+}
+
+void UT_MAX7219_Write_RewriteOfSameValueIsRedundant(void)
+{
+    MAX7219_Device device = MakeRunningDevice();
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDigit0 + 2, 0x3C));
+    MAX7219_Render(&device);
+
+    u8 digit = MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDigit0 + 2, 0x3C));
+    u8 shutdown = MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegShutdown, 0x01));
+    u8 noOp = MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegNoOp, 0x00));
+
+    TEST_ASSERT_EQUAL_HEX8(MAX7219_WRITE_REDUNDANT, digit);
+    TEST_ASSERT_EQUAL_HEX8(MAX7219_WRITE_REDUNDANT, shutdown);
+    TEST_ASSERT_EQUAL_HEX8(0, noOp);
+    TEST_ASSERT_EQUAL_HEX8(0, device.dirty);
+}
+
+void UT_MAX7219_Write_DigitWriteDuringShutdownLandsWithoutDirty(void)
+{
+    MAX7219_Device device = MakeRunningDevice();
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegShutdown, 0x00));
+    MAX7219_Render(&device);
+
+    u8 dirty = MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDigit0, 0xAA));
+
+    TEST_ASSERT_EQUAL_HEX8(0, dirty);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, device.digit[0]);
+}
+
+void UT_MAX7219_Write_DigitOutsideScanLimitDoesNotMarkDirty(void)
+{
+    MAX7219_Device device = MakeRunningDevice();
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegScanLimit, 0x02));
+    MAX7219_Render(&device);
+
+    u8 dirty = MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDigit7, 0xFF));
+
+    TEST_ASSERT_EQUAL_HEX8(0, dirty);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, device.digit[7]);
+}
+
+void UT_MAX7219_Write_IntensityDoesNotMarkDirty(void)
+{
+    MAX7219_Device device = MakeRunningDevice();
+
+    u8 dirty = MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegIntensity, 0x0F));
+
+    TEST_ASSERT_EQUAL_HEX8(0, dirty);
+    TEST_ASSERT_EQUAL_HEX8(0x0F, device.intensity);
+}
+
+void UT_MAX7219_Render_DecodeModeUsesCodeBFont(void)
+{
+    MAX7219_Device device = MakeRunningDevice();
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDecodeMode, 0x01));
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDigit0, 0x88));
+
+    u64 bitboard = MAX7219_Render(&device);
+
+    TEST_ASSERT_EQUAL_HEX8(0xFF, MAX7219_BITBOARD_ROW(bitboard, 0));
+    TEST_ASSERT_EQUAL_HEX8(0, device.dirty);
+}
+
+void UT_MAX7219_Render_DisplayTestOverridesShutdown(void)
+{
+    MAX7219_Device device;
+    memset(&device, 0, sizeof(device));
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDisplayTest, 0x01));
+
+    u64 bitboard = MAX7219_Render(&device);
+
+    TEST_ASSERT_EQUAL_HEX64(MAX7219_BITBOARD_ALL_ON, bitboard);
+}
+
+void UT_MAX7219_Render_MixedDecodeModeKeepsRawDigits(void)
+{
+    MAX7219_Device device = MakeRunningDevice();
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDecodeMode, 0x02));
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDigit0, 0x81));
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDigit0 + 1, 0x01));
+
+    u64 bitboard = MAX7219_Render(&device);
+
+    TEST_ASSERT_EQUAL_HEX64(UINT64_C(0x3081), bitboard);
+}
+
+void UT_MAX7219_Render_ScanLimitMasksUpperDigits(void)
+{
+    MAX7219_Device device = MakeRunningDevice();
+    for (u8 i = 0; i < MAX7219_DIGITS; ++i) {
+        MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegDigit0 + i, 0xFF));
+    }
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegScanLimit, 0x02));
+
+    u64 bitboard = MAX7219_Render(&device);
+
+    TEST_ASSERT_EQUAL_HEX64(UINT64_C(0xFFFFFF), bitboard);
+}
+
+void UT_MAX7219_PowerOn_DeviceStartsInShutdownWithUndefinedDigits(void)
+{
+    MAX7219_Device device = MakeRunningDevice();
+    MAX7219_Write(&device, MAX7219_FRAME(MAX7219_RegIntensity, 0x0F));
+
+    MAX7219_PowerOn(&device, 0xA5);
+
+    TEST_ASSERT_TRUE(MAX7219_IsShutdown(&device));
+    TEST_ASSERT_FALSE(MAX7219_IsDisplayTest(&device));
+    TEST_ASSERT_EQUAL_HEX8(0x00, device.intensity);
+    TEST_ASSERT_EQUAL_HEX8(0x00, device.scanLimit);
+    TEST_ASSERT_EQUAL_HEX8(0xA5, device.digit[7]);
+    TEST_ASSERT_EQUAL_HEX64(MAX7219_BITBOARD_ALL_OFF, MAX7219_Render(&device));
+}
@@ -0,0 +1,188 @@
+#include "ut.h"
+#include "unity.h"
+#include "queue.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+#define TEST_STREAM_FRAMES 200000
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Producer thread pushing increasing frame numbers */
+static void* Produce(void* argument)
+{
+    QUEUE_Instance* queue = argument;
+    u16 batch[37];
+    size sent = 0;
+
+    while (sent < TEST_STREAM_FRAMES) {
+        size count = TEST_STREAM_FRAMES - sent;
+        if (count > 37) {
+            count = 37;
+        }
+        for (size i = 0; i < count; ++i) {
+            batch[i] = (u16)(sent + i);
+        }
+
+        /* Retry the remainder until consumer makes space */
+        size pushed = 0;
+        while (pushed < count) {
+            pushed += QUEUE_Push(queue, &batch[pushed], count - pushed);
+            if (pushed < count) {
+                sched_yield();
+            }
+        }
+        sent += count;
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_QUEUE_Create_CapacityIsRoundedUpToPowerOfTwo(void)
+{
+    QUEUE_Instance queue;
+    TEST_ASSERT_STATUS_EQ(QUEUE_StatusOk, QUEUE_Create(&queue, 100));
+    TEST_ASSERT_SIZE_EQ(128, QUEUE_Capacity(&queue));
+    QUEUE_Destroy(&queue);
+
+    TEST_ASSERT_STATUS_EQ(QUEUE_StatusWrongSize, QUEUE_Create(&queue, 0));
+}
+
+void UT_QUEUE_Push_OnlyFreeSpaceIsFilled(void)
+{
+    QUEUE_Instance queue;
+    QUEUE_Create(&queue, 4);
+    const u16 frames[6] = {1, 2, 3, 4, 5, 6};
+
+    TEST_ASSERT_SIZE_EQ(4, QUEUE_Push(&queue, frames, 6));
+    TEST_ASSERT_SIZE_EQ(0, QUEUE_Push(&queue, frames, 1));
+
+    QUEUE_Destroy(&queue);
+}
+
+void UT_QUEUE_Pop_FramesWrapAroundInOrder(void)
+{
+    QUEUE_Instance queue;
+    QUEUE_Create(&queue, 4);
+    const u16 frames[6] = {1, 2, 3, 4, 5, 6};
+    u16 popped[4];
+
+    QUEUE_Push(&queue, frames, 3);
+    QUEUE_Pop(&queue, popped, 2);
+    QUEUE_Push(&queue, &frames[3], 3);
+
+    TEST_ASSERT_SIZE_EQ(4, QUEUE_Pop(&queue, popped, 4));
+    const u16 expected[4] = {3, 4, 5, 6};
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(expected, popped, 4);
+    TEST_ASSERT_SIZE_EQ(0, QUEUE_Pop(&queue, popped, 4));
+
+    QUEUE_Destroy(&queue);
+}
+
+void UT_QUEUE_PopToChain_WrappedFramesAreFedInOrder(void)
+{
+    QUEUE_Instance queue;
+    QUEUE_Create(&queue, 4);
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 2);
+
+    const u16 frames[] = {
+        MAX7219_FRAME(MAX7219_RegNoOp, 0),
+        MAX7219_FRAME(MAX7219_RegNoOp, 0),
+        MAX7219_FRAME(MAX7219_RegIntensity, 0x02),
+        MAX7219_FRAME(MAX7219_RegIntensity, 0x01)
+    };
+    QUEUE_Push(&queue, frames, 3);
+    QUEUE_PopToChain(&queue, &chain, 2);
+    QUEUE_Push(&queue, &frames[3], 1);
+
+    TEST_ASSERT_SIZE_EQ(2, QUEUE_PopToChain(&queue, &chain, 8));
+    TEST_ASSERT_EQUAL_UINT64(2, chain.tick);
+    TEST_ASSERT_EQUAL_HEX8(0x01, chain.devices[0].intensity);
+    TEST_ASSERT_EQUAL_HEX8(0x02, chain.devices[1].intensity);
+
+    CHAIN_Destroy(&chain);
+    QUEUE_Destroy(&queue);
+}
+
+void UT_QUEUE_Peek_RunEndsAtWrapAround(void)
+{
+    QUEUE_Instance queue;
+    QUEUE_Create(&queue, 4);
+    const u16 frames[6] = {1, 2, 3, 4, 5, 6};
+    const u16* run;
+
+    QUEUE_Push(&queue, frames, 3);
+    QUEUE_Advance(&queue, QUEUE_Peek(&queue, &run, 2));
+    QUEUE_Push(&queue, &frames[3], 3);
+
+    TEST_ASSERT_SIZE_EQ(2, QUEUE_Peek(&queue, &run, 8));
+    TEST_ASSERT_EQUAL_HEX16(3, run[0]);
+    TEST_ASSERT_EQUAL_HEX16(4, run[1]);
+    QUEUE_Advance(&queue, 2);
+
+    TEST_ASSERT_SIZE_EQ(2, QUEUE_Peek(&queue, &run, 8));
+    TEST_ASSERT_EQUAL_HEX16(5, run[0]);
+    TEST_ASSERT_EQUAL_HEX16(6, run[1]);
+
+    QUEUE_Destroy(&queue);
+}
+
+void UT_QUEUE_IsDrained_OnlyAfterCloseAndLastFrame(void)
+{
+    QUEUE_Instance queue;
+    QUEUE_Create(&queue, 4);
+    const u16 frame = 1;
+    u16 popped;
+
+    TEST_ASSERT_FALSE(QUEUE_IsDrained(&queue));
+    QUEUE_Push(&queue, &frame, 1);
+    QUEUE_Close(&queue);
+    TEST_ASSERT_FALSE(QUEUE_IsDrained(&queue));
+
+    TEST_ASSERT_SIZE_EQ(1, QUEUE_Pop(&queue, &popped, 1));
+    TEST_ASSERT_TRUE(QUEUE_IsDrained(&queue));
+
+    QUEUE_Destroy(&queue);
+}
+
+void UT_QUEUE_Pop_ConcurrentProducerFramesArriveInOrder(void)
+{
+    QUEUE_Instance queue;
+    QUEUE_Create(&queue, 256);
+
+    pthread_t producer;
+    pthread_create(&producer, NULL, Produce, &queue);
+
+    u16 batch[64];
+    size received = 0;
+    bool ordered = true;
+    while (received < TEST_STREAM_FRAMES) {
+        size count = QUEUE_Pop(&queue, batch, 64);
+        if (count == 0) {
+            sched_yield();
+        }
+        for (size i = 0; i < count; ++i) {
+            ordered = ordered && batch[i] == (u16)(received + i);
+        }
+        received += count;
+    }
+    pthread_join(producer, NULL);
+
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_SIZE_EQ(TEST_STREAM_FRAMES, received);
+
+    QUEUE_Destroy(&queue);
+}
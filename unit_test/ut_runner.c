@@ -7,6 +7,133 @@ int main(void)
 {
     UNITY_BEGIN();
 
+	/* UT_VIDEO */
+	RUN_TEST(UT_VIDEO_Create_WrongArguments);
+	RUN_TEST(UT_VIDEO_Publish_FrameReplacedBeforeTickIsDropped);
+	RUN_TEST(UT_VIDEO_Publish_MissingFramesAreDuplicated);
+	RUN_TEST(UT_VIDEO_Publish_WriteErrorIsReported);
+
+	/* UT_SERVER */
+	RUN_TEST(UT_SERVER_Create_WrongArguments);
+	RUN_TEST(UT_SERVER_Create_PathInUseIsKept);
+	RUN_TEST(UT_SERVER_Create_StaleSocketIsReplaced);
+	RUN_TEST(UT_SERVER_Display_BatchedTransactionsAreApplied);
+	RUN_TEST(UT_SERVER_Display_ConnectionsAreIndependent);
+	RUN_TEST(UT_SERVER_Run_MalformedMessageClosesConnection);
+
+	/* UT_CHAIN */
+	RUN_TEST(UT_CHAIN_Create_ErrStatusIsReturnedForZeroLength);
+	RUN_TEST(UT_CHAIN_Transfer_FirstFrameEndsUpInLastDevice);
+	RUN_TEST(UT_CHAIN_ChangedSince_OnlyTouchedDevicesAreReported);
+	RUN_TEST(UT_CHAIN_ChangedSince_LeavingShutdownRevealsEarlierWrites);
+	RUN_TEST(UT_CHAIN_Latch_RedundantFramesAreCounted);
+	RUN_TEST(UT_CHAIN_PowerOn_AllDevicesAreResetAndLitOnesReported);
+	RUN_TEST(UT_CHAIN_PowerOn_WritesDuringShutdownShowUpAfterWakeUp);
+	RUN_TEST(UT_CHAIN_Fork_StorageIsSharedUntilWritten);
+	RUN_TEST(UT_CHAIN_Fork_FailedCopyDropsAllLaterWrites);
+	RUN_TEST(UT_CHAIN_Fork_ForkOutlivesItsSource);
+
+	/* UT_HAL */
+	RUN_TEST(UT_HAL_Bind_WrongArguments);
+	RUN_TEST(UT_HAL_SpiWrite_CallIsOneTransaction);
+	RUN_TEST(UT_HAL_SpiSelect_HeldLoadSpansCalls);
+
+	/* UT_BRIGHTNESS */
+	RUN_TEST(UT_BRIGHTNESS_Level_MaxIntensitySingleDigitIsNearFullScale);
+	RUN_TEST(UT_BRIGHTNESS_Level_ScanLimitDividesLuminance);
+	RUN_TEST(UT_BRIGHTNESS_DutySteps_DisplayTestOverridesRegisters);
+	RUN_TEST(UT_BRIGHTNESS_Compute_UnlitLedsAreZero);
+	RUN_TEST(UT_BRIGHTNESS_ComputeChain_NothingIsDoneWhenNullPointerIsPassed);
+
+	/* UT_GOLDEN */
+	RUN_TEST(UT_GOLDEN_Compare_IdenticalData);
+	RUN_TEST(UT_GOLDEN_Compare_CountsDifferencesAndLocatesFirst);
+	RUN_TEST(UT_GOLDEN_Compare_WrongArguments);
+	RUN_TEST(UT_GOLDEN_CompareChain_RendersPendingChanges);
+
+	/* UT_IMAGE */
+	RUN_TEST(UT_IMAGE_Create_LayoutWrapsDevicesAndStacksChains);
+	RUN_TEST(UT_IMAGE_Create_WrongArguments);
+	RUN_TEST(UT_IMAGE_Rasterize_OnlyChangedDevicesAreRedrawn);
+	RUN_TEST(UT_IMAGE_Rasterize_PartialGridRowStaysBackground);
+	RUN_TEST(UT_IMAGE_WritePpm_HeaderAndPixels);
+	RUN_TEST(UT_IMAGE_WritePng_StoredBlocksAndChunks);
+
+	/* UT_STREAM */
+	RUN_TEST(UT_STREAM_Parse_RecordsStraddlingBlocksAreComplete);
+	RUN_TEST(UT_STREAM_Parse_TruncatedStreamIsReported);
+
+	/* UT_ENGINE */
+	RUN_TEST(UT_ENGINE_Run_ParallelResultMatchesSequentialFeed);
+	RUN_TEST(UT_ENGINE_Run_EmptyJobListReturnsImmediately);
+	RUN_TEST(UT_ENGINE_RunDeterministic_OutputIsIndependentOfWorkerCount);
+
+	/* UT_MAX7219 */
+	RUN_TEST(UT_MAX7219_Write_DigitWriteMarksDeviceDirty);
+	RUN_TEST(UT_MAX7219_Write_RewriteOfSameValueIsRedundant);
+	RUN_TEST(UT_MAX7219_Write_DigitWriteDuringShutdownLandsWithoutDirty);
+	RUN_TEST(UT_MAX7219_Write_DigitOutsideScanLimitDoesNotMarkDirty);
+	RUN_TEST(UT_MAX7219_Write_IntensityDoesNotMarkDirty);
+	RUN_TEST(UT_MAX7219_Render_DecodeModeUsesCodeBFont);
+	RUN_TEST(UT_MAX7219_Render_DisplayTestOverridesShutdown);
+	RUN_TEST(UT_MAX7219_Render_MixedDecodeModeKeepsRawDigits);
+	RUN_TEST(UT_MAX7219_Render_ScanLimitMasksUpperDigits);
+	RUN_TEST(UT_MAX7219_PowerOn_DeviceStartsInShutdownWithUndefinedDigits);
+
+	/* UT_TERM */
+	RUN_TEST(UT_TERM_Draw_OnlyChangedLedsAreRedrawn);
+	RUN_TEST(UT_TERM_Draw_DigitsAreDrawnWithSegments);
+	RUN_TEST(UT_TERM_Create_TooTallDrawingIsRejected);
+
+	/* UT_CSV */
+	RUN_TEST(UT_CSV_ParseSeconds_DecimalAndExponentNotationAreAccepted);
+	RUN_TEST(UT_CSV_Feed_BytesArePairedAndEmittedOnCsRisingEdge);
+	RUN_TEST(UT_CSV_Finish_UnterminatedLastLineIsParsed);
+	RUN_TEST(UT_CSV_Feed_MalformedLineIsReported);
+	RUN_TEST(UT_CSV_Feed_SignedTimestampsAreShiftedToFirstLine);
+	RUN_TEST(UT_CSV_Feed_TextAfterFirstDataLineIsReported);
+
+	/* UT_QUEUE */
+	RUN_TEST(UT_QUEUE_Create_CapacityIsRoundedUpToPowerOfTwo);
+	RUN_TEST(UT_QUEUE_Push_OnlyFreeSpaceIsFilled);
+	RUN_TEST(UT_QUEUE_Pop_FramesWrapAroundInOrder);
+	RUN_TEST(UT_QUEUE_PopToChain_WrappedFramesAreFedInOrder);
+	RUN_TEST(UT_QUEUE_Peek_RunEndsAtWrapAround);
+	RUN_TEST(UT_QUEUE_IsDrained_OnlyAfterCloseAndLastFrame);
+	RUN_TEST(UT_QUEUE_Pop_ConcurrentProducerFramesArriveInOrder);
+
+	/* UT_LAYOUT */
+	RUN_TEST(UT_LAYOUT_Locate_GridOrders);
+	RUN_TEST(UT_LAYOUT_Locate_SerpentineRunsBackwardsOnOddRows);
+	RUN_TEST(UT_LAYOUT_Locate_RotationIsClockwise);
+	RUN_TEST(UT_LAYOUT_Create_WrongDescriptor);
+	RUN_TEST(UT_LAYOUT_Create_OversizedGridIsRejected);
+	RUN_TEST(UT_LAYOUT_Wrapped_LastRowIsPartial);
+	RUN_TEST(UT_LAYOUT_Gather_ComposesCanvasAcrossWords);
+
+	/* UT_TRACE */
+	RUN_TEST(UT_TRACE_DecodeRecord_FieldsAreRestored);
+	RUN_TEST(UT_TRACE_DecodeRecord_TruncatedRecordIsDetected);
+	RUN_TEST(UT_TRACE_Parse_WrongSignatureIsRejected);
+	RUN_TEST(UT_TRACE_Replay_MappedTraceDrivesChains);
+	RUN_TEST(UT_TRACE_Replay_UnknownChainIsReported);
+	RUN_TEST(UT_TRACE_WriterInitCompressed_RepeatedRecordsAreRestored);
+	RUN_TEST(UT_TRACE_DecoderNext_MissingReferenceIsDetected);
+
+	/* UT_SCAN */
+	RUN_TEST(UT_SCAN_Create_ZeroDigitPeriodIsRejected);
+	RUN_TEST(UT_SCAN_Advance_BlankDevicesAreNotScheduled);
+	RUN_TEST(UT_SCAN_Advance_LitDigitIsEmittedOncePerScanPeriod);
+	RUN_TEST(UT_SCAN_Advance_ShutdownDevicePutsItToSleep);
+	RUN_TEST(UT_SCAN_Advance_ErrStatusIsReturnedForPastTime);
+
+	/* UT_INGEST */
+	RUN_TEST(UT_INGEST_Create_InvalidArgumentsAreRejected);
+	RUN_TEST(UT_INGEST_Create_WorkersAreLimitedToChains);
+	RUN_TEST(UT_INGEST_Record_UnknownChainIsRejected);
+	RUN_TEST(UT_INGEST_Run_ResultMatchesLockstepFeed);
+	RUN_TEST(UT_INGEST_RunDeterministic_TextIsIdenticalForAnyWorkerCount);
+
 	/* UT_HANDLE */
 	RUN_TEST(UT_HANDLE_Alloc_AfterFirstAllocationZeroHandleIsReturned);
 	RUN_TEST(UT_HANDLE_Alloc_HandlesAreReturnedInAscendingOrder);
@@ -22,6 +149,32 @@ int main(void)
 	RUN_TEST(UT_HANDLE_CountAll_ByDefaultCorrectNumberIsReturned);
 	RUN_TEST(UT_HANDLE_DeallocAll_HandlesAreFreedAfterOperation);
 
+	/* UT_SHM */
+	RUN_TEST(UT_SHM_Create_WrongArguments);
+	RUN_TEST(UT_SHM_Receive_TransactionIsShiftedAndLatched);
+	RUN_TEST(UT_SHM_Create_RunningEmulatorIsNotReplaced);
+	RUN_TEST(UT_SHM_Create_StaleRegionIsReplaced);
+	RUN_TEST(UT_SHM_Send_TransactionIsNeverSplit);
+	RUN_TEST(UT_SHM_Receive_SleepingSidesAreWoken);
+	RUN_TEST(UT_SHM_ReadState_PublishedStateIsVisible);
+
+	/* UT_BATCH */
+	RUN_TEST(UT_BATCH_Run_UpdateThenCompare);
+	RUN_TEST(UT_BATCH_Load_MalformedLineIsReported);
+
+	/* UT_SNAPSHOT */
+	RUN_TEST(UT_SNAPSHOT_Restore_SavedStateIsBroughtBack);
+	RUN_TEST(UT_SNAPSHOT_Restore_FailedForkAcceptsWritesAgain);
+	RUN_TEST(UT_SNAPSHOT_Restore_DifferentChainLengthLeavesChainsUntouched);
+	RUN_TEST(UT_SNAPSHOT_Restore_ShiftPositionOutOfRangeLeavesChainsUntouched);
+	RUN_TEST(UT_SNAPSHOT_Save_SmallBufferIsRejected);
+
+	/* UT_ENCODER */
+	RUN_TEST(UT_ENCODER_Encode_FramesReproduceCanvas);
+	RUN_TEST(UT_ENCODER_Encode_UnchangedDevicesGetNoOps);
+	RUN_TEST(UT_ENCODER_Encode_ChainShorterThanLayout);
+	RUN_TEST(UT_ENCODER_Encode_UnlatchedChainIsRejected);
+
     return UNITY_END();
 }
 
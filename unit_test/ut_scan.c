@@ -0,0 +1,145 @@
+#include "ut.h"
+#include "unity.h"
+#include "scan.h"
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+#define MAX_RECORDED_INTERVALS 64
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Recorded callback invocations */
+typedef struct
+{
+    SCAN_Interval intervals[MAX_RECORDED_INTERVALS];
+    size count;
+} Recorder;
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Store emitted interval */
+static void RecordInterval(void* context, const SCAN_Interval* interval)
+{
+    Recorder* recorder = context;
+    if (recorder->count < MAX_RECORDED_INTERVALS) {
+        recorder->intervals[recorder->count] = *interval;
+    }
+    ++recorder->count;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_SCAN_Create_ZeroDigitPeriodIsRejected(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 1);
+    Recorder recorder = {0};
+
+    SCAN_Instance scan;
+    TEST_ASSERT_STATUS_EQ(SCAN_StatusWrongTime,
+            SCAN_Create(&scan, &chain, 0, RecordInterval, &recorder));
+
+    CHAIN_Destroy(&chain);
+}
+
+void UT_SCAN_Advance_BlankDevicesAreNotScheduled(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 8);
+    Recorder recorder = {0};
+
+    SCAN_Instance scan;
+    SCAN_Create(&scan, &chain, SCAN_DEFAULT_DIGIT_PERIOD_NS, RecordInterval,
+            &recorder);
+    SCAN_Advance(&scan, 10 * SCAN_DEFAULT_DIGIT_PERIOD_NS);
+
+    TEST_ASSERT_SIZE_EQ(0, SCAN_CountActive(&scan));
+    TEST_ASSERT_SIZE_EQ(0, recorder.count);
+
+    SCAN_Destroy(&scan);
+    CHAIN_Destroy(&chain);
+}
+
+void UT_SCAN_Advance_LitDigitIsEmittedOncePerScanPeriod(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 2);
+    Recorder recorder = {0};
+
+    SCAN_Instance scan;
+    SCAN_Create(&scan, &chain, 1000, RecordInterval, &recorder);
+
+    UT_Broadcast(&chain, MAX7219_RegScanLimit, 0x01);
+    UT_Broadcast(&chain, MAX7219_RegIntensity, 0x07);
+    UT_Broadcast(&chain, MAX7219_RegShutdown, 0x01);
+    const u16 frames[] = {
+        MAX7219_FRAME(MAX7219_RegDigit0 + 1, 0x3C),
+        MAX7219_FRAME(MAX7219_RegNoOp, 0)
+    };
+    CHAIN_Transfer(&chain, frames, 2);
+    SCAN_Sync(&scan);
+
+    /* Two digits scanned, thus digit 1 starts at 1000 and 3000 */
+    SCAN_Advance(&scan, 4000);
+
+    TEST_ASSERT_SIZE_EQ(1, SCAN_CountActive(&scan));
+    TEST_ASSERT_SIZE_EQ(2, recorder.count);
+    TEST_ASSERT_SIZE_EQ(1, recorder.intervals[0].device);
+    TEST_ASSERT_EQUAL_UINT8(1, recorder.intervals[0].digit);
+    TEST_ASSERT_EQUAL_HEX8(0x3C, recorder.intervals[0].segments);
+    TEST_ASSERT_EQUAL_UINT64(1000, recorder.intervals[0].start);
+    TEST_ASSERT_EQUAL_UINT64(1000 + 1000 * 15 / 32, recorder.intervals[0].end);
+    TEST_ASSERT_EQUAL_UINT64(3000, recorder.intervals[1].start);
+
+    SCAN_Destroy(&scan);
+    CHAIN_Destroy(&chain);
+}
+
+void UT_SCAN_Advance_ShutdownDevicePutsItToSleep(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 1);
+    Recorder recorder = {0};
+    UT_Broadcast(&chain, MAX7219_RegDisplayTest, 0x01);
+
+    SCAN_Instance scan;
+    SCAN_Create(&scan, &chain, 1000, RecordInterval, &recorder);
+    SCAN_Advance(&scan, 8000);
+    TEST_ASSERT_SIZE_EQ(8, recorder.count);
+
+    UT_Broadcast(&chain, MAX7219_RegDisplayTest, 0x00);
+    SCAN_Sync(&scan);
+    SCAN_Advance(&scan, 16000);
+
+    TEST_ASSERT_SIZE_EQ(8, recorder.count);
+    TEST_ASSERT_SIZE_EQ(0, SCAN_CountActive(&scan));
+
+    SCAN_Destroy(&scan);
+    CHAIN_Destroy(&chain);
+}
+
+void UT_SCAN_Advance_ErrStatusIsReturnedForPastTime(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 1);
+    Recorder recorder = {0};
+
+    SCAN_Instance scan;
+    SCAN_Create(&scan, &chain, 1000, RecordInterval, &recorder);
+    SCAN_Advance(&scan, 5000);
+
+    TEST_ASSERT_STATUS_EQ(SCAN_StatusWrongTime, SCAN_Advance(&scan, 4000));
+
+    SCAN_Destroy(&scan);
+    CHAIN_Destroy(&chain);
+}
@@ -0,0 +1,267 @@
+#include "ut.h"
+#include "unity.h"
+#include "server.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define CHAINS  2
+#define DEVICES 2
+#define WORKERS 2
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Display reply as received by a client */
+typedef struct
+{
+    SERVER_Header header;
+    u64 bitboards[CHAINS * DEVICES];
+} Display;
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private variables --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+static SERVER_Instance server;
+static pthread_t thread;
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Build socket path unique to the test process */
+static const char* SocketPath(void)
+{
+    static char path[64];
+    snprintf(path, sizeof(path), "/tmp/ut_server_%d.sock", (int)getpid());
+    return path;
+}
+
+/* Server thread entry point */
+static void* ServerThread(void* argument)
+{
+    (void)argument;
+    SERVER_Run(&server);
+    return NULL;
+}
+
+/* Create server and run it in background */
+static void Start(void)
+{
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusOk,
+            SERVER_Create(&server, SocketPath(), CHAINS, DEVICES, WORKERS));
+    pthread_create(&thread, NULL, ServerThread, NULL);
+}
+
+/* Stop background server and release it */
+static void Finish(void)
+{
+    SERVER_Stop(&server);
+    pthread_join(thread, NULL);
+    SERVER_Destroy(&server);
+}
+
+/* Connect new client */
+static int Connect(void)
+{
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    strcpy(address.sun_path, SocketPath());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    TEST_ASSERT_EQUAL_INT(0, connect(fd, (struct sockaddr*)&address, sizeof(address)));
+    return fd;
+}
+
+/* Append message to request buffer, returns new length */
+static size Append(u8* buffer, size length, u16 type, u16 chain,
+        const u16* frames, size count)
+{
+    SERVER_Header header = {
+        .length = (u32)(count * sizeof(u16)),
+        .type = type,
+        .chain = chain
+    };
+    memcpy(buffer + length, &header, sizeof(header));
+    if (count > 0) {
+        memcpy(buffer + length + sizeof(header), frames, header.length);
+    }
+    return length + sizeof(header) + header.length;
+}
+
+/* Read exactly length bytes, returns false on end of stream */
+static bool ReadAll(int fd, void* buffer, size length)
+{
+    u8* bytes = buffer;
+    while (length > 0) {
+        ssize_t count = read(fd, bytes, length);
+        if (count <= 0) {
+            return false;
+        }
+        bytes += count;
+        length -= (size)count;
+    }
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_SERVER_Create_WrongArguments(void)
+{
+    SERVER_Instance instance;
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusNullPtr, SERVER_Create(NULL, SocketPath(), 1, 1, 1));
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusNullPtr, SERVER_Create(&instance, NULL, 1, 1, 1));
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusWrongSize, SERVER_Create(&instance, SocketPath(), 0, 1, 1));
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusWrongSize, SERVER_Create(&instance, SocketPath(), 1, 0, 1));
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusWrongSize,
+            SERVER_Create(&instance, SocketPath(), 1, SERVER_MAX_PAYLOAD, 1));
+
+    char longPath[256];
+    memset(longPath, 'a', sizeof(longPath) - 1);
+    longPath[sizeof(longPath) - 1] = '\0';
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusWrongSize, SERVER_Create(&instance, longPath, 1, 1, 1));
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusIoError,
+            SERVER_Create(&instance, "/nonexistent/ut_server.sock", 1, 1, 1));
+}
+
+void UT_SERVER_Create_PathInUseIsKept(void)
+{
+    SERVER_Instance instance;
+
+    /* Regular file */
+    FILE* file = fopen(SocketPath(), "w");
+    TEST_ASSERT_NOT_NULL(file);
+    fclose(file);
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusIoError,
+            SERVER_Create(&instance, SocketPath(), 1, 1, 1));
+    TEST_ASSERT_EQUAL_INT(0, access(SocketPath(), F_OK));
+    unlink(SocketPath());
+
+    /* Socket of a live server, connections are queued even without Run */
+    SERVER_Instance live;
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusOk, SERVER_Create(&live, SocketPath(), 1, 1, 1));
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusIoError,
+            SERVER_Create(&instance, SocketPath(), 1, 1, 1));
+    close(Connect());
+    SERVER_Destroy(&live);
+}
+
+void UT_SERVER_Create_StaleSocketIsReplaced(void)
+{
+    /* Socket file of a process which exited without removing it */
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    strcpy(address.sun_path, SocketPath());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    TEST_ASSERT_EQUAL_INT(0, bind(fd, (struct sockaddr*)&address, sizeof(address)));
+    close(fd);
+
+    Start();
+    close(Connect());
+    Finish();
+}
+
+void UT_SERVER_Display_BatchedTransactionsAreApplied(void)
+{
+    Start();
+    int client = Connect();
+
+    /* Two transactions per chain and the display request in a single write */
+    static const u16 first[] = {
+        MAX7219_FRAME(MAX7219_RegDisplayTest, 1), MAX7219_FRAME(MAX7219_RegNoOp, 0),
+        MAX7219_FRAME(MAX7219_RegShutdown, 1), MAX7219_FRAME(MAX7219_RegShutdown, 1)
+    };
+    static const u16 second[] = {
+        MAX7219_FRAME(MAX7219_RegShutdown, 1), MAX7219_FRAME(MAX7219_RegNoOp, 0),
+        MAX7219_FRAME(MAX7219_RegNoOp, 0), MAX7219_FRAME(MAX7219_RegDisplayTest, 1)
+    };
+    u8 request[64];
+    size length = Append(request, 0, SERVER_MessageFrames, 0, first, 4);
+    length = Append(request, length, SERVER_MessageFrames, 1, second, 4);
+    length = Append(request, length, SERVER_MessageDisplay, 7, NULL, 0);
+    TEST_ASSERT_EQUAL_INT((int)length, (int)write(client, request, length));
+
+    /* The first frame of a transaction ends up in the last device */
+    Display display;
+    TEST_ASSERT_TRUE(ReadAll(client, &display, sizeof(display)));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(display.bitboards), display.header.length);
+    TEST_ASSERT_EQUAL_UINT16(SERVER_MessageDisplay, display.header.type);
+    TEST_ASSERT_EQUAL_UINT16(7, display.header.chain);
+    TEST_ASSERT_EQUAL_UINT64(MAX7219_BITBOARD_ALL_OFF, display.bitboards[0]);
+    TEST_ASSERT_EQUAL_UINT64(MAX7219_BITBOARD_ALL_ON, display.bitboards[1]);
+    TEST_ASSERT_EQUAL_UINT64(MAX7219_BITBOARD_ALL_ON, display.bitboards[2]);
+    TEST_ASSERT_EQUAL_UINT64(MAX7219_BITBOARD_ALL_OFF, display.bitboards[3]);
+
+    /* Reset blanks everything */
+    length = Append(request, 0, SERVER_MessageReset, 0, NULL, 0);
+    length = Append(request, length, SERVER_MessageDisplay, 0, NULL, 0);
+    TEST_ASSERT_EQUAL_INT((int)length, (int)write(client, request, length));
+    TEST_ASSERT_TRUE(ReadAll(client, &display, sizeof(display)));
+    for (size i = 0; i < CHAINS * DEVICES; ++i) {
+        TEST_ASSERT_EQUAL_UINT64(MAX7219_BITBOARD_ALL_OFF, display.bitboards[i]);
+    }
+
+    close(client);
+    Finish();
+}
+
+void UT_SERVER_Display_ConnectionsAreIndependent(void)
+{
+    Start();
+    int lit = Connect();
+    int blank = Connect();
+
+    static const u16 test[] = {
+        MAX7219_FRAME(MAX7219_RegDisplayTest, 1), MAX7219_FRAME(MAX7219_RegDisplayTest, 1)
+    };
+    u8 request[32];
+    size length = Append(request, 0, SERVER_MessageFrames, 0, test, 2);
+    length = Append(request, length, SERVER_MessageDisplay, 0, NULL, 0);
+    TEST_ASSERT_EQUAL_INT((int)length, (int)write(lit, request, length));
+
+    Display display;
+    TEST_ASSERT_TRUE(ReadAll(lit, &display, sizeof(display)));
+    TEST_ASSERT_EQUAL_UINT64(MAX7219_BITBOARD_ALL_ON, display.bitboards[0]);
+
+    length = Append(request, 0, SERVER_MessageDisplay, 0, NULL, 0);
+    TEST_ASSERT_EQUAL_INT((int)length, (int)write(blank, request, length));
+    TEST_ASSERT_TRUE(ReadAll(blank, &display, sizeof(display)));
+    TEST_ASSERT_EQUAL_UINT64(MAX7219_BITBOARD_ALL_OFF, display.bitboards[0]);
+
+    close(lit);
+    close(blank);
+    Finish();
+}
+
+void UT_SERVER_Run_MalformedMessageClosesConnection(void)
+{
+    Start();
+    int client = Connect();
+
+    static const u16 frames[] = { 0 };
+    u8 request[16];
+    size length = Append(request, 0, SERVER_MessageFrames, CHAINS, frames, 1);
+    TEST_ASSERT_EQUAL_INT((int)length, (int)write(client, request, length));
+
+    u8 byte;
+    TEST_ASSERT_FALSE(ReadAll(client, &byte, 1));
+    close(client);
+
+    SERVER_Stop(&server);
+    pthread_join(thread, NULL);
+    SERVER_Stats total;
+    TEST_ASSERT_STATUS_EQ(SERVER_StatusOk, SERVER_Total(&server, &total));
+    TEST_ASSERT_EQUAL_UINT64(1, total.connections);
+    TEST_ASSERT_EQUAL_UINT64(1, total.rejected);
+    TEST_ASSERT_EQUAL_UINT64(0, total.frames);
+    SERVER_Destroy(&server);
+}
@@ -0,0 +1,240 @@
+#include "ut.h"
+#include "unity.h"
+#include "shm.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+#define CAPACITY 8
+#define DEVICES  2
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Firmware side driven from another thread */
+typedef struct
+{
+    SHM_Ring* ring;
+    size transactions;
+    SHM_Status status;
+} Producer;
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Build name unique to the test process */
+static const char* RingName(void)
+{
+    static char name[32];
+    snprintf(name, sizeof(name), "/ut_shm_%d", (int)getpid());
+    return name;
+}
+
+/* Send digit 0 of both devices set to the transaction number */
+static void* ProducerThread(void* argument)
+{
+    Producer* producer = argument;
+    for (size i = 0; i < producer->transactions; ++i) {
+        u16 frames[DEVICES] = {
+            MAX7219_FRAME(MAX7219_RegDigit0, i),
+            MAX7219_FRAME(MAX7219_RegDigit0, i)
+        };
+        producer->status = SHM_Send(producer->ring, 0, frames, DEVICES,
+                SHM_WAIT_FOREVER);
+        if (producer->status != SHM_StatusOk) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_SHM_Create_WrongArguments(void)
+{
+    SHM_Ring ring;
+    TEST_ASSERT_STATUS_EQ(SHM_StatusNullPtr, SHM_Create(NULL, RingName(), CAPACITY, 1, 1));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusNullPtr, SHM_Create(&ring, NULL, CAPACITY, 1, 1));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusWrongSize, SHM_Create(&ring, RingName(), 6, 1, 1));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusWrongSize, SHM_Create(&ring, RingName(), CAPACITY, 0, 1));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusWrongSize,
+            SHM_Create(&ring, RingName(), CAPACITY, SHM_MAX_CHAINS + 1, 1));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusIoError, SHM_Open(&ring, "/ut_shm_missing"));
+}
+
+void UT_SHM_Receive_TransactionIsShiftedAndLatched(void)
+{
+    SHM_Ring consumer;
+    SHM_Ring producer;
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Create(&consumer, RingName(), CAPACITY, 2, DEVICES));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Open(&producer, RingName()));
+
+    CHAIN_Instance chains[2];
+    CHAIN_Create(&chains[0], DEVICES);
+    CHAIN_Create(&chains[1], DEVICES);
+
+    /* The first frame sent ends up in the last device */
+    u16 frames[DEVICES] = {
+        MAX7219_FRAME(MAX7219_RegDigit0 + 2, 0xAA),
+        MAX7219_FRAME(MAX7219_RegDigit0 + 5, 0x55)
+    };
+    TEST_ASSERT_STATUS_EQ(SHM_StatusWrongSize, SHM_Send(&producer, 2, frames, DEVICES, 0));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Send(&producer, 1, frames, DEVICES, 0));
+
+    size received = 0;
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Receive(&consumer, chains, 0, &received));
+    TEST_ASSERT_SIZE_EQ(DEVICES, received);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, chains[1].devices[1].digit[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x55, chains[1].devices[0].digit[5]);
+    TEST_ASSERT_EQUAL_UINT64(0, chains[0].frames);
+
+    /* Nothing left, zero timeout returns at once */
+    TEST_ASSERT_STATUS_EQ(SHM_StatusTimeout, SHM_Receive(&consumer, chains, 0, &received));
+    TEST_ASSERT_SIZE_EQ(0, received);
+
+    CHAIN_Destroy(&chains[0]);
+    CHAIN_Destroy(&chains[1]);
+    SHM_Close(&producer);
+    SHM_Close(&consumer);
+}
+
+void UT_SHM_Create_RunningEmulatorIsNotReplaced(void)
+{
+    SHM_Ring consumer;
+    SHM_Ring other;
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Create(&consumer, RingName(), CAPACITY, 1, DEVICES));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusBusy, SHM_Create(&other, RingName(), CAPACITY, 1, DEVICES));
+
+    /* The region is still usable */
+    SHM_Ring producer;
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Open(&producer, RingName()));
+    TEST_ASSERT_EQUAL_UINT32(CAPACITY, producer.region->capacity);
+
+    SHM_Close(&producer);
+    SHM_Close(&consumer);
+}
+
+void UT_SHM_Create_StaleRegionIsReplaced(void)
+{
+    /* Object of an emulator which died without unlinking it */
+    int fd = shm_open(RingName(), O_CREAT | O_RDWR, 0600);
+    TEST_ASSERT_TRUE(fd >= 0);
+    TEST_ASSERT_EQUAL_INT(0, ftruncate(fd, 4096));
+    close(fd);
+
+    SHM_Ring consumer;
+    SHM_Ring producer;
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Create(&consumer, RingName(), CAPACITY, 1, DEVICES));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Open(&producer, RingName()));
+
+    SHM_Close(&producer);
+    SHM_Close(&consumer);
+}
+
+void UT_SHM_Send_TransactionIsNeverSplit(void)
+{
+    SHM_Ring consumer;
+    SHM_Ring producer;
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Create(&consumer, RingName(), CAPACITY, 1, DEVICES));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Open(&producer, RingName()));
+
+    u16 frames[CAPACITY + 1] = { 0 };
+    TEST_ASSERT_STATUS_EQ(SHM_StatusWrongSize, SHM_Send(&producer, 0, frames, CAPACITY + 1, 10));
+
+    /* One free entry is not enough for a transaction of two frames */
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Send(&producer, 0, frames, CAPACITY - 1, 0));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusTimeout, SHM_Send(&producer, 0, frames, 2, 10));
+
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, CAPACITY - 1);
+    size received = 0;
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Receive(&consumer, &chain, 0, &received));
+    TEST_ASSERT_SIZE_EQ(CAPACITY - 1, received);
+    TEST_ASSERT_SIZE_EQ(0, chain.shifted);
+
+    CHAIN_Destroy(&chain);
+    SHM_Close(&producer);
+    SHM_Close(&consumer);
+}
+
+void UT_SHM_Receive_SleepingSidesAreWoken(void)
+{
+    SHM_Ring consumer;
+    SHM_Ring producer;
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Create(&consumer, RingName(), CAPACITY, 1, DEVICES));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Open(&producer, RingName()));
+
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, DEVICES);
+    CHAIN_PowerOn(&chain, 0);
+
+    /* Many more frames than the ring holds, both sides have to sleep */
+    Producer context = { .ring = &producer, .transactions = 1000 };
+    pthread_t thread;
+    pthread_create(&thread, NULL, ProducerThread, &context);
+
+    size total = 0;
+    while (total < context.transactions * DEVICES) {
+        size received = 0;
+        TEST_ASSERT_STATUS_EQ(SHM_StatusOk,
+                SHM_Receive(&consumer, &chain, SHM_WAIT_FOREVER, &received));
+        total += received;
+    }
+    pthread_join(thread, NULL);
+
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, context.status);
+    TEST_ASSERT_EQUAL_UINT64(context.transactions * DEVICES, chain.frames);
+    TEST_ASSERT_EQUAL_HEX8((u8)(context.transactions - 1), chain.devices[0].digit[0]);
+
+    /* Closing the firmware side ends waiting for more */
+    size received = 0;
+    SHM_Close(&producer);
+    TEST_ASSERT_STATUS_EQ(SHM_StatusClosed,
+            SHM_Receive(&consumer, &chain, SHM_WAIT_FOREVER, &received));
+
+    CHAIN_Destroy(&chain);
+    SHM_Close(&consumer);
+}
+
+void UT_SHM_ReadState_PublishedStateIsVisible(void)
+{
+    SHM_Ring consumer;
+    SHM_Ring producer;
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Create(&consumer, RingName(), CAPACITY, 1, DEVICES));
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_Open(&producer, RingName()));
+
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, DEVICES);
+    CHAIN_PowerOn(&chain, 0);
+    u16 frames[DEVICES] = {
+        MAX7219_FRAME(MAX7219_RegDisplayTest, 1),
+        MAX7219_FRAME(MAX7219_RegNoOp, 0)
+    };
+    CHAIN_Transfer(&chain, frames, DEVICES);
+
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_PublishState(&consumer, &chain));
+    u64 state[DEVICES];
+    TEST_ASSERT_STATUS_EQ(SHM_StatusOk, SHM_ReadState(&producer, state));
+    TEST_ASSERT_EQUAL_UINT64(MAX7219_BITBOARD_ALL_OFF, state[0]);
+    TEST_ASSERT_EQUAL_UINT64(MAX7219_BITBOARD_ALL_ON, state[1]);
+
+    /* The emulator going away is reported to the firmware */
+    SHM_Close(&consumer);
+    TEST_ASSERT_STATUS_EQ(SHM_StatusClosed, SHM_Send(&producer, 0, frames, DEVICES, 0));
+
+    CHAIN_Destroy(&chain);
+    SHM_Close(&producer);
+}
@@ -0,0 +1,165 @@
+#include "ut.h"
+#include "unity.h"
+#include "snapshot.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_SNAPSHOT_Restore_SavedStateIsBroughtBack(void)
+{
+    CHAIN_Instance chains[2];
+    CHAIN_Create(&chains[0], 3);
+    CHAIN_Create(&chains[1], 5);
+    UT_Broadcast(&chains[0], MAX7219_RegShutdown, 0x01);
+    UT_Broadcast(&chains[0], MAX7219_RegDigit0, 0x42);
+    CHAIN_Render(&chains[0]);
+    CHAIN_Shift(&chains[1], MAX7219_FRAME(MAX7219_RegIntensity, 0x07));
+
+    size length = SNAPSHOT_Size(chains, 2);
+    void* buffer = malloc(length);
+    TEST_ASSERT_STATUS_EQ(SNAPSHOT_StatusOk,
+            SNAPSHOT_Save(chains, 2, buffer, length));
+
+    u8* expected = malloc(chains[1].storageSize);
+    memcpy(expected, chains[1].storage, chains[1].storageSize);
+    u64 tick = chains[0].tick;
+
+    /* Diverge from the checkpoint */
+    UT_Broadcast(&chains[0], MAX7219_RegDisplayTest, 0x01);
+    CHAIN_Render(&chains[0]);
+    UT_Broadcast(&chains[1], MAX7219_RegDigit7, 0xFF);
+
+    TEST_ASSERT_STATUS_EQ(SNAPSHOT_StatusOk,
+            SNAPSHOT_Restore(chains, 2, buffer, length));
+
+    TEST_ASSERT_EQUAL_UINT64(tick, chains[0].tick);
+    TEST_ASSERT_EQUAL_HEX64(UINT64_C(0x42), chains[0].framebuffer[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, chains[0].devices[2].displayTest);
+    TEST_ASSERT_EQUAL_UINT64(0, chains[1].tick);
+    TEST_ASSERT_EQUAL_size_t(1, chains[1].shifted);
+    TEST_ASSERT_EQUAL_MEMORY(expected, chains[1].storage, chains[1].storageSize);
+
+    free(expected);
+    free(buffer);
+    CHAIN_Destroy(&chains[0]);
+    CHAIN_Destroy(&chains[1]);
+}
+
+void UT_SNAPSHOT_Restore_FailedForkAcceptsWritesAgain(void)
+{
+    CHAIN_Instance source;
+    CHAIN_Create(&source, 2);
+    UT_Broadcast(&source, MAX7219_RegShutdown, 0x01);
+
+    size length = SNAPSHOT_Size(&source, 1);
+    void* buffer = malloc(length);
+    SNAPSHOT_Save(&source, 1, buffer, length);
+
+    /* Storage size no allocator can satisfy makes the copy fail */
+    CHAIN_Instance fork;
+    CHAIN_Fork(&source, &fork);
+    size storageSize = fork.storageSize;
+    fork.storageSize = SIZE_MAX / 2;
+    UT_Broadcast(&fork, MAX7219_RegDigit0, 0x18);
+    TEST_ASSERT_TRUE(fork.failed);
+    fork.storageSize = storageSize;
+
+    TEST_ASSERT_STATUS_EQ(SNAPSHOT_StatusOk,
+            SNAPSHOT_Restore(&fork, 1, buffer, length));
+    TEST_ASSERT_FALSE(fork.failed);
+    TEST_ASSERT_NOT_EQUAL(source.storage, fork.storage);
+
+    UT_Broadcast(&fork, MAX7219_RegDigit0, 0x18);
+    TEST_ASSERT_EQUAL_HEX8(0x18, fork.devices[1].digit[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, source.devices[1].digit[0]);
+
+    free(buffer);
+    CHAIN_Destroy(&fork);
+    CHAIN_Destroy(&source);
+}
+
+void UT_SNAPSHOT_Restore_DifferentChainLengthLeavesChainsUntouched(void)
+{
+    CHAIN_Instance chains[2];
+    CHAIN_Create(&chains[0], 2);
+    CHAIN_Create(&chains[1], 2);
+
+    size length = SNAPSHOT_Size(chains, 2);
+    void* buffer = malloc(length);
+    SNAPSHOT_Save(chains, 2, buffer, length);
+
+    CHAIN_Instance other[2];
+    CHAIN_Create(&other[0], 2);
+    CHAIN_Create(&other[1], 3);
+    UT_Broadcast(&other[0], MAX7219_RegShutdown, 0x01);
+
+    TEST_ASSERT_STATUS_EQ(SNAPSHOT_StatusWrongSize,
+            SNAPSHOT_Restore(other, 2, buffer, length));
+    TEST_ASSERT_EQUAL_UINT64(1, other[0].tick);
+    TEST_ASSERT_EQUAL_HEX8(0x01, other[0].devices[0].shutdown);
+
+    TEST_ASSERT_STATUS_EQ(SNAPSHOT_StatusBadFormat,
+            SNAPSHOT_Restore(other, 1, buffer, length));
+
+    free(buffer);
+    for (size i = 0; i < 2; ++i) {
+        CHAIN_Destroy(&chains[i]);
+        CHAIN_Destroy(&other[i]);
+    }
+}
+
+void UT_SNAPSHOT_Restore_ShiftPositionOutOfRangeLeavesChainsUntouched(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 2);
+    UT_Broadcast(&chain, MAX7219_RegShutdown, 0x01);
+
+    size length = SNAPSHOT_Size(&chain, 1);
+    void* buffer = malloc(length);
+    SNAPSHOT_Save(&chain, 1, buffer, length);
+    SNAPSHOT_ChainHeader* saved = (SNAPSHOT_ChainHeader*)
+            ((u8*)buffer + sizeof(SNAPSHOT_Header));
+
+    CHAIN_Instance other;
+    CHAIN_Create(&other, 2);
+
+    saved->shiftHead = 2;
+    TEST_ASSERT_STATUS_EQ(SNAPSHOT_StatusWrongSize,
+            SNAPSHOT_Restore(&other, 1, buffer, length));
+
+    saved->shiftHead = 1;
+    saved->shifted = 3;
+    TEST_ASSERT_STATUS_EQ(SNAPSHOT_StatusWrongSize,
+            SNAPSHOT_Restore(&other, 1, buffer, length));
+    TEST_ASSERT_EQUAL_UINT64(0, other.tick);
+    TEST_ASSERT_EQUAL_size_t(0, other.shiftHead);
+
+    saved->shifted = 2;
+    TEST_ASSERT_STATUS_EQ(SNAPSHOT_StatusOk,
+            SNAPSHOT_Restore(&other, 1, buffer, length));
+    TEST_ASSERT_EQUAL_HEX8(0x01, other.devices[0].shutdown);
+
+    free(buffer);
+    CHAIN_Destroy(&chain);
+    CHAIN_Destroy(&other);
+}
+
+void UT_SNAPSHOT_Save_SmallBufferIsRejected(void)
+{
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 4);
+
+    size length = SNAPSHOT_Size(&chain, 1);
+    void* buffer = malloc(length);
+
+    TEST_ASSERT_STATUS_EQ(SNAPSHOT_StatusWrongSize,
+            SNAPSHOT_Save(&chain, 1, buffer, length - 1));
+
+    free(buffer);
+    CHAIN_Destroy(&chain);
+}
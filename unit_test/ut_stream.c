@@ -0,0 +1,108 @@
+#include "ut.h"
+#include "unity.h"
+#include "stream.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Enough records to span several input blocks */
+#define TEST_RECORDS 150000
+#define TEST_FRAMES_PER_RECORD 8
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Verification state of received records */
+typedef struct
+{
+    size records;
+    bool ordered;
+} Checker;
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Check that records arrive complete and in order */
+static TRACE_Status CheckRecord(void* context, const TRACE_Record* record)
+{
+    Checker* checker = context;
+    u16 first = (u16)(record->frames[0] | (record->frames[1] << 8));
+
+    checker->ordered = checker->ordered
+            && record->count == TEST_FRAMES_PER_RECORD
+            && record->timestamp == 10 * (u64)checker->records
+            && first == (u16)checker->records;
+    ++checker->records;
+    return TRACE_StatusOk;
+}
+
+/* Write trace into temporary file and reopen it for reading */
+static int MakeTraceDescriptor(size records, bool truncate)
+{
+    char path[] = "/tmp/ut_stream_XXXXXX";
+    int fd = mkstemp(path);
+    FILE* file = fdopen(dup(fd), "wb");
+    unlink(path);
+
+    TRACE_Writer writer;
+    TRACE_WriterInit(&writer, file);
+    u16 frames[TEST_FRAMES_PER_RECORD] = {0};
+    for (size i = 0; i < records; ++i) {
+        frames[0] = (u16)i;
+        TRACE_WriteRecord(&writer, 0, 10 * i, frames, TEST_FRAMES_PER_RECORD);
+    }
+    fflush(file);
+    if (truncate) {
+        ftruncate(fileno(file), ftell(file) - 3);
+    }
+    fclose(file);
+
+    lseek(fd, 0, SEEK_SET);
+    return fd;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_STREAM_Parse_RecordsStraddlingBlocksAreComplete(void)
+{
+    int fd = MakeTraceDescriptor(TEST_RECORDS, false);
+    STREAM_Reader reader;
+    Checker checker = {.records = 0, .ordered = true};
+
+    TEST_ASSERT_STATUS_EQ(STREAM_StatusOk, STREAM_Create(&reader, fd));
+    STREAM_Status status = STREAM_Parse(&reader, CheckRecord, &checker);
+    u64 bytes = reader.bytes;
+    STREAM_Destroy(&reader);
+    close(fd);
+
+    TEST_ASSERT_STATUS_EQ(STREAM_StatusOk, status);
+    TEST_ASSERT_TRUE(bytes > 2 * STREAM_BLOCK_SIZE);
+    TEST_ASSERT_EQUAL_size_t(TEST_RECORDS, checker.records);
+    TEST_ASSERT_TRUE(checker.ordered);
+}
+
+void UT_STREAM_Parse_TruncatedStreamIsReported(void)
+{
+    int fd = MakeTraceDescriptor(10, true);
+    STREAM_Reader reader;
+    Checker checker = {.records = 0, .ordered = true};
+
+    STREAM_Create(&reader, fd);
+    STREAM_Status status = STREAM_Parse(&reader, CheckRecord, &checker);
+    TRACE_Status traceStatus = reader.traceStatus;
+    STREAM_Destroy(&reader);
+    close(fd);
+
+    TEST_ASSERT_STATUS_EQ(STREAM_StatusTraceError, status);
+    TEST_ASSERT_STATUS_EQ(TRACE_StatusTruncated, traceStatus);
+    TEST_ASSERT_EQUAL_size_t(9, checker.records);
+}
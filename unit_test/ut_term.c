@@ -0,0 +1,136 @@
+#include "ut.h"
+#include "unity.h"
+#include "term.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Read everything available in non-blocking pipe */
+static size Drain(int fd, char* buffer, size capacity)
+{
+    ssize_t count = read(fd, buffer, capacity - 1);
+    size length = (count > 0) ? (size)count : 0;
+    buffer[length] = '\0';
+    return length;
+}
+
+/* Count non-overlapping occurrences of text */
+static size CountOf(const char* haystack, const char* needle)
+{
+    size count = 0;
+    for (const char* at = strstr(haystack, needle); at != NULL;
+            at = strstr(at + strlen(needle), needle)) {
+        ++count;
+    }
+    return count;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_TERM_Draw_OnlyChangedLedsAreRedrawn(void)
+{
+    int pipes[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(pipes));
+    fcntl(pipes[0], F_SETFL, O_NONBLOCK);
+
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 2);
+    UT_Broadcast(&chain, MAX7219_RegScanLimit, 0x07);
+    UT_Broadcast(&chain, MAX7219_RegShutdown, 0x01);
+
+    TERM_Renderer renderer;
+    TEST_ASSERT_STATUS_EQ(TERM_StatusOk, TERM_Create(&renderer, pipes[1],
+            TERM_ModeMatrix, &chain, 1, TERM_DEFAULT_PER_ROW));
+
+    static char output[16384];
+    size written;
+    TERM_Draw(&renderer, &written);
+    TEST_ASSERT_SIZE_EQ(written, Drain(pipes[0], output, sizeof(output)));
+    TEST_ASSERT_SIZE_EQ(2 * 64, CountOf(output, "\xe2\x96\x88\xe2\x96\x88"));
+
+    /* Nothing changed, nothing is written */
+    TERM_Draw(&renderer, &written);
+    TEST_ASSERT_SIZE_EQ(0, written);
+
+    /* Two adjacent LEDs of device 1, row 3, columns D7 and D6 */
+    CHAIN_Shift(&chain, MAX7219_FRAME(MAX7219_RegNoOp, 0x00));
+    CHAIN_Shift(&chain, MAX7219_FRAME(MAX7219_RegDigit0 + 3, 0xC0));
+    CHAIN_Latch(&chain);
+    TERM_Draw(&renderer, &written);
+    Drain(pipes[0], output, sizeof(output));
+
+    TEST_ASSERT_SIZE_EQ(2, CountOf(output, "\xe2\x96\x88\xe2\x96\x88"));
+    TEST_ASSERT_SIZE_EQ(1, CountOf(output, "\x1b[4;1H"));
+    TEST_ASSERT_SIZE_EQ(1, CountOf(output, "H"));
+
+    TERM_Destroy(&renderer);
+    CHAIN_Destroy(&chain);
+    close(pipes[0]);
+    close(pipes[1]);
+}
+
+void UT_TERM_Draw_DigitsAreDrawnWithSegments(void)
+{
+    int pipes[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(pipes));
+    fcntl(pipes[0], F_SETFL, O_NONBLOCK);
+
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 1);
+    UT_Broadcast(&chain, MAX7219_RegShutdown, 0x01);
+    UT_Broadcast(&chain, MAX7219_RegDecodeMode, 0x01);
+    UT_Broadcast(&chain, MAX7219_RegDigit0, 0x88);
+
+    TERM_Renderer renderer;
+    TERM_Create(&renderer, pipes[1], TERM_ModeDigits, &chain, 1,
+            TERM_DEFAULT_PER_ROW);
+
+    static char output[16384];
+    TERM_Draw(&renderer, NULL);
+    Drain(pipes[0], output, sizeof(output));
+
+    /* Digit 0 is the rightmost one, "8." in Code B */
+    TEST_ASSERT_NOT_NULL(strstr(output, "\x1b[1;29H _  "));
+    TEST_ASSERT_NOT_NULL(strstr(output, "\x1b[2;29H|_| "));
+    TEST_ASSERT_NOT_NULL(strstr(output, "\x1b[3;29H|_|."));
+
+    TERM_Destroy(&renderer);
+    CHAIN_Destroy(&chain);
+    close(pipes[0]);
+    close(pipes[1]);
+}
+
+void UT_TERM_Create_TooTallDrawingIsRejected(void)
+{
+    /* 8192 matrix modules stacked one per row need 65536 terminal rows */
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 8192);
+
+    TERM_Renderer renderer;
+    TEST_ASSERT_STATUS_EQ(TERM_StatusWrongSize, TERM_Create(&renderer, -1,
+            TERM_ModeMatrix, &chain, 1, 1));
+
+    /* One module less ends on the last addressable row */
+    CHAIN_Instance shorter;
+    CHAIN_Create(&shorter, 8191);
+    TEST_ASSERT_STATUS_EQ(TERM_StatusOk, TERM_Create(&renderer, -1,
+            TERM_ModeMatrix, &shorter, 1, 1));
+    TEST_ASSERT_EQUAL_UINT16(65528, renderer.height);
+
+    TERM_Destroy(&renderer);
+    CHAIN_Destroy(&shorter);
+    CHAIN_Destroy(&chain);
+}
@@ -0,0 +1,229 @@
+#include "ut.h"
+#include "unity.h"
+#include "trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define TEST_ASSERT_SIZE_EQ(EXP, ACT) TEST_ASSERT_EQUAL_size_t((EXP), (ACT))
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private data types -------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Copy of records passed by parser */
+typedef struct
+{
+    size count;
+    u64 chains[8];
+    u64 timestamps[8];
+    u16 frames[8];
+} Collected;
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Create temporary file, path buffer must hold at least 32 bytes */
+static FILE* OpenTemporary(char* path)
+{
+    strcpy(path, "/tmp/ut_trace_XXXXXX");
+    int fd = mkstemp(path);
+    return fdopen(fd, "w+b");
+}
+
+/* Count records passed by parser */
+static TRACE_Status CountRecord(void* context, const TRACE_Record* record)
+{
+    (void)record;
+    ++*(size*)context;
+    return TRACE_StatusOk;
+}
+
+/* Remember chain, timestamp and the first frame of every record */
+static TRACE_Status CollectRecord(void* context, const TRACE_Record* record)
+{
+    Collected* collected = context;
+    if (collected->count < 8) {
+        collected->chains[collected->count] = record->chain;
+        collected->timestamps[collected->count] = record->timestamp;
+        collected->frames[collected->count] =
+                (u16)(record->frames[0] | (record->frames[1] << 8));
+    }
+    ++collected->count;
+    return TRACE_StatusOk;
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_TRACE_DecodeRecord_FieldsAreRestored(void)
+{
+    const u8 data[] = {0x02, 0xAC, 0x02, 0x02, 0x01, 0x0C, 0x0F, 0x0A};
+    u64 timestamp = 1000;
+    TRACE_Record record;
+    size consumed;
+
+    TRACE_Status status = TRACE_DecodeRecord(data, sizeof(data), &timestamp,
+            &record, &consumed);
+
+    TEST_ASSERT_STATUS_EQ(TRACE_StatusOk, status);
+    TEST_ASSERT_EQUAL_UINT64(2, record.chain);
+    TEST_ASSERT_EQUAL_UINT64(1300, record.timestamp);
+    TEST_ASSERT_SIZE_EQ(2, record.count);
+    TEST_ASSERT_EQUAL_PTR(&data[4], record.frames);
+    TEST_ASSERT_SIZE_EQ(sizeof(data), consumed);
+    TEST_ASSERT_EQUAL_UINT64(1300, timestamp);
+}
+
+void UT_TRACE_DecodeRecord_TruncatedRecordIsDetected(void)
+{
+    const u8 data[] = {0x00, 0x01, 0x02, 0x01, 0x0C, 0x0F};
+    u64 timestamp = 0;
+    TRACE_Record record;
+    size consumed;
+
+    TRACE_Status status = TRACE_DecodeRecord(data, sizeof(data), &timestamp,
+            &record, &consumed);
+
+    TEST_ASSERT_STATUS_EQ(TRACE_StatusTruncated, status);
+    TEST_ASSERT_EQUAL_UINT64(0, timestamp);
+}
+
+void UT_TRACE_Parse_WrongSignatureIsRejected(void)
+{
+    u8 data[TRACE_HEADER_SIZE] = "NOTATRACE";
+    size records = 0;
+
+    TEST_ASSERT_STATUS_EQ(TRACE_StatusBadHeader,
+            TRACE_Parse(data, sizeof(data), CountRecord, &records));
+}
+
+void UT_TRACE_Replay_MappedTraceDrivesChains(void)
+{
+    char path[32];
+    FILE* file = OpenTemporary(path);
+    TRACE_Writer writer;
+    TRACE_WriterInit(&writer, file);
+
+    const u16 wake[] = {
+        MAX7219_FRAME(MAX7219_RegShutdown, 0x01),
+        MAX7219_FRAME(MAX7219_RegShutdown, 0x01)
+    };
+    const u16 digits[] = {
+        MAX7219_FRAME(MAX7219_RegDigit0, 0x18),
+        MAX7219_FRAME(MAX7219_RegDigit0, 0x81)
+    };
+    TRACE_WriteRecord(&writer, 1, 100, wake, 2);
+    TRACE_WriteRecord(&writer, 1, 250, digits, 2);
+    TRACE_WriteRecord(&writer, 0, 300, digits, 1);
+    fclose(file);
+
+    CHAIN_Instance chains[2];
+    CHAIN_Create(&chains[0], 1);
+    CHAIN_Create(&chains[1], 2);
+
+    TRACE_Mapping mapping;
+    TEST_ASSERT_STATUS_EQ(TRACE_StatusOk, TRACE_Map(&mapping, path));
+    TRACE_Status status = TRACE_Replay(&mapping, chains, 2);
+    TRACE_Unmap(&mapping);
+    unlink(path);
+
+    TEST_ASSERT_STATUS_EQ(TRACE_StatusOk, status);
+    TEST_ASSERT_EQUAL_UINT64(1, chains[0].tick);
+    TEST_ASSERT_EQUAL_UINT64(2, chains[1].tick);
+    TEST_ASSERT_EQUAL_HEX8(0x18, chains[0].devices[0].digit[0]);
+    CHAIN_Render(&chains[1]);
+    TEST_ASSERT_EQUAL_HEX64(UINT64_C(0x81), chains[1].framebuffer[0]);
+    TEST_ASSERT_EQUAL_HEX64(UINT64_C(0x18), chains[1].framebuffer[1]);
+
+    CHAIN_Destroy(&chains[0]);
+    CHAIN_Destroy(&chains[1]);
+}
+
+void UT_TRACE_Replay_UnknownChainIsReported(void)
+{
+    char path[32];
+    FILE* file = OpenTemporary(path);
+    TRACE_Writer writer;
+    TRACE_WriterInit(&writer, file);
+    const u16 frame = MAX7219_FRAME(MAX7219_RegNoOp, 0);
+    TRACE_WriteRecord(&writer, 5, 0, &frame, 1);
+    fclose(file);
+
+    CHAIN_Instance chain;
+    CHAIN_Create(&chain, 1);
+
+    TRACE_Mapping mapping;
+    TRACE_Map(&mapping, path);
+    TRACE_Status status = TRACE_Replay(&mapping, &chain, 1);
+    TRACE_Unmap(&mapping);
+    unlink(path);
+
+    TEST_ASSERT_STATUS_EQ(TRACE_StatusWrongChain, status);
+
+    CHAIN_Destroy(&chain);
+}
+
+void UT_TRACE_WriterInitCompressed_RepeatedRecordsAreRestored(void)
+{
+    char path[32];
+    FILE* file = OpenTemporary(path);
+    TRACE_Writer writer;
+    TEST_ASSERT_STATUS_EQ(TRACE_StatusOk,
+            TRACE_WriterInitCompressed(&writer, file));
+
+    const u16 row0 = MAX7219_FRAME(MAX7219_RegDigit0, 0x18);
+    const u16 row1 = MAX7219_FRAME(MAX7219_RegDigit0 + 1, 0x24);
+    const u16 other = MAX7219_FRAME(MAX7219_RegIntensity, 0x0F);
+
+    /* Two rows refreshed in a loop with jitter, one write to another chain */
+    TRACE_WriteRecord(&writer, 0, 1000, &row0, 1);
+    TRACE_WriteRecord(&writer, 0, 2000, &row1, 1);
+    TRACE_WriteRecord(&writer, 0, 3003, &row0, 1);
+    TRACE_WriteRecord(&writer, 1, 3500, &other, 1);
+    TRACE_WriteRecord(&writer, 0, 3990, &row1, 1);
+    TRACE_WriteRecord(&writer, 0, 5000, &row0, 1);
+    fclose(file);
+
+    TRACE_Mapping mapping;
+    TRACE_Map(&mapping, path);
+    Collected collected = {0};
+    TRACE_Status status = TRACE_Parse(mapping.data, mapping.length,
+            CollectRecord, &collected);
+    size length = mapping.length;
+    TRACE_Unmap(&mapping);
+    unlink(path);
+
+    const u64 chains[] = {0, 0, 0, 1, 0, 0};
+    const u64 timestamps[] = {1000, 2000, 3003, 3500, 3990, 5000};
+    const u16 frames[] = {row0, row1, row0, other, row1, row0};
+    TEST_ASSERT_STATUS_EQ(TRACE_StatusOk, status);
+    TEST_ASSERT_SIZE_EQ(6, collected.count);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(chains, collected.chains, 6);
+    TEST_ASSERT_EQUAL_UINT64_ARRAY(timestamps, collected.timestamps, 6);
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(frames, collected.frames, 6);
+
+    /* Three literals with a frame each, three bare references and three
+     * timestamp changes too large for a single byte varint */
+    TEST_ASSERT_SIZE_EQ(TRACE_HEADER_SIZE + 3 * 2 + 6 * 3 + 3, length);
+}
+
+void UT_TRACE_DecoderNext_MissingReferenceIsDetected(void)
+{
+    /* Chain 0, no delta change, reference to the newest entry */
+    const u8 data[] = {0x00, 0x00, 0x03};
+    TRACE_Decoder decoder;
+    TRACE_DecoderInit(&decoder, TRACE_FLAG_COMPRESSED);
+    TRACE_Record record;
+    size consumed;
+
+    TEST_ASSERT_STATUS_EQ(TRACE_StatusBadReference,
+            TRACE_DecoderNext(&decoder, data, sizeof(data), &record, &consumed));
+}
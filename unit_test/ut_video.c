@@ -0,0 +1,129 @@
+#include "ut.h"
+#include "unity.h"
+#include "video.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------- */
+/* ------------------------------ Private macros ---------------------------- */
+/* -------------------------------------------------------------------------- */
+
+#define FRAME_SIZE 192
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------- Private functions --------------------------- */
+/* -------------------------------------------------------------------------- */
+
+/* Read everything available in non-blocking pipe */
+static size Drain(int fd, u8* buffer, size capacity)
+{
+    ssize_t count = read(fd, buffer, capacity);
+    return (count > 0) ? (size)count : 0;
+}
+
+/* Sleep for given number of milliseconds */
+static void SleepMs(long milliseconds)
+{
+    struct timespec delay = {
+        .tv_sec = milliseconds / 1000,
+        .tv_nsec = (milliseconds % 1000) * 1000000L
+    };
+    nanosleep(&delay, NULL);
+}
+
+/* -------------------------------------------------------------------------- */
+/* ---------------------------------- Tests --------------------------------- */
+/* -------------------------------------------------------------------------- */
+
+void UT_VIDEO_Create_WrongArguments(void)
+{
+    VIDEO_Output video;
+    TEST_ASSERT_STATUS_EQ(VIDEO_StatusNullPtr, VIDEO_Create(NULL, 1, FRAME_SIZE, 30));
+    TEST_ASSERT_STATUS_EQ(VIDEO_StatusWrongSize, VIDEO_Create(&video, 1, 0, 30));
+    TEST_ASSERT_STATUS_EQ(VIDEO_StatusWrongSize, VIDEO_Create(&video, 1, FRAME_SIZE, 0));
+}
+
+void UT_VIDEO_Publish_FrameReplacedBeforeTickIsDropped(void)
+{
+    int pipes[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(pipes));
+    fcntl(pipes[0], F_SETFL, O_NONBLOCK);
+
+    /* The first tick is long gone and the next one is a second away */
+    VIDEO_Output video;
+    TEST_ASSERT_STATUS_EQ(VIDEO_StatusOk, VIDEO_Create(&video, pipes[1], FRAME_SIZE, 1));
+    SleepMs(20);
+
+    u8 first[FRAME_SIZE];
+    u8 second[FRAME_SIZE];
+    memset(first, 0x11, sizeof(first));
+    memset(second, 0x22, sizeof(second));
+    TEST_ASSERT_STATUS_EQ(VIDEO_StatusOk, VIDEO_Publish(&video, first));
+    TEST_ASSERT_STATUS_EQ(VIDEO_StatusOk, VIDEO_Publish(&video, second));
+    TEST_ASSERT_STATUS_EQ(VIDEO_StatusOk, VIDEO_Finish(&video));
+
+    static u8 output[4 * FRAME_SIZE];
+    TEST_ASSERT_EQUAL_size_t(FRAME_SIZE, Drain(pipes[0], output, sizeof(output)));
+    TEST_ASSERT_EQUAL_MEMORY(second, output, FRAME_SIZE);
+    TEST_ASSERT_EQUAL_UINT64(2, video.published);
+    TEST_ASSERT_EQUAL_UINT64(1, video.dropped);
+    TEST_ASSERT_EQUAL_UINT64(1, video.written);
+
+    VIDEO_Destroy(&video);
+    close(pipes[0]);
+    close(pipes[1]);
+}
+
+void UT_VIDEO_Publish_MissingFramesAreDuplicated(void)
+{
+    int pipes[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(pipes));
+    fcntl(pipes[0], F_SETFL, O_NONBLOCK);
+
+    VIDEO_Output video;
+    VIDEO_Create(&video, pipes[1], FRAME_SIZE, 200);
+
+    u8 frame[FRAME_SIZE];
+    memset(frame, 0x5A, sizeof(frame));
+    VIDEO_Publish(&video, frame);
+    SleepMs(50);
+    VIDEO_Finish(&video);
+
+    /* Nothing is published after the first frame, every tick repeats it */
+    static u8 output[64 * FRAME_SIZE];
+    size length = Drain(pipes[0], output, sizeof(output));
+    TEST_ASSERT_EQUAL_size_t(0, length % FRAME_SIZE);
+    TEST_ASSERT_EQUAL_size_t(video.written, length / FRAME_SIZE);
+    TEST_ASSERT_TRUE(video.written >= 2);
+    TEST_ASSERT_EQUAL_UINT64(video.written - 1, video.duplicated);
+    for (size i = 0; i < length; i += FRAME_SIZE) {
+        TEST_ASSERT_EQUAL_MEMORY(frame, output + i, FRAME_SIZE);
+    }
+
+    VIDEO_Destroy(&video);
+    close(pipes[0]);
+    close(pipes[1]);
+}
+
+void UT_VIDEO_Publish_WriteErrorIsReported(void)
+{
+    int pipes[2];
+    TEST_ASSERT_EQUAL_INT(0, pipe(pipes));
+    close(pipes[1]);
+
+    /* Writing into a closed descriptor fails without raising a signal */
+    VIDEO_Output video;
+    VIDEO_Create(&video, pipes[1], FRAME_SIZE, 1000);
+
+    u8 frame[FRAME_SIZE] = {0};
+    VIDEO_Publish(&video, frame);
+    SleepMs(20);
+    TEST_ASSERT_STATUS_EQ(VIDEO_StatusIoError, VIDEO_Publish(&video, frame));
+    TEST_ASSERT_STATUS_EQ(VIDEO_StatusIoError, VIDEO_Finish(&video));
+
+    VIDEO_Destroy(&video);
+    close(pipes[0]);
+}